@@ -7,6 +7,7 @@
 #include "../request.hpp"
 #include "../pipeline/discover-version.hpp"
 #include "../pipeline/statistics-collector.hpp"
+#include "logging.hpp"
 
 #include <boost/lexical_cast.hpp>
 #include <boost/algorithm/string.hpp>
@@ -100,7 +101,7 @@ namespace ndn::chunks
     void
     Aggregator::processSegmentInterest(const Interest &interest)
     {
-        spdlog::info("Received interest: {}", interest.getName().toUri());
+        LOG_DEBUG(Log::AGGREGATOR, "Received interest: {}", interest.getName().toUri());
         // Parse child node names from the interest
         static bool isFirst = true;
         if (isFirst)
@@ -118,7 +119,7 @@ namespace ndn::chunks
     {
         m_originalInterest = interest;
         m_hasOriginalInterest = true;
-        spdlog::debug("Stored original interest: {}", interest.getName().toUri());
+        LOG_DEBUG(Log::AGGREGATOR, "Stored original interest: {}", interest.getName().toUri());
     }
 
     void Aggregator::respondToInterest(const Interest &interest)
@@ -127,15 +128,15 @@ namespace ndn::chunks
         uint64_t chunkNo = std::stoi(name[-2].toUri());
         if (m_flowController->isChunkProcessed(chunkNo))
         {
-            spdlog::debug("Producer::processSegmentInterest()");
+            LOG_DEBUG(Log::AGGREGATOR, "Producer::processSegmentInterest()");
             if (m_options.isVerbose)
             {
                 std::cerr << "Interest: " << interest << "\n";
-                spdlog::info("Interest: {}", interest.getName().toUri());
+                LOG_DEBUG(Log::AGGREGATOR, "Interest: {}", interest.getName().toUri());
             }
             const Name &name = interest.getName();
             uint64_t chunkNo = std::stoi(name[-2].toUri());
-            spdlog::debug("chunkNo is {}", chunkNo);
+            LOG_DEBUG(Log::AGGREGATOR, "chunkNo is {}", chunkNo);
 
             if (m_store[chunkNo].empty())
             {
@@ -170,7 +171,7 @@ namespace ndn::chunks
                 if (m_options.isVerbose)
                 {
                     std::cerr << "Data: " << *data << "\n";
-                    spdlog::info("Data: {}", (*data).getName().toUri());
+                    LOG_DEBUG(Log::AGGREGATOR, "Data: {}", (*data).getName().toUri());
                 }
                 m_face.put(*data);
 
@@ -186,7 +187,7 @@ namespace ndn::chunks
                         if (sentSegments == totalSegments)
                         {
                             m_store.erase(chunkNo);
-                            spdlog::debug("Cleared chunk {} after sending {} segments ", chunkNo, sentSegments);
+                            LOG_DEBUG(Log::AGGREGATOR, "Cleared chunk {} after sending {} segments ", chunkNo, sentSegments);
                         }
                     }
                 }
@@ -238,7 +239,7 @@ namespace ndn::chunks
             responseData->setContent(makeStringBlock(tlv::Content, responseContent));
 
             // Sign the data packet
-            m_keyChain.sign(*responseData);
+            m_keyChain.sign(*responseData, m_options.signingInfo);
 
             // Send the data packet back
             m_face.put(*responseData);
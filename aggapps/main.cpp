@@ -8,6 +8,7 @@
 
 #include <iostream>
 #include <spdlog/sinks/basic_file_sink.h>
+#include "logging.hpp"
 #include <ndn-cxx/security/validator-null.hpp>
 
 namespace ndn::chunks
@@ -78,10 +79,7 @@ namespace ndn::chunks
     main(int argc, char *argv[])
     {
         // Initialize logging
-        auto m_logger = spdlog::basic_logger_mt("aggregator_logger", "logs/aggregator.log");
-        spdlog::set_default_logger(m_logger);
-        spdlog::set_level(spdlog::level::debug);
-        spdlog::flush_on(spdlog::level::debug);
+        auto m_logger = Log::init("aggregator_logger", "logs/aggregator.log", "../experiments/aggregatorput.ini");
         spdlog::debug("Started aggregator");
 
         const std::string programName(argv[0]);
@@ -142,8 +140,8 @@ namespace ndn::chunks
         }
 
         // Update logging settings
-        spdlog::set_level(spdlog::level::from_str(logLevel));
-        spdlog::flush_on(spdlog::level::from_str(logLevel));
+        // Subsystems with a level of their own in [Log] keep it, flushing follows Log.FlushLevel
+        Log::setLevel(spdlog::level::from_str(logLevel));
 
         try
         {
@@ -1,6 +1,7 @@
 #include "pipeline-interests-adaptive.hpp"
 #include "data-fetcher.hpp"
 #include "../chunk/chunks-interests-adaptive.hpp"
+#include "logging.hpp"
 
 #include <boost/lexical_cast.hpp>
 #include <iomanip>
@@ -45,7 +46,7 @@ namespace ndn::chunks
   void
   PipelineInterestsAdaptive::doCancel()
   {
-    spdlog::debug("PipelineInterestsAdaptive::doCancel() in chunumber {}", m_prefix.get(-1).toUri());
+    LOG_DEBUG(Log::PIPELINE, "PipelineInterestsAdaptive::doCancel() in chunumber {}", m_prefix.get(-1).toUri());
     m_checkRtoEvent.cancel();
     m_segmentInfo.clear();
   }
@@ -70,7 +71,7 @@ namespace ndn::chunks
           m_nTimeouts++;
           hasTimeout = true;
           highTimeoutSeg = std::max(highTimeoutSeg, entry.first);
-          spdlog::debug("enqueue happened from checkRto");
+          LOG_DEBUG(Log::PIPELINE, "enqueue happened from checkRto");
           enqueueForRetransmission(entry.first);
         }
       }
@@ -85,7 +86,7 @@ namespace ndn::chunks
       }
       else
       {
-        spdlog::debug("should pause flow");
+        LOG_DEBUG(Log::PIPELINE, "should pause flow");
       }
     }
 
@@ -106,7 +107,7 @@ namespace ndn::chunks
     if (!isRetransmission && m_hasFailure)
       return;
 
-    spdlog::info("Send interest for segment #{}", segNo);
+    LOG_DEBUG(Log::PIPELINE, "Send interest for segment #{}", segNo);
 
     if (m_options.isVerbose)
     {
@@ -135,7 +136,7 @@ namespace ndn::chunks
         {
           std::cerr << "# of retries for segment #" << segNo
                     << " is " << m_retxCount[segNo] << "\n";
-          spdlog::info("# of retries for segment #{} is {}", segNo, m_retxCount[segNo]);
+          LOG_DEBUG(Log::PIPELINE, "# of retries for segment #{} is {}", segNo, m_retxCount[segNo]);
         }
       }
     }
@@ -150,10 +151,10 @@ namespace ndn::chunks
                                                  FORWARD_TO_MEM_FN(handleData),
                                                  FORWARD_TO_MEM_FN(handleNack),
                                                  FORWARD_TO_MEM_FN(handleLifetimeExpiration));
-    spdlog::debug("Interest name: {}", interest.getName().toUri());
+    LOG_DEBUG(Log::PIPELINE, "Interest name: {}", interest.getName().toUri());
     segInfo.timeSent = time::steady_clock::now();
     segInfo.rto = m_rttEstimator.getEstimatedRto();
-    spdlog::debug("In flight increment from sendInterest,m_infight is {},real m_inflight is {} in chunknumber {}", m_chunker->safe_getInFlight(), m_nInFlight, m_prefix.get(-1).toUri());
+    LOG_DEBUG(Log::PIPELINE, "In flight increment from sendInterest,m_infight is {},real m_inflight is {} in chunknumber {}", m_chunker->safe_getInFlight(), m_nInFlight, m_prefix.get(-1).toUri());
     m_chunker->safe_InFlightIncrement();
     m_nInFlight++;
     m_nSent++;
@@ -173,13 +174,13 @@ namespace ndn::chunks
   void
   PipelineInterestsAdaptive::schedulePackets()
   {
-    spdlog::debug("Pipeline schedule packets");
-    spdlog::debug("In flight: {} from {},real m_ninflight {} in chunknumber {}", m_chunker->safe_getInFlight(), m_prefix.get(0).toUri(), m_nInFlight, m_prefix.get(-1).toUri());
-    spdlog::debug("Window size: {} from {}", m_chunker->safe_getWindowSize(), m_prefix.get(0).toUri());
+    LOG_DEBUG(Log::PIPELINE, "Pipeline schedule packets");
+    LOG_DEBUG(Log::PIPELINE, "In flight: {} from {},real m_ninflight {} in chunknumber {}", m_chunker->safe_getInFlight(), m_prefix.get(0).toUri(), m_nInFlight, m_prefix.get(-1).toUri());
+    LOG_DEBUG(Log::PIPELINE, "Window size: {} from {}", m_chunker->safe_getWindowSize(), m_prefix.get(0).toUri());
     BOOST_ASSERT(m_chunker->safe_getInFlight() >= 0);
     BOOST_ASSERT(m_nInFlight >= 0);
     auto availableWindowSize = static_cast<int64_t>(m_chunker->safe_getWindowSize()) - m_chunker->safe_getInFlight();
-    spdlog::debug("Available window size: {}", availableWindowSize);
+    LOG_DEBUG(Log::PIPELINE, "Available window size: {}", availableWindowSize);
     // TODO: this logic is actually wrong, we should consider more about how to fit the available window size
     /*
     When the chunk isn't needed, the retransmission would definitely be sent because before all the data are received.
@@ -200,7 +201,7 @@ namespace ndn::chunks
       //   setStartTime(time::steady_clock::now());
       //   m_hasSent = true;
       // }
-      spdlog::debug("Available window size: {}", availableWindowSize);
+      LOG_DEBUG(Log::PIPELINE, "Available window size: {}", availableWindowSize);
       if (!m_retxQueue.empty())
       { // do retransmission first
         uint64_t retxSegNo = m_retxQueue.front();
@@ -215,7 +216,7 @@ namespace ndn::chunks
       }
       else
       { // send next segment
-        spdlog::debug("Send next segment not retransmission");
+        LOG_DEBUG(Log::PIPELINE, "Send next segment not retransmission");
         sendInterest(getNextSegmentNo(), false);
       }
       availableWindowSize--;
@@ -227,7 +228,7 @@ namespace ndn::chunks
       {
         m_scheduleEvent.cancel();
       }
-      spdlog::debug("schedule beacause of inflight is 0");
+      LOG_DEBUG(Log::PIPELINE, "schedule beacause of inflight is 0");
 
       m_scheduleEvent = m_scheduler.schedule(time::milliseconds(0), [this]
                                              { schedulePackets(); });
@@ -240,8 +241,8 @@ namespace ndn::chunks
   void
   PipelineInterestsAdaptive::wait()
   {
-    spdlog::info("Pipeline wait and m_hasFinalBlockId is {}", m_hasFinalBlockId);
-    spdlog::info("m_nSent is {} and m_nRetransimitted is {} and m_lastSegmentNo is{}", m_nSent, m_nRetransmitted, m_lastSegmentNo);
+    LOG_DEBUG(Log::PIPELINE, "Pipeline wait and m_hasFinalBlockId is {}", m_hasFinalBlockId);
+    LOG_DEBUG(Log::PIPELINE, "m_nSent is {} and m_nRetransimitted is {} and m_lastSegmentNo is{}", m_nSent, m_nRetransmitted, m_lastSegmentNo);
     if (m_waitEvent)
     {
       m_waitEvent.cancel();
@@ -255,7 +256,7 @@ namespace ndn::chunks
       }
       else
       {
-        spdlog::debug("should pause flow");
+        LOG_DEBUG(Log::PIPELINE, "should pause flow");
         m_waitEvent = m_scheduler.schedule(time::milliseconds(0), [this]
                                            { wait(); });
       }
@@ -269,7 +270,7 @@ namespace ndn::chunks
   void
   PipelineInterestsAdaptive::handleData(const Interest &interest, const Data &data)
   {
-    spdlog::info("Received data for interest {}", interest.getName().toUri());
+    LOG_DEBUG(Log::PIPELINE, "Received data for interest {}", interest.getName().toUri());
     if (isStopping())
       return;
 
@@ -278,7 +279,7 @@ namespace ndn::chunks
 
     auto &received = *(m_chunker->getReceived());
     received += data.getContent().value_size();
-    spdlog::debug("Received {} bytes, total received: {}", data.getContent().value_size(), received);
+    LOG_DEBUG(Log::PIPELINE, "Received {} bytes, total received: {}", data.getContent().value_size(), received);
     if (!m_hasFinalBlockId && data.getFinalBlock())
     {
       m_lastSegmentNo = data.getFinalBlock()->toSegment();
@@ -309,7 +310,7 @@ namespace ndn::chunks
       std::cerr << "Received segment #" << recvSegNo
                 << ", rtt=" << rtt.count() / 1e6 << "ms"
                 << ", rto=" << segInfo.rto.count() / 1e6 << "ms\n";
-      spdlog::info("Received segment #{}: rtt={}ms, rto={}ms", recvSegNo, rtt.count() / 1e6, segInfo.rto.count() / 1e6);
+      LOG_DEBUG(Log::PIPELINE, "Received segment #{}: rtt={}ms, rto={}ms", recvSegNo, rtt.count() / 1e6, segInfo.rto.count() / 1e6);
     }
 
     m_highData = std::max(m_highData, recvSegNo);
@@ -319,7 +320,7 @@ namespace ndn::chunks
     if (segInfo.state != SegmentState::InRetxQueue)
     {
 
-      spdlog::debug("In flight decrement from handleData,m_infight is {},real m_inflight is {} in chunknumber {}", m_chunker->safe_getInFlight(), m_nInFlight, m_prefix.get(-1).toUri());
+      LOG_DEBUG(Log::PIPELINE, "In flight decrement from handleData,m_infight is {},real m_inflight is {} in chunknumber {}", m_chunker->safe_getInFlight(), m_nInFlight, m_prefix.get(-1).toUri());
       m_chunker->safe_InFlightDecrement();
       m_nInFlight--;
     }
@@ -342,7 +343,7 @@ namespace ndn::chunks
           {
             std::cerr << "Received congestion mark, value = " << data.getCongestionMark()
                       << ", new cwnd = " << m_chunker->safe_getWindowSize() << "\n";
-            spdlog::info("Received congestion mark, value = {}, new cwnd = {}", data.getCongestionMark(), m_chunker->safe_getWindowSize());
+            LOG_INFO(Log::PIPELINE, "Received congestion mark, value = {}, new cwnd = {}", data.getCongestionMark(), m_chunker->safe_getWindowSize());
           }
         }
       }
@@ -389,7 +390,7 @@ namespace ndn::chunks
       }
       else
       {
-        spdlog::debug("should pause flow");
+        LOG_DEBUG(Log::PIPELINE, "should pause flow");
       }
     }
   }
@@ -404,7 +405,7 @@ namespace ndn::chunks
     {
       std::cerr << "Received Nack with reason " << nack.getReason()
                 << " for Interest " << interest << "\n";
-      spdlog::info("Received Nack with reason {} for Interest {}", boost::lexical_cast<std::string>(nack.getReason()), interest.getName().toUri());
+      LOG_INFO(Log::PIPELINE, "Received Nack with reason {} for Interest {}", boost::lexical_cast<std::string>(nack.getReason()), interest.getName().toUri());
     }
 
     uint64_t segNo = getSegmentFromPacket(interest);
@@ -416,7 +417,7 @@ namespace ndn::chunks
       break;
     case lp::NackReason::CONGESTION:
       // treated the same as timeout for now
-      spdlog::debug("enqueue happened from handleNack");
+      LOG_DEBUG(Log::PIPELINE, "enqueue happened from handleNack");
       enqueueForRetransmission(segNo);
       recordTimeout(segNo);
       if (!(m_chunker->getSplitinterest()->m_flowController->shouldPauseFlow(m_prefix.get(0).toUri())))
@@ -425,7 +426,7 @@ namespace ndn::chunks
       }
       else
       {
-        spdlog::debug("should pause flow");
+        LOG_DEBUG(Log::PIPELINE, "should pause flow");
       }
       break;
     default:
@@ -444,13 +445,13 @@ namespace ndn::chunks
     uint64_t segNo = getSegmentFromPacket(interest);
     if (m_segmentInfo.at(segNo).state == SegmentState::InRetxQueue)
     {
-      spdlog::debug("handleLifetimeExpiration, the segment is already in retx queue");
+      LOG_DEBUG(Log::PIPELINE, "handleLifetimeExpiration, the segment is already in retx queue");
       return;
     }
 
     m_nTimeouts++;
 
-    spdlog::debug("enqueue happened from handleLifetimeExpiration");
+    LOG_DEBUG(Log::PIPELINE, "enqueue happened from handleLifetimeExpiration");
     enqueueForRetransmission(segNo);
     recordTimeout(segNo);
     if (!(m_chunker->getSplitinterest()->m_flowController->shouldPauseFlow(m_prefix.get(0).toUri())))
@@ -459,7 +460,7 @@ namespace ndn::chunks
     }
     else
     {
-      spdlog::debug("should pause flow");
+      LOG_DEBUG(Log::PIPELINE, "should pause flow");
     }
   }
 
@@ -473,7 +474,7 @@ namespace ndn::chunks
       m_recPoint = m_highInterest;
 
       decreaseWindow();
-      spdlog::info("Timeout event, new cwnd = {}", m_chunker->safe_getWindowSize());
+      LOG_INFO(Log::PIPELINE, "Timeout event, new cwnd = {}", m_chunker->safe_getWindowSize());
       m_rttEstimator.backoffRto();
       m_nLossDecr++;
 
@@ -481,7 +482,7 @@ namespace ndn::chunks
       {
         std::cerr << "Packet loss event, new cwnd = " << m_chunker->safe_getWindowSize()
                   << ", ssthresh = " << m_chunker->safe_getSsthresh() << "\n";
-        spdlog::info("Packet loss event, new cwnd = {}, ssthresh = {}", m_chunker->safe_getWindowSize(), m_chunker->safe_getSsthresh());
+        LOG_INFO(Log::PIPELINE, "Packet loss event, new cwnd = {}, ssthresh = {}", m_chunker->safe_getWindowSize(), m_chunker->safe_getSsthresh());
       }
     }
   }
@@ -489,10 +490,10 @@ namespace ndn::chunks
   void
   PipelineInterestsAdaptive::enqueueForRetransmission(uint64_t segNo)
   {
-    spdlog::debug("in flight is {} from {} and m_ninflight is {} in chunumber {} with segNo {}", m_chunker->safe_getInFlight(), m_prefix.get(0).toUri(), m_nInFlight, m_prefix.get(-1).toUri(), segNo);
+    LOG_DEBUG(Log::PIPELINE, "in flight is {} from {} and m_ninflight is {} in chunumber {} with segNo {}", m_chunker->safe_getInFlight(), m_prefix.get(0).toUri(), m_nInFlight, m_prefix.get(-1).toUri(), segNo);
     BOOST_ASSERT(m_chunker->safe_getInFlight() > 0);
     BOOST_ASSERT(m_nInFlight > 0);
-    spdlog::debug("inflight decrement from enqueueForRetransmission,m_infight is {},real m_ninflight is{} in chunknumber {}", m_chunker->safe_getInFlight(), m_nInFlight, m_prefix.get(-1).toUri());
+    LOG_DEBUG(Log::PIPELINE, "inflight decrement from enqueueForRetransmission,m_infight is {},real m_ninflight is{} in chunknumber {}", m_chunker->safe_getInFlight(), m_nInFlight, m_prefix.get(-1).toUri());
     m_chunker->safe_InFlightDecrement();
     m_nInFlight--;
     m_retxQueue.push(segNo);
@@ -524,7 +525,7 @@ namespace ndn::chunks
     if (!m_hasFinalBlockId)
     {
       m_segmentInfo.erase(segNo);
-      spdlog::debug("inflight decrement from handleFail,m_infight is {},real m_inflight is {} in chunknumber {}", m_chunker->safe_getInFlight(), m_nInFlight, m_prefix.get(-1).toUri());
+      LOG_DEBUG(Log::PIPELINE, "inflight decrement from handleFail,m_infight is {},real m_inflight is {} in chunknumber {}", m_chunker->safe_getInFlight(), m_nInFlight, m_prefix.get(-1).toUri());
       m_chunker->safe_InFlightDecrement();
       m_nInFlight--;
 
@@ -545,7 +546,7 @@ namespace ndn::chunks
   void
   PipelineInterestsAdaptive::cancelInFlightSegmentsGreaterThan(uint64_t segNo)
   {
-    spdlog::debug("cancelInFlightSegmentsGreaterThan {}", segNo);
+    LOG_DEBUG(Log::PIPELINE, "cancelInFlightSegmentsGreaterThan {}", segNo);
     for (auto it = m_segmentInfo.begin(); it != m_segmentInfo.end();)
     {
       // cancel fetching all segments that follow
@@ -1,6 +1,7 @@
 #include "request.hpp"
 #include <boost/property_tree/ini_parser.hpp>
 #include <spdlog/sinks/basic_file_sink.h>
+#include "logging.hpp"
 
 namespace ndn::chunks
 {
@@ -12,18 +13,7 @@ namespace ndn::chunks
     {
         rttEstOptions->k = 8; // Increased from the ndn-cxx default of 4
 
-        // Setup logger
-        try
-        {
-            auto logger = spdlog::basic_logger_mt("request_logger", "logs/aggregator.log");
-            spdlog::set_default_logger(logger);
-            spdlog::set_level(spdlog::level::debug);
-            spdlog::flush_on(spdlog::level::debug);
-        }
-        catch (const spdlog::spdlog_ex &e)
-        {
-            std::cerr << "Logger initialization failed: " << e.what() << std::endl;
-        }
+        // Logs go to the aggregator's logger (Log::init() in main), setLogLevel() only tunes the pipeline subsystem
     }
 
     Request::~Request()
@@ -117,9 +107,7 @@ namespace ndn::chunks
     {
         try
         {
-            spdlog::level::level_enum logLevel = spdlog::level::from_str(level);
-            spdlog::set_level(logLevel);
-            spdlog::flush_on(logLevel);
+            Log::setLevel(Log::PIPELINE, spdlog::level::from_str(level));
         }
         catch (const std::exception &e)
         {
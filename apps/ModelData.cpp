@@ -1,35 +1,392 @@
 #include "ModelData.hpp"
 #include <cstring> // for memcpy
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <sstream>
+#include "kernels/reduce.hpp"
+#include "logging.hpp"
 #include <spdlog/spdlog.h>
 
-/**
- * Constructor
- */
-ModelData::ModelData()
-    : qsf(-1.0) // Initialize qsf as a double
+ModelSchema::ModelSchema()
+    : m_parameterCount(0),
+      m_encoding(ModelEncoding::FP64),
+      m_topkRatio(0.1),
+      m_segmentSize(0),
+      m_segmentCount(1)
+{
+}
+
+const ModelSchema &ModelSchema::instance()
 {
     // waiting for modify path
-    int parameterSize = readDataSizeFromConfig("../experiments/config.ini");
-    parameters.resize(parameterSize, 0.0);
+    static const ModelSchema schema = fromConfig("../experiments/config.ini");
+    return schema;
 }
 
-// Function to read DataSize from the [General] section of a configuration file
-int readDataSizeFromConfig(const std::string &filename)
+ModelSchema ModelSchema::fromConfig(const std::string &filename)
 {
+    ModelSchema schema;
+    int dataSize = 150; // Default value on error
+    int segmentSize = 0;
     boost::property_tree::ptree pt;
     try
     {
         boost::property_tree::ini_parser::read_ini(filename, pt);
-        int dataSize = pt.get<int>("General.DataSize"); // Using get to fetch the value and convert to int
-        return dataSize;
+        dataSize = pt.get<int>("General.DataSize", dataSize);
+        schema.m_encoding = parseModelEncoding(pt.get<std::string>("General.Encoding", "fp64"));
+        schema.m_topkRatio = pt.get<double>("General.TopKRatio", 0.1);
+        segmentSize = pt.get<int>("General.SegmentSize", 0);
     }
     catch (const std::exception &e)
     {
         spdlog::error("Exception caught: {}", e.what());
-        return 150; // Default value on error
     }
+
+    if (auto tensors = pt.get_child_optional("Tensors"))
+    {
+        for (const auto &[name, value] : *tensors)
+        {
+            // "64x3x3x3 float32"
+            std::istringstream iss(value.data());
+            std::string dims, dtype;
+            iss >> dims >> dtype;
+
+            std::vector<size_t> shape;
+            std::istringstream dimStream(dims);
+            std::string dim;
+            bool valid = !dims.empty();
+            while (valid && std::getline(dimStream, dim, 'x'))
+            {
+                try
+                {
+                    size_t pos = 0;
+                    unsigned long extent = std::stoul(dim, &pos);
+                    valid = pos == dim.size() && extent > 0;
+                    shape.push_back(extent);
+                }
+                catch (const std::exception &)
+                {
+                    valid = false;
+                }
+            }
+            if (!valid)
+            {
+                spdlog::error("Invalid shape \"{}\" for tensor {}, skipped", value.data(), name);
+                continue;
+            }
+            schema.addTensor(name, dtype.empty() ? "float64" : dtype, std::move(shape));
+        }
+    }
+
+    if (schema.m_tensors.empty())
+    {
+        schema.addTensor("parameters", "float64", {static_cast<size_t>(std::max(dataSize, 0))});
+    }
+    else if (pt.get_optional<int>("General.DataSize") && static_cast<size_t>(dataSize) != schema.m_parameterCount)
+    {
+        spdlog::warn("General.DataSize {} ignored, [Tensors] describe {} parameters", dataSize, schema.m_parameterCount);
+    }
+
+    schema.setSegmentSize(static_cast<size_t>(std::max(segmentSize, 0)));
+
+    spdlog::info("Model schema: {} tensors, {} parameters, encoding {}, {} segments of {} parameters",
+                 schema.m_tensors.size(), schema.m_parameterCount, modelEncodingName(schema.m_encoding),
+                 schema.m_segmentCount, schema.m_segmentSize);
+    return schema;
+}
+
+void ModelSchema::addTensor(const std::string &name, const std::string &dtype, std::vector<size_t> shape)
+{
+    size_t size = std::accumulate(shape.begin(), shape.end(), size_t(1), std::multiplies<size_t>());
+    m_tensors.push_back(TensorSpec{name, dtype, std::move(shape), m_parameterCount, size});
+    m_parameterCount += size;
+}
+
+void ModelSchema::setSegmentSize(size_t segmentSize)
+{
+    if (segmentSize == 0)
+    {
+        // Encoded bytes per parameter
+        double bytes = 8.0;
+        switch (m_encoding)
+        {
+        case ModelEncoding::FP64:
+            bytes = sizeof(double);
+            break;
+        case ModelEncoding::FP16:
+        case ModelEncoding::BF16:
+            bytes = sizeof(uint16_t);
+            break;
+        case ModelEncoding::INT8:
+            bytes = 1.0 + static_cast<double>(sizeof(float)) / INT8_BLOCK_SIZE;
+            break;
+        case ModelEncoding::TOPK:
+            bytes = std::max(m_topkRatio, 1e-6) * (sizeof(uint32_t) + sizeof(float));
+            break;
+        }
+        segmentSize = static_cast<size_t>((SEGMENT_PAYLOAD_BUDGET - sizeof(uint32_t)) / bytes);
+    }
+    m_segmentSize = std::max<size_t>(std::min(segmentSize, m_parameterCount), 1);
+    m_segmentCount = static_cast<uint32_t>(std::max<size_t>((m_parameterCount + m_segmentSize - 1) / m_segmentSize, 1));
+}
+
+const TensorSpec *ModelSchema::find(const std::string &name) const
+{
+    auto it = std::find_if(m_tensors.begin(), m_tensors.end(), [&name](const TensorSpec &tensor)
+                           { return tensor.name == name; });
+    return it != m_tensors.end() ? &*it : nullptr;
 }
 
+/**
+ * Constructor
+ */
+ModelData::ModelData()
+    : ModelData(ModelSchema::instance())
+{
+}
+
+ModelData::ModelData(const ModelSchema &schema)
+    : parameters(schema.parameterCount(), 0.0),
+      contributors(1),
+      qsf(-1.0), // Initialize qsf as a double
+      encoding(schema.encoding()),
+      topkRatio(schema.topkRatio())
+{
+}
+
+ModelData::ModelData(const ModelSchema &schema, uint32_t segment)
+    : parameters(schema.segmentLength(segment), 0.0),
+      contributors(1),
+      qsf(-1.0),
+      encoding(schema.encoding()),
+      topkRatio(schema.topkRatio())
+{
+}
+
+ModelEncoding parseModelEncoding(const std::string &name)
+{
+    if (name == "fp16")
+        return ModelEncoding::FP16;
+    if (name == "bf16")
+        return ModelEncoding::BF16;
+    if (name == "int8")
+        return ModelEncoding::INT8;
+    if (name == "topk")
+        return ModelEncoding::TOPK;
+    if (name != "fp64")
+        spdlog::warn("Unknown model encoding {}, falling back to fp64", name);
+    return ModelEncoding::FP64;
+}
+
+const char *modelEncodingName(ModelEncoding encoding)
+{
+    switch (encoding)
+    {
+    case ModelEncoding::FP64:
+        return "fp64";
+    case ModelEncoding::FP16:
+        return "fp16";
+    case ModelEncoding::BF16:
+        return "bf16";
+    case ModelEncoding::INT8:
+        return "int8";
+    case ModelEncoding::TOPK:
+        return "topk";
+    }
+    return "unknown";
+}
+
+namespace
+{
+    // Encoding tag, parameter count, payload size and contributor count in front of the parameter block
+    constexpr size_t HEADER_SIZE = sizeof(uint8_t) + 3 * sizeof(uint32_t);
+    constexpr size_t PAYLOAD_SIZE_OFFSET = sizeof(uint8_t) + sizeof(uint32_t);
+    constexpr size_t CONTRIBUTORS_OFFSET = PAYLOAD_SIZE_OFFSET + sizeof(uint32_t);
+    constexpr size_t TOPK_ENTRY_SIZE = sizeof(uint32_t) + sizeof(float);
+    // Doubles copied out of a misaligned FP64 payload at a time, 8 KB of stack
+    constexpr size_t FP64_CHUNK = 1024;
+
+    template <typename T>
+    void appendValue(std::vector<uint8_t> &buffer, T value)
+    {
+        const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&value);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+    }
+
+    template <typename T>
+    T readValue(const uint8_t *p)
+    {
+        T value;
+        std::memcpy(&value, p, sizeof(T));
+        return value;
+    }
+
+    // IEEE 754 binary16, round to nearest even, out of range values become infinity
+    uint16_t floatToHalf(float value)
+    {
+        uint32_t bits = readValue<uint32_t>(reinterpret_cast<const uint8_t *>(&value));
+        uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+        uint32_t absBits = bits & 0x7fffffff;
+
+        if (absBits >= 0x7f800000) // inf or nan
+            return sign | 0x7c00 | (absBits > 0x7f800000 ? 0x200 : 0);
+        if (absBits >= 0x477ff000) // rounds above 65504
+            return sign | 0x7c00;
+        if (absBits < 0x38800000) // half subnormal or zero, 2^24 is the subnormal step
+            return sign | static_cast<uint16_t>(std::nearbyint(std::fabs(value) * 16777216.0f));
+
+        uint32_t half = ((absBits >> 23) - 112) << 10 | ((absBits & 0x7fffff) >> 13);
+        uint32_t rest = absBits & 0x1fff;
+        if (rest > 0x1000 || (rest == 0x1000 && (half & 1)))
+            ++half;
+        return sign | static_cast<uint16_t>(half);
+    }
+
+    float halfToFloat(uint16_t half)
+    {
+        uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+        uint32_t exponent = (half >> 10) & 0x1f;
+        uint32_t mantissa = half & 0x3ff;
+        if (exponent == 0)
+        {
+            float value = static_cast<float>(mantissa) / 16777216.0f;
+            return sign ? -value : value;
+        }
+        uint32_t bits = exponent == 0x1f ? sign | 0x7f800000 | mantissa << 13
+                                         : sign | (exponent + 112) << 23 | mantissa << 13;
+        float value;
+        std::memcpy(&value, &bits, sizeof(float));
+        return value;
+    }
+
+    // bfloat16 is the upper half of a float, round to nearest even
+    uint16_t floatToBFloat16(float value)
+    {
+        uint32_t bits = readValue<uint32_t>(reinterpret_cast<const uint8_t *>(&value));
+        if ((bits & 0x7fffffff) > 0x7f800000)
+            return static_cast<uint16_t>((bits >> 16) | 0x40);
+        bits += 0x7fff + ((bits >> 16) & 1);
+        return static_cast<uint16_t>(bits >> 16);
+    }
+
+    float bfloat16ToFloat(uint16_t bf16)
+    {
+        uint32_t bits = static_cast<uint32_t>(bf16) << 16;
+        float value;
+        std::memcpy(&value, &bits, sizeof(float));
+        return value;
+    }
+
+    size_t topkCount(size_t parameterCount, double ratio)
+    {
+        if (parameterCount == 0)
+            return 0;
+        size_t k = static_cast<size_t>(std::ceil(ratio * static_cast<double>(parameterCount)));
+        return std::clamp<size_t>(k, 1, parameterCount);
+    }
+
+    void encodeParameters(const std::vector<double> &parameters, ModelEncoding encoding, double topkRatio, uint32_t contributors,
+                          std::vector<uint8_t> &buffer)
+    {
+        const size_t count = parameters.size();
+        switch (encoding)
+        {
+        case ModelEncoding::FP64:
+        {
+            const uint8_t *bytes = reinterpret_cast<const uint8_t *>(parameters.data());
+            buffer.insert(buffer.end(), bytes, bytes + count * sizeof(double));
+            break;
+        }
+        case ModelEncoding::FP16:
+        case ModelEncoding::BF16:
+        {
+            // The mean on the wire, accumulateModelData() scales it back
+            const double scale = 1.0 / std::max<uint32_t>(contributors, 1);
+            for (double value : parameters)
+            {
+                float f = static_cast<float>(value * scale);
+                appendValue(buffer, encoding == ModelEncoding::FP16 ? floatToHalf(f) : floatToBFloat16(f));
+            }
+            break;
+        }
+        case ModelEncoding::INT8:
+            for (size_t begin = 0; begin < count; begin += INT8_BLOCK_SIZE)
+            {
+                size_t end = std::min(begin + INT8_BLOCK_SIZE, count);
+                double maxAbs = 0.0;
+                for (size_t i = begin; i < end; ++i)
+                    maxAbs = std::max(maxAbs, std::fabs(parameters[i]));
+
+                float scale = static_cast<float>(maxAbs / 127.0);
+                appendValue(buffer, scale);
+                for (size_t i = begin; i < end; ++i)
+                {
+                    long q = scale > 0.0f ? std::lround(parameters[i] / scale) : 0;
+                    buffer.push_back(static_cast<uint8_t>(static_cast<int8_t>(std::clamp<long>(q, -127, 127))));
+                }
+            }
+            break;
+        case ModelEncoding::TOPK:
+        {
+            size_t k = topkCount(count, topkRatio);
+            std::vector<uint32_t> indices(count);
+            std::iota(indices.begin(), indices.end(), 0);
+            std::nth_element(indices.begin(), indices.begin() + k, indices.end(), [&parameters](uint32_t a, uint32_t b)
+                             { return std::fabs(parameters[a]) > std::fabs(parameters[b]); });
+            indices.resize(k);
+            // Ascending indices keep the scatter on the receiving side cache friendly
+            std::sort(indices.begin(), indices.end());
+
+            appendValue(buffer, static_cast<uint32_t>(k));
+            for (uint32_t index : indices)
+            {
+                appendValue(buffer, index);
+                appendValue(buffer, static_cast<float>(parameters[index]));
+            }
+            break;
+        }
+        }
+    }
+
+    /**
+     * @brief Check that the payload holds a well formed parameter block of the given encoding
+     * @param size Set to the size of the parameter block
+     */
+    bool payloadSizeFor(ModelEncoding encoding, size_t parameterCount, const uint8_t *payload, size_t available, size_t &size)
+    {
+        switch (encoding)
+        {
+        case ModelEncoding::FP64:
+            size = parameterCount * sizeof(double);
+            return true;
+        case ModelEncoding::FP16:
+        case ModelEncoding::BF16:
+            size = parameterCount * sizeof(uint16_t);
+            return true;
+        case ModelEncoding::INT8:
+            size = (parameterCount + INT8_BLOCK_SIZE - 1) / INT8_BLOCK_SIZE * sizeof(float) + parameterCount;
+            return true;
+        case ModelEncoding::TOPK:
+        {
+            if (available < sizeof(uint32_t))
+                return false;
+            size_t k = readValue<uint32_t>(payload);
+            if (k > parameterCount || sizeof(uint32_t) + k * TOPK_ENTRY_SIZE > available)
+                return false;
+            for (size_t i = 0; i < k; ++i)
+            {
+                if (readValue<uint32_t>(payload + sizeof(uint32_t) + i * TOPK_ENTRY_SIZE) >= parameterCount)
+                    return false;
+            }
+            size = sizeof(uint32_t) + k * TOPK_ENTRY_SIZE;
+            return true;
+        }
+        }
+        return false;
+    }
+} // namespace
+
 /**
  * @brief Serialize a ModelData object
  *
@@ -41,25 +398,29 @@ void serializeModelData(const ModelData &modelData, std::vector<uint8_t> &buffer
     // Clear the buffer first
     buffer.clear();
 
+    // Header: encoding, parameter count, size of the encoded parameter block and contributor count
+    buffer.push_back(static_cast<uint8_t>(modelData.encoding));
+    appendValue(buffer, static_cast<uint32_t>(modelData.parameters.size()));
+    appendValue(buffer, uint32_t(0));
+    appendValue(buffer, modelData.contributors);
+
     // Transfer ModelData.parameters into bytes
-    size_t paramSize = modelData.parameters.size() * sizeof(double);
-    buffer.resize(paramSize);
-    std::copy(reinterpret_cast<const uint8_t *>(modelData.parameters.data()),
-              reinterpret_cast<const uint8_t *>(modelData.parameters.data()) + paramSize,
-              buffer.data());
+    encodeParameters(modelData.parameters, modelData.encoding, modelData.topkRatio, modelData.contributors, buffer);
+    uint32_t payloadSize = static_cast<uint32_t>(buffer.size() - HEADER_SIZE);
+    std::memcpy(buffer.data() + PAYLOAD_SIZE_OFFSET, &payloadSize, sizeof(uint32_t));
 
     // Transfer ModelData.qsf into bytes (now double instead of int)
-    buffer.insert(buffer.end(), reinterpret_cast<const uint8_t *>(&modelData.qsf), reinterpret_cast<const uint8_t *>(&modelData.qsf + 1));
+    appendValue(buffer, modelData.qsf);
 
     // Serialize ModelData.congestedNodes into bytes
     for (const auto &str : modelData.congestedNodes)
     {
-        uint32_t strLength = static_cast<uint32_t>(str.size());
-        buffer.insert(buffer.end(), reinterpret_cast<uint8_t *>(&strLength), reinterpret_cast<uint8_t *>(&strLength + 1)); // Insert the length of each string within the vector
-        buffer.insert(buffer.end(), str.begin(), str.end());                                                               // Insert the string
+        appendValue(buffer, static_cast<uint32_t>(str.size())); // Insert the length of each string within the vector
+        buffer.insert(buffer.end(), str.begin(), str.end());    // Insert the string
     }
 
-    spdlog::info("Serialized ModelData with {} parameters and {} congested nodes", modelData.parameters.size(), modelData.congestedNodes.size());
+    LOG_DEBUG(Log::APP, "Serialized ModelData with {} parameters ({}, {} bytes) and {} congested nodes",
+              modelData.parameters.size(), modelEncodingName(modelData.encoding), payloadSize, modelData.congestedNodes.size());
 }
 
 /**
@@ -71,47 +432,156 @@ void serializeModelData(const ModelData &modelData, std::vector<uint8_t> &buffer
  */
 bool deserializeModelData(const std::vector<uint8_t> &buffer, ModelData &modelData)
 {
+    ModelDataView view;
+    if (!deserializeModelData(buffer.data(), buffer.size(), modelData.parameters.size(), view))
+    {
+        return false;
+    }
+
     // Transfer ModelData.parameters back
-    size_t paramSize = modelData.parameters.size() * sizeof(double);
-    if (buffer.size() < paramSize)
+    std::fill(modelData.parameters.begin(), modelData.parameters.end(), 0.0);
+    accumulateModelData(view, modelData.parameters.data());
+    modelData.encoding = view.encoding;
+    modelData.contributors = view.contributors;
+    modelData.qsf = view.qsf;
+
+    // Deserialize ModelData.congestedNodes
+    view.forEachCongestedNode([&modelData](std::string_view node)
+                              { modelData.congestedNodes.emplace_back(node); });
+
+    LOG_DEBUG(Log::APP, "Deserialized ModelData with {} parameters and {} congested nodes", modelData.parameters.size(), modelData.congestedNodes.size());
+    return true;
+}
+
+/**
+ * @brief Decode a serialized buffer into a ModelDataView without copying or allocating
+ *
+ * Same layout as serializeModelData(), the congested node section is walked once here so that
+ * ModelDataView::forEachCongestedNode() doesn't need to bounds-check again.
+ */
+bool deserializeModelData(const uint8_t *buffer, size_t bufferSize, size_t parameterCount, ModelDataView &view)
+{
+    if (bufferSize < HEADER_SIZE)
+    {
+        spdlog::error("Buffer size can't hold ModelData header!");
+        return false;
+    }
+
+    uint8_t encoding = buffer[0];
+    size_t count = readValue<uint32_t>(buffer + sizeof(uint8_t));
+    size_t payloadSize = readValue<uint32_t>(buffer + PAYLOAD_SIZE_OFFSET);
+    uint32_t contributors = readValue<uint32_t>(buffer + CONTRIBUTORS_OFFSET);
+    if (encoding > static_cast<uint8_t>(ModelEncoding::TOPK))
+    {
+        spdlog::error("Unknown parameter encoding {}!", encoding);
+        return false;
+    }
+    if (count != parameterCount)
+    {
+        spdlog::error("Parameter count {} doesn't match expected {}!", count, parameterCount);
+        return false;
+    }
+
+    size_t currentIndex = HEADER_SIZE;
+    size_t expectedSize = 0;
+    if (payloadSize > bufferSize - currentIndex ||
+        !payloadSizeFor(static_cast<ModelEncoding>(encoding), count, buffer + currentIndex, payloadSize, expectedSize) ||
+        expectedSize != payloadSize)
     {
         spdlog::error("Buffer size is smaller than expected!");
         return false;
     }
-    std::copy(buffer.data(), buffer.data() + paramSize, reinterpret_cast<uint8_t *>(modelData.parameters.data()));
+    view.encoding = static_cast<ModelEncoding>(encoding);
+    view.contributors = contributors;
+    view.payload = buffer + currentIndex;
+    view.payloadSize = payloadSize;
+    view.parameterCount = count;
+    currentIndex += payloadSize;
 
-    // Transfer ModelData.qsf back (now double instead of int)
-    size_t currentIndex = paramSize;
-    if (currentIndex + sizeof(double) > buffer.size())
+    if (currentIndex + sizeof(double) > bufferSize)
     {
-        std::cout << "Buffer size can't hold qsf value!" << std::endl;
+        spdlog::error("Buffer size can't hold qsf value!");
         return false;
     }
-    std::copy(buffer.data() + currentIndex, buffer.data() + currentIndex + sizeof(double), reinterpret_cast<uint8_t *>(&modelData.qsf));
+    view.qsf = readValue<double>(buffer + currentIndex);
     currentIndex += sizeof(double);
-    // Deserialize ModelData.congestedNodes
-    while (currentIndex < buffer.size())
+
+    view.congestedNodesBegin = buffer + currentIndex;
+    while (currentIndex < bufferSize)
     {
-        if (currentIndex + sizeof(uint32_t) > buffer.size())
+        if (currentIndex + sizeof(uint32_t) > bufferSize)
         {
             spdlog::error("Buffer size can't hold string length!");
             return false;
         }
 
-        uint32_t strLength;
-        std::copy(buffer.data() + currentIndex, buffer.data() + currentIndex + sizeof(uint32_t), reinterpret_cast<uint8_t *>(&strLength)); // Copy memory of the string's length
+        uint32_t strLength = readValue<uint32_t>(buffer + currentIndex);
         currentIndex += sizeof(uint32_t);
 
-        if (currentIndex + strLength > buffer.size())
+        if (currentIndex + strLength > bufferSize)
         {
             spdlog::error("Buffer size can't hold string content!");
             return false;
         }
-        std::string str(reinterpret_cast<const char *>(buffer.data() + currentIndex), strLength);
-        modelData.congestedNodes.push_back(str);
         currentIndex += strLength;
     }
-
-    spdlog::info("Deserialized ModelData with {} parameters and {} congested nodes", modelData.parameters.size(), modelData.congestedNodes.size());
+    view.congestedNodesEnd = buffer + bufferSize;
     return true;
-}
\ No newline at end of file
+}
+
+void accumulateModelData(const ModelDataView &view, double *sum)
+{
+    const uint8_t *payload = view.payload;
+    const size_t count = view.parameterCount;
+    switch (view.encoding)
+    {
+    case ModelEncoding::FP64:
+        // The payload sits HEADER_SIZE bytes into the packet, whose own offset is arbitrary, a double pointer into it
+        // is only valid when it happens to be aligned
+        if (reinterpret_cast<uintptr_t>(payload) % alignof(double) == 0)
+        {
+            Reduce::sum(sum, reinterpret_cast<const double *>(payload), count);
+            break;
+        }
+        for (size_t begin = 0; begin < count; begin += FP64_CHUNK)
+        {
+            double chunk[FP64_CHUNK];
+            size_t n = std::min(FP64_CHUNK, count - begin);
+            std::memcpy(chunk, payload + begin * sizeof(double), n * sizeof(double));
+            Reduce::sum(sum + begin, chunk, n);
+        }
+        break;
+    case ModelEncoding::FP16:
+    {
+        const double scale = std::max<uint32_t>(view.contributors, 1);
+        for (size_t i = 0; i < count; ++i)
+            sum[i] += scale * halfToFloat(readValue<uint16_t>(payload + i * sizeof(uint16_t)));
+        break;
+    }
+    case ModelEncoding::BF16:
+    {
+        const double scale = std::max<uint32_t>(view.contributors, 1);
+        for (size_t i = 0; i < count; ++i)
+            sum[i] += scale * bfloat16ToFloat(readValue<uint16_t>(payload + i * sizeof(uint16_t)));
+        break;
+    }
+    case ModelEncoding::INT8:
+        for (size_t begin = 0; begin < count; begin += INT8_BLOCK_SIZE)
+        {
+            size_t end = std::min(begin + INT8_BLOCK_SIZE, count);
+            double scale = readValue<float>(payload);
+            payload += sizeof(float);
+            for (size_t i = begin; i < end; ++i)
+                sum[i] += scale * static_cast<int8_t>(*payload++);
+        }
+        break;
+    case ModelEncoding::TOPK:
+    {
+        size_t k = readValue<uint32_t>(payload);
+        payload += sizeof(uint32_t);
+        for (size_t i = 0; i < k; ++i, payload += TOPK_ENTRY_SIZE)
+            sum[readValue<uint32_t>(payload)] += readValue<float>(payload + sizeof(uint32_t));
+        break;
+    }
+    }
+}
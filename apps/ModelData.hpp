@@ -3,21 +3,213 @@
 #include <vector>
 #include <cstdint>
 #include <string>
+#include <string_view>
+#include <cstring>
+#include <algorithm>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/ini_parser.hpp>
 #include <iostream>
 
+/**
+ * @brief Wire encoding of the parameter block
+ *
+ * FP64 ships the raw doubles, the others trade precision for bytes on the wire:
+ * FP16/BF16 use 2 bytes per element, INT8 one byte per element plus a float scale per block of
+ * INT8_BLOCK_SIZE elements, TOPK only the k largest-magnitude elements as (uint32 index, float value) pairs.
+ * FP16/BF16 carry the sum divided by its contributor count, an aggregator's partial sum then stays in the range of
+ * its children's payloads (65504 for FP16) and keeps their relative precision whatever the fan-in.
+ */
+enum class ModelEncoding : uint8_t
+{
+    FP64 = 0,
+    FP16 = 1,
+    BF16 = 2,
+    INT8 = 3,
+    TOPK = 4
+};
+
+constexpr size_t INT8_BLOCK_SIZE = 64;
+
+// Bytes of encoded parameters per Data packet when General.SegmentSize is auto, leaves room below the 8800 bytes
+// NDN packet limit for the name, the signature, qsf and the congested nodes
+constexpr size_t SEGMENT_PAYLOAD_BUDGET = 7000;
+
+/**
+ * @brief Parse the encoding name used in config.ini (fp64, fp16, bf16, int8, topk)
+ * @return FP64 for unknown names
+ */
+ModelEncoding parseModelEncoding(const std::string &name);
+
+const char *modelEncodingName(ModelEncoding encoding);
+
+/**
+ * @brief One named tensor of the model, stored flat inside ModelData::parameters
+ */
+struct TensorSpec
+{
+    std::string name;
+    std::string dtype;         // Element type on the training side, e.g. float32
+    std::vector<size_t> shape; // Dimensions, outermost first
+    size_t offset;             // Index of the first element in ModelData::parameters
+    size_t size;               // Number of elements, product of shape
+};
+
+/**
+ * @brief Immutable description of the model exchanged per iteration
+ *
+ * Loaded once per process from the [General] and [Tensors] sections of config.ini, ModelData is sized from it.
+ * Each [Tensors] entry reads "name = 64x3x3x3 float32" (dtype defaults to float64), tensors are laid out
+ * back to back in declaration order. Without a [Tensors] section the model is a single float64 tensor
+ * "parameters" of General.DataSize elements.
+ *
+ * The flat parameter vector is streamed in segments of General.SegmentSize parameters, one Data packet each
+ * (0, the default, sizes them from the encoding to fit one packet). Every segment is requested and aggregated on
+ * its own under a packet seq: segment k (from 0) of iteration i (from 1) is seq (i - 1) * segmentCount() + k + 1,
+ * so a model small enough for one packet keeps seq == iteration.
+ */
+class ModelSchema
+{
+public:
+    /**
+     * @brief The process-wide schema, loaded from ../experiments/config.ini on first use
+     */
+    static const ModelSchema &instance();
+
+    /**
+     * @brief Build a schema from a configuration file, falls back to the defaults if it can't be read
+     * @param filename Path of the INI file
+     */
+    static ModelSchema fromConfig(const std::string &filename);
+
+    const std::vector<TensorSpec> &tensors() const { return m_tensors; }
+
+    /**
+     * @brief Look up a tensor by name
+     * @return nullptr if the schema has no such tensor
+     */
+    const TensorSpec *find(const std::string &name) const;
+
+    /**
+     * @brief Total number of parameters over all tensors
+     */
+    size_t parameterCount() const { return m_parameterCount; }
+
+    ModelEncoding encoding() const { return m_encoding; }
+
+    double topkRatio() const { return m_topkRatio; }
+
+    /**
+     * @brief Parameters per segment, the last segment may be shorter
+     */
+    size_t segmentSize() const { return m_segmentSize; }
+
+    uint32_t segmentCount() const { return m_segmentCount; }
+
+    /**
+     * @brief Index of the segment's first parameter
+     */
+    size_t segmentOffset(uint32_t segment) const { return segment * m_segmentSize; }
+
+    size_t segmentLength(uint32_t segment) const
+    {
+        size_t offset = segmentOffset(segment);
+        return offset < m_parameterCount ? std::min(m_segmentSize, m_parameterCount - offset) : 0;
+    }
+
+    uint32_t segmentSeq(uint32_t iteration, uint32_t segment) const
+    {
+        return (iteration - 1) * m_segmentCount + segment + 1;
+    }
+
+    /**
+     * @brief Iteration of a packet seq, 0 for seq 0 (tree broadcast)
+     */
+    uint32_t iterationOf(uint32_t seq) const { return seq == 0 ? 0 : (seq - 1) / m_segmentCount + 1; }
+
+    uint32_t segmentOf(uint32_t seq) const { return seq == 0 ? 0 : (seq - 1) % m_segmentCount; }
+
+private:
+    ModelSchema();
+
+    void addTensor(const std::string &name, const std::string &dtype, std::vector<size_t> shape);
+
+    /**
+     * @brief Split the parameters into segments
+     * @param segmentSize Parameters per segment, 0 to fit SEGMENT_PAYLOAD_BUDGET with the configured encoding
+     */
+    void setSegmentSize(size_t segmentSize);
+
+private:
+    std::vector<TensorSpec> m_tensors;
+    size_t m_parameterCount;
+    ModelEncoding m_encoding;
+    double m_topkRatio;
+    size_t m_segmentSize;
+    uint32_t m_segmentCount;
+};
+
 struct ModelData
 {
     std::vector<double> parameters; // Model parameters
+    uint32_t contributors;          // Number of producers' models summed into parameters
     double qsf;
     std::vector<std::string> congestedNodes;
+    ModelEncoding encoding; // Encoding used by serializeModelData()
+    double topkRatio;       // Fraction of parameters kept by TOPK
 
+    /**
+     * @brief Allocate parameters for the process-wide ModelSchema
+     */
     ModelData();
+
+    explicit ModelData(const ModelSchema &schema);
+
+    /**
+     * @brief Allocate parameters for one segment of schema
+     */
+    ModelData(const ModelSchema &schema, uint32_t segment);
+};
+
+/**
+ * @brief Non-owning view over a serialized ModelData buffer
+ *
+ * Points straight into the bytes it was decoded from (e.g. the Content TLV value of a Data packet),
+ * so the buffer must outlive the view. The parameter block stays in its wire encoding, use
+ * accumulateModelData() to add it to a dense sum. The buffer isn't required to be aligned.
+ */
+struct ModelDataView
+{
+    ModelEncoding encoding = ModelEncoding::FP64;
+    const uint8_t *payload = nullptr; // Start of the encoded parameter block
+    size_t payloadSize = 0;
+    size_t parameterCount = 0; // Number of parameters once decoded
+    uint32_t contributors = 1; // Number of producers' models summed into the parameter block
+    double qsf = -1.0;
+    const uint8_t *congestedNodesBegin = nullptr; // Length-prefixed congested node strings
+    const uint8_t *congestedNodesEnd = nullptr;
+
+    /**
+     * @brief Invoke fn(std::string_view) for every congested node, in serialization order
+     */
+    template <typename Function>
+    void forEachCongestedNode(Function &&fn) const
+    {
+        const uint8_t *it = congestedNodesBegin;
+        while (it < congestedNodesEnd)
+        {
+            uint32_t strLength;
+            std::memcpy(&strLength, it, sizeof(uint32_t));
+            it += sizeof(uint32_t);
+            fn(std::string_view(reinterpret_cast<const char *>(it), strLength));
+            it += strLength;
+        }
+    }
 };
 /**
  * @brief Serialize a ModelData object
  *
+ * The parameter block is encoded with modelData.encoding.
+ *
  * @param modelData The ModelData object to serialize
  * @param buffer The buffer to store the serialized data
  */
@@ -26,10 +218,32 @@ void serializeModelData(const ModelData &modelData, std::vector<uint8_t> &buffer
 /**
  * @brief Deserialize buffer data into a ModelData object
  *
+ * Compressed parameter blocks are expanded back to doubles, modelData.encoding is set to the received encoding.
+ *
  * @param buffer The buffer containing the serialized data
  * @param modelData The ModelData object to store the deserialized data
  * @return True if deserialization is successful, otherwise false
  */
 bool deserializeModelData(const std::vector<uint8_t> &buffer, ModelData &modelData);
 
-int readDataSizeFromConfig(const std::string &filename);
\ No newline at end of file
+/**
+ * @brief Decode a serialized buffer into a ModelDataView without copying or allocating
+ *
+ * @param buffer Pointer to the serialized data, e.g. data.getContent().value()
+ * @param bufferSize Size of the serialized data
+ * @param parameterCount Expected number of parameters
+ * @param view The view to fill, only valid while buffer is alive
+ * @return True if the buffer is well formed, otherwise false
+ */
+bool deserializeModelData(const uint8_t *buffer, size_t bufferSize, size_t parameterCount, ModelDataView &view);
+
+/**
+ * @brief sum[i] += parameter i of view, decoding on the fly
+ *
+ * TOPK only touches the k transmitted entries, so sparse contributions are summed without expanding them.
+ *
+ * @param view A view filled by deserializeModelData()
+ * @param sum Dense accumulator holding at least view.parameterCount elements
+ */
+void accumulateModelData(const ModelDataView &view, double *sum);
+
@@ -0,0 +1,211 @@
+#ifndef AGGREGATION_SUBTREE_HPP
+#define AGGREGATION_SUBTREE_HPP
+
+#include <vector>
+#include <map>
+#include <set>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+/**
+ * Aggregation subtree carried in the ApplicationParameters of an initialization Interest
+ *
+ * Wire format, NDN TLV with VAR-NUMBER types and lengths:
+ *   SUBTREE  := TYPE_SUBTREE LENGTH NODE_NAME+ PARENTS
+ *   NODE_NAME := TYPE_NODE_NAME LENGTH bytes        (node table, the subtree's root first)
+ *   PARENTS  := TYPE_PARENTS LENGTH VAR-NUMBER+     (index of each node's parent in the table, the root's is 0)
+ * The Interest name keeps the same size whatever the subtree, only the parameters grow, by one node name plus a few
+ * bytes per node. Parse() doesn't copy, node names are views into the parsed buffer.
+ */
+class AggregationSubtree
+{
+public:
+    static constexpr uint64_t TYPE_SUBTREE = 200;
+    static constexpr uint64_t TYPE_NODE_NAME = 201;
+    static constexpr uint64_t TYPE_PARENTS = 202;
+
+    /**
+     * @brief Encode the subtree of treeMap rooted at root, breadth first
+     * @param treeMap Children of every inner node, nodes that aren't keys are leaves
+     */
+    static std::vector<uint8_t> Encode(const std::string &root, const std::map<std::string, std::vector<std::string>> &treeMap)
+    {
+        std::vector<std::string_view> nodes{root};
+        std::vector<uint64_t> parents{0};
+        std::deque<size_t> queue{0};
+        while (!queue.empty())
+        {
+            size_t index = queue.front();
+            queue.pop_front();
+            auto it = treeMap.find(std::string(nodes[index]));
+            if (it == treeMap.end())
+                continue;
+            for (const std::string &child : it->second)
+            {
+                queue.push_back(nodes.size());
+                nodes.push_back(child);
+                parents.push_back(index);
+            }
+        }
+
+        std::vector<uint8_t> value;
+        for (std::string_view node : nodes)
+        {
+            AppendVarNumber(value, TYPE_NODE_NAME);
+            AppendVarNumber(value, node.size());
+            value.insert(value.end(), node.begin(), node.end());
+        }
+        std::vector<uint8_t> packedParents;
+        for (uint64_t parent : parents)
+            AppendVarNumber(packedParents, parent);
+        AppendVarNumber(value, TYPE_PARENTS);
+        AppendVarNumber(value, packedParents.size());
+        value.insert(value.end(), packedParents.begin(), packedParents.end());
+
+        std::vector<uint8_t> wire;
+        AppendVarNumber(wire, TYPE_SUBTREE);
+        AppendVarNumber(wire, value.size());
+        wire.insert(wire.end(), value.begin(), value.end());
+        return wire;
+    }
+
+    /**
+     * @brief Decode a SUBTREE element, buffer must outlive the subtree
+     * @return False if buffer isn't a well formed subtree
+     */
+    bool Parse(const uint8_t *buffer, size_t size)
+    {
+        m_nodes.clear();
+        m_parents.clear();
+
+        const uint8_t *it = buffer;
+        const uint8_t *end = buffer + size;
+        uint64_t type, length;
+        if (!ReadVarNumber(it, end, type) || type != TYPE_SUBTREE || !ReadVarNumber(it, end, length) || length > static_cast<size_t>(end - it))
+            return false;
+        end = it + length;
+
+        while (it < end)
+        {
+            if (!ReadVarNumber(it, end, type) || !ReadVarNumber(it, end, length) || length > static_cast<size_t>(end - it))
+                return false;
+            const uint8_t *valueEnd = it + length;
+            if (type == TYPE_NODE_NAME)
+            {
+                m_nodes.emplace_back(reinterpret_cast<const char *>(it), length);
+            }
+            else if (type == TYPE_PARENTS)
+            {
+                m_parents.reserve(m_nodes.size());
+                uint64_t parent;
+                for (const uint8_t *parentIt = it; parentIt < valueEnd;)
+                {
+                    if (!ReadVarNumber(parentIt, valueEnd, parent) || parent >= m_nodes.size())
+                        return false;
+                    m_parents.push_back(static_cast<uint32_t>(parent));
+                }
+            }
+            // Unknown elements are skipped, for later extensions
+            it = valueEnd;
+        }
+
+        // Every node but the root must come after its parent
+        if (m_nodes.empty() || m_parents.size() != m_nodes.size() || m_parents[0] != 0)
+            return false;
+        for (size_t i = 1; i < m_parents.size(); ++i)
+        {
+            if (m_parents[i] >= i)
+                return false;
+        }
+        return true;
+    }
+
+    size_t Size() const
+    {
+        return m_nodes.size();
+    }
+
+    std::string_view Node(size_t index) const
+    {
+        return m_nodes[index];
+    }
+
+    uint32_t Parent(size_t index) const
+    {
+        return m_parents[index];
+    }
+
+    /**
+     * @brief Leaf nodes under each child of the root, a child that is a leaf maps to itself
+     *
+     * Same result as App::getLeafNodes() on the consumer's tree.
+     */
+    std::map<std::string, std::vector<std::string>> ChildLeaves() const
+    {
+        // Parents come before their children, so walking backwards settles every node's leaves before its parent's
+        std::vector<bool> hasChild(m_nodes.size(), false);
+        for (size_t i = 1; i < m_nodes.size(); ++i)
+            hasChild[m_parents[i]] = true;
+
+        std::vector<std::set<std::string_view>> leaves(m_nodes.size());
+        for (size_t i = m_nodes.size(); i-- > 1;)
+        {
+            if (!hasChild[i])
+                leaves[i].insert(m_nodes[i]);
+            if (m_parents[i] != 0)
+                leaves[m_parents[i]].insert(leaves[i].begin(), leaves[i].end());
+        }
+
+        std::map<std::string, std::vector<std::string>> result;
+        for (size_t i = 1; i < m_nodes.size(); ++i)
+        {
+            if (m_parents[i] == 0)
+            {
+                std::vector<std::string> &childLeaves = result[std::string(m_nodes[i])];
+                childLeaves.assign(leaves[i].begin(), leaves[i].end());
+            }
+        }
+        return result;
+    }
+
+private:
+    static void AppendVarNumber(std::vector<uint8_t> &out, uint64_t number)
+    {
+        if (number < 253)
+        {
+            out.push_back(static_cast<uint8_t>(number));
+            return;
+        }
+        int bytes = number <= 0xFFFF ? 2 : (number <= 0xFFFFFFFF ? 4 : 8);
+        out.push_back(bytes == 2 ? 253 : (bytes == 4 ? 254 : 255));
+        for (int shift = (bytes - 1) * 8; shift >= 0; shift -= 8)
+            out.push_back(static_cast<uint8_t>(number >> shift));
+    }
+
+    static bool ReadVarNumber(const uint8_t *&it, const uint8_t *end, uint64_t &number)
+    {
+        if (it >= end)
+            return false;
+        uint8_t first = *it++;
+        if (first < 253)
+        {
+            number = first;
+            return true;
+        }
+        size_t bytes = first == 253 ? 2 : (first == 254 ? 4 : 8);
+        if (static_cast<size_t>(end - it) < bytes)
+            return false;
+        number = 0;
+        for (size_t i = 0; i < bytes; ++i)
+            number = (number << 8) | *it++;
+        return true;
+    }
+
+private:
+    std::vector<std::string_view> m_nodes; // Node table, views into the parsed buffer
+    std::vector<uint32_t> m_parents;
+};
+
+#endif // AGGREGATION_SUBTREE_HPP
@@ -0,0 +1,228 @@
+#ifndef AGGREGATION_TABLE_HPP
+#define AGGREGATION_TABLE_HPP
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+#include "ModelData.hpp"
+
+/**
+ * Fixed-capacity table of in-progress aggregation iterations, slot = seq % capacity
+ *
+ * Every slot is allocated once in Reset() and recycled afterwards, so the steady state does no allocation
+ * per iteration. Children are identified by their index in the aggregation tree, arrivals are tracked in a
+ * bitmask. With a quorum of k the iteration may be forwarded once k children have arrived instead of all of them.
+ */
+class AggregationTable
+{
+public:
+    struct Slot
+    {
+        uint32_t seq = 0;
+        bool inUse = false;   // Downstream interest accepted, result not sent yet
+        bool started = false; // Interests for this iteration have been sent upstream
+        bool hasData = false; // At least one child's data has been aggregated
+
+        std::string dataName;                    // Whole name of the downstream interest
+        std::vector<double> sum;                 // Result after performing aggregation (arithmetic add them together)
+        std::vector<std::string> congestedNodes; // Result after aggregating congestion signal
+
+        std::vector<uint64_t> arrived; // Bit i is set once child i's data has been aggregated
+        size_t arrivedCount = 0;
+        uint32_t contributors = 0; // Producers' models summed so far, over all children
+
+        // Partial aggregation
+        bool overdue = false;  // Deadline passed, the iteration is forwarded with whatever has arrived
+        bool finished = false; // Result scheduled to be sent downstream
+        bool closed = false;   // Later data isn't aggregated any more
+        bool sendDue = false;  // Grace window is over, the result is sent once the reducers are done with the slot
+        uint32_t reducing = 0; // Completions asked of the reducer pool and not handled yet
+
+        std::chrono::milliseconds startTime{0}; // When the first upstream interest was sent
+        std::chrono::milliseconds aggregateTime{0};
+        bool timing = false; // startTime is valid
+
+        bool HasArrived(size_t child) const
+        {
+            return (arrived[child / 64] >> (child % 64)) & 1;
+        }
+
+        /**
+         * @brief Mark child's data as aggregated
+         * @return False if it had already arrived, i.e. the data is a duplicate
+         */
+        bool MarkArrived(size_t child)
+        {
+            uint64_t bit = uint64_t(1) << (child % 64);
+            if (arrived[child / 64] & bit)
+                return false;
+            arrived[child / 64] |= bit;
+            ++arrivedCount;
+            return true;
+        }
+    };
+
+    AggregationTable() : m_childCount(0), m_quorum(0), m_inUseCount(0), m_dataCount(0) {}
+
+    /**
+     * @brief Drop all iterations and preallocate every slot
+     * @param capacity Max number of iterations in progress at the same time
+     * @param parameterCount Size of the parameter accumulator
+     * @param childCount Number of children to aggregate per iteration
+     * @param quorum Number of children enough to forward an iteration, 0 (or more than childCount) for all of them
+     */
+    void Reset(size_t capacity, size_t parameterCount, size_t childCount, size_t quorum = 0)
+    {
+        m_slots.assign(std::max<size_t>(capacity, 1), Slot{});
+        for (Slot &slot : m_slots)
+        {
+            slot.sum.assign(parameterCount, 0.0);
+            slot.arrived.assign((childCount + 63) / 64, 0);
+        }
+        m_childCount = childCount;
+        m_quorum = quorum == 0 ? childCount : std::min(quorum, childCount);
+        m_inUseCount = 0;
+        m_dataCount = 0;
+    }
+
+    /**
+     * @brief Take the slot of seq for a new iteration
+     * @return nullptr if seq is already in progress or its slot is held by another iteration
+     */
+    Slot *Acquire(uint32_t seq)
+    {
+        if (m_slots.empty())
+            return nullptr;
+        Slot &slot = m_slots[seq % m_slots.size()];
+        if (slot.inUse)
+            return nullptr;
+
+        slot.seq = seq;
+        slot.inUse = true;
+        slot.started = false;
+        slot.hasData = false;
+        slot.dataName.clear();
+        std::fill(slot.sum.begin(), slot.sum.end(), 0.0);
+        slot.congestedNodes.clear();
+        std::fill(slot.arrived.begin(), slot.arrived.end(), 0);
+        slot.arrivedCount = 0;
+        slot.contributors = 0;
+        slot.overdue = false;
+        slot.finished = false;
+        slot.closed = false;
+        slot.sendDue = false;
+        slot.reducing = 0;
+        slot.aggregateTime = std::chrono::milliseconds(0);
+        slot.timing = false;
+        ++m_inUseCount;
+        return &slot;
+    }
+
+    /**
+     * @brief Slot of an iteration in progress
+     * @return nullptr if seq isn't in progress
+     */
+    Slot *Find(uint32_t seq)
+    {
+        if (m_slots.empty())
+            return nullptr;
+        Slot &slot = m_slots[seq % m_slots.size()];
+        return slot.inUse && slot.seq == seq ? &slot : nullptr;
+    }
+
+    /**
+     * @brief Record that slot received its first data
+     */
+    void MarkHasData(Slot &slot)
+    {
+        if (!slot.hasData)
+        {
+            slot.hasData = true;
+            ++m_dataCount;
+        }
+    }
+
+    void Release(Slot &slot)
+    {
+        if (!slot.inUse)
+            return;
+        if (slot.hasData)
+            --m_dataCount;
+        slot.inUse = false;
+        slot.hasData = false;
+        --m_inUseCount;
+    }
+
+    bool IsComplete(const Slot &slot) const
+    {
+        return slot.arrivedCount == m_childCount;
+    }
+
+    /**
+     * @brief Whether enough children have arrived to forward the iteration
+     */
+    bool IsQuorate(const Slot &slot) const
+    {
+        return slot.arrivedCount >= m_quorum;
+    }
+
+    size_t Quorum() const
+    {
+        return m_quorum;
+    }
+
+    template <typename Function>
+    void ForEachInUse(Function &&fn) const
+    {
+        for (const Slot &slot : m_slots)
+        {
+            if (slot.inUse)
+                fn(slot);
+        }
+    }
+
+    size_t Capacity() const
+    {
+        return m_slots.size();
+    }
+
+    /**
+     * @brief Number of iterations in progress
+     */
+    size_t InUseCount() const
+    {
+        return m_inUseCount;
+    }
+
+    /**
+     * @brief Number of iterations holding partial aggregation results, i.e. the data queue size
+     */
+    size_t DataCount() const
+    {
+        return m_dataCount;
+    }
+
+private:
+    std::vector<Slot> m_slots;
+    size_t m_childCount;
+    size_t m_quorum;
+    size_t m_inUseCount;
+    size_t m_dataCount;
+};
+
+/**
+ * @brief Add a child's payload to slot: its parameters to the sum, its congestion signal to the congested nodes
+ *
+ * The aggregation step of every Data, run by Aggregator::Aggregate() on the io thread or by the reducer pool's workers.
+ */
+inline void aggregateModelData(AggregationTable::Slot &slot, const ModelDataView &view)
+{
+    accumulateModelData(view, slot.sum.data());
+    auto &signalList = slot.congestedNodes;
+    view.forEachCongestedNode([&signalList](std::string_view node)
+                              { signalList.emplace_back(node); });
+}
+
+#endif // AGGREGATION_TABLE_HPP
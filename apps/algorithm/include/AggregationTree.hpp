@@ -13,6 +13,8 @@
 #include <climits>
 #include <set>
 #include <algorithm>
+#include "../utility/utility.hpp"
+#include "min_cost_flow_solver.hpp"
 
 class AggregationTree {
 public:
@@ -23,6 +25,15 @@ public:
 
     bool aggregationTreeConstruction(std::vector<std::string> dataPointNames, int C);
 
+    // Outcome of repairTree(), the failed node was replaced by heads among parent's children
+    struct TreeRepair {
+        std::string parent;
+        std::vector<std::string> heads;
+    };
+
+    // Replace a failed aggregator of the constructed tree, only its children are reclustered
+    bool repairTree(const std::string &failed, int C, TreeRepair &repair);
+
     // Global variables
     std::unordered_map<std::string, std::vector<std::pair<std::string, int>>> graph;
     //std::string filename = "src/ndnSIM/examples/topologies/DataCenterTopology.txt";
@@ -32,6 +43,8 @@ public:
     std::string globalClient = "con0";
     std::map<std::string, std::vector<std::string>> aggregationAllocation;
     std::vector<std::vector<std::string>> noCHTree;
-    std::map<std::string, std::map<std::string, int>> linkCostMatrix;
+    Utility::LinkCostMatrix linkCostMatrix;
+    std::set<std::string> failedNodes; // Never chosen as cluster head again
+    MinCostFlowSolver::Backend solverBackend = MinCostFlowSolver::kNetworkSimplex; // Min-cost flow of the balanced clustering
 
 };
\ No newline at end of file
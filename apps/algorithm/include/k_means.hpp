@@ -5,28 +5,34 @@
 #include <vector>
 #include <map>
 #include <string>
+#include <cstdint>
+
+#include "../utility/utility.hpp"
+#include "../utility/thread_pool.hpp"
 
 class KMeans {
 public:
     enum InitMethod { kForgy, kRandomPartition };
     KMeans(const std::vector<std::string>& data, int k,
+           const Utility::LinkCostMatrix& linkCostMatrix,
            InitMethod init_method, unsigned int seed);
     const std::vector<std::vector<std::string>>& cluster_centers() const;
     const std::vector<int>& assignments() const;
-    double GetSumSquaredError(const std::map<std::string, std::map<std::string, int>> linkCostMatrix) const;
+    double GetSumSquaredError() const;
     std::vector<std::vector<std::string>> clusters;
 
 protected:
     void Init();
-    int CalDistance(const std::string& data1,
-                    const std::string& data2,
-                    std::map<std::string, std::map<std::string, int>> linkCostMatrix) const;
-    int CalDistance(const std::string& data1,
-                    const std::vector<std::string>& clu,
-                    std::map<std::string, std::map<std::string, int>> linkCostMatrix) const;
+    int LinkCost(int data1, int data2) const;
+    int CalDistance(int data, int cluster) const;
+    // sums[i] = sum of the costs from every member of cluster to data point i
+    void ClusterCostSums(int cluster, std::vector<int32_t>& sums) const;
+    // Same for the data points [begin, end), sums[i - begin]
+    void ClusterCostSums(int cluster, int begin, int end, int32_t* sums) const;
     void UpdateClusterCenter();
     void InitWithRandomCenter();
     void InitWithRandomAssignment();
+    static constexpr int kAssignTile = 4096; // Data points bucketed per task in UpdateClusterCenter
     const int n_;
     // const int s_;
     const int k_;
@@ -34,7 +40,10 @@ protected:
     InitMethod init_method_;
     const unsigned int seed_;
     std::vector<int> assignments_;
+    std::vector<std::vector<int>> members_; // Data point indices of each cluster
+    std::vector<int32_t> link_costs_;       // Link costs between data points, n_ x n_ row-major
     std::default_random_engine el_;
+    Utility::ThreadPool* pool_ = nullptr; // Runs UpdateClusterCenter in parallel when set
 };
 
 #endif  // K_MEANS_H_
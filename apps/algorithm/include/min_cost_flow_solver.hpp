@@ -0,0 +1,31 @@
+#ifndef MIN_COST_FLOW_SOLVER_H_
+#define MIN_COST_FLOW_SOLVER_H_
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Min-cost flow on the bipartite graph of RegularizedKMeans: every data point sends one unit to one of k
+// clusters, costs[i][j] per unit, and the cluster sizes are bounded (BuildHard) or priced by f (Build).
+class MinCostFlowSolver {
+public:
+    enum Backend { kNetworkSimplex, kSuccessiveShortestPath };
+    static std::unique_ptr<MinCostFlowSolver> Create(Backend backend);
+
+    virtual ~MinCostFlowSolver() = default;
+    virtual void BuildHard(const std::vector<std::vector<double>>& costs, int k,
+                           int lower_bound, int upper_bound) = 0;
+    // f(j, s) is the cost of cluster j holding s data points
+    virtual void Build(const std::vector<std::vector<double>>& costs,
+                       const std::function<double(int, int)>& f) = 0;
+    virtual void Solve() = 0;
+    // Replace the point to cluster costs, the next Solve() may start from the current flow
+    virtual void UpdateCosts(const std::vector<std::vector<double>>& costs) = 0;
+    virtual void GetAssignments(std::vector<int>* assignments) const = 0;
+    virtual double min_cost() const = 0;
+    // Heap bytes held by the solver's graph and work arrays
+    virtual size_t memory_bytes() const = 0;
+};
+
+#endif  // MIN_COST_FLOW_SOLVER_H_
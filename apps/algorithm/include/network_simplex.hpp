@@ -4,16 +4,21 @@
 #include <functional>
 #include <vector>
 
-class NetworkSimplex {
+#include "min_cost_flow_solver.hpp"
+
+class NetworkSimplex : public MinCostFlowSolver {
 public:
     void BuildHard(const std::vector<std::vector<double>>& costs, int k,
-                   int lower_bound, int upper_bound);
+                   int lower_bound, int upper_bound) override;
     void Build(const std::vector<std::vector<double>>& costs,
-               const std::function<double(int, int)>& f);
+               const std::function<double(int, int)>& f) override;
+    void Solve() override;
     void Simplex();
-    void UpdateCosts(const std::vector<std::vector<double>>& costs);
-    void GetAssignments(std::vector<int>* assignments) const;
-    double min_cost() const;
+    // Keeps the spanning tree, the next Simplex() warm starts from the current flow
+    void UpdateCosts(const std::vector<std::vector<double>>& costs) override;
+    void GetAssignments(std::vector<int>* assignments) const override;
+    double min_cost() const override;
+    size_t memory_bytes() const override;
 
 private:
     std::vector<int> BuildBasic(const std::vector<std::vector<double>>& costs,
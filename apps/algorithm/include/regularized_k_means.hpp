@@ -2,30 +2,34 @@
 #define REGULARIZED_K_MEANS_H_
 
 #include <functional>
+#include <memory>
 #include <random>
 #include <vector>
 
 #include "k_means.hpp"
-#include "network_simplex.hpp"
+#include "min_cost_flow_solver.hpp"
 
 class RegularizedKMeans : public KMeans {
 public:
     RegularizedKMeans(const std::vector<std::string>& data, int k,
-                      std::map<std::string, std::map<std::string, int>> costMatrix,
+                      const Utility::LinkCostMatrix& costMatrix,
                       InitMethod init_method = KMeans::kForgy,
-                      bool warm_start = true, int n_jobs = 1,
-                      unsigned int seed = std::random_device{}());
+                      bool warm_start = true, int n_jobs = -1,
+                      unsigned int seed = std::random_device{}(),
+                      MinCostFlowSolver::Backend backend = MinCostFlowSolver::kNetworkSimplex);
     double SolveHard();
     double SolveHard(int lower_bound, int upper_bound);
     double Solve(const std::function<double(int, int)>& f);
 
 protected:
-    double Solve(std::function<NetworkSimplex()> builder);
+    double Solve(const std::function<void(MinCostFlowSolver&)>& build);
     void UpdateCostMatrix();
+    static constexpr int kCostTile = 256; // Rows of costs_ filled per task, a tile of every member's cost row fits in L1
     const bool warm_start_;
     const int n_jobs_;
+    const MinCostFlowSolver::Backend backend_;
+    std::unique_ptr<Utility::ThreadPool> thread_pool_; // Lives as long as the solver, threads are started once
     std::vector<std::vector<double>> costs_;
-    std::map<std::string, std::map<std::string, int>> linkCostMatrix;
 };
 
 #endif  // REGULARIZED_K_MEANS_H_
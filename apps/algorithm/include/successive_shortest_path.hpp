@@ -0,0 +1,67 @@
+#ifndef SUCCESSIVE_SHORTEST_PATH_H_
+#define SUCCESSIVE_SHORTEST_PATH_H_
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "min_cost_flow_solver.hpp"
+
+// Successive shortest paths: data points are routed one at a time along a shortest path of the residual graph,
+// found by Dijkstra on costs reduced by node potentials. A path only passes a routed point to move it between
+// two clusters, so Dijkstra runs on the k clusters and the sink, the cheapest point to move from cluster j to
+// j' being the top of a heap kept per pair. The point to cluster arcs are the cost matrix and a cluster's arcs
+// to the sink its sorted marginal costs, no edge list is stored. Every Solve() starts from an empty flow; after
+// UpdateCosts() the previous assignment wins all ties, so an optimum that still is one is kept as by the simplex.
+class SuccessiveShortestPath : public MinCostFlowSolver {
+public:
+    void BuildHard(const std::vector<std::vector<double>>& costs, int k,
+                   int lower_bound, int upper_bound) override;
+    void Build(const std::vector<std::vector<double>>& costs,
+               const std::function<double(int, int)>& f) override;
+    void Solve() override;
+    void UpdateCosts(const std::vector<std::vector<double>>& costs) override;
+    void GetAssignments(std::vector<int>* assignments) const override;
+    double min_cost() const override;
+    size_t memory_bytes() const override;
+
+private:
+    using MoveHeap = std::vector<std::pair<double, int>>; // (cost change, point), min-heap
+    void BuildBasic(const std::vector<std::vector<double>>& costs, int capacity);
+    // Costs the flow is solved on: scaled, less one unit on the preferred cluster and the bonus on lower bound arcs
+    double Cost(int point, int cluster) const {
+        return costs_[static_cast<size_t>(point) * k_ + cluster] * scale_ - (preferred_[point] == cluster ? 1.0 : 0.0);
+    }
+    double Marginal(int cluster, int load) const {
+        return marginals_[static_cast<size_t>(cluster) * capacity_ + load] * scale_ - (load < lower_bound_ ? bound_bonus_ : 0.0);
+    }
+    MoveHeap& Moves(int from, int to) { return moves_[static_cast<size_t>(from) * k_ + to]; }
+    bool CheapestMove(int from, int to, double* cost, int* point);
+    void ShortestPath(int source);
+    void Augment();
+    void Assign(int point, int cluster);
+    int n_ = 0;
+    int k_ = 0;
+    int capacity_ = 0;               // Sink arcs of every cluster
+    int lower_bound_ = 0;
+    double bound_bonus_ = 0.0;       // Taken off the lower bound arcs' costs so they fill first
+    // Costs are scaled by n_ + 1 when there's a preferred assignment, its n_ units of preference then never
+    // outweigh a difference of one in the costs, exact as long as they're integral like RegularizedKMeans' ones
+    double scale_ = 1.0;
+    bool solved_ = false;
+    std::vector<int> preferred_;     // Assignment of the last Solve() after UpdateCosts(), -1 for none
+    std::vector<double> costs_;      // n_ x k_ row-major
+    std::vector<double> marginals_;  // k_ x capacity_, each row ascending
+    std::vector<int> assignments_;   // Cluster of every point, -1 before it's routed
+    std::vector<int> loads_;         // Points of every cluster
+    std::vector<MoveHeap> moves_;    // k_ x k_, stale entries of points that left are dropped when on top
+    // Dijkstra state over the clusters and the sink (index k_)
+    std::vector<double> potential_;
+    std::vector<double> dist_;
+    std::vector<int> pred_cluster_;  // -1 when reached from the source point
+    std::vector<int> pred_point_;    // Point moved into the cluster on the path
+    std::vector<bool> settled_;
+    double min_cost_ = 0.0;
+};
+
+#endif  // SUCCESSIVE_SHORTEST_PATH_H_
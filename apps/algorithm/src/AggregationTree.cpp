@@ -25,7 +25,7 @@ AggregationTree::AggregationTree(std::string file)
     filename = file;
     fullList = Utility::getContextInfo(filename);
     CHList = fullList;
-    linkCostMatrix = Utility::GetAllLinkCost(filename);
+    linkCostMatrix = Utility::GetLinkCostMatrix(filename);
     // graph = Utility::initializeGraph(filename);
     // std::cout << "Finish initialization!" << std::endl;
 }
@@ -37,13 +37,32 @@ std::string AggregationTree::findCH(std::vector<std::string> clusterNodes, std::
     // Initiate a large enough cost
     int leastCost = 1000;
 
+    // Names outside the topology cost 0, as the lookups of the old nested map did
+    auto indexOf = [this](const std::string &name) -> int32_t
+    {
+        auto it = linkCostMatrix.index.find(name);
+        return it == linkCostMatrix.index.end() ? -1 : it->second;
+    };
+    auto cost = [this](int32_t from, int32_t to)
+    {
+        return (from < 0 || to < 0) ? 0 : linkCostMatrix.cost(from, to);
+    };
+    int32_t clientIndex = indexOf(client);
+    std::vector<int32_t> nodeIndices;
+    nodeIndices.reserve(clusterNodes.size());
+    for (const auto &node : clusterNodes)
+    {
+        nodeIndices.push_back(indexOf(node));
+    }
+
     for (const auto &headCandidate : clusterHeadCandidate)
     {
         bool canBeCH = true;
+        int32_t headIndex = indexOf(headCandidate);
 
-        for (const auto &node : clusterNodes)
+        for (int32_t node : nodeIndices)
         {
-            if (linkCostMatrix[node][client] < linkCostMatrix[node][headCandidate])
+            if (cost(node, clientIndex) < cost(node, headIndex))
             {
                 canBeCH = false;
                 break;
@@ -54,9 +73,9 @@ std::string AggregationTree::findCH(std::vector<std::string> clusterNodes, std::
         long long totalCost = 0;
         if (canBeCH)
         {
-            for (const auto &node : clusterNodes)
+            for (int32_t node : nodeIndices)
             {
-                totalCost += linkCostMatrix[node][headCandidate];
+                totalCost += cost(node, headIndex);
             }
             int averageCost = static_cast<int>(totalCost / clusterNodes.size());
 
@@ -131,19 +150,17 @@ bool AggregationTree::aggregationTreeConstruction(std::vector<std::string> dataP
 
     // auto data = ReadData(file);
     // auto start_time = std::chrono::high_resolution_clock::now();
-    double result;
-    KMeans *k_means;
-    auto *rkm = new RegularizedKMeans(
-        dataPointNames, numClusters, linkCostMatrix, init_method, !no_warm_start,
-        threads, seed);
-    result = rkm->SolveHard();
-    k_means = rkm;
-    // delete k_means;
+    // On the stack like repairTree()'s, its thread pool is joined once the layer is clustered
+    std::vector<std::vector<std::string>> newCluster;
+    {
+        RegularizedKMeans rkm(dataPointNames, numClusters, linkCostMatrix, init_method, !no_warm_start,
+                              threads, seed, solverBackend);
+        rkm.SolveHard();
+        newCluster = std::move(rkm.clusters);
+    }
 
     // BKM finish...
 
-    std::vector<std::vector<std::string>> newCluster = k_means->clusters;
-
     // Construct the nodeList for CH allocation
     int i = 0;
     std::cout << "\nIterating new clusters." << std::endl;
@@ -214,3 +231,139 @@ bool AggregationTree::aggregationTreeConstruction(std::vector<std::string> dataP
     }
     return true;
 }
+
+/**
+ * Repair after an aggregator, or the link to it, failed. Its children are reclustered with the cached link costs into
+ * ceil(children / C) clusters (a single one for a tree built with the same C, the solver only runs when C shrank), each
+ * cluster gets a head among the aggregators left out of the tree, and the heads take the failed node's place among its
+ * parent's children. The rest of the tree is untouched, so only the parent and the heads need a new subtree.
+ */
+bool AggregationTree::repairTree(const std::string &failed, int C, TreeRepair &repair)
+{
+    auto failedIt = aggregationAllocation.find(failed);
+    if (failedIt == aggregationAllocation.end() || failed == globalClient)
+    {
+        std::cerr << failed << " isn't an aggregator of the tree, it can't be replaced." << std::endl;
+        return false;
+    }
+
+    // Children list holding the failed node, the consumer's children of the later rounds are in noCHTree
+    std::vector<std::string> *siblings = nullptr;
+    for (auto &[node, children] : aggregationAllocation)
+    {
+        if (std::find(children.begin(), children.end(), failed) != children.end())
+        {
+            repair.parent = node;
+            siblings = &children;
+            break;
+        }
+    }
+    for (auto &subTree : noCHTree)
+    {
+        if (siblings == nullptr && std::find(subTree.begin(), subTree.end(), failed) != subTree.end())
+        {
+            repair.parent = globalClient;
+            siblings = &subTree;
+        }
+    }
+    if (siblings == nullptr)
+    {
+        std::cerr << "No parent of " << failed << " in the tree." << std::endl;
+        return false;
+    }
+
+    // Head candidates are the aggregators that aren't in the tree and haven't failed
+    std::set<std::string> used;
+    for (const auto &[node, children] : aggregationAllocation)
+    {
+        used.insert(node);
+        used.insert(children.begin(), children.end());
+    }
+    for (const auto &subTree : noCHTree)
+    {
+        used.insert(subTree.begin(), subTree.end());
+    }
+    std::vector<std::string> candidates;
+    for (const auto &node : fullList)
+    {
+        if (used.count(node) == 0 && failedNodes.count(node) == 0 && node != failed)
+        {
+            candidates.push_back(node);
+        }
+    }
+
+    const std::vector<std::string> &orphans = failedIt->second;
+    int numClusters = static_cast<int>(ceil(static_cast<double>(orphans.size()) / C));
+    std::vector<std::vector<std::string>> clusters;
+    if (numClusters <= 1)
+    {
+        clusters.push_back(orphans);
+    }
+    else
+    {
+        RegularizedKMeans rkm(orphans, numClusters, linkCostMatrix, RegularizedKMeans::InitMethod::kForgy, true, -1,
+                              std::random_device{}(), solverBackend);
+        rkm.SolveHard();
+        clusters = rkm.clusters;
+    }
+
+    // Pick the heads first, the tree is only changed once all of them are found
+    auto indexOf = [this](const std::string &name) -> int32_t
+    {
+        auto it = linkCostMatrix.index.find(name);
+        return it == linkCostMatrix.index.end() ? -1 : it->second;
+    };
+    std::vector<std::string> heads;
+    for (const auto &cluster : clusters)
+    {
+        std::string head = findCH(cluster, candidates, globalClient);
+        if (head == globalClient)
+        {
+            // No candidate is closer to the cluster than the consumer, settle for the cheapest reachable one
+            head.clear();
+            long long leastCost = std::numeric_limits<long long>::max();
+            for (const auto &candidate : candidates)
+            {
+                int32_t to = indexOf(candidate);
+                long long totalCost = 0;
+                for (const auto &node : cluster)
+                {
+                    int32_t from = indexOf(node);
+                    int32_t cost = (from < 0 || to < 0) ? -1 : linkCostMatrix.cost(from, to);
+                    if (cost < 0)
+                    {
+                        totalCost = std::numeric_limits<long long>::max();
+                        break;
+                    }
+                    totalCost += cost;
+                }
+                if (totalCost < leastCost)
+                {
+                    leastCost = totalCost;
+                    head = candidate;
+                }
+            }
+        }
+        if (head.empty())
+        {
+            std::cerr << "No aggregator left to replace " << failed << "." << std::endl;
+            return false;
+        }
+        candidates.erase(std::remove(candidates.begin(), candidates.end(), head), candidates.end());
+        heads.push_back(head);
+    }
+
+    for (size_t i = 0; i < heads.size(); ++i)
+    {
+        aggregationAllocation[heads[i]] = clusters[i];
+        CHList.erase(std::remove(CHList.begin(), CHList.end(), heads[i]), CHList.end());
+    }
+    aggregationAllocation.erase(failed);
+    failedNodes.insert(failed);
+    auto position = std::find(siblings->begin(), siblings->end(), failed);
+    *position = heads.front();
+    siblings->insert(position + 1, heads.begin() + 1, heads.end());
+
+    repair.heads = heads;
+    return true;
+}
@@ -1,9 +1,12 @@
 #include "../include/k_means.hpp"
 
+#include <algorithm>
+
 // Pseudo-random number generation
 std::random_device rd;
 
 KMeans::KMeans(const std::vector<std::string>& data, int k,
+               const Utility::LinkCostMatrix& linkCostMatrix,
                InitMethod init_method, unsigned int seed)
         : data_(data),
           n_(static_cast<int>(data.size())),
@@ -13,7 +16,25 @@ KMeans::KMeans(const std::vector<std::string>& data, int k,
           clusters(std::vector<std::vector<std::string>>(k)), // initialization of clusters
           init_method_(init_method),
           el_(seed),
-          seed_(seed) {}
+          seed_(seed) {
+    // Only the costs between data points are ever used, keep them contiguous. Names missing from the matrix
+    // cost 0, as the nested map used to default them.
+    std::vector<int> rows(n_, -1);
+    for (int i = 0; i < n_; ++i) {
+        auto it = linkCostMatrix.index.find(data_[i]);
+        if (it != linkCostMatrix.index.end())
+            rows[i] = it->second;
+    }
+    link_costs_.assign(static_cast<size_t>(n_) * n_, 0);
+    for (int i = 0; i < n_; ++i) {
+        if (rows[i] < 0)
+            continue;
+        for (int j = 0; j < n_; ++j) {
+            if (rows[j] >= 0)
+                link_costs_[static_cast<size_t>(i) * n_ + j] = linkCostMatrix.cost(rows[i], rows[j]);
+        }
+    }
+}
 
 const std::vector<std::vector<std::string>>& KMeans::cluster_centers() const {
     return this->clusters;
@@ -23,23 +44,35 @@ const std::vector<int>& KMeans::assignments() const {
     return this->assignments_;
 }
 
-// todo: Done!
-int KMeans::CalDistance(const std::string& data1,
-                        const std::string& data2,
-                        std::map<std::string, std::map<std::string, int>> linkCostMatrix) const {
-    return linkCostMatrix[data1][data2];
+int KMeans::LinkCost(int data1, int data2) const {
+    return link_costs_[static_cast<size_t>(data1) * n_ + data2];
 }
 
-// todo: Done!
-int KMeans::CalDistance(const std::string& data1,
-                        const std::vector<std::string>& cluster,
-                        std::map<std::string, std::map<std::string, int>> linkCostMatrix) const {
+// Average cost from the cluster's members to the data point
+int KMeans::CalDistance(int data, int cluster) const {
+    const std::vector<int>& members = members_[cluster];
+    if (members.empty())
+        return 0;
     int distance = 0;
-    for (const auto& node : cluster) {
-        distance += linkCostMatrix[node][data1];
+    for (int node : members) {
+        distance += LinkCost(node, data);
+    }
+    return distance / static_cast<int>(members.size());
+}
+
+void KMeans::ClusterCostSums(int cluster, std::vector<int32_t>& sums) const {
+    sums.resize(n_);
+    ClusterCostSums(cluster, 0, n_, sums.data());
+}
+
+void KMeans::ClusterCostSums(int cluster, int begin, int end, int32_t* sums) const {
+    std::fill(sums, sums + (end - begin), 0);
+    for (int node : members_[cluster]) {
+        const int32_t* row = &link_costs_[static_cast<size_t>(node) * n_ + begin];
+        for (int i = 0; i < end - begin; ++i) {
+            sums[i] += row[i];
+        }
     }
-    distance = distance / cluster.size();
-    return distance;
 }
 
 void KMeans::Init() {
@@ -58,16 +91,49 @@ void KMeans::Init() {
 void KMeans::UpdateClusterCenter() {
     clusters.clear();
     clusters.resize(k_);
-    for (int i = 0; i < n_; ++i) {
-        clusters[assignments_[i]].emplace_back(data_[i]);
+    members_.clear();
+    members_.resize(k_);
+    if (pool_ == nullptr || n_ <= kAssignTile) {
+        for (int i = 0; i < n_; ++i) {
+            clusters[assignments_[i]].emplace_back(data_[i]);
+            members_[assignments_[i]].push_back(i);
+        }
+        return;
     }
+
+    // Bucket each tile of data points, then concatenate the buckets in tile order so members stay sorted
+    const int tiles = (n_ + kAssignTile - 1) / kAssignTile;
+    std::vector<std::vector<std::vector<int>>> buckets(tiles, std::vector<std::vector<int>>(k_));
+    pool_->ParallelFor(0, n_, kAssignTile, [this, &buckets](int begin, int end) {
+        std::vector<std::vector<int>>& local = buckets[begin / kAssignTile];
+        for (int i = begin; i < end; ++i) {
+            local[assignments_[i]].push_back(i);
+        }
+    });
+    pool_->ParallelFor(0, k_, 1, [this, &buckets](int begin, int end) {
+        for (int j = begin; j < end; ++j) {
+            for (const std::vector<std::vector<int>>& local : buckets) {
+                members_[j].insert(members_[j].end(), local[j].begin(), local[j].end());
+            }
+            clusters[j].reserve(members_[j].size());
+            for (int i : members_[j]) {
+                clusters[j].emplace_back(data_[i]);
+            }
+        }
+    });
 }
 
-double KMeans::GetSumSquaredError(const std::map<std::string, std::map<std::string, int>> linkCostMatrix) const {
+double KMeans::GetSumSquaredError() const {
     double sum = 0;
-    for (int i = 0; i < n_; ++i) {
-        // ToDo: change the code
-        sum += CalDistance(data_[i], clusters[assignments_[i]], linkCostMatrix);
+    std::vector<int32_t> sums;
+    for (int j = 0; j < k_; ++j) {
+        if (members_[j].empty())
+            continue;
+        ClusterCostSums(j, sums);
+        for (int i = 0; i < n_; ++i) {
+            if (assignments_[i] == j)
+                sum += sums[i] / static_cast<int>(members_[j].size());
+        }
     }
     return sum;
 }
@@ -75,8 +141,10 @@ double KMeans::GetSumSquaredError(const std::map<std::string, std::map<std::stri
 // Use the result of assignment, assign the data to the clusters
 void KMeans::InitWithRandomCenter() {
     clusters.resize(k_);
+    members_.resize(k_);
     for (int i = 0; i < n_; ++i) {
         clusters[assignments_[i]].emplace_back(data_[i]);
+        members_[assignments_[i]].push_back(i);
     }
 }
 
@@ -0,0 +1,14 @@
+#include "../include/min_cost_flow_solver.hpp"
+
+#include "../include/network_simplex.hpp"
+#include "../include/successive_shortest_path.hpp"
+
+std::unique_ptr<MinCostFlowSolver> MinCostFlowSolver::Create(Backend backend) {
+    switch (backend) {
+        case kSuccessiveShortestPath:
+            return std::make_unique<SuccessiveShortestPath>();
+        case kNetworkSimplex:
+        default:
+            return std::make_unique<NetworkSimplex>();
+    }
+}
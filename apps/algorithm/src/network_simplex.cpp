@@ -82,6 +82,8 @@ void NetworkSimplex::BuildTree() {
     }
 }
 
+void NetworkSimplex::Solve() { Simplex(); }
+
 void NetworkSimplex::Simplex() {
     int num_edges = static_cast<int>(edge_list_.size());
     for (int edge_index = 0, scaned = 0; scaned < num_edges;
@@ -129,6 +131,13 @@ void NetworkSimplex::GetAssignments(std::vector<int>* assignments) const {
 
 double NetworkSimplex::min_cost() const { return min_cost_; }
 
+size_t NetworkSimplex::memory_bytes() const {
+    return edge_list_.capacity() * sizeof(Edge) +
+           (parent_.capacity() + parent_edge_index_.capacity() +
+            parent_direction_.capacity() + potential_tag_.capacity()) * sizeof(int) +
+           potential_.capacity() * sizeof(double) + vis_.capacity() / 8;
+}
+
 void NetworkSimplex::Pivot(int edge_index, int direction, double delta) {
     Edge& edge = edge_list_[edge_index];
     int min_res_cap = edge.cap;
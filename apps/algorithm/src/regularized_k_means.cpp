@@ -4,77 +4,68 @@
 #include <thread>
 
 RegularizedKMeans::RegularizedKMeans(
-        const std::vector<std::string>& data, int k, std::map<std::string, std::map<std::string, int>> costMatrix, InitMethod init_method,
-        bool warm_start, int n_jobs, unsigned int seed)
-        : KMeans(data, k, init_method, seed),
+        const std::vector<std::string>& data, int k, const Utility::LinkCostMatrix& costMatrix, InitMethod init_method,
+        bool warm_start, int n_jobs, unsigned int seed, MinCostFlowSolver::Backend backend)
+        : KMeans(data, k, costMatrix, init_method, seed),
           warm_start_(warm_start),
-          n_jobs_(n_jobs == -1 ? std::thread::hardware_concurrency() : n_jobs),
-          costs_(static_cast<int>(data.size()), std::vector<double>(k)),
-          linkCostMatrix(costMatrix){}
+          n_jobs_(n_jobs <= 0 ? std::max(1, static_cast<int>(std::thread::hardware_concurrency())) : n_jobs),
+          backend_(backend),
+          thread_pool_(std::make_unique<Utility::ThreadPool>(n_jobs_)),
+          costs_(static_cast<int>(data.size()), std::vector<double>(k)) {
+    pool_ = thread_pool_.get();
+}
 
 double RegularizedKMeans::SolveHard() {
     return SolveHard(n_ / k_, (n_ + k_ - 1) / k_);
 }
 
 double RegularizedKMeans::SolveHard(int lower_bound, int upper_bound) {
-    return Solve([this, lower_bound, upper_bound]() -> NetworkSimplex {
-        NetworkSimplex ns = NetworkSimplex();
-        ns.BuildHard(this->costs_, this->k_, lower_bound, upper_bound);
-        return ns;
+    return Solve([this, lower_bound, upper_bound](MinCostFlowSolver& solver) {
+        solver.BuildHard(this->costs_, this->k_, lower_bound, upper_bound);
     });
 }
 
 double RegularizedKMeans::Solve(const std::function<double(int, int)>& f) {
-    return Solve([this, &f]() -> NetworkSimplex {
-        NetworkSimplex ns = NetworkSimplex();
-        ns.Build(this->costs_, f);
-        return ns;
+    return Solve([this, &f](MinCostFlowSolver& solver) {
+        solver.Build(this->costs_, f);
     });
 }
 
-double RegularizedKMeans::Solve(std::function<NetworkSimplex()> builder) {
+double RegularizedKMeans::Solve(const std::function<void(MinCostFlowSolver&)>& build) {
     Init();
     UpdateCostMatrix();
     std::vector<int> old_assignments;
-    NetworkSimplex ns_solver = builder();
-    ns_solver.Simplex();
-    ns_solver.GetAssignments(&assignments_);
+    std::unique_ptr<MinCostFlowSolver> solver = MinCostFlowSolver::Create(backend_);
+    build(*solver);
+    solver->Solve();
+    solver->GetAssignments(&assignments_);
     do {
         old_assignments = assignments_;
         UpdateClusterCenter();
         UpdateCostMatrix();
         if (warm_start_) {
-            ns_solver.UpdateCosts(costs_);
+            solver->UpdateCosts(costs_);
         } else {
-            ns_solver = builder();
+            solver = MinCostFlowSolver::Create(backend_);
+            build(*solver);
         }
-        ns_solver.Simplex();
-        ns_solver.GetAssignments(&assignments_);
+        solver->Solve();
+        solver->GetAssignments(&assignments_);
     } while (old_assignments != assignments_);
-    return GetSumSquaredError(linkCostMatrix);
+    return GetSumSquaredError();
 }
 
+// costs_[i][j] is the average cost from cluster j's members to data point i. Rows are filled in tiles, each
+// reading the same short slice of every member's contiguous cost row, so a task stays in cache.
 void RegularizedKMeans::UpdateCostMatrix() {
-    if (n_jobs_ <= 1) {
-        for (int i = 0; i < n_; ++i) {
-            for (int j = 0; j < k_; ++j) {
-                costs_[i][j] = CalDistance(data_[i], clusters[j], linkCostMatrix);
+    thread_pool_->ParallelFor(0, n_, kCostTile, [this](int begin, int end) {
+        int32_t sums[kCostTile];
+        for (int j = 0; j < k_; ++j) {
+            int size = static_cast<int>(members_[j].size());
+            ClusterCostSums(j, begin, end, sums);
+            for (int i = begin; i < end; ++i) {
+                costs_[i][j] = size == 0 ? 0 : sums[i - begin] / size;
             }
         }
-    } else {
-        std::vector<std::thread> threads(n_jobs_);
-        for (int t = 0; t < n_jobs_; ++t) {
-            threads[t] = std::thread(std::bind(
-                    [this](int thread_idx) {
-                        for (int idx = thread_idx; idx < n_ * k_; idx += n_jobs_) {
-                            int i = idx / k_;
-                            int j = idx % k_;
-                            costs_[i][j] = CalDistance(data_[i], clusters[j], linkCostMatrix);
-                        }
-                    },
-                    t));
-        }
-        std::for_each(threads.begin(), threads.end(),
-                      [](std::thread& x) { x.join(); });
-    }
+    });
 }
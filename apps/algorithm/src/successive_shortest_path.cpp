@@ -0,0 +1,226 @@
+#include "../include/successive_shortest_path.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+constexpr double kInfinity = std::numeric_limits<double>::infinity();
+}
+
+void SuccessiveShortestPath::BuildHard(
+        const std::vector<std::vector<double>>& costs, int k, int lower_bound,
+        int upper_bound) {
+    int n = static_cast<int>(costs.size());
+    if (static_cast<long long>(upper_bound) * k < n ||
+        static_cast<long long>(lower_bound) * k > n) {
+        throw std::invalid_argument("Cluster size bounds admit no assignment");
+    }
+    BuildBasic(costs, upper_bound);
+    lower_bound_ = lower_bound;
+    std::fill(marginals_.begin(), marginals_.end(), 0.0);
+}
+
+void SuccessiveShortestPath::Build(
+        const std::vector<std::vector<double>>& costs,
+        const std::function<double(int, int)>& f) {
+    BuildBasic(costs, static_cast<int>(costs.size()));
+    // The s-th unit into a cluster costs f(j, s + 1) - f(j, s) as in NetworkSimplex::Build, the flow takes
+    // the cheapest of these parallel arcs first whatever their order
+    for (int j = 0; j < k_; ++j) {
+        double* row = &marginals_[static_cast<size_t>(j) * capacity_];
+        for (int t = 0; t < capacity_; ++t) {
+            row[t] = f(j, t + 1) - f(j, t);
+        }
+        std::sort(row, row + capacity_);
+    }
+}
+
+void SuccessiveShortestPath::BuildBasic(
+        const std::vector<std::vector<double>>& costs, int capacity) {
+    n_ = static_cast<int>(costs.size());
+    k_ = static_cast<int>(costs.front().size());
+    capacity_ = capacity;
+    lower_bound_ = 0;
+    solved_ = false;
+    preferred_.assign(n_, -1);
+    costs_.resize(static_cast<size_t>(n_) * k_);
+    UpdateCosts(costs);
+    marginals_.resize(static_cast<size_t>(k_) * capacity_);
+    assignments_.resize(n_);
+    loads_.resize(k_);
+    moves_.resize(static_cast<size_t>(k_) * k_);
+    potential_.resize(k_ + 1);
+    dist_.resize(k_ + 1);
+    pred_cluster_.resize(k_ + 1);
+    pred_point_.resize(k_ + 1);
+    settled_.resize(k_ + 1);
+}
+
+void SuccessiveShortestPath::Solve() {
+    bool preferring = std::any_of(preferred_.begin(), preferred_.end(), [](int cluster) { return cluster >= 0; });
+    scale_ = preferring ? n_ + 1.0 : 1.0;
+    // A path's cost is at most 2n + 1 arcs of max_cost, a bonus of twice that makes every path ending on a
+    // lower bound arc cheaper than any ending on another one, so the bounds are met whenever they can be
+    bound_bonus_ = 0.0;
+    if (lower_bound_ > 0) {
+        double max_cost = 0.0;
+        for (double cost : costs_) {
+            max_cost = std::max(max_cost, std::abs(cost));
+        }
+        bound_bonus_ = (4.0 * n_ + 3.0) * (max_cost * scale_ + 1.0) + 1.0;
+    }
+    std::fill(assignments_.begin(), assignments_.end(), -1);
+    std::fill(loads_.begin(), loads_.end(), 0);
+    for (auto& moves : moves_) {
+        moves.clear();
+    }
+    // No point is routed yet, only the arcs to the sink need a non-negative reduced cost
+    std::fill(potential_.begin(), potential_.end(), 0.0);
+    potential_[k_] = kInfinity;
+    for (int j = 0; j < k_; ++j) {
+        potential_[k_] = std::min(potential_[k_], Marginal(j, 0));
+    }
+    for (int point = 0; point < n_; ++point) {
+        ShortestPath(point);
+        Augment();
+    }
+    solved_ = true;
+
+    min_cost_ = 0.0;
+    for (int i = 0; i < n_; ++i) {
+        min_cost_ += costs_[static_cast<size_t>(i) * k_ + assignments_[i]];
+    }
+    for (int j = 0; j < k_; ++j) {
+        for (int t = 0; t < loads_[j]; ++t) {
+            min_cost_ += marginals_[static_cast<size_t>(j) * capacity_ + t];
+        }
+    }
+}
+
+void SuccessiveShortestPath::UpdateCosts(
+        const std::vector<std::vector<double>>& costs) {
+    for (int i = 0; i < n_; ++i) {
+        std::copy(costs[i].begin(), costs[i].end(), costs_.begin() + static_cast<size_t>(i) * k_);
+    }
+    if (solved_) {
+        preferred_ = assignments_;
+    }
+}
+
+void SuccessiveShortestPath::GetAssignments(std::vector<int>* assignments) const {
+    *assignments = assignments_;
+}
+
+double SuccessiveShortestPath::min_cost() const { return min_cost_; }
+
+size_t SuccessiveShortestPath::memory_bytes() const {
+    size_t bytes = (costs_.capacity() + marginals_.capacity() +
+                    potential_.capacity() + dist_.capacity()) * sizeof(double) +
+                   (preferred_.capacity() + assignments_.capacity() + loads_.capacity() +
+                    pred_cluster_.capacity() + pred_point_.capacity()) * sizeof(int) +
+                   settled_.capacity() / 8 + moves_.capacity() * sizeof(MoveHeap);
+    for (const auto& moves : moves_) {
+        bytes += moves.capacity() * sizeof(MoveHeap::value_type);
+    }
+    return bytes;
+}
+
+// Cost change of the cheapest member of from moved to to, false if from is empty
+bool SuccessiveShortestPath::CheapestMove(int from, int to, double* cost, int* point) {
+    MoveHeap& moves = Moves(from, to);
+    while (!moves.empty() && assignments_[moves.front().second] != from) {
+        std::pop_heap(moves.begin(), moves.end(), std::greater<>());
+        moves.pop_back();
+    }
+    if (moves.empty()) {
+        return false;
+    }
+    *cost = moves.front().first;
+    *point = moves.front().second;
+    return true;
+}
+
+// Dijkstra over the clusters from an unrouted point, stopping once the sink is nearer than every cluster left.
+// The graph is dense, so the nearest node is found by a scan rather than a heap.
+void SuccessiveShortestPath::ShortestPath(int source) {
+    const int sink = k_;
+    for (int j = 0; j < k_; ++j) {
+        dist_[j] = Cost(source, j) - potential_[j];
+        pred_cluster_[j] = -1;
+        pred_point_[j] = source;
+    }
+    dist_[sink] = kInfinity;
+    std::fill(settled_.begin(), settled_.end(), false);
+
+    while (true) {
+        int u = sink;
+        for (int j = 0; j < k_; ++j) {
+            if (!settled_[j] && dist_[j] < dist_[u]) {
+                u = j;
+            }
+        }
+        if (dist_[u] == kInfinity) {
+            throw std::logic_error("Cluster capacities below the number of points");
+        }
+        if (u == sink) {
+            break;
+        }
+        settled_[u] = true;
+        double base = dist_[u] + potential_[u];
+        if (loads_[u] < capacity_ && base + Marginal(u, loads_[u]) - potential_[sink] < dist_[sink]) {
+            dist_[sink] = base + Marginal(u, loads_[u]) - potential_[sink];
+            pred_cluster_[sink] = u;
+        }
+        for (int v = 0; v < k_; ++v) {
+            double cost;
+            int point;
+            if (!settled_[v] && v != u && CheapestMove(u, v, &cost, &point) &&
+                base + cost - potential_[v] < dist_[v]) {
+                dist_[v] = base + cost - potential_[v];
+                pred_cluster_[v] = u;
+                pred_point_[v] = point;
+            }
+        }
+    }
+
+    // Clusters left unsettled are at least as far as the sink and keep their potential
+    for (int j = 0; j < k_; ++j) {
+        if (settled_[j]) {
+            potential_[j] += dist_[j] - dist_[sink];
+        }
+    }
+}
+
+// Walk the path back from the sink, every point on it moves to the cluster after it
+void SuccessiveShortestPath::Augment() {
+    int cluster = pred_cluster_[k_];
+    ++loads_[cluster];
+    while (cluster != -1) {
+        int from = pred_cluster_[cluster];
+        Assign(pred_point_[cluster], cluster);
+        cluster = from;
+    }
+}
+
+void SuccessiveShortestPath::Assign(int point, int cluster) {
+    assignments_[point] = cluster;
+    for (int to = 0; to < k_; ++to) {
+        if (to == cluster) {
+            continue;
+        }
+        MoveHeap& moves = Moves(cluster, to);
+        moves.emplace_back(Cost(point, to) - Cost(point, cluster), point);
+        std::push_heap(moves.begin(), moves.end(), std::greater<>());
+        // Drop the points that left, and the copies of those that came back, once they outnumber the members.
+        // A sorted range is a heap.
+        if (moves.size() > 2 * static_cast<size_t>(loads_[cluster]) + 16) {
+            moves.erase(std::remove_if(moves.begin(), moves.end(),
+                                       [this, cluster](const auto& move) { return assignments_[move.second] != cluster; }),
+                        moves.end());
+            std::sort(moves.begin(), moves.end());
+            moves.erase(std::unique(moves.begin(), moves.end()), moves.end());
+        }
+    }
+}
@@ -0,0 +1,164 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Utility {
+
+    /**
+     * Fixed set of worker threads reused across parallel loops. A loop is cut into tiles, each participant
+     * (the workers and the calling thread) gets a contiguous run of them and steals from the others' tails
+     * once its own run is done. ParallelFor must not be called from several threads at once.
+     */
+    class ThreadPool {
+    public:
+        using Body = std::function<void(int, int)>;
+
+        // threads counts the calling thread, 0 or less means one per core
+        explicit ThreadPool(int threads)
+        {
+            if (threads <= 0)
+                threads = static_cast<int>(std::thread::hardware_concurrency());
+            threads = std::max(threads, 1);
+            queues_ = std::vector<Queue>(threads);
+            for (int t = 1; t < threads; ++t) {
+                workers_.emplace_back([this, t]() { WorkerLoop(t); });
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        ~ThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            wake_.notify_all();
+            for (std::thread& worker : workers_) {
+                worker.join();
+            }
+        }
+
+        int size() const { return static_cast<int>(queues_.size()); }
+
+        // Runs body(tileBegin, tileEnd) over [begin, end) in tiles of at most grain items, returns when all are done
+        void ParallelFor(int begin, int end, int grain, const Body& body)
+        {
+            if (end <= begin)
+                return;
+            grain = std::max(grain, 1);
+            const int tiles = (end - begin + grain - 1) / grain;
+            if (tiles == 1 || workers_.empty()) {
+                for (int b = begin; b < end; b += grain) {
+                    body(b, std::min(b + grain, end));
+                }
+                return;
+            }
+
+            const int participants = size();
+            pending_.store(tiles, std::memory_order_relaxed);
+            for (int p = 0; p < participants; ++p) {
+                std::lock_guard<std::mutex> lock(queues_[p].mutex);
+                for (int t = tiles * p / participants; t < tiles * (p + 1) / participants; ++t) {
+                    int b = begin + t * grain;
+                    queues_[p].tiles.push_back(Tile{b, std::min(b + grain, end), &body});
+                }
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                ++generation_;
+            }
+            wake_.notify_all();
+
+            RunTiles(0);
+            std::unique_lock<std::mutex> lock(mutex_);
+            done_.wait(lock, [this]() { return pending_.load(std::memory_order_acquire) == 0; });
+        }
+
+    private:
+        struct Tile {
+            int begin;
+            int end;
+            const Body* body;
+        };
+
+        struct Queue {
+            std::mutex mutex;
+            std::deque<Tile> tiles;
+        };
+
+        bool PopOwn(int self, Tile& tile)
+        {
+            Queue& queue = queues_[self];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tiles.empty())
+                return false;
+            tile = queue.tiles.front();
+            queue.tiles.pop_front();
+            return true;
+        }
+
+        bool Steal(int self, Tile& tile)
+        {
+            const int participants = size();
+            for (int offset = 1; offset < participants; ++offset) {
+                Queue& queue = queues_[(self + offset) % participants];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                if (!queue.tiles.empty()) {
+                    tile = queue.tiles.back();
+                    queue.tiles.pop_back();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void RunTiles(int self)
+        {
+            Tile tile;
+            while (PopOwn(self, tile) || Steal(self, tile)) {
+                (*tile.body)(tile.begin, tile.end);
+                if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    done_.notify_all();
+                }
+            }
+        }
+
+        void WorkerLoop(int self)
+        {
+            unsigned long long seen = 0;
+            while (true) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    wake_.wait(lock, [this, seen]() { return stop_ || generation_ != seen; });
+                    if (stop_)
+                        return;
+                    seen = generation_;
+                }
+                RunTiles(self);
+            }
+        }
+
+        std::vector<Queue> queues_; // One per participant, index 0 is the calling thread
+        std::vector<std::thread> workers_;
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::condition_variable done_;
+        std::atomic<int> pending_{0};
+        unsigned long long generation_ = 0;
+        bool stop_ = false;
+    };
+
+}
+
+#endif // THREAD_POOL_HPP
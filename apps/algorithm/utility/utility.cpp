@@ -14,6 +14,9 @@
 #include <unordered_map>
 #include <climits>
 #include <stdexcept>
+#include <atomic>
+#include <functional>
+#include <thread>
 
 
 
@@ -117,7 +120,7 @@ std::unordered_map<std::string, std::vector<std::pair<std::string, int>>> Utilit
 
 
 // Function to find the minimum link cost between any two nodes using Dijkstra's algorithm
-int Utility::findLinkCost(const std::string& start, const std::string& end, const std::unordered_map<std::string, std::vector<std::pair<std::string, int>>> graph) {
+int Utility::findLinkCost(const std::string& start, const std::string& end, const std::unordered_map<std::string, std::vector<std::pair<std::string, int>>>& graph) {
     if (graph.find(start) == graph.end() || graph.find(end) == graph.end())
         return -1; // Nodes are not present in the graph
 
@@ -235,16 +238,186 @@ int Utility::countProducers(std::string filename) {
     return producerCount;
 }
 
-std::map<std::string, std::map<std::string, int>> Utility::GetAllLinkCost(std::string filename)
+// Same links as initializeGraph(), with integer node ids
+Utility::CsrGraph Utility::loadCsrGraph(std::string filename) {
+    CsrGraph graph;
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open file: " << filename << std::endl;
+        graph.offsets.push_back(0);
+        return graph;
+    }
+
+    auto idOf = [&graph](const std::string& name) {
+        auto it = graph.ids.find(name);
+        if (it != graph.ids.end())
+            return it->second;
+        int32_t id = static_cast<int32_t>(graph.names.size());
+        graph.names.push_back(name);
+        graph.ids.emplace(name, id);
+        return id;
+    };
+
+    // Links as (from, to, cost), both directions
+    std::vector<std::pair<int32_t, std::pair<int32_t, int32_t>>> edges;
+    std::string line;
+    bool linkSection = false;
+    while (getline(file, line)) {
+        if (line == "link") {
+            linkSection = true;
+            continue;
+        }
+
+        if (linkSection && !line.empty()) {
+            std::istringstream iss(line);
+            std::string node1, node2;
+            std::string speed; // Placeholder for speed
+            int cost;
+            iss >> node1 >> node2 >> speed >> cost;
+
+            int32_t id1 = idOf(node1);
+            int32_t id2 = idOf(node2);
+            edges.push_back({id1, {id2, cost}});
+            edges.push_back({id2, {id1, cost}});
+        }
+    }
+
+    // Counting sort of the edges by source node
+    graph.offsets.assign(graph.names.size() + 1, 0);
+    for (const auto& edge : edges)
+        graph.offsets[edge.first + 1]++;
+    for (size_t i = 1; i < graph.offsets.size(); i++)
+        graph.offsets[i] += graph.offsets[i - 1];
+    graph.targets.resize(edges.size());
+    graph.costs.resize(edges.size());
+    std::vector<int32_t> next(graph.offsets.begin(), graph.offsets.end() - 1);
+    for (const auto& edge : edges) {
+        int32_t slot = next[edge.first]++;
+        graph.targets[slot] = edge.second.first;
+        graph.costs[slot] = edge.second.second;
+    }
+    return graph;
+}
+
+namespace {
+    constexpr int32_t UNREACHABLE = INT32_MAX;
+
+    // Costs from source to every node of the graph
+    void dijkstra(const Utility::CsrGraph& graph, int32_t source, std::vector<int32_t>& distances) {
+        using Entry = std::pair<int32_t, int32_t>; // (cost, node)
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> pq;
+        distances.assign(graph.nodeCount(), UNREACHABLE);
+        distances[source] = 0;
+        pq.push({0, source});
+
+        while (!pq.empty()) {
+            auto [currentCost, currentNode] = pq.top();
+            pq.pop();
+            if (currentCost > distances[currentNode])
+                continue; // Stale entry, the node was settled cheaper
+
+            for (int32_t edge = graph.offsets[currentNode]; edge < graph.offsets[currentNode + 1]; edge++) {
+                int32_t nextNode = graph.targets[edge];
+                int32_t newCost = currentCost + graph.costs[edge];
+                if (newCost < distances[nextNode]) {
+                    distances[nextNode] = newCost;
+                    pq.push({newCost, nextNode});
+                }
+            }
+        }
+    }
+
+    // Costs between every pair of nodes of the graph, row-major
+    std::vector<int32_t> floydWarshall(const Utility::CsrGraph& graph) {
+        size_t n = graph.nodeCount();
+        std::vector<int32_t> distances(n * n, UNREACHABLE);
+        for (size_t i = 0; i < n; i++) {
+            distances[i * n + i] = 0;
+            for (int32_t edge = graph.offsets[i]; edge < graph.offsets[i + 1]; edge++) {
+                int32_t& cost = distances[i * n + graph.targets[edge]];
+                cost = std::min(cost, graph.costs[edge]);
+            }
+        }
+        for (size_t k = 0; k < n; k++) {
+            const int32_t* rowK = &distances[k * n];
+            for (size_t i = 0; i < n; i++) {
+                int32_t viaK = distances[i * n + k];
+                if (viaK == UNREACHABLE)
+                    continue;
+                int32_t* rowI = &distances[i * n];
+                for (size_t j = 0; j < n; j++) {
+                    if (rowK[j] != UNREACHABLE && viaK + rowK[j] < rowI[j])
+                        rowI[j] = viaK + rowK[j];
+                }
+            }
+        }
+        return distances;
+    }
+}
+
+Utility::LinkCostMatrix Utility::allPairsLinkCost(const CsrGraph& graph, const std::vector<std::string>& sources) {
+    LinkCostMatrix matrix;
+    matrix.nodes = sources;
+    size_t n = sources.size();
+    matrix.costs.assign(n * n, -1);
+
+    std::vector<int32_t> graphIds(n, -1);
+    for (size_t i = 0; i < n; i++) {
+        matrix.costs[i * n + i] = 0;
+        matrix.index.emplace(sources[i], static_cast<int32_t>(i));
+        auto it = graph.ids.find(sources[i]);
+        if (it != graph.ids.end())
+            graphIds[i] = it->second;
+    }
+
+    // Copy the rows of the sources out of the costs from every node
+    auto fillRow = [&](size_t i, const int32_t* distances) {
+        for (size_t j = 0; j < n; j++) {
+            if (graphIds[j] >= 0 && distances[graphIds[j]] != UNREACHABLE)
+                matrix.costs[i * n + j] = distances[graphIds[j]];
+        }
+    };
+
+    // Dense graph, a single O(V^3) pass beats a heap per source
+    size_t v = graph.nodeCount();
+    if (v > 0 && graph.targets.size() * 2 >= v * v) {
+        std::vector<int32_t> distances = floydWarshall(graph);
+        for (size_t i = 0; i < n; i++) {
+            if (graphIds[i] >= 0)
+                fillRow(i, &distances[graphIds[i] * v]);
+        }
+        return matrix;
+    }
+
+    // Sparse graph, sources are handed out to the workers one at a time
+    std::atomic<size_t> nextSource{0};
+    auto worker = [&]() {
+        std::vector<int32_t> distances;
+        for (size_t i = nextSource++; i < n; i = nextSource++) {
+            if (graphIds[i] < 0)
+                continue;
+            dijkstra(graph, graphIds[i], distances);
+            fillRow(i, distances.data());
+        }
+    };
+    size_t threadCount = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), (n + 15) / 16);
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < threadCount; t++)
+        threads.emplace_back(worker);
+    worker();
+    for (std::thread& thread : threads)
+        thread.join();
+    return matrix;
+}
+
+Utility::LinkCostMatrix Utility::GetLinkCostMatrix(std::string filename)
 {
-    std::map<std::string, std::map<std::string, int>> linkCostMatrix;
     std::vector<std::string> nodeList;
-    std::unordered_map<std::string, std::vector<std::pair<std::string, int>>> graph;
 
     std::ifstream file(filename);
     if (!file.is_open()) {
         std::cerr << "Fail to open file." << filename << std::endl;
-        return linkCostMatrix;
+        return LinkCostMatrix();
     }
     std::string line;
     bool isRouterSection = false;
@@ -261,20 +434,17 @@ std::map<std::string, std::map<std::string, int>> Utility::GetAllLinkCost(std::s
         }
     }
 
-    // Get graph for further computation
-    graph = initializeGraph(filename);
-
-    // Compute link cost matrix
-    for (const auto& node1: nodeList) {
-        for (const auto& node2 : nodeList) {
-            if (node1 == node2) {
-                linkCostMatrix[node1][node2] = 0;
-            } else if (linkCostMatrix[node1].find(node2) == linkCostMatrix[node1].end()) {
-                int cost = findLinkCost(node1, node2, graph);
-                linkCostMatrix[node1][node2] = cost;
-                linkCostMatrix[node2][node1] = cost;
-            }
-        }
+    return allPairsLinkCost(loadCsrGraph(filename), nodeList);
+}
+
+std::map<std::string, std::map<std::string, int>> Utility::GetAllLinkCost(std::string filename)
+{
+    std::map<std::string, std::map<std::string, int>> linkCostMatrix;
+    LinkCostMatrix matrix = GetLinkCostMatrix(filename);
+    for (size_t i = 0; i < matrix.nodes.size(); i++) {
+        std::map<std::string, int>& row = linkCostMatrix[matrix.nodes[i]];
+        for (size_t j = 0; j < matrix.nodes.size(); j++)
+            row[matrix.nodes[j]] = matrix.cost(i, j);
     }
     return linkCostMatrix;
-}
\ No newline at end of file
+}
@@ -1,3 +1,6 @@
+#ifndef UTILITY_HPP
+#define UTILITY_HPP
+
 #include <iostream>
 #include <vector>
 #include <cmath> // For ceil
@@ -11,6 +14,7 @@
 #include <limits>
 #include <unordered_map>
 #include <climits>
+#include <cstdint>
 #include <set>
 
 
@@ -30,7 +34,38 @@ namespace Utility{
 
     std::unordered_map<std::string, std::vector<std::pair<std::string, int>>> initializeGraph(std::string filename);
 
-    int findLinkCost(const std::string& start, const std::string& end, const std::unordered_map<std::string, std::vector<std::pair<std::string, int>>> graph);
+    int findLinkCost(const std::string& start, const std::string& end, const std::unordered_map<std::string, std::vector<std::pair<std::string, int>>>& graph);
+
+    // Links of the topology in compressed sparse row form, nodes are numbered in order of first appearance
+    struct CsrGraph {
+        std::vector<std::string> names;
+        std::unordered_map<std::string, int32_t> ids;
+        std::vector<int32_t> offsets; // Edges of node i are [offsets[i], offsets[i + 1])
+        std::vector<int32_t> targets;
+        std::vector<int32_t> costs;
+
+        size_t nodeCount() const { return names.size(); }
+    };
+
+    CsrGraph loadCsrGraph(std::string filename);
+
+    // Shortest path cost between every pair of nodes, row-major, -1 if unreachable
+    struct LinkCostMatrix {
+        std::vector<std::string> nodes;
+        std::unordered_map<std::string, int32_t> index;
+        std::vector<int32_t> costs;
+
+        int32_t cost(size_t from, size_t to) const { return costs[from * nodes.size() + to]; }
+    };
+
+    /**
+     * Costs between the given sources, one Dijkstra per source run in parallel over the CSR graph, or
+     * Floyd-Warshall over the whole graph when it's dense. Sources missing from the graph get -1.
+     */
+    LinkCostMatrix allPairsLinkCost(const CsrGraph& graph, const std::vector<std::string>& sources);
+
+    // Matrix over the producers, aggregators and consumers of a topology file
+    LinkCostMatrix GetLinkCostMatrix(std::string filename);
 
     std::vector<std::string> getProducers(std::string filename);
 
@@ -38,4 +73,6 @@ namespace Utility{
 
     std::map<std::string, std::map<std::string, int>> GetAllLinkCost(std::string filename);
 
-};
\ No newline at end of file
+};
+
+#endif // UTILITY_HPP
@@ -0,0 +1,184 @@
+#ifndef INA_BENCH_HPP
+#define INA_BENCH_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <fstream>
+#include <fmt/core.h>
+
+/**
+ * Minimal microbenchmark harness for the INA data path
+ *
+ * Every case is calibrated until one batch of operations takes minTime / repetitions, then timed over
+ * `repetitions` batches; the median, min and max ns per operation are reported. Results are printed as a table
+ * and written as JSON lines, one object per case, so runs can be diffed and plotted.
+ */
+namespace Bench
+{
+    /**
+     * @brief Keep the compiler from optimizing value, and the work producing it, away
+     */
+    template <typename T>
+    inline void DoNotOptimize(const T &value)
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    using Params = std::vector<std::pair<std::string, std::string>>;
+
+    struct Result
+    {
+        std::string name; // suite/case
+        Params params;
+        uint64_t iterations = 0; // Operations per timed batch
+        double medianNs = 0.0;   // Per operation
+        double minNs = 0.0;
+        double maxNs = 0.0;
+        double bytesPerOp = 0.0; // Payload bytes one operation processes, 0 if not meaningful
+    };
+
+    /**
+     * @brief Payload sizes (parameters per packet) and fan-ins every suite sweeps, and the bipartite instances
+     * (producers x clusters) of the clustering solvers
+     */
+    struct Sweep
+    {
+        std::vector<size_t> sizes{150, 875, 8192, 65536};
+        std::vector<size_t> fanIns{2, 4, 8, 16, 32};
+        std::vector<size_t> producers{100, 1000, 10000};
+        std::vector<size_t> clusters{4, 32, 256};
+    };
+
+    class Runner
+    {
+    public:
+        struct Options
+        {
+            std::string filter; // Only cases whose "name params" contain it
+            std::chrono::milliseconds minTime{200};
+            int repetitions = 5;
+        };
+
+        explicit Runner(Options options) : m_options(std::move(options)) {}
+
+        /**
+         * @brief Whether a case is selected by the filter, for suites that set up expensive fixtures
+         */
+        bool Selected(const std::string &name, const Params &params) const
+        {
+            return m_options.filter.empty() || Label(name, params).find(m_options.filter) != std::string::npos;
+        }
+
+        /**
+         * @brief Time one case
+         * @param fn Callable fn(uint64_t n) performing the operation n times
+         * @param bytesPerOp Payload bytes per operation, reported as throughput
+         */
+        template <typename Function>
+        void Run(const std::string &name, const Params &params, double bytesPerOp, Function &&fn)
+        {
+            if (!Selected(name, params))
+                return;
+
+            using Clock = std::chrono::steady_clock;
+            auto time = [&fn](uint64_t n)
+            {
+                auto start = Clock::now();
+                fn(n);
+                return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            };
+
+            // Grow the batch until it's long enough to time reliably
+            double target = std::chrono::duration<double, std::nano>(m_options.minTime).count() / std::max(m_options.repetitions, 1);
+            uint64_t iterations = 1;
+            double elapsed = time(iterations);
+            while (elapsed < target && iterations < (uint64_t(1) << 40))
+            {
+                double scale = elapsed > 0 ? std::min(target / elapsed * 1.2, 10.0) : 10.0;
+                iterations = std::max<uint64_t>(iterations + 1, static_cast<uint64_t>(iterations * scale));
+                elapsed = time(iterations);
+            }
+
+            std::vector<double> samples;
+            for (int i = 0; i < std::max(m_options.repetitions, 1); ++i)
+                samples.push_back(time(iterations) / iterations);
+            std::sort(samples.begin(), samples.end());
+
+            Result result;
+            result.name = name;
+            result.params = params;
+            result.iterations = iterations;
+            result.medianNs = samples[samples.size() / 2];
+            result.minNs = samples.front();
+            result.maxNs = samples.back();
+            result.bytesPerOp = bytesPerOp;
+            Print(result);
+            m_results.push_back(std::move(result));
+        }
+
+        const std::vector<Result> &Results() const
+        {
+            return m_results;
+        }
+
+        /**
+         * @brief Write the results as JSON lines
+         * @return False if path can't be written
+         */
+        bool WriteJsonLines(const std::string &path) const
+        {
+            std::ofstream file(path, std::ios::trunc);
+            if (!file.is_open())
+                return false;
+            for (const Result &result : m_results)
+            {
+                file << fmt::format("{{\"name\":\"{}\"", result.name);
+                for (const auto &[key, value] : result.params)
+                    file << fmt::format(",\"{}\":\"{}\"", key, value);
+                file << fmt::format(",\"iterations\":{},\"median_ns\":{:.2f},\"min_ns\":{:.2f},\"max_ns\":{:.2f},\"bytes_per_op\":{:.0f},\"mb_per_s\":{:.2f}}}",
+                                    result.iterations, result.medianNs, result.minNs, result.maxNs, result.bytesPerOp, Throughput(result))
+                     << "\n";
+            }
+            return file.good();
+        }
+
+    private:
+        static std::string Label(const std::string &name, const Params &params)
+        {
+            std::string label = name;
+            for (const auto &[key, value] : params)
+                label += " " + key + "=" + value;
+            return label;
+        }
+
+        static double Throughput(const Result &result)
+        {
+            return result.medianNs > 0 ? result.bytesPerOp / result.medianNs * 1e3 : 0.0;
+        }
+
+        static void Print(const Result &result)
+        {
+            std::string line = fmt::format("{:<60} {:>14.1f} ns/op", Label(result.name, result.params), result.medianNs);
+            if (result.bytesPerOp > 0)
+                line += fmt::format(" {:>10.1f} MB/s", Throughput(result));
+            fmt::print("{}\n", line);
+        }
+
+    private:
+        Options m_options;
+        std::vector<Result> m_results;
+    };
+
+    // Suites, one per area of the data path
+    void ModelBenchmarks(Runner &runner, const Sweep &sweep);
+    void WindowBenchmarks(Runner &runner, const Sweep &sweep);
+    void ChunkBenchmarks(Runner &runner, const Sweep &sweep);
+    void NameBenchmarks(Runner &runner, const Sweep &sweep);
+    void SolverBenchmarks(Runner &runner, const Sweep &sweep);
+} // namespace Bench
+
+#endif // INA_BENCH_HPP
@@ -0,0 +1,117 @@
+#include "bench.hpp"
+#include "../../aggapps/controller/controller.hpp"
+#include "../../mmproducer/InputGenerator.hpp"
+#include <ndn-cxx/data.hpp>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+namespace
+{
+    // Segment size of the chunk apps (Aggregator::Options::maxSegmentSize)
+    constexpr size_t CHUNK_SEGMENT_SIZE = 4096;
+
+    // Chunks in the input file of the InputGenerator case
+    constexpr size_t INPUT_CHUNKS = 16;
+
+    std::filesystem::path writeConfig(const std::string &fileName, const std::string &contents)
+    {
+        std::filesystem::path path = std::filesystem::temp_directory_path() / fileName;
+        std::ofstream file(path, std::ios::trunc);
+        file << contents;
+        return path;
+    }
+
+    /**
+     * @brief One chunk of a child, chunkBytes split into CHUNK_SEGMENT_SIZE segments of random bytes
+     */
+    ndn::chunks::DataChunk makeChunk(const std::string &node, size_t chunkBytes, std::mt19937 &generator)
+    {
+        std::uniform_int_distribution<int> byte(0, 255);
+        ndn::chunks::DataChunk chunk;
+        uint64_t segment = 0;
+        for (size_t offset = 0; offset < chunkBytes; offset += CHUNK_SEGMENT_SIZE, ++segment)
+        {
+            std::vector<uint8_t> content(std::min(CHUNK_SEGMENT_SIZE, chunkBytes - offset));
+            for (uint8_t &value : content)
+                value = static_cast<uint8_t>(byte(generator));
+            auto data = std::make_shared<ndn::Data>(ndn::Name("/" + node + "/chunk").appendSegment(segment));
+            data->setContent(ndn::make_span(content.data(), content.size()));
+            chunk[segment] = data;
+        }
+        return chunk;
+    }
+}
+
+namespace Bench
+{
+    void ChunkBenchmarks(Runner &runner, const Sweep &sweep)
+    {
+        std::mt19937 generator(11);
+        std::filesystem::path controllerConfig = writeConfig("ina-bench-controller.ini", "[General]\ntable-size = 10\nmax-buffered-chunks = 100\n");
+
+        // A chunk holds a model of size float64 parameters, as the chunk apps ship it
+        for (size_t size : sweep.sizes)
+        {
+            size_t chunkBytes = size * sizeof(double);
+
+            // FlowController::averageDataObjects, reached through addChunk() once every child has delivered a chunk
+            for (size_t fanIn : sweep.fanIns)
+            {
+                Params params{{"size", std::to_string(size)}, {"fanin", std::to_string(fanIn)}};
+                if (!runner.Selected("chunk/flow_controller_average", params))
+                    continue;
+
+                std::vector<std::string> nodes;
+                std::vector<ndn::chunks::DataChunk> chunks;
+                for (size_t child = 0; child < fanIn; ++child)
+                {
+                    nodes.push_back("agg" + std::to_string(child));
+                    chunks.push_back(makeChunk(nodes.back(), chunkBytes, generator));
+                }
+                ndn::chunks::FlowController controller(controllerConfig.string(), nodes);
+                uint64_t chunkNumber = 0;
+                runner.Run("chunk/flow_controller_average", params, static_cast<double>(chunkBytes * fanIn), [&](uint64_t n)
+                           {
+                               for (uint64_t i = 0; i < n; ++i)
+                               {
+                                   ++chunkNumber;
+                                   for (size_t child = 0; child < fanIn; ++child)
+                                       controller.addChunk(nodes[child], chunkNumber, chunks[child]);
+                                   if (!controller.isChunkProcessed(chunkNumber))
+                                       std::abort();
+                                   controller.removeProcessedChunk(chunkNumber);
+                               } });
+            }
+
+            // InputGenerator::getChunk, opening a chunk of the producer's input file and reading it through
+            Params params{{"size", std::to_string(size)}};
+            if (!runner.Selected("chunk/input_generator", params))
+                continue;
+            std::filesystem::path inputConfig = writeConfig("ina-bench-input.ini", "[General]\nchunk-size = " + std::to_string(chunkBytes) + "\n");
+            std::filesystem::path inputFile = std::filesystem::temp_directory_path() / "ina-bench-input.bin";
+            {
+                std::ofstream file(inputFile, std::ios::binary | std::ios::trunc);
+                std::vector<char> bytes(chunkBytes * INPUT_CHUNKS);
+                for (char &value : bytes)
+                    value = static_cast<char>(generator());
+                file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+            }
+            InputGenerator input(inputConfig.string(), inputFile.string());
+            size_t totalChunks = input.readFile();
+            std::vector<char> buffer(chunkBytes);
+            uint64_t next = 0;
+            runner.Run("chunk/input_generator", params, static_cast<double>(chunkBytes), [&](uint64_t n)
+                       {
+                           for (uint64_t i = 0; i < n; ++i)
+                           {
+                               std::unique_ptr<std::istream> stream = input.getChunk(next++ % totalChunks);
+                               stream->read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                               DoNotOptimize(buffer.data());
+                           } });
+            std::filesystem::remove(inputConfig);
+            std::filesystem::remove(inputFile);
+        }
+        std::filesystem::remove(controllerConfig);
+    }
+} // namespace Bench
@@ -0,0 +1,124 @@
+/**
+ * Microbenchmarks of the INA data path, no NFD needed
+ *
+ * Usage: ina-bench [--filter text] [--out results.jsonl] [--min-time ms] [--repetitions n]
+ *                  [--sizes 150,875,...] [--fanins 2,4,...] [--isa scalar|sse2|avx2|avx512]
+ *                  [--producers 100,1000,...] [--clusters 4,32,...]
+ *
+ * Sizes are parameters per packet (or per chunk for the chunk apps), fan-ins the number of children aggregated.
+ * Producers and clusters size the min-cost flow instances of the balanced clustering, one per pair.
+ */
+#include "bench.hpp"
+#include "../kernels/reduce.hpp"
+#include <spdlog/spdlog.h>
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+
+namespace
+{
+    std::vector<size_t> parseList(const std::string &text)
+    {
+        std::vector<size_t> values;
+        std::istringstream stream(text);
+        std::string item;
+        while (std::getline(stream, item, ','))
+        {
+            if (!item.empty())
+                values.push_back(std::stoul(item));
+        }
+        return values;
+    }
+
+    bool parseIsa(const std::string &name, Reduce::Isa &isa)
+    {
+        if (name == "scalar")
+            isa = Reduce::Isa::Scalar;
+        else if (name == "sse2")
+            isa = Reduce::Isa::SSE2;
+        else if (name == "avx2")
+            isa = Reduce::Isa::AVX2;
+        else if (name == "avx512")
+            isa = Reduce::Isa::AVX512;
+        else
+            return false;
+        return true;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    Bench::Runner::Options options;
+    Bench::Sweep sweep;
+    std::string output = "ina-bench.jsonl";
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::string value = argv[++i];
+        try
+        {
+            if (arg == "--filter")
+                options.filter = value;
+            else if (arg == "--out")
+                output = value;
+            else if (arg == "--min-time")
+                options.minTime = std::chrono::milliseconds(std::stol(value));
+            else if (arg == "--repetitions")
+                options.repetitions = std::stoi(value);
+            else if (arg == "--sizes")
+                sweep.sizes = parseList(value);
+            else if (arg == "--fanins")
+                sweep.fanIns = parseList(value);
+            else if (arg == "--producers")
+                sweep.producers = parseList(value);
+            else if (arg == "--clusters")
+                sweep.clusters = parseList(value);
+            else if (arg == "--isa")
+            {
+                Reduce::Isa isa;
+                if (!parseIsa(value, isa) || !Reduce::useIsa(isa))
+                {
+                    std::cerr << "Instruction set " << value << " isn't supported here" << std::endl;
+                    return EXIT_FAILURE;
+                }
+            }
+            else
+            {
+                std::cerr << "Usage: " << argv[0] << " [--filter text] [--out results.jsonl] [--min-time ms] [--repetitions n]"
+                          << " [--sizes 150,875,...] [--fanins 2,4,...] [--isa scalar|sse2|avx2|avx512]"
+                          << " [--producers 100,1000,...] [--clusters 4,32,...]" << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        catch (const std::exception &)
+        {
+            std::cerr << "Invalid value " << value << " for " << arg << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // The schemas built for every size would log otherwise
+    spdlog::set_level(spdlog::level::warn);
+    std::cout << "Reduction kernels: " << Reduce::isaName(Reduce::activeIsa()) << std::endl;
+
+    Bench::Runner runner(options);
+    Bench::ModelBenchmarks(runner, sweep);
+    Bench::WindowBenchmarks(runner, sweep);
+    Bench::ChunkBenchmarks(runner, sweep);
+    Bench::NameBenchmarks(runner, sweep);
+    Bench::SolverBenchmarks(runner, sweep);
+
+    if (!runner.WriteJsonLines(output))
+    {
+        std::cerr << "Failed to write " << output << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << runner.Results().size() << " results written to " << output << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,126 @@
+#include "bench.hpp"
+#include "../ModelData.hpp"
+#include "../aggregation_table.hpp"
+#include <spdlog/spdlog.h>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+namespace
+{
+    const char *const ENCODINGS[] = {"fp64", "fp16", "bf16", "int8", "topk"};
+
+    /**
+     * @brief Schema of a single float64 tensor of parameterCount elements, sent as one segment
+     */
+    ModelSchema makeSchema(size_t parameterCount, const std::string &encoding)
+    {
+        std::filesystem::path path = std::filesystem::temp_directory_path() / "ina-bench-schema.ini";
+        {
+            std::ofstream file(path, std::ios::trunc);
+            file << "[General]\n"
+                 << "DataSize = " << parameterCount << "\n"
+                 << "SegmentSize = " << parameterCount << "\n"
+                 << "Encoding = " << encoding << "\n"
+                 << "TopKRatio = 0.1\n";
+        }
+        ModelSchema schema = ModelSchema::fromConfig(path.string());
+        std::filesystem::remove(path);
+        return schema;
+    }
+
+    ModelData makeModel(const ModelSchema &schema, std::mt19937 &generator)
+    {
+        std::normal_distribution<double> distribution(0.0, 1.0);
+        ModelData model(schema);
+        for (double &parameter : model.parameters)
+            parameter = distribution(generator);
+        model.contributors = 1;
+        model.qsf = 3.0;
+        model.congestedNodes = {"agg0", "agg1"};
+        return model;
+    }
+}
+
+namespace Bench
+{
+    void ModelBenchmarks(Runner &runner, const Sweep &sweep)
+    {
+        std::mt19937 generator(42);
+        for (const char *encoding : ENCODINGS)
+        {
+            for (size_t size : sweep.sizes)
+            {
+                Params params{{"encoding", encoding}, {"size", std::to_string(size)}};
+                ModelSchema schema = makeSchema(size, encoding);
+                ModelData model = makeModel(schema, generator);
+                std::vector<uint8_t> buffer;
+                serializeModelData(model, buffer);
+                double wireBytes = static_cast<double>(buffer.size());
+
+                runner.Run("codec/serialize", params, wireBytes, [&](uint64_t n)
+                           {
+                               for (uint64_t i = 0; i < n; ++i)
+                               {
+                                   serializeModelData(model, buffer);
+                                   DoNotOptimize(buffer.data());
+                               } });
+
+                ModelData decoded(schema);
+                runner.Run("codec/deserialize", params, wireBytes, [&](uint64_t n)
+                           {
+                               for (uint64_t i = 0; i < n; ++i)
+                               {
+                                   bool ok = deserializeModelData(buffer, decoded);
+                                   DoNotOptimize(ok);
+                                   DoNotOptimize(decoded.parameters.data());
+                               } });
+
+                runner.Run("codec/deserialize_view", params, wireBytes, [&](uint64_t n)
+                           {
+                               ModelDataView view;
+                               for (uint64_t i = 0; i < n; ++i)
+                               {
+                                   bool ok = deserializeModelData(buffer.data(), buffer.size(), size, view);
+                                   DoNotOptimize(ok);
+                                   DoNotOptimize(view.payload);
+                               } });
+
+                // Aggregator::Aggregate on a Data's content, as OnData runs it for every child of an iteration
+                for (size_t fanIn : sweep.fanIns)
+                {
+                    Params aggParams{{"encoding", encoding}, {"size", std::to_string(size)}, {"fanin", std::to_string(fanIn)}};
+                    if (!runner.Selected("aggregate/view", aggParams))
+                        continue;
+
+                    std::vector<std::vector<uint8_t>> payloads(fanIn);
+                    for (std::vector<uint8_t> &payload : payloads)
+                        serializeModelData(makeModel(schema, generator), payload);
+
+                    AggregationTable table;
+                    table.Reset(4, size, fanIn);
+                    uint32_t seq = 0;
+                    runner.Run("aggregate/view", aggParams, wireBytes * fanIn, [&](uint64_t n)
+                               {
+                                   for (uint64_t i = 0; i < n; ++i)
+                                   {
+                                       AggregationTable::Slot *slot = table.Acquire(++seq);
+                                       for (size_t child = 0; child < fanIn; ++child)
+                                       {
+                                           ModelDataView view;
+                                           if (!deserializeModelData(payloads[child].data(), payloads[child].size(), size, view) || !slot->MarkArrived(child))
+                                               std::abort();
+                                           slot->contributors += view.contributors;
+                                           aggregateModelData(*slot, view);
+                                           table.MarkHasData(*slot);
+                                       }
+                                       DoNotOptimize(slot->sum.data());
+                                       if (!table.IsComplete(*slot))
+                                           std::abort();
+                                       table.Release(*slot);
+                                   } });
+                }
+            }
+        }
+    }
+} // namespace Bench
@@ -0,0 +1,98 @@
+#include "bench.hpp"
+#include "../flow_table.hpp"
+#include "../ModelData.hpp"
+#include <ndn-cxx/interest.hpp>
+#include <ndn-cxx/data.hpp>
+#include <ndn-cxx/encoding/buffer.hpp>
+
+namespace
+{
+    /**
+     * @brief Flows of an aggregator with fanIn children, named and prefixed the way InterestGenerator() does
+     */
+    void internFlows(FlowTable &flows, size_t fanIn)
+    {
+        for (size_t child = 0; child < fanIn; ++child)
+        {
+            std::string name = "pro" + std::to_string(child);
+            FlowId flow = flows.Intern(name);
+            flows[flow].nameSec0_2 = "/" + name + "/pro" + std::to_string(child) + ".pro" + std::to_string(child + fanIn) + "/data";
+        }
+    }
+}
+
+namespace Bench
+{
+    void NameBenchmarks(Runner &runner, const Sweep &sweep)
+    {
+        for (size_t fanIn : sweep.fanIns)
+        {
+            FlowTable flows;
+            internFlows(flows, fanIn);
+
+            // SendInterest(): name of the next seq, flow lookup and the Interest the face encodes
+            Params params{{"fanin", std::to_string(fanIn)}};
+            uint32_t seq = 0;
+            runner.Run("name/send_interest", params, 0, [&](uint64_t n)
+                       {
+                           for (uint64_t i = 0; i < n; ++i)
+                           {
+                               ++seq;
+                               auto newName = std::make_shared<ndn::Name>(flows[seq % fanIn].nameSec0_2);
+                               newName->appendSequenceNumber(seq);
+                               std::string nameWithSeq = newName->toUri();
+                               FlowId flow = flows.Find(*newName);
+                               uint64_t key = (uint64_t(flow) << 32) | newName->get(-1).toSequenceNumber();
+                               ndn::Interest interest;
+                               interest.setNonce(seq);
+                               interest.setCanBePrefix(false);
+                               interest.setName(*newName);
+                               interest.setInterestLifetime(ndn::time::milliseconds(2000));
+                               DoNotOptimize(interest.wireEncode().size());
+                               DoNotOptimize(nameWithSeq.size());
+                               DoNotOptimize(key);
+                           } });
+
+            // OnData(): decoding the packet, then the name parsing and flow lookup done before aggregation
+            for (size_t size : sweep.sizes)
+            {
+                // Content is a segment, never larger than a packet's payload budget
+                size_t contentBytes = size * sizeof(double);
+                if (contentBytes > SEGMENT_PAYLOAD_BUDGET)
+                    continue;
+                Params dataParams{{"size", std::to_string(size)}, {"fanin", std::to_string(fanIn)}};
+                if (!runner.Selected("name/on_data", dataParams))
+                    continue;
+
+                std::vector<ndn::Block> wires;
+                for (size_t child = 0; child < fanIn; ++child)
+                {
+                    ndn::Name name(flows[child].nameSec0_2);
+                    name.appendSequenceNumber(child + 1);
+                    ndn::Data data(name);
+                    std::vector<uint8_t> content(contentBytes, static_cast<uint8_t>(child));
+                    data.setContent(ndn::make_span(content.data(), content.size()));
+                    data.setSignatureInfo(ndn::SignatureInfo(ndn::tlv::DigestSha256));
+                    data.setSignatureValue(std::make_shared<ndn::Buffer>(32));
+                    wires.push_back(data.wireEncode());
+                }
+                uint64_t next = 0;
+                runner.Run("name/on_data", dataParams, static_cast<double>(wires[0].size()), [&](uint64_t n)
+                           {
+                               for (uint64_t i = 0; i < n; ++i)
+                               {
+                                   ndn::Data data(wires[next++ % fanIn]);
+                                   int dataSize = data.wireEncode().size();
+                                   std::string dataName = data.getName().toUri();
+                                   uint32_t dataSeq = data.getName().at(-1).toSequenceNumber();
+                                   std::string type = data.getName().get(-2).toUri();
+                                   FlowId flow = flows.Find(data.getName());
+                                   if (flow == INVALID_FLOW || type != "data")
+                                       std::abort();
+                                   DoNotOptimize(data.getContent().value());
+                                   DoNotOptimize(dataSize + dataSeq + dataName.size());
+                               } });
+            }
+        }
+    }
+} // namespace Bench
@@ -0,0 +1,107 @@
+#include "bench.hpp"
+#include "../algorithm/include/min_cost_flow_solver.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <random>
+
+namespace
+{
+    using Costs = std::vector<std::vector<double>>;
+
+    const std::pair<MinCostFlowSolver::Backend, const char *> BACKENDS[] = {
+        {MinCostFlowSolver::kNetworkSimplex, "network_simplex"},
+        {MinCostFlowSolver::kSuccessiveShortestPath, "successive_shortest_path"},
+    };
+
+    /**
+     * @brief Costs of a RegularizedKMeans iteration: producers and cluster centres scattered on a plane, the cost
+     * being their rounded distance, integral like the averaged link costs
+     */
+    Costs makeCosts(size_t producers, size_t clusters, std::mt19937 &generator)
+    {
+        std::uniform_real_distribution<double> coordinate(0.0, 1000.0);
+        std::vector<std::pair<double, double>> centres(clusters);
+        for (auto &centre : centres)
+            centre = {coordinate(generator), coordinate(generator)};
+        Costs costs(producers, std::vector<double>(clusters));
+        for (auto &row : costs)
+        {
+            double x = coordinate(generator), y = coordinate(generator);
+            for (size_t j = 0; j < clusters; ++j)
+                row[j] = std::round(std::hypot(x - centres[j].first, y - centres[j].second));
+        }
+        return costs;
+    }
+
+    void buildHard(MinCostFlowSolver &solver, const Costs &costs)
+    {
+        int n = static_cast<int>(costs.size()), k = static_cast<int>(costs.front().size());
+        solver.BuildHard(costs, k, n / k, (n + k - 1) / k);
+    }
+}
+
+namespace Bench
+{
+    void SolverBenchmarks(Runner &runner, const Sweep &sweep)
+    {
+        std::mt19937 generator(17);
+        for (size_t producers : sweep.producers)
+        {
+            for (size_t clusters : sweep.clusters)
+            {
+                if (clusters < 2 || clusters >= producers)
+                    continue;
+                Costs costs = makeCosts(producers, clusters, generator);
+                // The costs of the next iteration, every centre moved a little as UpdateClusterCenter() does
+                Costs nextCosts = costs;
+                std::uniform_int_distribution<int> shift(-20, 20);
+                for (size_t j = 0; j < clusters; ++j)
+                {
+                    int delta = shift(generator);
+                    for (auto &row : nextCosts)
+                        row[j] = std::max(0.0, row[j] + delta);
+                }
+
+                double expected = -1.0;
+                for (const auto &[backend, backendName] : BACKENDS)
+                {
+                    std::string name = std::string("solver/") + backendName;
+                    Params params{{"producers", std::to_string(producers)}, {"clusters", std::to_string(clusters)}};
+                    if (!runner.Selected(name, params) && !runner.Selected(name + "_warm", params))
+                        continue;
+
+                    // Both backends must find the same optimum, the memory is what a solved instance holds
+                    std::unique_ptr<MinCostFlowSolver> solver = MinCostFlowSolver::Create(backend);
+                    buildHard(*solver, costs);
+                    solver->Solve();
+                    if (expected >= 0 && std::abs(solver->min_cost() - expected) > 1e-6)
+                        std::abort();
+                    expected = solver->min_cost();
+                    params.emplace_back("memory_kb", std::to_string(solver->memory_bytes() / 1024));
+
+                    // RegularizedKMeans without warm start: build the graph and solve it from scratch
+                    runner.Run(name, params, 0, [&](uint64_t n)
+                               {
+                                   for (uint64_t i = 0; i < n; ++i)
+                                   {
+                                       std::unique_ptr<MinCostFlowSolver> cold = MinCostFlowSolver::Create(backend);
+                                       buildHard(*cold, costs);
+                                       cold->Solve();
+                                       DoNotOptimize(cold->min_cost());
+                                   } });
+
+                    // With warm start: the costs of the next iteration, then back, on the solved graph
+                    uint64_t iteration = 0;
+                    runner.Run(name + "_warm", params, 0, [&](uint64_t n)
+                               {
+                                   for (uint64_t i = 0; i < n; ++i, ++iteration)
+                                   {
+                                       solver->UpdateCosts(iteration % 2 == 0 ? nextCosts : costs);
+                                       solver->Solve();
+                                       DoNotOptimize(solver->min_cost());
+                                   } });
+                }
+            }
+        }
+    }
+} // namespace Bench
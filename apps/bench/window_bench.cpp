@@ -0,0 +1,58 @@
+#include "bench.hpp"
+#include "../sliding_window.hpp"
+#include "../window_stats.hpp"
+#include "../flow_table.hpp"
+#include <random>
+
+namespace Bench
+{
+    void WindowBenchmarks(Runner &runner, const Sweep &)
+    {
+        // QSF window as the consumer and aggregator feed it, one sample per Data then the average and the rate.
+        // Occupancy is the number of packets inside the 20 ms window, i.e. the arrival rate.
+        for (size_t occupancy : {16, 128, 1000})
+        {
+            Params params{{"occupancy", std::to_string(occupancy)}};
+            SlidingWindow<double> window(std::chrono::milliseconds(20));
+            uint64_t packet = 0;
+            runner.Run("window/sliding_window", params, 0, [&](uint64_t n)
+                       {
+                           for (uint64_t i = 0; i < n; ++i, ++packet)
+                           {
+                               auto arrival = std::chrono::milliseconds(packet * 20 / occupancy);
+                               window.AddPacket(arrival, static_cast<double>(packet % 7));
+                               DoNotOptimize(window.GetAverageQsf());
+                               DoNotOptimize(window.GetDataArrivalRate());
+                           } });
+        }
+
+        // Per RTT sample work of CongestionDetection
+        std::mt19937 generator(7);
+        std::uniform_int_distribution<int64_t> rtt(500, 5000);
+        std::vector<int64_t> samples(4096);
+        for (int64_t &sample : samples)
+            sample = rtt(generator);
+        for (size_t length : {3, 16, 64})
+        {
+            Params params{{"window", std::to_string(length)}};
+            WindowedSum<int64_t, RTT_WINDOW_CAPACITY> windowSum(length);
+            Ewma historical(0.3);
+            WindowedMin<int64_t, RTT_MIN_WINDOW> minimum;
+            QuantileSketch tail(0.95);
+            size_t next = 0;
+            runner.Run("window/rtt_estimators", params, 0, [&](uint64_t n)
+                       {
+                           for (uint64_t i = 0; i < n; ++i)
+                           {
+                               int64_t sample = samples[next++ & 4095];
+                               int64_t evicted;
+                               if (windowSum.Add(sample, &evicted))
+                                   historical.Add(static_cast<double>(evicted));
+                               minimum.Add(sample);
+                               tail.Add(static_cast<double>(sample));
+                               DoNotOptimize(windowSum.Sum());
+                               DoNotOptimize(historical.Value());
+                           } });
+        }
+    }
+} // namespace Bench
@@ -0,0 +1,203 @@
+#ifndef FLOW_TABLE_HPP
+#define FLOW_TABLE_HPP
+
+#include <ndn-cxx/name.hpp>
+#include <ndn-cxx/util/scheduler.hpp>
+#include <vector>
+#include <deque>
+#include <string>
+#include <chrono>
+#include <limits>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include "sliding_window.hpp"
+#include "window_stats.hpp"
+#include "telemetry.hpp"
+
+// Largest General.RTTWindowSize, the RTT window's samples are kept in a fixed ring buffer
+constexpr size_t RTT_WINDOW_CAPACITY = 64;
+
+// RTT samples the per-flow minimum RTT is taken over
+constexpr size_t RTT_MIN_WINDOW = 256;
+
+/**
+ * Small integer handle of a flow (an upstream child), assigned in the order flows are interned
+ */
+using FlowId = uint32_t;
+
+constexpr FlowId INVALID_FLOW = std::numeric_limits<FlowId>::max();
+
+/**
+ * Congestion control, QSF and logging state of one flow
+ */
+struct FlowState
+{
+    std::string name;       // Flow prefix, i.e. the first name segment, e.g. "agg0"
+    std::string nameSec0_2; // First three segments of the interest name, e.g. "/agg0/pro0.pro1/data"
+    int round = 0;          // Index of the (sub-)tree this flow belongs to, consumer only
+
+    // Log files
+    std::string rtoRecorder;
+    std::string responseTimeRecorder;
+    std::string windowRecorder;
+    std::string inFlightRecorder;
+    std::string qsfRecorder;
+    std::string queueRecorder;
+
+    // Telemetry streams the recorders write to, text output goes to the paths above
+    TelemetryStream rtoStream = INVALID_STREAM;
+    TelemetryStream responseTimeStream = INVALID_STREAM;
+    TelemetryStream inFlightStream = INVALID_STREAM;
+    TelemetryStream qsfStream = INVALID_STREAM;
+    TelemetryStream queueStream = INVALID_STREAM;
+
+    // cwnd management
+    double window = 1.0;
+    uint32_t inFlight = 0;
+    double ssthresh = std::numeric_limits<double>::max();
+    std::chrono::milliseconds lastWindowDecreaseTime{0};
+    double cubicWmax = 1.0;
+    double cubicLastWmax = 1.0;
+    uint32_t lastCongestionSeq = 0;
+    int successiveCongestion = 0;
+
+    // RTT/RTO measurement
+    int rttCount = 0;                                      // How many RTT samples this flow has received
+    WindowedSum<int64_t, RTT_WINDOW_CAPACITY> rttWindow;   // Last General.RTTWindowSize samples
+    Ewma rttHistorical;                                    // EWMA of the samples leaving rttWindow
+    WindowedMin<int64_t, RTT_MIN_WINDOW> rttMin;           // Minimum of the last RTT_MIN_WINDOW samples
+    QuantileSketch rttTail{0.95};                          // 95th percentile of every sample
+    int64_t srtt = 0;
+    int64_t rttvar = 0;
+    int roundRTT = 0;
+    bool initRTO = false;
+    std::chrono::milliseconds rtoThreshold{0};
+    int numTimeout = 0;
+    int silentRounds = 0; // Timeout check rounds in a row that expired an interest of this flow with no Data in between
+
+    // QSF
+    bool firstData = true;
+    SlidingWindow<double> qsfSlidingWindow;
+    ndn::scheduler::EventId rateEvent;
+    double rateLimit = 0.0;       // Unit: pkgs/us
+    double estimatedBW = 0.0;     // Unit: pkgs/us
+    int64_t rttEstimationQsf = 0; // Unit: us
+
+    std::deque<uint32_t> interestQueue; // Iterations waiting to be requested from this flow
+    uint32_t seq = 0;                   // Latest iteration requested from this flow
+};
+
+/**
+ * Interns flow names into dense FlowIds and stores the per-flow state contiguously
+ *
+ * Flows are interned once when the aggregation tree is set up, afterwards a packet's flow is resolved with a
+ * single lookup and every per-flow field is reached by index. Interning may reallocate the state array, so
+ * don't keep references to a FlowState across Intern() calls.
+ */
+class FlowTable
+{
+public:
+    /**
+     * @brief Id of flow name, a new flow is added if it's not interned yet
+     */
+    FlowId Intern(const std::string &name)
+    {
+        auto it = m_ids.find(name);
+        if (it != m_ids.end())
+            return it->second;
+
+        FlowId id = static_cast<FlowId>(m_flows.size());
+        m_flows.emplace_back();
+        m_flows.back().name = name;
+        m_ids.emplace(name, id);
+        return id;
+    }
+
+    /**
+     * @brief Id of flow name
+     * @return INVALID_FLOW if the flow isn't interned
+     */
+    FlowId Find(const std::string &name) const
+    {
+        auto it = m_ids.find(name);
+        return it != m_ids.end() ? it->second : INVALID_FLOW;
+    }
+
+    /**
+     * @brief Id of the flow a packet belongs to, i.e. of its first name component
+     * @return INVALID_FLOW if the flow isn't interned
+     */
+    FlowId Find(const ndn::Name &name) const
+    {
+        const ndn::name::Component &component = name.get(0);
+        return Find(std::string(reinterpret_cast<const char *>(component.value()), component.value_size()));
+    }
+
+    /**
+     * @brief Hand flow id over to another child, e.g. the aggregator replacing a failed one
+     *
+     * The flow keeps its id, so the timers, pending interests and aggregation table bits keyed by it stay valid. The
+     * old name is retired, packets of the old child still in flight can be told apart with Retired().
+     * @return False if name already has a flow
+     */
+    bool Rename(FlowId id, const std::string &name)
+    {
+        if (m_ids.count(name) != 0)
+            return false;
+        m_ids.erase(m_flows[id].name);
+        m_retired.insert(m_flows[id].name);
+        m_retired.erase(name);
+        m_flows[id].name = name;
+        m_ids.emplace(name, id);
+        return true;
+    }
+
+    /**
+     * @brief Whether a packet comes from a child whose flow was renamed away from it
+     */
+    bool Retired(const ndn::Name &name) const
+    {
+        const ndn::name::Component &component = name.get(0);
+        return m_retired.count(std::string(reinterpret_cast<const char *>(component.value()), component.value_size())) != 0;
+    }
+
+    FlowState &operator[](FlowId id)
+    {
+        return m_flows[id];
+    }
+
+    const FlowState &operator[](FlowId id) const
+    {
+        return m_flows[id];
+    }
+
+    const std::string &Name(FlowId id) const
+    {
+        return m_flows[id].name;
+    }
+
+    size_t Size() const
+    {
+        return m_flows.size();
+    }
+
+    std::vector<FlowState>::iterator begin() { return m_flows.begin(); }
+    std::vector<FlowState>::iterator end() { return m_flows.end(); }
+    std::vector<FlowState>::const_iterator begin() const { return m_flows.begin(); }
+    std::vector<FlowState>::const_iterator end() const { return m_flows.end(); }
+
+    void Clear()
+    {
+        m_flows.clear();
+        m_ids.clear();
+        m_retired.clear();
+    }
+
+private:
+    std::vector<FlowState> m_flows;
+    std::unordered_map<std::string, FlowId> m_ids;
+    std::unordered_set<std::string> m_retired;
+};
+
+#endif // FLOW_TABLE_HPP
@@ -0,0 +1,474 @@
+#include "reduce.hpp"
+#include <algorithm>
+#include <atomic>
+#include <spdlog/spdlog.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define REDUCE_X86 1
+#else
+#define REDUCE_X86 0
+#endif
+
+namespace Reduce
+{
+    namespace
+    {
+        namespace scalar
+        {
+            template <typename T>
+            void sum(T *dst, const T *src, size_t n)
+            {
+                for (size_t i = 0; i < n; ++i)
+                    dst[i] += src[i];
+            }
+
+            template <typename T>
+            void scaledSum(T *dst, const T *src, T scale, size_t n)
+            {
+                for (size_t i = 0; i < n; ++i)
+                    dst[i] += scale * src[i];
+            }
+
+            template <typename T>
+            void sumN(T *dst, const T *const *srcs, size_t count, size_t n)
+            {
+                for (size_t i = 0; i < n; ++i)
+                {
+                    T acc = dst[i];
+                    for (size_t k = 0; k < count; ++k)
+                        acc += srcs[k][i];
+                    dst[i] = acc;
+                }
+            }
+
+            template <typename T>
+            void mean(T *dst, const T *const *srcs, size_t count, size_t n)
+            {
+                for (size_t i = 0; i < n; ++i)
+                {
+                    T acc = 0;
+                    for (size_t k = 0; k < count; ++k)
+                        acc += srcs[k][i];
+                    dst[i] = acc / static_cast<T>(count);
+                }
+            }
+
+            void meanBytes(uint8_t *dst, const uint8_t *const *srcs, size_t count, size_t n)
+            {
+                for (size_t i = 0; i < n; ++i)
+                {
+                    uint64_t acc = 0;
+                    for (size_t k = 0; k < count; ++k)
+                        acc += srcs[k][i];
+                    dst[i] = static_cast<uint8_t>(acc / count);
+                }
+            }
+        } // namespace scalar
+
+#if REDUCE_X86
+        /**
+         * The kernel bodies are identical for every instruction set, only the vector width and the
+         * load/store/add/mul/div/set1 overloads of the enclosing namespace differ. Each expansion is
+         * compiled with its own target attribute so the translation unit itself needs no -m flags.
+         */
+#define REDUCE_DEFINE_KERNELS(TARGET, WIDTH)                                                 \
+    template <typename T>                                                                    \
+    TARGET void sum(T *dst, const T *src, size_t n)                                          \
+    {                                                                                        \
+        constexpr size_t lanes = WIDTH / sizeof(T);                                          \
+        size_t i = 0;                                                                        \
+        for (; i + lanes <= n; i += lanes)                                                   \
+            store(dst + i, add(load(dst + i), load(src + i)));                               \
+        scalar::sum(dst + i, src + i, n - i);                                                \
+    }                                                                                        \
+                                                                                             \
+    template <typename T>                                                                    \
+    TARGET void scaledSum(T *dst, const T *src, T scale, size_t n)                           \
+    {                                                                                        \
+        constexpr size_t lanes = WIDTH / sizeof(T);                                          \
+        const auto factor = set1(scale);                                                     \
+        size_t i = 0;                                                                        \
+        for (; i + lanes <= n; i += lanes)                                                   \
+            store(dst + i, add(load(dst + i), mul(factor, load(src + i))));                  \
+        scalar::scaledSum(dst + i, src + i, scale, n - i);                                   \
+    }                                                                                        \
+                                                                                             \
+    template <typename T>                                                                    \
+    TARGET void sumN(T *dst, const T *const *srcs, size_t count, size_t n)                   \
+    {                                                                                        \
+        constexpr size_t lanes = WIDTH / sizeof(T);                                          \
+        size_t i = 0;                                                                        \
+        for (; i + lanes <= n; i += lanes)                                                   \
+        {                                                                                    \
+            auto acc = load(dst + i);                                                        \
+            for (size_t k = 0; k < count; ++k)                                               \
+                acc = add(acc, load(srcs[k] + i));                                           \
+            store(dst + i, acc);                                                             \
+        }                                                                                    \
+        for (; i < n; ++i)                                                                   \
+            for (size_t k = 0; k < count; ++k)                                               \
+                dst[i] += srcs[k][i];                                                        \
+    }                                                                                        \
+                                                                                             \
+    template <typename T>                                                                    \
+    TARGET void mean(T *dst, const T *const *srcs, size_t count, size_t n)                   \
+    {                                                                                        \
+        constexpr size_t lanes = WIDTH / sizeof(T);                                          \
+        const auto divisor = set1(static_cast<T>(count));                                    \
+        size_t i = 0;                                                                        \
+        for (; i + lanes <= n; i += lanes)                                                   \
+        {                                                                                    \
+            auto acc = set1(static_cast<T>(0));                                              \
+            for (size_t k = 0; k < count; ++k)                                               \
+                acc = add(acc, load(srcs[k] + i));                                           \
+            store(dst + i, div(acc, divisor));                                               \
+        }                                                                                    \
+        for (; i < n; ++i)                                                                   \
+        {                                                                                    \
+            T acc = 0;                                                                       \
+            for (size_t k = 0; k < count; ++k)                                               \
+                acc += srcs[k][i];                                                           \
+            dst[i] = acc / static_cast<T>(count);                                            \
+        }                                                                                    \
+    }
+
+        // The float byte mean is exact as long as count * 255 fits the 24-bit mantissa and the quotient
+        // can't round up to the next integer, both hold well beyond any realistic fan-in.
+        constexpr size_t MAX_SIMD_BYTE_MEAN_COUNT = 65536;
+
+        namespace sse2
+        {
+#define REDUCE_SSE2 __attribute__((target("sse2")))
+            REDUCE_SSE2 inline __m128d load(const double *p) { return _mm_loadu_pd(p); }
+            REDUCE_SSE2 inline __m128 load(const float *p) { return _mm_loadu_ps(p); }
+            REDUCE_SSE2 inline __m128i load(const int32_t *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+            REDUCE_SSE2 inline void store(double *p, __m128d v) { _mm_storeu_pd(p, v); }
+            REDUCE_SSE2 inline void store(float *p, __m128 v) { _mm_storeu_ps(p, v); }
+            REDUCE_SSE2 inline void store(int32_t *p, __m128i v) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v); }
+            REDUCE_SSE2 inline __m128d add(__m128d a, __m128d b) { return _mm_add_pd(a, b); }
+            REDUCE_SSE2 inline __m128 add(__m128 a, __m128 b) { return _mm_add_ps(a, b); }
+            REDUCE_SSE2 inline __m128i add(__m128i a, __m128i b) { return _mm_add_epi32(a, b); }
+            REDUCE_SSE2 inline __m128d mul(__m128d a, __m128d b) { return _mm_mul_pd(a, b); }
+            REDUCE_SSE2 inline __m128 mul(__m128 a, __m128 b) { return _mm_mul_ps(a, b); }
+            // SSE2 has no 32-bit mullo, multiply even and odd lanes separately and interleave the low halves
+            REDUCE_SSE2 inline __m128i mul(__m128i a, __m128i b)
+            {
+                __m128i even = _mm_mul_epu32(a, b);
+                __m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+                return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                          _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+            }
+            REDUCE_SSE2 inline __m128d div(__m128d a, __m128d b) { return _mm_div_pd(a, b); }
+            REDUCE_SSE2 inline __m128 div(__m128 a, __m128 b) { return _mm_div_ps(a, b); }
+            REDUCE_SSE2 inline __m128d set1(double v) { return _mm_set1_pd(v); }
+            REDUCE_SSE2 inline __m128 set1(float v) { return _mm_set1_ps(v); }
+            REDUCE_SSE2 inline __m128i set1(int32_t v) { return _mm_set1_epi32(v); }
+
+            REDUCE_DEFINE_KERNELS(REDUCE_SSE2, 16)
+
+            REDUCE_SSE2 void meanBytes(uint8_t *dst, const uint8_t *const *srcs, size_t count, size_t n)
+            {
+                if (count > MAX_SIMD_BYTE_MEAN_COUNT)
+                    return scalar::meanBytes(dst, srcs, count, n);
+
+                const __m128i zero = _mm_setzero_si128();
+                const __m128 divisor = _mm_set1_ps(static_cast<float>(count));
+                size_t i = 0;
+                for (; i + 16 <= n; i += 16)
+                {
+                    __m128i acc0 = zero, acc1 = zero, acc2 = zero, acc3 = zero;
+                    for (size_t k = 0; k < count; ++k)
+                    {
+                        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(srcs[k] + i));
+                        __m128i lo = _mm_unpacklo_epi8(v, zero);
+                        __m128i hi = _mm_unpackhi_epi8(v, zero);
+                        acc0 = _mm_add_epi32(acc0, _mm_unpacklo_epi16(lo, zero));
+                        acc1 = _mm_add_epi32(acc1, _mm_unpackhi_epi16(lo, zero));
+                        acc2 = _mm_add_epi32(acc2, _mm_unpacklo_epi16(hi, zero));
+                        acc3 = _mm_add_epi32(acc3, _mm_unpackhi_epi16(hi, zero));
+                    }
+                    __m128i q0 = _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(acc0), divisor));
+                    __m128i q1 = _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(acc1), divisor));
+                    __m128i q2 = _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(acc2), divisor));
+                    __m128i q3 = _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(acc3), divisor));
+                    __m128i packed = _mm_packus_epi16(_mm_packs_epi32(q0, q1), _mm_packs_epi32(q2, q3));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), packed);
+                }
+                for (; i < n; ++i)
+                {
+                    uint64_t acc = 0;
+                    for (size_t k = 0; k < count; ++k)
+                        acc += srcs[k][i];
+                    dst[i] = static_cast<uint8_t>(acc / count);
+                }
+            }
+#undef REDUCE_SSE2
+        } // namespace sse2
+
+        namespace avx2
+        {
+#define REDUCE_AVX2 __attribute__((target("avx2")))
+            REDUCE_AVX2 inline __m256d load(const double *p) { return _mm256_loadu_pd(p); }
+            REDUCE_AVX2 inline __m256 load(const float *p) { return _mm256_loadu_ps(p); }
+            REDUCE_AVX2 inline __m256i load(const int32_t *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+            REDUCE_AVX2 inline void store(double *p, __m256d v) { _mm256_storeu_pd(p, v); }
+            REDUCE_AVX2 inline void store(float *p, __m256 v) { _mm256_storeu_ps(p, v); }
+            REDUCE_AVX2 inline void store(int32_t *p, __m256i v) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+            REDUCE_AVX2 inline __m256d add(__m256d a, __m256d b) { return _mm256_add_pd(a, b); }
+            REDUCE_AVX2 inline __m256 add(__m256 a, __m256 b) { return _mm256_add_ps(a, b); }
+            REDUCE_AVX2 inline __m256i add(__m256i a, __m256i b) { return _mm256_add_epi32(a, b); }
+            REDUCE_AVX2 inline __m256d mul(__m256d a, __m256d b) { return _mm256_mul_pd(a, b); }
+            REDUCE_AVX2 inline __m256 mul(__m256 a, __m256 b) { return _mm256_mul_ps(a, b); }
+            REDUCE_AVX2 inline __m256i mul(__m256i a, __m256i b) { return _mm256_mullo_epi32(a, b); }
+            REDUCE_AVX2 inline __m256d div(__m256d a, __m256d b) { return _mm256_div_pd(a, b); }
+            REDUCE_AVX2 inline __m256 div(__m256 a, __m256 b) { return _mm256_div_ps(a, b); }
+            REDUCE_AVX2 inline __m256d set1(double v) { return _mm256_set1_pd(v); }
+            REDUCE_AVX2 inline __m256 set1(float v) { return _mm256_set1_ps(v); }
+            REDUCE_AVX2 inline __m256i set1(int32_t v) { return _mm256_set1_epi32(v); }
+
+            REDUCE_DEFINE_KERNELS(REDUCE_AVX2, 32)
+
+            REDUCE_AVX2 void meanBytes(uint8_t *dst, const uint8_t *const *srcs, size_t count, size_t n)
+            {
+                if (count > MAX_SIMD_BYTE_MEAN_COUNT)
+                    return scalar::meanBytes(dst, srcs, count, n);
+
+                const __m256 divisor = _mm256_set1_ps(static_cast<float>(count));
+                // packs/packus work per 128-bit lane, this puts the four 8-byte groups back in order
+                const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+                size_t i = 0;
+                for (; i + 32 <= n; i += 32)
+                {
+                    __m256i acc[4] = {_mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256()};
+                    for (size_t k = 0; k < count; ++k)
+                    {
+                        for (int j = 0; j < 4; ++j)
+                        {
+                            __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(srcs[k] + i + j * 8));
+                            acc[j] = _mm256_add_epi32(acc[j], _mm256_cvtepu8_epi32(bytes));
+                        }
+                    }
+                    __m256i q[4];
+                    for (int j = 0; j < 4; ++j)
+                        q[j] = _mm256_cvttps_epi32(_mm256_div_ps(_mm256_cvtepi32_ps(acc[j]), divisor));
+                    __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(q[0], q[1]), _mm256_packs_epi32(q[2], q[3]));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_permutevar8x32_epi32(packed, order));
+                }
+                for (; i < n; ++i)
+                {
+                    uint64_t acc = 0;
+                    for (size_t k = 0; k < count; ++k)
+                        acc += srcs[k][i];
+                    dst[i] = static_cast<uint8_t>(acc / count);
+                }
+            }
+#undef REDUCE_AVX2
+        } // namespace avx2
+
+        namespace avx512
+        {
+#define REDUCE_AVX512 __attribute__((target("avx512f")))
+            REDUCE_AVX512 inline __m512d load(const double *p) { return _mm512_loadu_pd(p); }
+            REDUCE_AVX512 inline __m512 load(const float *p) { return _mm512_loadu_ps(p); }
+            REDUCE_AVX512 inline __m512i load(const int32_t *p) { return _mm512_loadu_si512(p); }
+            REDUCE_AVX512 inline void store(double *p, __m512d v) { _mm512_storeu_pd(p, v); }
+            REDUCE_AVX512 inline void store(float *p, __m512 v) { _mm512_storeu_ps(p, v); }
+            REDUCE_AVX512 inline void store(int32_t *p, __m512i v) { _mm512_storeu_si512(p, v); }
+            REDUCE_AVX512 inline __m512d add(__m512d a, __m512d b) { return _mm512_add_pd(a, b); }
+            REDUCE_AVX512 inline __m512 add(__m512 a, __m512 b) { return _mm512_add_ps(a, b); }
+            REDUCE_AVX512 inline __m512i add(__m512i a, __m512i b) { return _mm512_add_epi32(a, b); }
+            REDUCE_AVX512 inline __m512d mul(__m512d a, __m512d b) { return _mm512_mul_pd(a, b); }
+            REDUCE_AVX512 inline __m512 mul(__m512 a, __m512 b) { return _mm512_mul_ps(a, b); }
+            REDUCE_AVX512 inline __m512i mul(__m512i a, __m512i b) { return _mm512_mullo_epi32(a, b); }
+            REDUCE_AVX512 inline __m512d div(__m512d a, __m512d b) { return _mm512_div_pd(a, b); }
+            REDUCE_AVX512 inline __m512 div(__m512 a, __m512 b) { return _mm512_div_ps(a, b); }
+            REDUCE_AVX512 inline __m512d set1(double v) { return _mm512_set1_pd(v); }
+            REDUCE_AVX512 inline __m512 set1(float v) { return _mm512_set1_ps(v); }
+            REDUCE_AVX512 inline __m512i set1(int32_t v) { return _mm512_set1_epi32(v); }
+
+            REDUCE_DEFINE_KERNELS(REDUCE_AVX512, 64)
+#undef REDUCE_AVX512
+        } // namespace avx512
+#undef REDUCE_DEFINE_KERNELS
+#endif // REDUCE_X86
+
+        struct KernelTable
+        {
+            Isa isa;
+            void (*sumF64)(double *, const double *, size_t);
+            void (*sumF32)(float *, const float *, size_t);
+            void (*sumI32)(int32_t *, const int32_t *, size_t);
+            void (*scaledSumF64)(double *, const double *, double, size_t);
+            void (*scaledSumF32)(float *, const float *, float, size_t);
+            void (*scaledSumI32)(int32_t *, const int32_t *, int32_t, size_t);
+            void (*sumNF64)(double *, const double *const *, size_t, size_t);
+            void (*sumNF32)(float *, const float *const *, size_t, size_t);
+            void (*sumNI32)(int32_t *, const int32_t *const *, size_t, size_t);
+            void (*meanF64)(double *, const double *const *, size_t, size_t);
+            void (*meanF32)(float *, const float *const *, size_t, size_t);
+            void (*meanU8)(uint8_t *, const uint8_t *const *, size_t, size_t);
+        };
+
+#define REDUCE_KERNEL_TABLE(ISA, NS, BYTE_MEAN)                                                  \
+    {                                                                                            \
+        ISA,                                                                                     \
+            &NS::sum<double>, &NS::sum<float>, &NS::sum<int32_t>,                                \
+            &NS::scaledSum<double>, &NS::scaledSum<float>, &NS::scaledSum<int32_t>,              \
+            &NS::sumN<double>, &NS::sumN<float>, &NS::sumN<int32_t>,                             \
+            &NS::mean<double>, &NS::mean<float>, &BYTE_MEAN                                      \
+    }
+
+        const KernelTable SCALAR_KERNELS = REDUCE_KERNEL_TABLE(Isa::Scalar, scalar, scalar::meanBytes);
+#if REDUCE_X86
+        const KernelTable SSE2_KERNELS = REDUCE_KERNEL_TABLE(Isa::SSE2, sse2, sse2::meanBytes);
+        const KernelTable AVX2_KERNELS = REDUCE_KERNEL_TABLE(Isa::AVX2, avx2, avx2::meanBytes);
+        // AVX-512F has no byte unpacking, the byte mean stays on AVX2
+        const KernelTable AVX512_KERNELS = REDUCE_KERNEL_TABLE(Isa::AVX512, avx512, avx2::meanBytes);
+#endif
+#undef REDUCE_KERNEL_TABLE
+
+        bool isSupported(Isa isa)
+        {
+#if REDUCE_X86
+            __builtin_cpu_init();
+            switch (isa)
+            {
+            case Isa::Scalar:
+                return true;
+            case Isa::SSE2:
+                return __builtin_cpu_supports("sse2");
+            case Isa::AVX2:
+                return __builtin_cpu_supports("avx2");
+            case Isa::AVX512:
+                return __builtin_cpu_supports("avx512f");
+            }
+            return false;
+#else
+            return isa == Isa::Scalar;
+#endif
+        }
+
+        const KernelTable &tableFor(Isa isa)
+        {
+#if REDUCE_X86
+            switch (isa)
+            {
+            case Isa::AVX512:
+                return AVX512_KERNELS;
+            case Isa::AVX2:
+                return AVX2_KERNELS;
+            case Isa::SSE2:
+                return SSE2_KERNELS;
+            case Isa::Scalar:
+                break;
+            }
+#endif
+            return SCALAR_KERNELS;
+        }
+
+        std::atomic<const KernelTable *> &activeTable()
+        {
+            static std::atomic<const KernelTable *> table = []()
+            {
+                Isa isa = detectIsa();
+                spdlog::info("Reduction kernels using {}", isaName(isa));
+                return &tableFor(isa);
+            }();
+            return table;
+        }
+
+        inline const KernelTable &kernels()
+        {
+            return *activeTable().load(std::memory_order_relaxed);
+        }
+    } // namespace
+
+    Isa detectIsa()
+    {
+        for (Isa isa : {Isa::AVX512, Isa::AVX2, Isa::SSE2})
+        {
+            if (isSupported(isa))
+            {
+                return isa;
+            }
+        }
+        return Isa::Scalar;
+    }
+
+    Isa activeIsa()
+    {
+        return kernels().isa;
+    }
+
+    bool useIsa(Isa isa)
+    {
+        if (!isSupported(isa))
+        {
+            spdlog::warn("Reduction kernels: {} is not supported on this CPU", isaName(isa));
+            return false;
+        }
+        activeTable().store(&tableFor(isa), std::memory_order_relaxed);
+        return true;
+    }
+
+    const char *isaName(Isa isa)
+    {
+        switch (isa)
+        {
+        case Isa::Scalar:
+            return "scalar";
+        case Isa::SSE2:
+            return "SSE2";
+        case Isa::AVX2:
+            return "AVX2";
+        case Isa::AVX512:
+            return "AVX-512";
+        }
+        return "unknown";
+    }
+
+    void sum(double *dst, const double *src, size_t n) { kernels().sumF64(dst, src, n); }
+    void sum(float *dst, const float *src, size_t n) { kernels().sumF32(dst, src, n); }
+    void sum(int32_t *dst, const int32_t *src, size_t n) { kernels().sumI32(dst, src, n); }
+
+    void scaledSum(double *dst, const double *src, double scale, size_t n) { kernels().scaledSumF64(dst, src, scale, n); }
+    void scaledSum(float *dst, const float *src, float scale, size_t n) { kernels().scaledSumF32(dst, src, scale, n); }
+    void scaledSum(int32_t *dst, const int32_t *src, int32_t scale, size_t n) { kernels().scaledSumI32(dst, src, scale, n); }
+
+    void sumN(double *dst, const double *const *srcs, size_t count, size_t n) { kernels().sumNF64(dst, srcs, count, n); }
+    void sumN(float *dst, const float *const *srcs, size_t count, size_t n) { kernels().sumNF32(dst, srcs, count, n); }
+    void sumN(int32_t *dst, const int32_t *const *srcs, size_t count, size_t n) { kernels().sumNI32(dst, srcs, count, n); }
+
+    void mean(double *dst, const double *const *srcs, size_t count, size_t n)
+    {
+        if (count == 0)
+            return;
+        kernels().meanF64(dst, srcs, count, n);
+    }
+
+    void mean(float *dst, const float *const *srcs, size_t count, size_t n)
+    {
+        if (count == 0)
+            return;
+        kernels().meanF32(dst, srcs, count, n);
+    }
+
+    void mean(int32_t *dst, const int32_t *const *srcs, size_t count, size_t n)
+    {
+        if (count == 0)
+            return;
+        // No integer division in SIMD, sum vectorized and truncate afterwards
+        std::fill(dst, dst + n, 0);
+        kernels().sumNI32(dst, srcs, count, n);
+        for (size_t i = 0; i < n; ++i)
+            dst[i] /= static_cast<int32_t>(count);
+    }
+
+    void mean(uint8_t *dst, const uint8_t *const *srcs, size_t count, size_t n)
+    {
+        if (count == 0)
+            return;
+        kernels().meanU8(dst, srcs, count, n);
+    }
+} // namespace Reduce
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Element-wise reduction kernels shared by the INA aggregator/consumer and the chunk FlowControllers.
+ *
+ * Every entry point forwards to the implementation picked for the running CPU (AVX-512, AVX2, SSE2 or
+ * plain scalar), the choice is made once on first use. Pointers must be aligned for their element type,
+ * beyond that the vector loads and stores are unaligned. Destination and sources must not overlap.
+ */
+namespace Reduce
+{
+    enum class Isa
+    {
+        Scalar,
+        SSE2,
+        AVX2,
+        AVX512
+    };
+
+    /**
+     * @brief Best instruction set supported by the running CPU
+     */
+    Isa detectIsa();
+
+    /**
+     * @brief Instruction set the kernels currently dispatch to
+     */
+    Isa activeIsa();
+
+    /**
+     * @brief Force the kernels onto a specific instruction set, e.g. to compare implementations
+     * @return False if the running CPU doesn't support isa, the active set is left unchanged then
+     */
+    bool useIsa(Isa isa);
+
+    const char *isaName(Isa isa);
+
+    /**
+     * @brief dst[i] += src[i]
+     */
+    void sum(double *dst, const double *src, size_t n);
+    void sum(float *dst, const float *src, size_t n);
+    void sum(int32_t *dst, const int32_t *src, size_t n);
+
+    /**
+     * @brief dst[i] += scale * src[i]
+     */
+    void scaledSum(double *dst, const double *src, double scale, size_t n);
+    void scaledSum(float *dst, const float *src, float scale, size_t n);
+    void scaledSum(int32_t *dst, const int32_t *src, int32_t scale, size_t n);
+
+    /**
+     * @brief dst[i] += srcs[0][i] + ... + srcs[count - 1][i], reading every source in a single pass
+     */
+    void sumN(double *dst, const double *const *srcs, size_t count, size_t n);
+    void sumN(float *dst, const float *const *srcs, size_t count, size_t n);
+    void sumN(int32_t *dst, const int32_t *const *srcs, size_t count, size_t n);
+
+    /**
+     * @brief dst[i] = (srcs[0][i] + ... + srcs[count - 1][i]) / count, integer types truncate
+     */
+    void mean(double *dst, const double *const *srcs, size_t count, size_t n);
+    void mean(float *dst, const float *const *srcs, size_t count, size_t n);
+    void mean(int32_t *dst, const int32_t *const *srcs, size_t count, size_t n);
+    void mean(uint8_t *dst, const uint8_t *const *srcs, size_t count, size_t n);
+} // namespace Reduce
@@ -0,0 +1,116 @@
+#include "logging.hpp"
+#include <spdlog/async.h>
+#include <spdlog/sinks/basic_file_sink.h>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/ini_parser.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+
+namespace Log
+{
+    std::atomic<int> g_levels[SUBSYSTEM_COUNT] = {
+        {spdlog::level::info}, {spdlog::level::info}, {spdlog::level::info}, {spdlog::level::info}, {spdlog::level::info}};
+
+    namespace
+    {
+        bool g_overridden[SUBSYSTEM_COUNT] = {}; // Subsystem has a level of its own, e.g. from [Log] in config.ini
+
+        // The spdlog logger itself must let through whatever the most verbose subsystem logs
+        void updateLoggerLevel()
+        {
+            int lowest = spdlog::level::off;
+            for (const std::atomic<int> &level : g_levels)
+                lowest = std::min(lowest, level.load(std::memory_order_relaxed));
+            spdlog::set_level(static_cast<spdlog::level::level_enum>(lowest));
+        }
+    } // namespace
+
+    const char *subsystemName(Subsystem subsystem)
+    {
+        switch (subsystem)
+        {
+        case APP:
+            return "App";
+        case CONSUMER:
+            return "Consumer";
+        case AGGREGATOR:
+            return "Aggregator";
+        case PRODUCER:
+            return "Producer";
+        case PIPELINE:
+            return "Pipeline";
+        default:
+            return "Unknown";
+        }
+    }
+
+    void setLevel(Subsystem subsystem, spdlog::level::level_enum level)
+    {
+        g_levels[subsystem].store(level, std::memory_order_relaxed);
+        g_overridden[subsystem] = true;
+        updateLoggerLevel();
+    }
+
+    void setLevel(spdlog::level::level_enum level)
+    {
+        for (int i = 0; i < SUBSYSTEM_COUNT; ++i)
+        {
+            if (!g_overridden[i])
+                g_levels[i].store(level, std::memory_order_relaxed);
+        }
+        updateLoggerLevel();
+    }
+
+    std::shared_ptr<spdlog::logger> init(const std::string &loggerName, const std::string &filename, const std::string &configFile)
+    {
+        std::string level = "info";
+        std::string flushLevel = "info";
+        bool async = false;
+        size_t queueSize = 8192;
+        std::string subsystemLevels[SUBSYSTEM_COUNT];
+
+        boost::property_tree::ptree pt;
+        try
+        {
+            boost::property_tree::ini_parser::read_ini(configFile, pt);
+            level = pt.get<std::string>("Log.Level", level);
+            flushLevel = pt.get<std::string>("Log.FlushLevel", flushLevel);
+            async = pt.get<bool>("Log.Async", async);
+            queueSize = pt.get<size_t>("Log.QueueSize", queueSize);
+            for (int i = 0; i < SUBSYSTEM_COUNT; ++i)
+                subsystemLevels[i] = pt.get<std::string>(std::string("Log.") + subsystemName(static_cast<Subsystem>(i)), "");
+        }
+        catch (const std::exception &)
+        {
+            // No config (yet), keep the defaults
+        }
+
+        spdlog::drop(loggerName);
+        std::shared_ptr<spdlog::logger> logger;
+        if (async)
+        {
+            // One writer thread per process, shared by every async logger
+            if (!spdlog::thread_pool())
+                spdlog::init_thread_pool(std::max<size_t>(queueSize, 1), 1);
+            logger = spdlog::basic_logger_mt<spdlog::async_factory_nonblock>(loggerName, filename);
+        }
+        else
+        {
+            logger = spdlog::basic_logger_mt(loggerName, filename);
+        }
+        spdlog::set_default_logger(logger);
+
+        std::fill(std::begin(g_overridden), std::end(g_overridden), false);
+        setLevel(spdlog::level::from_str(level));
+        for (int i = 0; i < SUBSYSTEM_COUNT; ++i)
+        {
+            if (!subsystemLevels[i].empty())
+                setLevel(static_cast<Subsystem>(i), spdlog::level::from_str(subsystemLevels[i]));
+        }
+
+        spdlog::flush_on(spdlog::level::from_str(flushLevel));
+        spdlog::flush_every(std::chrono::seconds(1));
+        return logger;
+    }
+} // namespace Log
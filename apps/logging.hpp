@@ -0,0 +1,101 @@
+#ifndef LOGGING_HPP
+#define LOGGING_HPP
+
+#include <spdlog/spdlog.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <cstddef>
+
+/**
+ * Logging facade over spdlog for the packet path
+ *
+ * Per-packet statements go through the LOG_TRACE/LOG_DEBUG/LOG_INFO macros. Statements below LOG_ACTIVE_LEVEL are
+ * compiled out, so their arguments aren't even evaluated, experiment builds raise it with
+ * `make LOG_ACTIVE_LEVEL=SPDLOG_LEVEL_DEBUG`. The remaining ones are filtered at runtime by the level of their
+ * subsystem. Warnings and errors keep using spdlog::warn/spdlog::error directly.
+ *
+ * Log::init() reads the [Log] section of config.ini:
+ *   Level = info         default runtime level of every subsystem
+ *   FlushLevel = info    flush after every message of this level or above, others are flushed every second
+ *   Async = false        format and write on a background thread instead of the packet path
+ *   QueueSize = 8192     bounded async queue, the oldest message is dropped when it's full
+ *   Consumer = debug     per-subsystem override, keys are the names returned by subsystemName()
+ */
+#ifndef LOG_ACTIVE_LEVEL
+#define LOG_ACTIVE_LEVEL SPDLOG_LEVEL_INFO
+#endif
+
+namespace Log
+{
+    enum Subsystem
+    {
+        APP,
+        CONSUMER,
+        AGGREGATOR,
+        PRODUCER,
+        PIPELINE,
+        SUBSYSTEM_COUNT
+    };
+
+    /**
+     * @brief Name of the subsystem as used in config.ini, e.g. "Aggregator"
+     */
+    const char *subsystemName(Subsystem subsystem);
+
+    extern std::atomic<int> g_levels[SUBSYSTEM_COUNT];
+
+    inline bool shouldLog(Subsystem subsystem, spdlog::level::level_enum level)
+    {
+        return level >= g_levels[subsystem].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Set the runtime level of one subsystem, it's no longer affected by setLevel(level)
+     */
+    void setLevel(Subsystem subsystem, spdlog::level::level_enum level);
+
+    /**
+     * @brief Set the runtime level of every subsystem that has no level of its own
+     */
+    void setLevel(spdlog::level::level_enum level);
+
+    /**
+     * @brief Create the file logger of this process and make it the spdlog default logger
+     *
+     * Replaces any logger created by an earlier call, e.g. App's logger when a derived app initializes.
+     *
+     * @param loggerName Name of the spdlog logger
+     * @param filename Log file, appended to
+     * @param configFile INI file holding the [Log] section, defaults apply if it can't be read
+     */
+    std::shared_ptr<spdlog::logger> init(const std::string &loggerName, const std::string &filename,
+                                         const std::string &configFile = "../experiments/config.ini");
+} // namespace Log
+
+#define LOG_CALL(subsystem, level, function, ...)     \
+    do                                                \
+    {                                                 \
+        if (Log::shouldLog(subsystem, level))         \
+            spdlog::function(__VA_ARGS__);            \
+    } while (0)
+
+#if LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_TRACE
+#define LOG_TRACE(subsystem, ...) LOG_CALL(subsystem, spdlog::level::trace, trace, __VA_ARGS__)
+#else
+#define LOG_TRACE(subsystem, ...) (void)0
+#endif
+
+#if LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG
+#define LOG_DEBUG(subsystem, ...) LOG_CALL(subsystem, spdlog::level::debug, debug, __VA_ARGS__)
+#else
+#define LOG_DEBUG(subsystem, ...) (void)0
+#endif
+
+#if LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_INFO
+#define LOG_INFO(subsystem, ...) LOG_CALL(subsystem, spdlog::level::info, info, __VA_ARGS__)
+#else
+#define LOG_INFO(subsystem, ...) (void)0
+#endif
+
+#endif // LOGGING_HPP
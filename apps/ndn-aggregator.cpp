@@ -16,11 +16,7 @@ Aggregator::Aggregator()
     SetSeqMax(std::numeric_limits<uint32_t>::max());
     SetRetxTimer(std::chrono::milliseconds(10));
     m_ccAlgorithm = CcAlgorithm::AIMD;
-    m_logger = spdlog::basic_logger_mt("aggregator_logger", "logs/aggregator.log");
-
-    spdlog::set_default_logger(m_logger);
-    spdlog::set_level(spdlog::level::info); // 设置日志级别
-    spdlog::flush_on(spdlog::level::info);  // 每条 info 级别及以上的日志后刷新
+    m_logger = Log::init("aggregator_logger", "logs/aggregator.log"); // 级别、刷新与异步模式见 config.ini [Log]
 
     spdlog::info("Aggregator initialized");
 
@@ -47,7 +43,12 @@ void Aggregator::ReadConfig()
     m_useCwa = pt.get<bool>("General.UseCwa", true);
     m_useCubicFastConv = pt.get<bool>("General.UseCubicFastConv", false);
     m_smooth_window_size = pt.get<int>("General.RTTWindowSize", 3);
-    m_dataSize = pt.get<int>("General.DataSize", 150);
+    if (m_smooth_window_size < 1 || m_smooth_window_size > static_cast<int>(RTT_WINDOW_CAPACITY))
+    {
+        spdlog::error("General.RTTWindowSize must be between 1 and {}", RTT_WINDOW_CAPACITY);
+        std::exit(EXIT_FAILURE);
+    }
+    m_dataSize = static_cast<int>(ModelSchema::instance().segmentSize());
 
     // QSF section
     m_qsfQueueThreshold = pt.get<int>("QSF.QueueThreshold", 3);
@@ -59,92 +60,48 @@ void Aggregator::ReadConfig()
     // Aggregator section
     m_interestQueue = pt.get<int>("Aggregator.AggInterestQueue", 10);
     m_dataQueue = pt.get<int>("Aggregator.AggDataQueue", 20);
+    m_aggTableSize = pt.get<int>("Aggregator.AggTableSize", 128);
+    m_reducerThreads = pt.get<int>("Aggregator.ReducerThreads", 0);
+
+    // Same number of iterations as the consumer, every iteration is requested segment by segment
+    m_iteNum = pt.get<int>("Consumer.Iteration", 200);
+    m_lastSeq = ModelSchema::instance().segmentSeq(m_iteNum, ModelSchema::instance().segmentCount() - 1);
+    m_repairRounds = pt.get<int>("Consumer.RepairRounds", 5);
+    m_partialQuorum = pt.get<int>("Aggregator.PartialQuorum", 0);
+    m_partialDeadline = pt.get<double>("Aggregator.PartialDeadline", 0.0);
+    std::string latePolicy = pt.get<std::string>("Aggregator.LatePolicy", "merge");
+    m_latePolicy = (latePolicy == "drop") ? LatePolicy::DROP : LatePolicy::MERGE;
+    m_lateGrace = pt.get<double>("Aggregator.LateGrace", 1.0);
+
+    // Pacer section
+    m_pacerTick = pt.get<int>("Pacer.TickInterval", 500);
+    m_pacerBurst = pt.get<double>("Pacer.Burst", 4.0);
+
+    // Security section
+    m_signing = SigningPolicy::fromConfig("../experiments/config.ini");
 }
 
 void Aggregator::setPrefix(const ndn::Name &prefix)
 {
     m_prefix = prefix;
 }
-/**
- * Intermediate function to parse string, used in aggTreeProcessStrings()
- * Changed from set into list
- * @param input
- * @return Parsed string
- */
-std::pair<std::string, std::vector<std::string>> Aggregator::aggTreeProcessSingleString(const std::string &input)
-{
-    std::istringstream iss(input);
-    std::string segment;
-    std::vector<std::string> segments;
-
-    // Use getline to split the string by '.'
-    while (getline(iss, segment, '.'))
-    {
-        segments.push_back(segment);
-    }
-
-    // Check if there are enough segments to form a key and a vector
-    if (segments.size() > 1)
-    {
-        std::string key = segments[0];
-        std::vector<std::string> values(segments.begin() + 1, segments.end());
-        return {key, values};
-    }
-
-    return {}; // Return an empty pair if not enough segments
-}
-
-/**
- * When receive "initialization" message (tree construction) from consumer, parse the message to get required info
- * Changed from set into list
- * @param inputs
- * @return A map consist child node info for current aggregator
- */
-std::map<std::string, std::vector<std::string>>
-Aggregator::aggTreeProcessStrings(const std::vector<std::string> &inputs)
-{
-    std::map<std::string, std::vector<std::string>> result;
-
-    for (const std::string &input : inputs)
-    {
-        auto entry = aggTreeProcessSingleString(input);
-        if (!entry.first.empty())
-        {
-            // Append all elements from entry.second to the vector at result[entry.first]
-            result[entry.first].insert(
-                result[entry.first].end(),
-                entry.second.begin(),
-                entry.second.end());
-        }
-    }
-
-    return result;
-}
 
 /**
  * Get data queue of certain flow
  */
 double
-Aggregator::GetDataQueueSize(std::string prefix)
+Aggregator::GetDataQueueSize(FlowId flow)
 {
     double queueSize = 0.0;
-    for (const auto &[seq, aggList] : map_agg_oldSeq_newName)
-    {
-        // TODO: delete later
-        /*         NS_LOG_DEBUG("Seq: " << seq);
-                // Iterate through the vector of strings (value)
-                NS_LOG_DEBUG("aggList: ");
-                for (const auto& str : aggList) {
-                    NS_LOG_DEBUG(str); // Print each string in the vector
-                } */
-
-        if (std::find(aggList.begin(), aggList.end(), prefix) == aggList.end())
+    // Iterations started upstream whose data from this flow is already waiting for the others
+    m_aggTable.ForEachInUse([&queueSize, flow](const AggregationTable::Slot &slot)
+                            {
+        if (slot.started && slot.HasArrived(flow))
         {
             queueSize += 1.0;
-        }
-    }
+        } });
 
-    spdlog::debug("Flow: {} -> Data queue size: {}", prefix, queueSize);
+    LOG_DEBUG(Log::AGGREGATOR, "Flow: {} -> Data queue size: {}", m_flows.Name(flow), queueSize);
     return queueSize;
 }
 
@@ -194,7 +151,7 @@ Aggregator::GetAggregateTimeAverage()
 {
     if (iterationCount == 0)
     {
-        spdlog::debug("Error happened when calculating aggregate time!");
+        LOG_DEBUG(Log::AGGREGATOR, "Error happened when calculating aggregate time!");
         return 0;
     }
 
@@ -208,25 +165,24 @@ void Aggregator::CheckRetxTimeout()
 {
     std::chrono::milliseconds now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
 
-    for (auto it = m_timeoutCheck.begin(); it != m_timeoutCheck.end();)
-    {
-        std::string name = it->first;
-        std::string flow = std::make_shared<ndn::Name>(name)->get(0).toUri();
-        if (now - it->second > RTO_threshold[flow])
-        {
-            it = m_timeoutCheck.erase(it);
-            ndn::Interest interest(name);
-            m_pendingInterest[name].cancel();
-            // OnTimeout(interest);
-            m_timeoutEvent = m_scheduler.schedule(ndn::time::milliseconds(0), [this, name]
-                                                  { this->OnTimeout(ndn::Interest(name)); });
-        }
-        // else
-        // {
-        //     ++it;
-        // }
-        it++;
-    }
+    // Only the interests whose deadline has passed are visited, they stay tracked until OnTimeout() handles them
+    std::vector<TimerWheel::Key> expired;
+    m_timeouts.Expire(now, expired);
+    // Silent rounds of a child are reported to the consumer's status probes, a burst of expirations is one round
+    std::set<FlowId> silentFlows;
+    for (TimerWheel::Key key : expired)
+    {
+        FlowId flow = TimerWheel::KeyFlow(key);
+        silentFlows.insert(flow);
+        ndn::Name name(m_flows[flow].nameSec0_2);
+        name.appendSequenceNumber(TimerWheel::KeySeq(key));
+        if (PendingInterest *pending = m_pit.Find(key))
+            pending->handle.cancel();
+        m_timeoutEvent = m_scheduler.schedule(ndn::time::milliseconds(0), [this, name]
+                                              { this->OnTimeout(ndn::Interest(name)); });
+    }
+    for (FlowId flow : silentFlows)
+        ++m_flows[flow].silentRounds;
     m_retxEvent = m_scheduler.schedule(ndn::time::milliseconds(m_retxTimer.count()), [this]
                                        { this->CheckRetxTimeout(); });
 }
@@ -234,50 +190,36 @@ void Aggregator::CheckRetxTimeout()
 /**
  * Based on RTT of the first iteration, compute their RTT average as threshold, use the threshold for congestion control
  * Apply Exponentially Weighted Moving Average (EWMA) for RTT Threshold Computation
- * @param prefix
+ * @param flow
  * @param responseTime
  * @return congestion signal
  */
-bool Aggregator::CongestionDetection(std::string prefix, int64_t responseTime)
+bool Aggregator::CongestionDetection(FlowId flow, int64_t responseTime)
 {
-    //* Normal usage is "push_back" "pop_front"
-    // Update RTT windowed queue and historical estimation
-    RTT_windowed_queue[prefix].push_back(responseTime);
-    RTT_count[prefix]++;
-
-    if (RTT_windowed_queue[prefix].size() > m_smooth_window_size)
+    FlowState &state = m_flows[flow];
+    // Update RTT windowed average and historical estimation, the sample leaving the window feeds the EWMA
+    int64_t transitionValue;
+    if (state.rttWindow.Add(responseTime, &transitionValue))
     {
-        int64_t transitionValue = RTT_windowed_queue[prefix].front();
-        RTT_windowed_queue[prefix].pop_front();
-
-        if (RTT_historical_estimation[prefix] == 0)
-        {
-            RTT_historical_estimation[prefix] = transitionValue;
-        }
-        else
-        {
-            RTT_historical_estimation[prefix] = m_EWMAFactor * transitionValue + (1 - m_EWMAFactor) * RTT_historical_estimation[prefix];
-        }
+        state.rttHistorical.Add(static_cast<double>(transitionValue));
     }
     else
     {
-        spdlog::debug("RTT_windowed_queue size: {}", RTT_windowed_queue[prefix].size());
+        LOG_DEBUG(Log::AGGREGATOR, "RTT window size: {}", state.rttWindow.Size());
     }
+    state.rttMin.Add(responseTime);
+    state.rttTail.Add(static_cast<double>(responseTime));
+    state.rttCount++;
 
     // Detect congestion
-    if (RTT_count[prefix] >= 2 * m_smooth_window_size)
+    if (state.rttCount >= 2 * m_smooth_window_size)
     {
-        int64_t pastRTTAverage = 0;
-        for (int64_t pastRTT : RTT_windowed_queue[prefix])
-        {
-            pastRTTAverage += pastRTT;
-        }
-        pastRTTAverage /= m_smooth_window_size;
+        int64_t pastRTTAverage = state.rttWindow.Sum() / m_smooth_window_size;
 
         // Enable RTT-estimation for scheduler
         isRTTEstimated = true;
 
-        int64_t rtt_threshold = m_thresholdFactor * RTT_historical_estimation[prefix];
+        int64_t rtt_threshold = m_thresholdFactor * state.rttHistorical.Value();
         if (rtt_threshold < pastRTTAverage)
         {
             return true;
@@ -289,35 +231,36 @@ bool Aggregator::CongestionDetection(std::string prefix, int64_t responseTime)
     }
     else
     {
-        spdlog::debug("RTT_count: {}", RTT_count[prefix]);
+        LOG_DEBUG(Log::AGGREGATOR, "RTT_count: {}", state.rttCount);
         return false;
     }
 }
 
 /**
  * Measure new RTO
- * @param prefix
+ * @param flow
  * @param resTime unit - us
  * @return New RTO
  */
-void Aggregator::RTOMeasure(std::string prefix, int64_t resTime)
+void Aggregator::RTOMeasure(FlowId flow, int64_t resTime)
 {
-    if (roundRTT[prefix] == 0)
+    FlowState &state = m_flows[flow];
+    if (state.roundRTT == 0)
     {
-        RTTVAR[prefix] = resTime / 2;
-        SRTT[prefix] = resTime;
+        state.rttvar = resTime / 2;
+        state.srtt = resTime;
     }
     else
     {
-        RTTVAR[prefix] = 0.75 * RTTVAR[prefix] + 0.25 * std::abs(SRTT[prefix] - resTime); // RTTVAR = (1 - b) * RTTVAR + b * |SRTT - RTTsample|, where b = 0.25
-        SRTT[prefix] = 0.875 * SRTT[prefix] + 0.125 * resTime;                            // SRTT = (1 - a) * SRTT + a * RTTsample, where a = 0.125
+        state.rttvar = 0.75 * state.rttvar + 0.25 * std::abs(state.srtt - resTime); // RTTVAR = (1 - b) * RTTVAR + b * |SRTT - RTTsample|, where b = 0.25
+        state.srtt = 0.875 * state.srtt + 0.125 * resTime;                            // SRTT = (1 - a) * SRTT + a * RTTsample, where a = 0.125
     }
-    roundRTT[prefix]++;
-    int64_t RTO = SRTT[prefix] + 4 * RTTVAR[prefix]; // RTO = SRTT + K * RTTVAR, where K = 4
+    state.roundRTT++;
+    int64_t RTO = state.srtt + 4 * state.rttvar; // RTO = SRTT + K * RTTVAR, where K = 4
 
-    RTO_threshold[prefix] = std::chrono::milliseconds(4 * RTO);
+    state.rtoThreshold = std::chrono::milliseconds(4 * RTO);
 
-    // NS_LOG_DEBUG("RTO measurement: " << RTO_threshold[name_sec0].GetMilliSeconds() << " ms");
+    // NS_LOG_DEBUG("RTO measurement: " << state.rtoThreshold.GetMilliSeconds() << " ms");
 }
 
 /**
@@ -326,23 +269,33 @@ void Aggregator::RTOMeasure(std::string prefix, int64_t resTime)
  */
 void Aggregator::OnTimeout(const ndn::Interest &interest)
 {
-    if (m_timeoutCheck.find(interest.getName().toUri()) != m_timeoutCheck.end())
+    std::shared_ptr<ndn::Name> name = std::make_shared<ndn::Name>(interest.getName());
+    uint32_t seq = name->get(-1).toSequenceNumber();
+    FlowId flow = m_flows.Find(*name);
+    if (flow == INVALID_FLOW && m_flows.Retired(*name))
     {
-        m_timeoutCheck.erase(interest.getName().toUri());
+        LOG_DEBUG(Log::AGGREGATOR, "Timeout of {} from a replaced child, ignored", name->toUri());
+        return;
     }
-    else
+    if (flow == INVALID_FLOW)
     {
-        spdlog::info("already recieved packet");
+        spdlog::error("Error when timeout, please exit and check!");
+        std::exit(EXIT_FAILURE);
         return;
     }
-    std::shared_ptr<ndn::Name> name = std::make_shared<ndn::Name>(interest.getName());
-    std::string name_sec0 = name->get(0).toUri();
-    uint32_t seq = name->get(-1).toSequenceNumber();
-    spdlog::debug("Flow {} - name -> {}: timeout.", name_sec0, interest.getName().toUri());
+    if (!m_timeouts.Cancel(TimerWheel::MakeKey(flow, seq)))
+    {
+        LOG_DEBUG(Log::AGGREGATOR, "already recieved packet");
+        return;
+    }
+    // Give the interest up, the seq is requested again with a new entry
+    m_pit.Erase(TimerWheel::MakeKey(flow, seq));
+    FlowState &state = m_flows[flow];
+    LOG_DEBUG(Log::AGGREGATOR, "Flow {} - name -> {}: timeout.", state.name, interest.getName().toUri());
 
-    if (m_inFlight[name_sec0] > 0)
+    if (state.inFlight > 0)
     {
-        m_inFlight[name_sec0]--;
+        state.inFlight--;
     }
     else
     {
@@ -354,13 +307,7 @@ void Aggregator::OnTimeout(const ndn::Interest &interest)
     // TODO: Should we implement qsf rate decrease when timeout?
 
     // qsf timeout handling
-    if (interestQueue.find(name_sec0) == interestQueue.end())
-    {
-        spdlog::error("Error when timeout, please exit and check!");
-        std::exit(EXIT_FAILURE);
-        return;
-    }
-    interestQueue[name_sec0].push_front(seq);
+    state.interestQueue.push_front(seq);
 
     suspiciousPacketCount++;
 }
@@ -426,17 +373,35 @@ void Aggregator::StopApplication()
  */
 void Aggregator::Aggregate(const ModelData &data, const uint32_t &seq)
 {
-    // first initialization
-    if (sumParameters.find(seq) == sumParameters.end())
+    AggregationTable::Slot *slot = m_aggTable.Find(seq);
+    if (slot == nullptr)
     {
-        sumParameters[seq] = std::vector<double>(m_dataSize, 0.0f);
+        spdlog::error("Iteration {} is not in the aggregation table!", seq);
+        return;
     }
 
     // Aggregate data
-    std::transform(sumParameters[seq].begin(), sumParameters[seq].end(), data.parameters.begin(), sumParameters[seq].begin(), std::plus<double>());
+    Reduce::sum(slot->sum.data(), data.parameters.data(), std::min(data.parameters.size(), slot->sum.size()));
 
     // Aggregate congestion signal
-    congestionSignalList[seq].insert(congestionSignalList[seq].end(), data.congestedNodes.begin(), data.congestedNodes.end());
+    slot->congestedNodes.insert(slot->congestedNodes.end(), data.congestedNodes.begin(), data.congestedNodes.end());
+}
+
+/**
+ * Perform aggregation directly on the upstream packet's content (sum)
+ * @param data
+ * @param seq
+ */
+void Aggregator::Aggregate(const ModelDataView &data, const uint32_t &seq)
+{
+    AggregationTable::Slot *slot = m_aggTable.Find(seq);
+    if (slot == nullptr)
+    {
+        spdlog::error("Iteration {} is not in the aggregation table!", seq);
+        return;
+    }
+
+    aggregateModelData(*slot, data);
 }
 
 /**
@@ -447,36 +412,40 @@ void Aggregator::Aggregate(const ModelData &data, const uint32_t &seq)
 ModelData
 Aggregator::GetMean(const uint32_t &seq)
 {
-    ModelData result;
-    if (sumParameters.find(seq) != sumParameters.end())
+    const ModelSchema &schema = ModelSchema::instance();
+    ModelData result(schema, schema.segmentOf(seq));
+    const AggregationTable::Slot *slot = m_aggTable.Find(seq);
+    if (slot != nullptr)
     {
-        result.parameters = sumParameters[seq];
+        // The accumulator is sized for the longest segment
+        std::copy_n(slot->sum.begin(), result.parameters.size(), result.parameters.begin());
+        result.contributors = slot->contributors;
 
         // Encapsulate qsf as meta data
         double maxQsf = 0;
-        for (const auto &[key, value] : aggregationMap)
+        for (const FlowState &state : m_flows)
         {
-            spdlog::debug("Flow - {} . Interest queue size: {}", key, interestQueue[key].size());
-            maxQsf = std::max(maxQsf, static_cast<double>(interestQueue[key].size()));
+            LOG_DEBUG(Log::AGGREGATOR, "Flow - {} . Interest queue size: {}", state.name, state.interestQueue.size());
+            maxQsf = std::max(maxQsf, static_cast<double>(state.interestQueue.size()));
         }
 
-        spdlog::info("Max interest queue size: {}", maxQsf);
+        LOG_DEBUG(Log::AGGREGATOR, "Max interest queue size: {}", maxQsf);
 
-        maxQsf = std::max(maxQsf, static_cast<double>(sumParameters.size()));
+        maxQsf = std::max(maxQsf, static_cast<double>(m_aggTable.DataCount()));
 
-        spdlog::info("Final QSF: {}", maxQsf);
+        LOG_DEBUG(Log::AGGREGATOR, "Final QSF: {}", maxQsf);
         result.qsf = maxQsf;
 
         // Add congestionSignal of current node if necessary, currently disable!
         /*         if (congestionSignal[seq]) {
-                    congestionSignalList[seq].push_back(m_prefix.toUri());
+                    slot->congestedNodes.push_back(m_prefix.toUri());
                     NS_LOG_DEBUG("Congestion detected on current node!");
                 }
-                result.congestedNodes = congestionSignalList[seq]; */
+                result.congestedNodes = slot->congestedNodes; */
     }
     else
     {
-        spdlog::debug("Error when get aggregation result, please exit and check!");
+        LOG_DEBUG(Log::AGGREGATOR, "Error when get aggregation result, please exit and check!");
         std::exit(EXIT_FAILURE);
     }
 
@@ -490,14 +459,26 @@ Aggregator::GetMean(const uint32_t &seq)
 void Aggregator::OnNack(const ndn::Interest &interest, const ndn::lp::Nack &nack)
 {
     App::OnNack(interest, nack);
-    spdlog::info("NACK received for: {}, reason: {}", nack.getInterest().getName().toUri(), static_cast<int>(nack.getReason()));
+    LOG_INFO(Log::AGGREGATOR, "NACK received for: {}, reason: {}", nack.getInterest().getName().toUri(), static_cast<int>(nack.getReason()));
     std::string dataName = nack.getInterest().getName().toUri();
-    std::string name_sec0 = nack.getInterest().getName().get(0).toUri();
     uint32_t seq = nack.getInterest().getName().get(-1).toSequenceNumber();
+    FlowId flow = m_flows.Find(nack.getInterest().getName());
+    if (flow == INVALID_FLOW && m_flows.Retired(nack.getInterest().getName()))
+    {
+        LOG_DEBUG(Log::AGGREGATOR, "NACK of {} from a replaced child, ignored", dataName);
+        return;
+    }
+    if (flow == INVALID_FLOW)
+    {
+        spdlog::error("NACK of an unknown flow, please exit and check!");
+        std::exit(EXIT_FAILURE);
+        return;
+    }
+    FlowState &state = m_flows[flow];
 
-    if (m_inFlight[name_sec0] > 0)
+    if (state.inFlight > 0)
     {
-        m_inFlight[name_sec0]--;
+        state.inFlight--;
     }
     else
     {
@@ -508,14 +489,14 @@ void Aggregator::OnNack(const ndn::Interest &interest, const ndn::lp::Nack &nack
 
     //! To be updated, when nack is received, what's the best strategy to control sending rate?
     // Insert the rejected interest back to the front of the interest queue
-    interestQueue[name_sec0].push_front(seq);
+    state.interestQueue.push_front(seq);
 
     // Decrease sending rate for certain flow
-    // WindowDecrease(name_sec0, "nack");
+    // WindowDecrease(flow, "nack");
 
     // Stop tracing rtt and timeout
-    rttStartTime.erase(dataName);
-    m_timeoutCheck.erase(dataName);
+    m_pit.Erase(TimerWheel::MakeKey(flow, seq));
+    m_timeouts.Cancel(TimerWheel::MakeKey(flow, seq));
     nackCount++;
 }
 
@@ -560,37 +541,38 @@ Aggregator::GetSeqMax() const
 
 // /**
 //  * Increase cwnd
-//  * @param prefix Flow name
+//  * @param flow Flow name
 //  */
-void Aggregator::WindowIncrease(std::string prefix)
+void Aggregator::WindowIncrease(FlowId flow)
 {
+    FlowState &state = m_flows[flow];
     if (m_ccAlgorithm == CcAlgorithm::AIMD)
     {
         // If cwnd is larger than 8, check whether current bottleneck is because of downstream slow interest, if so, stop increasing cwnd
-        /*         if (m_window[prefix] > 8.0 && m_window[prefix] - m_inFlight[prefix] > 30.0){
+        /*         if (state.window > 8.0 && state.window - state.inFlight > 30.0){
                     NS_LOG_DEBUG("Current bottleneck is downstream slow interest, stop increasing cwnd.");
                 } else  */
         if (m_useWIS)
         {
-            if (m_window[prefix] < m_ssthresh[prefix])
+            if (state.window < state.ssthresh)
             {
-                m_window[prefix] += 1.0;
+                state.window += 1.0;
             }
             else
             {
-                m_window[prefix] += (1.0 / m_window[prefix]);
+                state.window += (1.0 / state.window);
             }
-            spdlog::debug("Window size of flow '{}' is increased to {}", prefix, m_window[prefix]);
+            LOG_DEBUG(Log::AGGREGATOR, "Window size of flow '{}' is increased to {}", state.name, state.window);
         }
         else
         {
-            m_window[prefix] += 1.0;
-            spdlog::debug("Window size of flow '{}' is increased to {}", prefix, m_window[prefix]);
+            state.window += 1.0;
+            LOG_DEBUG(Log::AGGREGATOR, "Window size of flow '{}' is increased to {}", state.name, state.window);
         }
     }
     else if (m_ccAlgorithm == CcAlgorithm::CUBIC)
     {
-        CubicIncerase(prefix);
+        CubicIncerase(flow);
     }
     else
     {
@@ -601,54 +583,55 @@ void Aggregator::WindowIncrease(std::string prefix)
 
 /**
  * Decrease cwnd
- * @param prefix Flow name
+ * @param flow Flow name
  * @param type Congestion type
  */
-void Aggregator::WindowDecrease(std::string prefix, std::string type)
+void Aggregator::WindowDecrease(FlowId flow, std::string type)
 {
+    FlowState &state = m_flows[flow];
     // Track last window decrease time
     std::chrono::milliseconds now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
-    lastWindowDecreaseTime[prefix] = now;
+    state.lastWindowDecreaseTime = now;
 
     // AIMD for timeout
     if (m_ccAlgorithm == CcAlgorithm::AIMD)
     {
         if (type == "timeout")
         {
-            m_ssthresh[prefix] = m_window[prefix] * m_alpha;
-            m_window[prefix] = m_ssthresh[prefix];
+            state.ssthresh = state.window * m_alpha;
+            state.window = state.ssthresh;
         }
         else if (type == "nack")
         {
-            m_ssthresh[prefix] = m_window[prefix] * m_alpha;
-            m_window[prefix] = m_ssthresh[prefix];
+            state.ssthresh = state.window * m_alpha;
+            state.window = state.ssthresh;
         }
         else if (type == "LocalCongestion")
         {
-            m_ssthresh[prefix] = m_window[prefix] * m_beta;
-            m_window[prefix] = m_ssthresh[prefix];
+            state.ssthresh = state.window * m_beta;
+            state.window = state.ssthresh;
         }
         else if (type == "RemoteCongestion")
         {
-            m_ssthresh[prefix] = m_window[prefix] * m_gamma;
-            m_window[prefix] = m_ssthresh[prefix];
+            state.ssthresh = state.window * m_gamma;
+            state.window = state.ssthresh;
         }
     }
     else if (m_ccAlgorithm == CcAlgorithm::CUBIC)
     {
         if (type == "timeout")
         {
-            m_ssthresh[prefix] = m_window[prefix] * m_alpha;
-            m_window[prefix] = m_ssthresh[prefix];
+            state.ssthresh = state.window * m_alpha;
+            state.window = state.ssthresh;
         }
         else if (type == "nack")
         {
-            m_ssthresh[prefix] = m_window[prefix] * m_alpha;
-            m_window[prefix] = m_ssthresh[prefix];
+            state.ssthresh = state.window * m_alpha;
+            state.window = state.ssthresh;
         }
         else if (type == "LocalCongestion")
         {
-            CubicDecrease(prefix, type);
+            CubicDecrease(flow, type);
         }
         else if (type == "RemoteCongestion")
         {
@@ -662,32 +645,33 @@ void Aggregator::WindowDecrease(std::string prefix, std::string type)
     }
 
     // Window size can't be reduced below 1
-    if (m_window[prefix] < m_minWindow)
+    if (state.window < m_minWindow)
     {
-        m_window[prefix] = m_minWindow;
+        state.window = m_minWindow;
     }
-    spdlog::debug("Window size of flow '{}' is decreased to {}. Reason: {}", prefix, m_window[prefix], type);
+    LOG_DEBUG(Log::AGGREGATOR, "Window size of flow '{}' is decreased to {}. Reason: {}", state.name, state.window, type);
 }
 
 /**
  * Cubic increase
- * @param prefix Flow name
+ * @param flow Flow name
  */
-void Aggregator::CubicIncerase(std::string prefix)
+void Aggregator::CubicIncerase(FlowId flow)
 {
+    FlowState &state = m_flows[flow];
     // 1. Time since last congestion event in Seconds, round the value to 3 decimal places
     std::chrono::microseconds now = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime);
-    const double t = std::round(1000 * (now.count() - std::chrono::duration_cast<std::chrono::microseconds>(lastWindowDecreaseTime[prefix]).count()) / 1e9) / 1000;
-    spdlog::debug("Time since last congestion event: {}", t);
+    const double t = std::round(1000 * (now.count() - std::chrono::duration_cast<std::chrono::microseconds>(state.lastWindowDecreaseTime).count()) / 1e9) / 1000;
+    LOG_DEBUG(Log::AGGREGATOR, "Time since last congestion event: {}", t);
 
     // 2. Time it takes to increase the window to cubic_wmax
     // K = cubic_root(W_max*(1-beta_cubic)/C) (Eq. 2)
-    const double k = std::cbrt(m_cubicWmax[prefix] * (1 - m_cubicBeta) / m_cubic_c);
-    spdlog::debug("K value: {}", k);
+    const double k = std::cbrt(state.cubicWmax * (1 - m_cubicBeta) / m_cubic_c);
+    LOG_DEBUG(Log::AGGREGATOR, "K value: {}", k);
 
     // 3. Target: W_cubic(t) = C*(t-K)^3 + W_max (Eq. 1)
-    const double w_cubic = m_cubic_c * std::pow(t - k, 3) + m_cubicWmax[prefix];
-    spdlog::debug("Cubic increase target: {}", w_cubic);
+    const double w_cubic = m_cubic_c * std::pow(t - k, 3) + state.cubicWmax;
+    LOG_DEBUG(Log::AGGREGATOR, "Cubic increase target: {}", w_cubic);
 
     // 4. Estimate of Reno Increase (Currently Disabled)
     //  const double rtt = m_rtt->GetCurrentEstimate().GetSeconds();
@@ -697,12 +681,12 @@ void Aggregator::CubicIncerase(std::string prefix)
     // constexpr double w_est = 0.0;
 
     //! Original cubic increase
-    /*     if (m_cubicWmax[prefix] <= 0) {
+    /*     if (state.cubicWmax <= 0) {
             NS_LOG_DEBUG("Error! Wmax is less than 0, check cubic increase!");
             Simulator::Stop();
         }
 
-        double cubic_increment = std::max(w_cubic, 0.0) - m_window[prefix];
+        double cubic_increment = std::max(w_cubic, 0.0) - state.window;
         // Cubic increment must be positive:
         // Note: This change is not part of the RFC, but I added it to improve performance.
         if (cubic_increment < 0) {
@@ -710,22 +694,22 @@ void Aggregator::CubicIncerase(std::string prefix)
         }
 
         NS_LOG_DEBUG("Cubic increment: " << cubic_increment);
-        m_window[prefix] += cubic_increment / m_window[prefix]; */
+        state.window += cubic_increment / state.window; */
 
     //! Customized cubic increase
-    if (m_window[prefix] < m_ssthresh[prefix])
+    if (state.window < state.ssthresh)
     {
-        m_window[prefix] += 1.0;
+        state.window += 1.0;
     }
     else
     {
-        if (m_cubicWmax[prefix] <= 0)
+        if (state.cubicWmax <= 0)
         {
             spdlog::error("Error! Wmax is less than 0, check cubic increase!");
             std::exit(EXIT_FAILURE);
         }
 
-        double cubic_increment = std::max(w_cubic, 0.0) - m_window[prefix];
+        double cubic_increment = std::max(w_cubic, 0.0) - state.window;
         // Cubic increment must be positive:
         // Note: This change is not part of the RFC, but I added it to improve performance.
         if (cubic_increment < 0)
@@ -733,25 +717,26 @@ void Aggregator::CubicIncerase(std::string prefix)
             cubic_increment = 0.0;
         }
 
-        spdlog::debug("Cubic increment: {}", cubic_increment);
-        m_window[prefix] += cubic_increment / m_window[prefix];
+        LOG_DEBUG(Log::AGGREGATOR, "Cubic increment: {}", cubic_increment);
+        state.window += cubic_increment / state.window;
     }
 
-    spdlog::debug("Window size of flow '{}' is increased to {}", prefix, m_window[prefix]);
+    LOG_DEBUG(Log::AGGREGATOR, "Window size of flow '{}' is increased to {}", state.name, state.window);
 }
 
 /**
  * Cubic decrease
- * @param prefix Flow name
+ * @param flow Flow name
  * @param type Congestion type
  */
-void Aggregator::CubicDecrease(std::string prefix, std::string type)
+void Aggregator::CubicDecrease(FlowId flow, std::string type)
 {
+    FlowState &state = m_flows[flow];
     //! Traditional cubic window decrease
-    m_cubicWmax[prefix] = m_window[prefix];
-    m_ssthresh[prefix] = m_window[prefix] * m_cubicBeta;
-    m_ssthresh[prefix] = std::max<double>(m_ssthresh[prefix], m_minWindow);
-    m_window[prefix] = m_window[prefix] * m_cubicBeta;
+    state.cubicWmax = state.window;
+    state.ssthresh = state.window * m_cubicBeta;
+    state.ssthresh = std::max<double>(state.ssthresh, m_minWindow);
+    state.window = state.window * m_cubicBeta;
 }
 
 /**
@@ -761,26 +746,26 @@ void Aggregator::CubicDecrease(std::string prefix, std::string type)
 void Aggregator::OnInterest(const ndn::InterestFilter &filter, const ndn::Interest &interest)
 {
 
-    spdlog::debug("The incoming interest packet size is: {}", interest.wireEncode().size());
+    LOG_DEBUG(Log::AGGREGATOR, "The incoming interest packet size is: {}", interest.wireEncode().size());
     App::OnInterest(filter, interest);
 
     std::string interestType = interest.getName().get(-2).toUri();
 
     if (interestType == "data")
     {
-        spdlog::debug("aggregator received the interest packet that is of type data");
+        LOG_DEBUG(Log::AGGREGATOR, "aggregator received the interest packet that is of type data");
         std::string originalName = interest.getName().toUri();
         uint32_t seq = interest.getName().get(-1).toSequenceNumber();
         bool isQueueFull = false;
         bool isDownstreamRetx = false;
 
         //? Check whether interest queue is full
-        for (const auto &[key, value] : aggregationMap)
+        for (const FlowState &state : m_flows)
         {
-            if (interestQueue[key].size() >= m_interestQueue)
+            if (state.interestQueue.size() >= m_interestQueue)
             {
                 isQueueFull = true;
-                spdlog::info("Interest queue of flow {} is full, drop it - {}", key, interest.getName().toUri());
+                LOG_INFO(Log::AGGREGATOR, "Interest queue of flow {} is full, drop it - {}", state.name, interest.getName().toUri());
                 interestOverflow++;
 
                 // Interest queue overflow, send NACK back to downstream for notification
@@ -790,10 +775,10 @@ void Aggregator::OnInterest(const ndn::InterestFilter &filter, const ndn::Intere
         }
 
         //? Check whether the interest is retransmission from downstream
-        if (m_agg_newDataName.find(seq) != m_agg_newDataName.end() || map_agg_oldSeq_newName.find(seq) != map_agg_oldSeq_newName.end())
+        if (m_aggTable.Find(seq) != nullptr)
         {
             isDownstreamRetx = true;
-            spdlog::info("This is a retransmission interest from downstream, drop it - {}", interest.getName().toUri());
+            LOG_INFO(Log::AGGREGATOR, "This is a retransmission interest from downstream, drop it - {}", interest.getName().toUri());
             downstreamRetxCount++;
             return;
         }
@@ -801,10 +786,20 @@ void Aggregator::OnInterest(const ndn::InterestFilter &filter, const ndn::Intere
         // If queue isn't full, perform interest splitting
         if (!isQueueFull && !isDownstreamRetx)
         {
+            AggregationTable::Slot *slot = m_aggTable.Acquire(seq);
+            if (slot == nullptr)
+            {
+                // Slot still held by an older iteration, treat it like an interest queue overflow
+                LOG_INFO(Log::AGGREGATOR, "Aggregation table slot of seq {} is busy, drop it - {}", seq, interest.getName().toUri());
+                interestOverflow++;
+                SendNack(std::make_shared<ndn::Interest>(interest));
+                return;
+            }
+
             // Store original name into aggMap
-            m_agg_newDataName[seq] = interest.getName().toUri();
+            slot->dataName = interest.getName().toUri();
 
-            spdlog::debug("New downstream interest's seq: {}", seq);
+            LOG_DEBUG(Log::AGGREGATOR, "New downstream interest's seq: {}", seq);
 
             // Split interest
             InterestSplitting(seq);
@@ -812,18 +807,18 @@ void Aggregator::OnInterest(const ndn::InterestFilter &filter, const ndn::Intere
             //! Debugging, check whether this works in qsf design
             if (firstInterest)
             {
-                for (const auto &[key, value] : aggregationMap)
-                {
-
-                    m_scheduleEvent[key] = m_scheduler.schedule(ndn::time::milliseconds(0), [this, key]
-                                                                { this->ScheduleNextPacket(key); });
-                }
+                auto now = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime);
+                for (FlowId flow = 0; flow < m_flows.Size(); ++flow)
+                    m_pacer.Start(flow, now.count());
+                if (!m_pacerEvent)
+                    m_pacerEvent = m_scheduler.schedule(ndn::time::milliseconds(0), [this]
+                                                        { this->PacerTick(); });
                 firstInterest = false;
             }
         }
         else
         {
-            spdlog::debug("Error! Interest queue is full or downstream retransmission, please check!");
+            LOG_DEBUG(Log::AGGREGATOR, "Error! Interest queue is full or downstream retransmission, please check!");
             std::exit(EXIT_FAILURE);
             return;
         }
@@ -835,62 +830,83 @@ void Aggregator::OnInterest(const ndn::InterestFilter &filter, const ndn::Intere
         // Synchronize signal
         treeSync = true;
 
-        std::chrono::milliseconds now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
-
-        // Record current time as simulation start time on aggregator
-        startSimulation = now;
-
-        // Read aggregation tree from init message
-        std::vector<std::string> inputs;
-        if (interest.getName().size() > 3)
+        // Read aggregation tree from init message's parameters, the node names point into the interest
+        AggregationSubtree subtree;
+        if (!interest.hasApplicationParameters() ||
+            !subtree.Parse(interest.getApplicationParameters().value(), interest.getApplicationParameters().value_size()))
         {
-            for (size_t i = 1; i < interest.getName().size() - 2; ++i)
+            spdlog::error("Malformed aggregation tree in {}, stop and check!", interest.getName().toUri());
+            std::exit(EXIT_FAILURE);
+            return;
+        }
+        // A running aggregator gets a new subtree when the consumer repaired the tree, only the replaced children change
+        if (!aggregationMap.empty())
+        {
+            if (!ReplaceChildren(subtree.ChildLeaves()))
             {
-                spdlog::info("Aggregation tree received: {}", interest.getName().get(i).toUri());
-                inputs.push_back(interest.getName().get(i).toUri());
+                spdlog::error("Repaired aggregation tree in {} changes more than the replaced children, stop and check!", interest.getName().toUri());
+                std::exit(EXIT_FAILURE);
+                return;
             }
         }
-        aggregationMap = aggTreeProcessStrings(inputs);
-
-        // for (const auto &[key, value] : aggregationMap)
-        // {
-        //     spdlog::info("Key: {}", key);
-        //     spdlog::info("Values: ");
-        //     for (const auto &str : value)
-        //     {
-        //         spdlog::info("  {}", str);
-        //     }
-        // }
-
-        // Define for new congestion control
-        numChild = static_cast<int>(aggregationMap.size());
-
-        // testing, delete later!!!!
-        if (aggregationMap.empty())
+        else
         {
-            spdlog::info("Error, aggregationMap is empty!");
-            std::exit(EXIT_FAILURE);
-            return;
-        } /* else {
-            // Print the result mapping
-            NS_LOG_DEBUG("Aggregation tree received: ");
-            for (const auto& [node, leaves] : aggregationMap) {
-                NS_LOG_DEBUG(node << " contains leaf nodes: ");
-                for (const auto& leaf : leaves) {
-                    NS_LOG_DEBUG(leaf << " ");
-                }
+            // Record current time as simulation start time on aggregator
+            startSimulation = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
+
+            aggregationMap = subtree.ChildLeaves();
+            for (const auto &[child, leaves] : aggregationMap)
+            {
+                spdlog::info("Aggregation tree received: child {} with {} leaves", child, leaves.size());
+            }
+
+            // for (const auto &[key, value] : aggregationMap)
+            // {
+            //     spdlog::info("Key: {}", key);
+            //     spdlog::info("Values: ");
+            //     for (const auto &str : value)
+            //     {
+            //         spdlog::info("  {}", str);
+            //     }
+            // }
+
+            // Define for new congestion control
+            numChild = static_cast<int>(aggregationMap.size());
+
+            // Intern child flows, a child's FlowId is also its bit in the aggregation table
+            m_flows.Clear();
+            for (const auto &[child, leaves] : aggregationMap)
+            {
+                m_flows.Intern(child);
             }
-        } */
 
-        //! After receiving aggregation tree, start basic initialization
-        // Initialize logging session
-        InitializeLogFile();
+            // testing, delete later!!!!
+            if (aggregationMap.empty())
+            {
+                spdlog::info("Error, aggregationMap is empty!");
+                std::exit(EXIT_FAILURE);
+                return;
+            } /* else {
+                // Print the result mapping
+                NS_LOG_DEBUG("Aggregation tree received: ");
+                for (const auto& [node, leaves] : aggregationMap) {
+                    NS_LOG_DEBUG(node << " contains leaf nodes: ");
+                    for (const auto& leaf : leaves) {
+                        NS_LOG_DEBUG(leaf << " ");
+                    }
+                }
+            } */
+
+            //! After receiving aggregation tree, start basic initialization
+            // Initialize logging session
+            InitializeLogFile();
 
-        // Initialize parameteres
-        InitializeParameters();
+            // Initialize parameteres
+            InitializeParameters();
 
-        // Perform interest name splitting
-        InterestGenerator();
+            // Perform interest name splitting
+            InterestGenerator();
+        }
 
         //! nack works
         /*         auto nack = std::make_shared<ndn::lp::Nack>(*interest);
@@ -905,55 +921,70 @@ void Aggregator::OnInterest(const ndn::InterestFilter &filter, const ndn::Intere
         // 设set data packet content
         data->setFreshnessPeriod(ndn::time::milliseconds(m_freshness.count()));
         // data->setFreshnessPeriod(ndn::time::seconds(10));
-        // use KeyChain to sign Data packet
-        m_keyChain.sign(*data);
+        // sign Data packet with the configured signing policy
+        m_signing.Sign(m_keyChain, *data);
         // send Data packet
         m_face.put(*data);
         spdlog::info("Initialization data packet sent: {}", data.get()->getName().toUri());
     }
+    // The consumer probes an aggregator that went silent, the answer lists the children silent for as long
+    else if (interestType == "status")
+    {
+        std::string silent;
+        for (const FlowState &state : m_flows)
+        {
+            if (m_repairRounds > 0 && state.silentRounds >= m_repairRounds)
+                silent += (silent.empty() ? "" : " ") + state.name;
+        }
+        auto data = std::make_shared<ndn::Data>(interest.getName());
+        data->setContent(std::make_shared<::ndn::Buffer>(silent.begin(), silent.end()));
+        m_signing.Sign(m_keyChain, *data);
+        m_face.put(*data);
+        spdlog::info("Status data packet sent: {}, silent children [{}]", data->getName().toUri(), silent);
+    }
 }
 
 /**
- * Process incoming data packets
- * @param prefix
+ * Pacer's periodic tick, every flow sends what its rate limit allows since the last tick
  */
-void Aggregator::ScheduleNextPacket(std::string prefix)
+void Aggregator::PacerTick()
 {
-    if (interestQueue.find(prefix) == interestQueue.end())
+    auto now = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime);
+    m_pacer.Tick(now.count(), [this](FlowId flow)
+                 { return this->ReleasePacket(flow); });
+
+    // Stop ticking once every flow has finished
+    if (m_pacer.ActiveCount() == 0)
     {
-        spdlog::error("Flow {} is not found in the interest queue.", prefix);
-        std::exit(EXIT_FAILURE);
+        m_pacerEvent.reset();
         return;
     }
+    m_pacerEvent = m_scheduler.schedule(ndn::time::microseconds(m_pacerTick), [this]
+                                        { this->PacerTick(); });
+}
 
-    if (!interestQueue.at(prefix).empty())
+/**
+ * Send the next interest of flow, called by the pacer once per token
+ * @param flow
+ * @return False if the flow's interest queue is empty
+ */
+bool Aggregator::ReleasePacket(FlowId flow)
+{
+    if (flow >= m_flows.Size())
     {
-        if (m_sendEvent[prefix])
-        {
-
-            m_sendEvent[prefix].cancel();
-            m_sendEvent[prefix].reset();
-            spdlog::debug("Suspicious, remove the previous event.");
-        }
-
-        m_sendEvent[prefix] = m_scheduler.schedule(ndn::time::milliseconds(0), [this, prefix]
-                                                   { this->SendPacket(prefix); });
-        double nextTime = 1 / m_rateLimit[prefix]; // Unit: us
-
-        spdlog::debug("Flow {} -> Schedule next sending event after {} ms.", prefix, nextTime / 1000);
-        m_scheduleEvent[prefix] = m_scheduler.schedule(ndn::time::microseconds(static_cast<int64_t>(nextTime)), [this, prefix]
-                                                       { this->ScheduleNextPacket(prefix); });
+        spdlog::error("Flow {} is not found in the flow table.", flow);
+        std::exit(EXIT_FAILURE);
+        return false;
     }
-    else
-    {
-        //! What's the best strategy when interest queue is empty?
-        // Schedule again after 1/5 rate limit
-        double nextTime = 1 / m_rateLimit[prefix] / 5; // Unit: us
 
-        spdlog::debug("Flow {} -> Interest queue is empty. Schedule next sending event after {} ms.", prefix, nextTime / 1000);
-        m_scheduleEvent[prefix] = m_scheduler.schedule(ndn::time::microseconds(static_cast<int64_t>(nextTime)), [this, prefix]
-                                                       { this->ScheduleNextPacket(prefix); });
+    //! What's the best strategy when interest queue is empty? The flow keeps earning tokens up to the burst size
+    if (m_flows[flow].interestQueue.empty())
+    {
+        LOG_DEBUG(Log::AGGREGATOR, "Flow {} -> Interest queue is empty, try again on the next tick.", m_flows.Name(flow));
+        return false;
     }
+    SendPacket(flow);
+    return true;
 }
 
 /**
@@ -975,43 +1006,101 @@ void Aggregator::InterestGenerator()
         }
         name_sec1.resize(name_sec1.size() - 1);
         name_sec0_2 = "/" + key + "/" + name_sec1 + "/data";
-        NameSec0_2[key] = name_sec0_2;
+        m_flows[m_flows.Find(key)].nameSec0_2 = name_sec0_2;
         vec_iteration.push_back(key); // Will be added to aggregation map later
     }
 }
 
+/**
+ * Hand the flows of replaced children over to their replacements, keeping the flow ids so the aggregation table, the
+ * timers and the pending interests carry on. A replacement covers the same leaves as the child it replaces.
+ * @param children Children and their leaves of the repaired subtree
+ * @return False if the children changed in another way, e.g. their number
+ */
+bool Aggregator::ReplaceChildren(const std::map<std::string, std::vector<std::string>> &children)
+{
+    std::vector<std::string> added;
+    for (const auto &[child, leaves] : children)
+    {
+        if (aggregationMap.find(child) == aggregationMap.end())
+            added.push_back(child);
+    }
+
+    std::vector<std::pair<std::string, std::string>> replacements;
+    for (const auto &[child, leaves] : aggregationMap)
+    {
+        if (children.find(child) != children.end())
+            continue;
+        std::set<std::string> oldLeaves(leaves.begin(), leaves.end());
+        auto replacement = std::find_if(added.begin(), added.end(), [&](const std::string &node)
+                                        {
+                                            const std::vector<std::string> &newLeaves = children.at(node);
+                                            return std::set<std::string>(newLeaves.begin(), newLeaves.end()) == oldLeaves; });
+        if (replacement == added.end())
+            return false;
+        replacements.emplace_back(child, *replacement);
+        added.erase(replacement);
+    }
+    if (!added.empty())
+        return false;
+
+    for (const auto &[oldChild, newChild] : replacements)
+    {
+        FlowId flow = m_flows.Find(oldChild);
+        if (!m_flows.Rename(flow, newChild))
+            return false;
+
+        std::string name_sec1;
+        for (const auto &leaf : children.at(newChild))
+        {
+            name_sec1 += leaf + ".";
+        }
+        name_sec1.resize(name_sec1.size() - 1);
+        FlowState &state = m_flows[flow];
+        state.nameSec0_2 = "/" + newChild + "/" + name_sec1 + "/data";
+        state.silentRounds = 0;
+        std::replace(vec_iteration.begin(), vec_iteration.end(), oldChild, newChild);
+        spdlog::info("Child {} is replaced by {}, its outstanding interests are sent to {} from now on", oldChild, newChild, newChild);
+    }
+    aggregationMap = children;
+    return true;
+}
+
 /**
  * Divide interest into several new interests, performed whe receiving aggregation tree
  */
 void Aggregator::InterestSplitting(uint32_t seq)
 {
     // Divide interests and push them into queue
-    for (const auto &[key, value] : aggregationMap)
+    for (FlowState &state : m_flows)
     {
-        interestQueue[key].push_back(seq);
+        state.interestQueue.push_back(seq);
     }
 }
 
 /**
  * Check whether interest buffer is empty, if not, send new interests
  */
-void Aggregator::SendPacket(std::string prefix)
+void Aggregator::SendPacket(FlowId flow)
 {
-    if (!interestQueue.at(prefix).empty())
+    FlowState &state = m_flows[flow];
+    if (!state.interestQueue.empty())
     {
-        uint32_t iteration = interestQueue.at(prefix).front();
-        interestQueue.at(prefix).pop_front();
-        spdlog::debug("delete interest from queue: {}", iteration);
-        std::shared_ptr<ndn::Name> name = std::make_shared<ndn::Name>(NameSec0_2[prefix]);
+        uint32_t iteration = state.interestQueue.front();
+        state.interestQueue.pop_front();
+        LOG_DEBUG(Log::AGGREGATOR, "delete interest from queue: {}", iteration);
+        std::shared_ptr<ndn::Name> name = std::make_shared<ndn::Name>(state.nameSec0_2);
         name->appendSequenceNumber(iteration);
 
         SendInterest(name);
 
         // Check whether it's new iteration
-        if (aggregateStartTime.find(iteration) == aggregateStartTime.end())
+        AggregationTable::Slot *slot = m_aggTable.Find(iteration);
+        if (slot != nullptr && !slot->started)
         {
             std::chrono::milliseconds now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
-            aggregateStartTime[iteration] = now;
+            slot->startTime = now;
+            slot->timing = true;
 
             // TODO: delete later
             /*             std::vector<std::string> vec_flow; // Store all flow segments within aggMap
@@ -1023,23 +1112,20 @@ void Aggregator::SendPacket(std::string prefix)
                             vec_flow.push_back(nameWithSeq);
                         } */
 
-            map_agg_oldSeq_newName[iteration] = vec_iteration;
+            slot->started = true;
+            ArmIterationDeadline(iteration);
         }
 
-        // Stop interest scheduling after reaching the last iteration
-        if (iteration == m_iteNum)
+        // Stop interest scheduling after reaching the last segment of the last iteration
+        if (iteration == m_lastSeq)
         {
             spdlog::info("All iterations have been finished, no need to schedule new interests.");
-            if (m_scheduleEvent[prefix])
-            {
-                m_scheduleEvent[prefix].cancel();
-                m_scheduleEvent[prefix].reset();
-            }
+            m_pacer.Stop(flow);
         }
     }
     else
     {
-        spdlog::debug("Flow - {}: interest queue is empty, this should never happen!", prefix);
+        LOG_DEBUG(Log::AGGREGATOR, "Flow - {}: interest queue is empty, this should never happen!", state.name);
         std::exit(EXIT_FAILURE);
         return;
     }
@@ -1055,36 +1141,60 @@ void Aggregator::SendInterest(std::shared_ptr<ndn::Name> newName)
         return;
 
     std::string nameWithSeq = newName->toUri();
-    std::string name_sec0 = newName->get(0).toUri();
+    FlowId flow = m_flows.Find(*newName);
+    TimerWheel::Key key = TimerWheel::MakeKey(flow, newName->get(-1).toSequenceNumber());
 
     std::chrono::milliseconds now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
 
-    // Trace timeout
-    m_timeoutCheck[nameWithSeq] = now;
+    // Trace timeout, the deadline uses the flow's RTO threshold at sending time
+    if (flow != INVALID_FLOW)
+        m_timeouts.Arm(key, now + m_flows[flow].rtoThreshold);
 
-    // Start response time
-    rttStartTime[nameWithSeq] = now;
+    // Pending entry, holds the reference of the response time
+    PendingInterest *pending = nullptr;
+    if (flow != INVALID_FLOW)
+    {
+        bool inserted;
+        std::tie(pending, inserted) = m_pit.Insert(key);
+        if (pending == nullptr)
+        {
+            spdlog::error("Pending interest table is full ({} entries), can't send {}!", m_pit.Capacity(), nameWithSeq);
+            std::exit(EXIT_FAILURE);
+            return;
+        }
+        if (!inserted)
+            pending->retxCount++;
+        pending->sendTime = now;
+    }
     uint32_t nonce = static_cast<uint32_t>(m_uniformDist(m_rand));
-    spdlog::info("Sending new interest: {}", nameWithSeq);
+    LOG_DEBUG(Log::AGGREGATOR, "Sending new interest: {}", nameWithSeq);
     std::shared_ptr<ndn::Interest> newInterest = std::make_shared<ndn::Interest>();
     newInterest->setNonce(nonce);
     newInterest->setCanBePrefix(false);
     newInterest->setName(*newName);
     std::chrono::milliseconds interestLifeTime(m_interestLifeTime);
     newInterest->setInterestLifetime(ndn::time::milliseconds(interestLifeTime.count()));
-    m_pendingInterest[nameWithSeq] = m_face.expressInterest(*newInterest,
-                                                            std::bind(&Aggregator::OnData, this, _1, _2),
-                                                            std::bind(&Aggregator::OnNack, this, _1, _2),
-                                                            std::bind(&Aggregator::OnTimeout, this, _1));
+    ndn::PendingInterestHandle handle = m_face.expressInterest(*newInterest,
+                                                               std::bind(&Aggregator::OnData, this, _1, _2),
+                                                               std::bind(&Aggregator::OnNack, this, _1, _2),
+                                                               std::bind(&Aggregator::OnTimeout, this, _1));
+    if (pending != nullptr)
+    {
+        pending->nonce = nonce;
+        pending->handle = handle;
+    }
 
     // Designed for congestion control recording
-    m_inFlight[name_sec0]++;
+    if (flow != INVALID_FLOW)
+    {
+        m_flows[flow].inFlight++;
+    }
 
     // Record interest throughput
     // Actual interests sending and retransmission are recorded as well
     int interestSize = newInterest->wireEncode().size();
     totalInterestThroughput += interestSize;
-    spdlog::debug("Interest size: {}", interestSize);
+    LOG_DEBUG(Log::AGGREGATOR, "Interest size: {}", interestSize);
 }
 
 /**
@@ -1093,30 +1203,46 @@ void Aggregator::SendInterest(std::shared_ptr<ndn::Name> newName)
  */
 void Aggregator::SendData(uint32_t seq)
 {
-    // Get aggregation result for current iteration
+    AggregationTable::Slot *slot = m_aggTable.Find(seq);
+    if (slot == nullptr)
+    {
+        spdlog::error("Iteration {} is not in the aggregation table, nothing to send!", seq);
+        return;
+    }
+
+    // Late data merged in the grace window is still being reduced, a worker may be writing the sum. The last
+    // completion sends the result, nothing is read or put before that
+    if (slot->reducing > 0)
+    {
+        slot->closed = true;
+        slot->sendDue = true;
+        return;
+    }
+
+    // Get aggregation result for current iteration, the sum is re-encoded with the configured encoding here
     std::vector<uint8_t> newbuffer;
     serializeModelData(GetMean(seq), newbuffer);
 
     // create data packet
     auto data = std::make_shared<ndn::Data>();
 
-    std::string name_string = m_agg_newDataName[seq];
-    spdlog::info("New aggregated data's name: {}", name_string);
+    const std::string &name_string = slot->dataName;
+    LOG_DEBUG(Log::AGGREGATOR, "New aggregated data's name: {}", name_string);
     std::shared_ptr<ndn::Name> newName = std::make_shared<ndn::Name>(name_string);
     data->setName(*newName);
     data->setContent(std::make_shared<::ndn::Buffer>(newbuffer.begin(), newbuffer.end()));
     data->setFreshnessPeriod(ndn::time::milliseconds(m_freshness.count()));
-    // use KeyChain to sign Data packet
-    m_keyChain.sign(*data);
+    // sign Data packet with the configured signing policy
+    m_signing.Sign(m_keyChain, *data);
     // send Data packet
     m_face.put(*data);
 
-    // Clear aggregation mapping and aggregation result for current iteration
-    aggregateTime.erase(seq);
-    map_agg_oldSeq_newName.erase(seq);
-    m_agg_newDataName.erase(seq);
-    sumParameters.erase(seq);
-    partialAggResult.erase(seq);
+    // Children that haven't answered won't be waited for any more
+    if (!m_aggTable.IsComplete(*slot))
+        CancelStragglers(*slot);
+
+    // Release the table slot, its buffers are reused by a later iteration
+    m_aggTable.Release(*slot);
 }
 
 /**
@@ -1126,7 +1252,7 @@ void Aggregator::SendData(uint32_t seq)
  */
 void Aggregator::SendNack(std::shared_ptr<const ndn::Interest> interest)
 {
-    spdlog::info("Send NACK back to downstream for interest queue overflow: {}", interest->getName().toUri());
+    LOG_INFO(Log::AGGREGATOR, "Send NACK back to downstream for interest queue overflow: {}", interest->getName().toUri());
     ndn::lp::NackHeader nackHeader;
     nackHeader.setReason(ndn::lp::NackReason::QUEUE_OVERFLOW);
 
@@ -1152,306 +1278,463 @@ void Aggregator::OnData(const ndn::Interest &interest, const ndn::Data &data)
         return;
 
     App::OnData(interest, data);
-    spdlog::info("Received content object: {}", data.getName().toUri());
+    LOG_DEBUG(Log::AGGREGATOR, "Received content object: {}", data.getName().toUri());
+    switch (m_signing.Verify(data))
+    {
+    case SigningPolicy::Verdict::REJECT:
+        LOG_INFO(Log::AGGREGATOR, "Data {} failed {} verification, dropped", data.getName().toUri(), signingModeName(m_signing.Mode()));
+        return;
+    case SigningPolicy::Verdict::HOLD:
+        LOG_DEBUG(Log::AGGREGATOR, "Data {} is held until its manifest arrives", data.getName().toUri());
+        return;
+    default:
+        break;
+    }
+    // Segments held for the manifest this data carried are handled right after it
+    for (ndn::Data &held : m_signing.TakeReleased())
+        m_scheduler.schedule(ndn::time::milliseconds(0), [this, held = std::move(held)]
+                             { this->OnData(ndn::Interest(held.getName()), held); });
     int dataSize = data.wireEncode().size();
 
     std::string dataName = data.getName().toUri();
-    std::string name_sec0 = data.getName().get(0).toUri();
     uint32_t seq = data.getName().at(-1).toSequenceNumber();
     std::string type = data.getName().get(-2).toUri();
+    FlowId flow = m_flows.Find(data.getName());
+    if (flow == INVALID_FLOW && m_flows.Retired(data.getName()))
+    {
+        LOG_DEBUG(Log::AGGREGATOR, "Late data {} from a replaced child, dropped", dataName);
+        return;
+    }
+    if (flow == INVALID_FLOW)
+    {
+        LOG_INFO(Log::AGGREGATOR, "Data from {} doesn't belong to any child flow, please check!", data.getName().get(0).toUri());
+        std::exit(EXIT_FAILURE);
+        return;
+    }
+    FlowState &state = m_flows[flow];
+    state.silentRounds = 0;
 
     //! For testing purpose
-    auto start = std::chrono::high_resolution_clock::now();
-    auto stop = std::chrono::high_resolution_clock::now();
+    [[maybe_unused]] auto start = std::chrono::high_resolution_clock::now();
 
     // Record data throughput
     totalDataThroughput += dataSize;
-    spdlog::debug("The incoming data packet size is: {}", dataSize);
+    LOG_DEBUG(Log::AGGREGATOR, "The incoming data packet size is: {}", dataSize);
 
     // Stop checking timeout associated with this name
-    if (m_timeoutCheck.find(dataName) != m_timeoutCheck.end())
-        m_timeoutCheck.erase(dataName);
-    else
+    if (!m_timeouts.Cancel(TimerWheel::MakeKey(flow, seq)))
     {
-        spdlog::debug("Suspicious data packet, not exists in timeout list.");
+        LOG_DEBUG(Log::AGGREGATOR, "Suspicious data packet, not exists in timeout list.");
         std::exit(EXIT_FAILURE);
     }
 
+    // The interest is satisfied, recycle its pending entry
+    PendingInterest pending;
+    bool wasPending = m_pit.Erase(TimerWheel::MakeKey(flow, seq), &pending);
+
     // TODO from yitong : testing, delete later
-    GetDataQueueSize(name_sec0);
+    GetDataQueueSize(flow);
 
     // TODO from yitong : what's the best strategy to react to data queue overflow?
     // Check whether data queue exceeds the limit
-    if (sumParameters.find(seq) == sumParameters.end())
+    AggregationTable::Slot *slot = m_aggTable.Find(seq);
+    if (slot != nullptr && !slot->hasData)
     {
         // New iteration, currently not exist in the partial agg result
-        if (partialAggResult.size() >= m_dataQueue)
+        if (m_aggTable.DataCount() >= m_dataQueue)
         {
             // Exceed max data size
-            spdlog::info("Exceeding the max data queue, stop interest sending for flow {}", name_sec0);
+            LOG_INFO(Log::AGGREGATOR, "Exceeding the max data queue, stop interest sending for flow {}", state.name);
             dataOverflow++;
 
-            // Schdule next event after 5 * current period
-            if (m_scheduleEvent[name_sec0])
-            {
-
-                m_scheduleEvent[name_sec0].cancel();
-                m_scheduleEvent[name_sec0].reset();
-            }
-
-            double nextTime = 5 * 1 / m_rateLimit[name_sec0]; // Unit: us
-            spdlog::info("Flow {} -> Schedule next sending event after {} ms.", name_sec0, nextTime / 1000);
-
-            m_scheduleEvent[name_sec0] = m_scheduler.schedule(ndn::time::microseconds(static_cast<int64_t>(nextTime)), [this, name_sec0]
-                                                              { this->ScheduleNextPacket(name_sec0); });
+            // Pause the flow for 5 * current period
+            double nextTime = 5 * 1 / state.rateLimit; // Unit: us
+            LOG_DEBUG(Log::AGGREGATOR, "Flow {} -> Pause interest sending for {} ms.", state.name, nextTime / 1000);
+            auto now = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime);
+            m_pacer.Pause(flow, now.count() + static_cast<int64_t>(nextTime));
         }
-        partialAggResult[seq] = true;
+        m_aggTable.MarkHasData(*slot);
     }
 
-    if (m_inFlight[name_sec0] > 0)
+    if (state.inFlight > 0)
     {
-        m_inFlight[name_sec0]--;
+        state.inFlight--;
     }
     else
     {
-        spdlog::debug("Error! In-flight packet is less than 0, please check!");
+        LOG_DEBUG(Log::AGGREGATOR, "Error! In-flight packet is less than 0, please check!");
         std::exit(EXIT_FAILURE);
         return;
     }
 
     //! For testing purpose
-    stop = std::chrono::high_resolution_clock::now();
-    spdlog::debug("1: {} us", std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count());
+    LOG_DEBUG(Log::AGGREGATOR, "1: {} us", std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count());
     // Check data type
     if (type == "data")
     {
         // Perform data name matching with interest name
-        ModelData upstreamModelData;
+        ModelDataView upstreamModelData;
 
-        auto data_agg = map_agg_oldSeq_newName.find(seq);
-        auto data_map = m_agg_newDataName.find(seq);
-        if (data_map != m_agg_newDataName.end() && data_agg != map_agg_oldSeq_newName.end())
+        if (slot != nullptr && slot->started)
         {
             // Aggregation starts
-            auto &vec = data_agg->second;
-            auto vecIt = std::find(vec.begin(), vec.end(), name_sec0);
-            std::vector<uint8_t> oldbuffer(data.getContent().value(), data.getContent().value() + data.getContent().value_size());
-            if (deserializeModelData(oldbuffer, upstreamModelData))
+            const ndn::Block &content = data.getContent();
+            size_t segmentLength = ModelSchema::instance().segmentLength(ModelSchema::instance().segmentOf(seq));
+            if (deserializeModelData(content.value(), content.value_size(), segmentLength, upstreamModelData))
             {
-                if (vecIt != vec.end())
+                if (slot->closed && !slot->HasArrived(flow))
                 {
-                    Aggregate(upstreamModelData, seq);
-                    vec.erase(vecIt);
+                    // Iteration already forwarded without this child, keep the measurements below
+                    LOG_DEBUG(Log::AGGREGATOR, "Iteration {} has been forwarded, drop the late data from {}", seq, state.name);
+                    lateDropped++;
+                }
+                else if (slot->MarkArrived(flow))
+                {
+                    slot->contributors += upstreamModelData.contributors;
+                    if (slot->finished)
+                    {
+                        LOG_DEBUG(Log::AGGREGATOR, "Iteration {} has been forwarded, merge the late data from {}", seq, state.name);
+                        lateMerged++;
+                    }
+                    if (m_reducers)
+                    {
+                        // Workers own the sum until a completion is handled, so every payload from the quorum on asks
+                        // for one and the result is only sent once all of them are back
+                        bool last = slot->finished || IsReady(*slot);
+                        if (last)
+                        {
+                            ++slot->reducing;
+                            slot->closed = m_latePolicy == LatePolicy::DROP;
+                        }
+                        m_reducers->Submit(*slot, content, upstreamModelData, last);
+                    }
+                    else
+                        Aggregate(upstreamModelData, seq);
 
                     //! For testing purpose
-                    stop = std::chrono::high_resolution_clock::now();
-                    spdlog::debug("2: {} us", std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count());
+                    LOG_DEBUG(Log::AGGREGATOR, "2: {} us", std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count());
                 }
                 else
                 {
-                    spdlog::info("Data name doesn't exist in aggMap, meaning this data packet is duplicate from upstream!");
-                    std::exit(EXIT_FAILURE);
+                    // Child's bit is already set, drop the duplicate and keep the aggregation going
+                    spdlog::warn("Data from {} for iteration {} has already been aggregated, drop the duplicate!", state.name, seq);
                     return;
                 }
             }
             else
             {
-                spdlog::info("Error when deserializing data packet, please check!");
+                LOG_INFO(Log::AGGREGATOR, "Error when deserializing data packet, please check!");
                 std::exit(EXIT_FAILURE);
                 return;
             }
 
             // RTT measurement
-            if (rttStartTime.find(dataName) != rttStartTime.end())
+            std::chrono::milliseconds responseTime(0);
+            if (wasPending)
             {
 
                 std::chrono::milliseconds now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
-                responseTime[dataName] = now - rttStartTime[dataName];
-                ResponseTimeSum(std::chrono::duration_cast<std::chrono::microseconds>(responseTime[dataName]).count());
-                spdlog::info("ResponseTime for data packet : {}=> is: {} us", dataName, std::chrono::duration_cast<std::chrono::microseconds>(responseTime[dataName]).count());
+                responseTime = now - pending.sendTime;
+                ResponseTimeSum(std::chrono::duration_cast<std::chrono::microseconds>(responseTime).count());
+                LOG_DEBUG(Log::AGGREGATOR, "ResponseTime for data packet : {}=> is: {} us", dataName, std::chrono::duration_cast<std::chrono::microseconds>(responseTime).count());
             }
 
             // RTO/RTT measure
-            RTOMeasure(name_sec0, std::chrono::duration_cast<std::chrono::microseconds>(responseTime[dataName]).count());
-            RTTMeasure(name_sec0, std::chrono::duration_cast<std::chrono::microseconds>(responseTime[dataName]).count());
+            RTOMeasure(flow, std::chrono::duration_cast<std::chrono::microseconds>(responseTime).count());
+            RTTMeasure(flow, std::chrono::duration_cast<std::chrono::microseconds>(responseTime).count());
 
             //! Debugging, qsf design
             // Update estimated bandwidth
-            BandwidthEstimation(name_sec0, upstreamModelData.qsf);
+            BandwidthEstimation(flow, upstreamModelData.qsf);
 
             // Init rate limit update
-            if (firstData.at(name_sec0))
+            if (state.firstData)
             {
-                spdlog::info("Init rate limit update for flow {}", name_sec0);
+                LOG_DEBUG(Log::AGGREGATOR, "Init rate limit update for flow {}", state.name);
                 // question: is it too late to start?
-                m_rateEvent[name_sec0] = m_scheduler.schedule(ndn::time::microseconds(0), [this, name_sec0]
-                                                              { this->RateLimitUpdate(name_sec0); });
-                firstData[name_sec0] = false;
+                state.rateEvent = m_scheduler.schedule(ndn::time::microseconds(0), [this, flow]
+                                                       { this->RateLimitUpdate(flow); });
+                state.firstData = false;
             }
 
             //! For testing purpose
-            stop = std::chrono::high_resolution_clock::now();
-            spdlog::debug("3: {} us", std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count());
+            LOG_DEBUG(Log::AGGREGATOR, "3: {} us", std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count());
             // Record qsf info
-            QsfRecorder(name_sec0, upstreamModelData.qsf);
-            QueueRecorder(name_sec0, GetDataQueueSize(name_sec0));
+            QsfRecorder(flow, upstreamModelData.qsf);
+            QueueRecorder(flow, GetDataQueueSize(flow));
 
             AggTableRecorder(seq);
 
             // Record RTT
-            ResponseTimeRecorder(responseTime[dataName], seq, name_sec0);
+            ResponseTimeRecorder(responseTime, seq, flow);
 
             // Record RTO
-            RTORecorder(name_sec0);
+            RTORecorder(flow);
 
-            InFlightRecorder(name_sec0);
+            InFlightRecorder(flow);
 
-            // Check whether the aggregation of current iteration is done
-            if (vec.empty())
+            // Check whether the aggregation of current iteration is done, in pipeline mode the reducer reports it
+            if (IsReady(*slot))
             {
-                spdlog::info("Aggregation of iteration {} finished.", seq);
-                // Measure aggregation time
-                if (aggregateStartTime.find(seq) != aggregateStartTime.end())
-                {
-
-                    std::chrono::milliseconds now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
-                    aggregateTime[seq] = now - aggregateStartTime[seq];
-                    AggregateTimeSum(std::chrono::duration_cast<std::chrono::microseconds>(aggregateTime[seq]).count());
-                    aggregateStartTime.erase(seq);
-
-                    spdlog::info("Aggregator's aggregate time of sequence {} is: {} ms", seq, aggregateTime[seq].count());
-                }
-                else
-                {
-                    spdlog::debug("Error when calculating aggregation time, no reference found for seq {}", seq);
-                }
-
-                // Record aggregation time
-                AggregateTimeRecorder(aggregateTime[seq], seq);
-
-                // Send data
-                spdlog::debug("Send data packet after 2 ms.");
-                m_scheduler.schedule(ndn::time::milliseconds(2), [this, seq]
-                                     { this->SendData(seq); });
-
-                // All iterations finished, record the entire throughput
-                if (iterationCount == m_iteNum)
-                {
-
-                    std::chrono::milliseconds now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
-                    stopSimulation = now;
-
-                    // Record throughput and results
-                    ThroughputRecorder(totalInterestThroughput, totalDataThroughput, startSimulation);
-                    ResultRecorder(GetAggregateTimeAverage());
-                }
+                if (!m_reducers)
+                    FinishIteration(*slot);
             }
             else
             {
-                spdlog::debug("Wait for others to aggregate.");
+                LOG_DEBUG(Log::AGGREGATOR, "Wait for others to aggregate.");
             }
-
-            // Clear rtt mapping of this packet
-            rttStartTime.erase(dataName);
-            responseTime.erase(dataName);
         }
         else
         {
-            spdlog::debug("Error, data name can't be recognized!");
+            LOG_DEBUG(Log::AGGREGATOR, "Error, data name can't be recognized!");
             std::exit(EXIT_FAILURE);
             return;
         }
     }
 }
 
-// /**
-//  * Record window when receiving a new packet
-//  */
-void Aggregator::WindowRecorder(std::string prefix)
+/**
+ * Aggregation of an iteration is done, record its aggregation time and send the result downstream
+ * @param slot
+ */
+void Aggregator::FinishIteration(AggregationTable::Slot &slot)
 {
-    // Open file; on first call, truncate it to delete old content
-    std::ofstream file(window_recorder[prefix], std::ios::app);
+    // Merged late data completes an iteration that has already been scheduled
+    if (slot.finished)
+        return;
+    slot.finished = true;
 
-    if (file.is_open())
+    uint32_t seq = slot.seq;
+    LOG_DEBUG(Log::AGGREGATOR, "Aggregation of iteration {} finished.", seq);
+    int64_t sendDelay = 2000; // Unit: us
+    if (!m_aggTable.IsComplete(slot))
+    {
+        partialCount++;
+        LOG_INFO(Log::AGGREGATOR, "Iteration {} is forwarded with {} of {} children", seq, slot.arrivedCount, m_flows.Size());
+        if (m_latePolicy == LatePolicy::DROP)
+        {
+            slot.closed = true;
+            CancelStragglers(slot);
+        }
+        else
+        {
+            // Stragglers' interests stay pending through the grace window, what they bring is folded into the result
+            sendDelay = std::max(sendDelay, static_cast<int64_t>(m_lateGrace * static_cast<double>(MedianSrtt())));
+        }
+    }
+    // Measure aggregation time
+    if (slot.timing)
     {
 
         std::chrono::milliseconds now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
-        file << now.count() << " " << m_window[prefix] << " " << m_ssthresh[prefix] << " " << interestQueue[prefix].size() << std::endl; // Write text followed by a newline
-        file.close();                                                                                                                    // Close the file after writing
+        slot.aggregateTime = now - slot.startTime;
+        AggregateTimeSum(std::chrono::duration_cast<std::chrono::microseconds>(slot.aggregateTime).count());
+        slot.timing = false;
+
+        LOG_DEBUG(Log::AGGREGATOR, "Aggregator's aggregate time of sequence {} is: {} ms", seq, slot.aggregateTime.count());
     }
     else
     {
-        spdlog::error("Unable to open file: {}", window_recorder[prefix]);
+        LOG_DEBUG(Log::AGGREGATOR, "Error when calculating aggregation time, no reference found for seq {}", seq);
     }
-}
 
-/**
- * Record in-flight packets when receiving a new packet
- */
-void Aggregator::InFlightRecorder(std::string prefix)
-{
-    // Open file; on first call, truncate it to delete old content
-    std::ofstream file(inFlight_recorder[prefix], std::ios::app);
+    // Record aggregation time
+    AggregateTimeRecorder(slot.aggregateTime, seq);
 
-    if (file.is_open())
+    // Send data
+    LOG_DEBUG(Log::AGGREGATOR, "Send data packet after {} ms.", sendDelay / 1000.0);
+    m_scheduler.schedule(ndn::time::microseconds(sendDelay), [this, seq]
+                         { this->SendData(seq); });
+
+    // All iterations finished, record the entire throughput. Segments are aggregated on their own, iterationCount counts them
+    if (iterationCount == m_lastSeq)
     {
 
         std::chrono::milliseconds now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
-        file << now.count() << " " << m_inFlight[prefix] << std::endl; // Write text followed by a newline
-        file.close();                                                  // Close the file after writing
+        stopSimulation = now;
+
+        // Record throughput and results
+        ThroughputRecorder(totalInterestThroughput, totalDataThroughput, startSimulation);
+        ResultRecorder(GetAggregateTimeAverage());
     }
-    else
+}
+
+/**
+ * Posted by the reducer pool once the last data of an iteration has been reduced
+ * @param seq
+ */
+void Aggregator::OnIterationReduced(uint32_t seq)
+{
+    AggregationTable::Slot *slot = m_aggTable.Find(seq);
+    if (slot == nullptr)
     {
-        std::cerr << "Unable to open file: " << inFlight_recorder[prefix] << std::endl;
+        spdlog::error("Iteration {} was reduced but is not in the aggregation table!", seq);
+        return;
     }
+    if (slot->reducing > 0)
+        --slot->reducing;
+    if (!slot->finished)
+        FinishIteration(*slot);
+    else if (slot->sendDue && slot->reducing == 0)
+        SendData(seq);
+}
+
+bool Aggregator::IsReady(const AggregationTable::Slot &slot) const
+{
+    return m_aggTable.IsQuorate(slot) || (slot.overdue && slot.arrivedCount > 0);
 }
 
 /**
- * Record the response time for each returned packet, store them in a file
- * @param responseTime
+ * Deadline of an iteration whose interests have just been sent upstream, derived from the children's median SRTT
+ * so that one slow child doesn't hold the iteration back
+ * @param seq
  */
-void Aggregator::ResponseTimeRecorder(std::chrono::milliseconds responseTime, uint32_t seq, std::string prefix)
+void Aggregator::ArmIterationDeadline(uint32_t seq)
 {
-    // Open the file using fstream in append mode
-    std::ofstream file(responseTime_recorder[prefix], std::ios::app);
+    if (m_partialDeadline <= 0)
+        return;
 
-    if (!file.is_open())
-    {
-        std::cerr << "Failed to open the file: " << responseTime_recorder[prefix] << std::endl;
+    // No RTT sample yet, wait for every child
+    int64_t median = MedianSrtt();
+    if (median == 0)
         return;
+
+    auto deadline = static_cast<int64_t>(m_partialDeadline * static_cast<double>(median)); // Unit: us
+    LOG_DEBUG(Log::AGGREGATOR, "Iteration {}'s deadline is {} ms", seq, deadline / 1000.0);
+    m_scheduler.schedule(ndn::time::microseconds(deadline), [this, seq]
+                         { this->OnIterationDeadline(seq); });
+}
+
+int64_t Aggregator::MedianSrtt() const
+{
+    std::vector<int64_t> srtts;
+    srtts.reserve(m_flows.Size());
+    for (const FlowState &state : m_flows)
+    {
+        if (state.srtt > 0)
+            srtts.push_back(state.srtt);
     }
+    if (srtts.empty())
+        return 0;
 
-    // Write the response_time to the file, followed by a newline
+    auto median = srtts.begin() + srtts.size() / 2;
+    std::nth_element(srtts.begin(), median, srtts.end());
+    return *median;
+}
 
-    std::chrono::milliseconds now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
-    file << now.count() << " " << seq << " " << responseTime.count() / 1000 << std::endl;
+/**
+ * @param seq
+ */
+void Aggregator::OnIterationDeadline(uint32_t seq)
+{
+    AggregationTable::Slot *slot = m_aggTable.Find(seq);
+    if (slot == nullptr || slot->finished || slot->closed)
+        return;
 
-    // Close the file
-    file.close();
+    // Without any child the next arrival forwards the iteration
+    slot->overdue = true;
+    if (!IsReady(*slot))
+        return;
+
+    LOG_DEBUG(Log::AGGREGATOR, "Iteration {}'s deadline expired with {} of {} children", seq, slot->arrivedCount, m_flows.Size());
+    if (m_reducers)
+    {
+        slot->closed = m_latePolicy == LatePolicy::DROP;
+        ++slot->reducing;
+        m_reducers->Flush(*slot);
+    }
+    else
+    {
+        FinishIteration(*slot);
+    }
 }
 
 /**
- * Record RTO when receiving data packet
- * @param prefix
+ * @param slot
  */
-void Aggregator::RTORecorder(std::string prefix)
+void Aggregator::CancelStragglers(AggregationTable::Slot &slot)
 {
-    // Open the file using fstream in append mode
-    std::ofstream file(RTO_recorder[prefix], std::ios::app);
+    for (FlowId flow = 0; flow < m_flows.Size(); ++flow)
+    {
+        if (slot.HasArrived(flow))
+            continue;
+        FlowState &state = m_flows[flow];
 
-    if (!file.is_open())
+        // Not requested yet
+        auto it = std::find(state.interestQueue.begin(), state.interestQueue.end(), slot.seq);
+        if (it != state.interestQueue.end())
+        {
+            state.interestQueue.erase(it);
+            if (slot.seq == m_lastSeq)
+                m_pacer.Stop(flow);
+        }
+
+        // Outstanding
+        TimerWheel::Key key = TimerWheel::MakeKey(flow, slot.seq);
+        m_timeouts.Cancel(key);
+        PendingInterest pending;
+        if (m_pit.Erase(key, &pending))
+        {
+            pending.handle.cancel();
+            if (state.inFlight > 0)
+                state.inFlight--;
+        }
+    }
+}
+
+// /**
+//  * Record window when receiving a new packet
+//  */
+void Aggregator::WindowRecorder(FlowId flow)
+{
+    FlowState &state = m_flows[flow];
+    // Open file; on first call, truncate it to delete old content
+    std::ofstream file(state.windowRecorder, std::ios::app);
+
+    if (file.is_open())
     {
-        std::cerr << "Failed to open the file: " << RTO_recorder[prefix] << std::endl;
-        return;
+
+        std::chrono::milliseconds now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
+        file << now.count() << " " << state.window << " " << state.ssthresh << " " << state.interestQueue.size() << std::endl; // Write text followed by a newline
+        file.close();                                                                                                                    // Close the file after writing
+    }
+    else
+    {
+        spdlog::error("Unable to open file: {}", state.windowRecorder);
     }
+}
 
-    // Write the response_time to the file, followed by a newline
+/**
+ * Record in-flight packets when receiving a new packet
+ */
+void Aggregator::InFlightRecorder(FlowId flow)
+{
+    FlowState &state = m_flows[flow];
+    std::chrono::milliseconds now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
+    Telemetry::Instance().Record(state.inFlightStream, flow, now.count(), {static_cast<double>(state.inFlight)});
+}
 
+/**
+ * Record the response time for each returned packet, store them in a file
+ * @param responseTime
+ */
+void Aggregator::ResponseTimeRecorder(std::chrono::milliseconds responseTime, uint32_t seq, FlowId flow)
+{
+    FlowState &state = m_flows[flow];
     std::chrono::milliseconds now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
-    file << now.count() << " " << RTO_threshold[prefix].count() / 1000 << std::endl;
+    Telemetry::Instance().Record(state.responseTimeStream, flow, now.count(),
+                                 {static_cast<double>(seq), static_cast<double>(responseTime.count() / 1000)});
+}
 
-    // Close the file
-    file.close();
+/**
+ * Record RTO when receiving data packet
+ * @param flow
+ */
+void Aggregator::RTORecorder(FlowId flow)
+{
+    FlowState &state = m_flows[flow];
+    std::chrono::milliseconds now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
+    Telemetry::Instance().Record(state.rtoStream, flow, now.count(), {static_cast<double>(state.rtoThreshold.count() / 1000)});
 }
 
 /**
@@ -1460,21 +1743,9 @@ void Aggregator::RTORecorder(std::string prefix)
  */
 void Aggregator::AggregateTimeRecorder(std::chrono::milliseconds aggregateTime, uint32_t seq)
 {
-    // Open the file using fstream in append mode
-    std::ofstream file(aggregateTime_recorder, std::ios::app);
-
-    if (!file.is_open())
-    {
-        std::cerr << "Failed to open the file: " << aggregateTime_recorder << std::endl;
-        return;
-    }
-
-    // Write aggregation time to file, followed by a new line
-
     std::chrono::milliseconds now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
-    file << now.count() << " " << seq << " " << aggregateTime.count() / 1000 << std::endl;
-
-    file.close();
+    Telemetry::Instance().Record(aggregateTimeStream, INVALID_FLOW, now.count(),
+                                 {static_cast<double>(seq), static_cast<double>(aggregateTime.count() / 1000)});
 }
 
 /**
@@ -1485,29 +1756,33 @@ void Aggregator::InitializeLogFile()
     // Check whether the object path exists, if not, create it first
     CheckDirectoryExist(folderPath);
 
-    // Open the file and clear all contents for all log files
+    // Samples are recorded to a binary telemetry log, telemetry-convert writes the text files below from it
+    Telemetry &telemetry = Telemetry::Instance();
+    telemetry.Open(folderPath + m_prefix.toUri() + "_telemetry.bin");
+
     // Initialize file name for different upstream node, meaning that RTT/cwnd is measured per flow
-    for (const auto &[child, leaves] : aggregationMap)
-    {
-        RTO_recorder[child] = folderPath + m_prefix.toUri() + "_RTO_" + child + ".txt";
-        responseTime_recorder[child] = folderPath + m_prefix.toUri() + "_RTT_" + child + ".txt";
-        // window_recorder[child] = folderPath + m_prefix.toUri() + "_window_" + child + ".txt";
-        inFlight_recorder[child] = folderPath + m_prefix.toUri() + "_inFlight_" + child + ".txt";
-        qsf_recorder[child] = folderPath + m_prefix.toUri() + "_qsf_" + child + ".txt";
-        qsNew_recorder[child] = folderPath + m_prefix.toUri() + "_queue_" + child + ".txt";
-        OpenFile(RTO_recorder[child]);
-        OpenFile(responseTime_recorder[child]);
-        // OpenFile(window_recorder[child]);
-        OpenFile(inFlight_recorder[child]);
-        OpenFile(qsf_recorder[child]);
-        OpenFile(qsNew_recorder[child]);
+    for (FlowState &state : m_flows)
+    {
+        const std::string &child = state.name;
+        state.rtoRecorder = folderPath + m_prefix.toUri() + "_RTO_" + child + ".txt";
+        state.responseTimeRecorder = folderPath + m_prefix.toUri() + "_RTT_" + child + ".txt";
+        // state.windowRecorder = folderPath + m_prefix.toUri() + "_window_" + child + ".txt";
+        state.inFlightRecorder = folderPath + m_prefix.toUri() + "_inFlight_" + child + ".txt";
+        state.qsfRecorder = folderPath + m_prefix.toUri() + "_qsf_" + child + ".txt";
+        state.queueRecorder = folderPath + m_prefix.toUri() + "_queue_" + child + ".txt";
+        state.rtoStream = telemetry.RegisterStream(state.rtoRecorder, "i");
+        state.responseTimeStream = telemetry.RegisterStream(state.responseTimeRecorder, "ii");
+        // OpenFile(state.windowRecorder);
+        state.inFlightStream = telemetry.RegisterStream(state.inFlightRecorder, "i");
+        state.qsfStream = telemetry.RegisterStream(state.qsfRecorder, "fffffiii", true);
+        state.queueStream = telemetry.RegisterStream(state.queueRecorder, "ffffii", true);
     }
 
     // Initialize log file for aggregate time
     aggregateTime_recorder = folderPath + m_prefix.toUri() + "_aggregationTime.txt";
-    OpenFile(aggregateTime_recorder);
+    aggregateTimeStream = telemetry.RegisterStream(aggregateTime_recorder, "ii");
     aggTable_recorder = folderPath + m_prefix.toUri() + "_aggTable_.txt";
-    OpenFile(aggTable_recorder);
+    aggTableStream = telemetry.RegisterStream(aggTable_recorder, "iii");
 }
 
 /**
@@ -1517,43 +1792,73 @@ void Aggregator::InitializeLogFile()
 void Aggregator::InitializeParameters()
 {
     // Initialize window
-    for (const auto &[key, value] : aggregationMap)
+    for (FlowState &state : m_flows)
     {
-        m_window[key] = m_initialWindow;
-        m_inFlight[key] = 0;
-        m_ssthresh[key] = std::numeric_limits<double>::max();
-        // successiveCongestion[key] = 0;
+        state.window = m_initialWindow;
+        state.inFlight = 0;
+        state.ssthresh = std::numeric_limits<double>::max();
+        // state.successiveCongestion = 0;
 
         // Initialize RTO measurement parameters
-        SRTT[key] = 0;
-        RTTVAR[key] = 0;
-        roundRTT[key] = 0;
+        state.srtt = 0;
+        state.rttvar = 0;
+        state.roundRTT = 0;
 
         // Initialize CUBIC factor
-        m_cubicLastWmax[key] = m_initialWindow;
-        m_cubicWmax[key] = m_initialWindow;
+        state.cubicLastWmax = m_initialWindow;
+        state.cubicWmax = m_initialWindow;
 
         std::chrono::milliseconds now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
-        lastWindowDecreaseTime[key] = now;
-        RTT_historical_estimation[key] = 0; //! Re-initialize this RTT-estimation, what's the correct way?
-        RTT_count[key] = 0;
+        state.lastWindowDecreaseTime = now;
+        state.rttWindow = WindowedSum<int64_t, RTT_WINDOW_CAPACITY>(m_smooth_window_size);
+        state.rttHistorical = Ewma(m_EWMAFactor); //! Re-initialize this RTT-estimation, what's the correct way?
+        state.rttMin.Clear();
+        state.rttTail.Clear();
+        state.rttCount = 0;
 
         // Initialize timeout checking
-        RTO_threshold[key] = 5 * m_retxTimer;
+        state.rtoThreshold = 5 * m_retxTimer;
 
         // Initialize seq
-        SeqMap[key] = 0;
+        state.seq = 0;
 
         //! Debugging - Initialize qsf info
-        m_qsfSlidingWindows[key] = SlidingWindow<double>(std::chrono::milliseconds(m_qsfTimeDuration));
-        m_estimatedBW[key] = m_qsfInitRate;
-        m_rateLimit[key] = m_qsfInitRate;
-        firstData[key] = true;
-        // m_rateEvent[key] = Simulator::ScheduleNow(&Aggregator::RateLimitUpdate, this, key);
+        state.qsfSlidingWindow = SlidingWindow<double>(std::chrono::milliseconds(m_qsfTimeDuration));
+        state.estimatedBW = m_qsfInitRate;
+        state.rateLimit = m_qsfInitRate;
+        state.firstData = true;
+        // state.rateEvent = Simulator::ScheduleNow(&Aggregator::RateLimitUpdate, this, flow);
         // Difference : add a new schedule here
-        // m_rateEvent[key] = m_scheduler.schedule(ndn::time::milliseconds(0), [this, key]
-        //                                         { this->RateLimitUpdate(key); });
-        RTT_estimation_qsf[key] = 0; // Init rtt estimation as 0
+        // state.rateEvent = m_scheduler.schedule(ndn::time::milliseconds(0), [this, flow]
+        //                                         { this->RateLimitUpdate(flow); });
+        state.rttEstimationQsf = 0; // Init rtt estimation as 0
+    }
+
+    // Workers may still hold slots of the previous run, finish them before the table is reset
+    m_reducers.reset();
+
+    // Preallocate the aggregation table for all iterations that can be in progress at once
+    m_aggTable.Reset(m_aggTableSize, m_dataSize, m_flows.Size(), std::max(m_partialQuorum, 0));
+    if (m_aggTable.Quorum() < m_flows.Size() || m_partialDeadline > 0)
+        spdlog::info("Partial aggregation: quorum {} of {} children, deadline {} x median SRTT, {} late data",
+                     m_aggTable.Quorum(), m_flows.Size(), m_partialDeadline,
+                     m_latePolicy == LatePolicy::DROP ? "drop" : fmt::format("merge within {} x median SRTT of", m_lateGrace));
+
+    // At most one interest per child and iteration in progress, keep the table at most half full
+    m_pit.Reset(2 * m_aggTable.Capacity() * m_flows.Size());
+
+    // One token bucket per child, refilled at its QSF rate limit
+    m_pacer.Reset(m_flows.Size(), m_pacerTick, m_pacerBurst);
+    for (FlowId flow = 0; flow < m_flows.Size(); ++flow)
+        m_pacer.SetRate(flow, m_flows[flow].rateLimit);
+
+    // Pipeline mode: decode and reduce on worker threads, completions come back to the io thread
+    if (m_reducerThreads > 0)
+    {
+        m_reducers = std::make_unique<ReducerPool>(m_reducerThreads, [this](uint32_t seq)
+                                                   { boost::asio::post(m_face.getIoContext(), [this, seq]
+                                                                       { this->OnIterationReduced(seq); }); });
+        spdlog::info("Aggregator reduces upstream data on {} threads", m_reducers->ThreadCount());
     }
 
     // Init params for interest sending rate pacing
@@ -1565,11 +1870,12 @@ void Aggregator::InitializeParameters()
 //  * Check whether the cwnd has been decreased within the last RTT duration
 //  * @param threshold
 //  */
-bool Aggregator::CanDecreaseWindow(std::string prefix, int64_t threshold)
+bool Aggregator::CanDecreaseWindow(FlowId flow, int64_t threshold)
 {
+    FlowState &state = m_flows[flow];
 
     std::chrono::milliseconds now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
-    if (now.count() - lastWindowDecreaseTime[prefix].count() > threshold)
+    if (now.count() - state.lastWindowDecreaseTime.count() > threshold)
     {
         return true;
     }
@@ -1605,21 +1911,10 @@ void Aggregator::ThroughputRecorder(int interestThroughput, int dataThroughput,
 
 void Aggregator::AggTableRecorder(uint32_t seq)
 {
-    // Open the file using fstream in append mode
-    std::ofstream file(aggTable_recorder, std::ios::app);
-
-    if (!file.is_open())
-    {
-        std::cerr << "Failed to open the file: " << aggTable_recorder << std::endl;
-        return;
-    }
-
-    // Write aggregation time to file, followed by a new line
-
     std::chrono::milliseconds now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
-    file << now.count() << " " << seq << " " << partialAggResult.size() << " " << sumParameters.size() << std::endl;
-
-    file.close();
+    // Iterations holding partial results and iterations in progress, the former partialAggResult and sumParameters sizes
+    Telemetry::Instance().Record(aggTableStream, INVALID_FLOW, now.count(),
+                                 {static_cast<double>(seq), static_cast<double>(m_aggTable.DataCount()), static_cast<double>(m_aggTable.InUseCount())});
 }
 
 /**
@@ -1642,8 +1937,24 @@ void Aggregator::ResultRecorder(int64_t aveAggTime)
     file << "The number of downstream duplicate interest retransmission is " << downstreamRetxCount << " times" << std::endl;
     file << "Interest queue overflow is triggered for " << interestOverflow << " times" << std::endl;
     file << "Data queue overflow is triggered for " << dataOverflow << " times" << std::endl;
+    file << "Iterations forwarded without every child: " << partialCount << ", late data dropped: " << lateDropped << ", late data merged: " << lateMerged << std::endl;
     file << "Nack(upstream interest queue overflow) is triggered for " << nackCount << " times" << std::endl;
     file << "Average aggregation time: " << aveAggTime / 1000 << " ms" << std::endl;
+    const SigningPolicy::Stats &signing = m_signing.GetStats();
+    file << "Signing (" << signingModeName(m_signing.Mode()) << "): " << signing.keySigned << " key signed, " << signing.digestSigned
+         << " digest signed, " << signing.manifests << " manifests, " << signing.rejected << " rejected, " << signing.held << " held, " << signing.unmatched << " unmatched" << std::endl;
+    for (FlowId flow = 0; flow < m_flows.Size(); ++flow)
+    {
+        const Pacer::Stats &stats = m_pacer.GetStats(flow);
+        file << "Flow " << m_flows.Name(flow) << " pacing: " << stats.released << " interests sent, " << stats.expected
+             << " allowed by the rate limit (error " << stats.Error() << "), max batch " << stats.maxBatch << std::endl;
+        const FlowState &state = m_flows[flow];
+        if (!state.rttMin.Empty())
+        {
+            file << "Flow " << m_flows.Name(flow) << " RTT: min " << state.rttMin.Value() << " us (last " << RTT_MIN_WINDOW
+                 << " samples), p95 " << static_cast<int64_t>(state.rttTail.Value()) << " us, historical " << static_cast<int64_t>(state.rttHistorical.Value()) << " us" << std::endl;
+        }
+    }
     file << "-----------------------------------" << std::endl;
 }
 
@@ -1651,90 +1962,59 @@ void Aggregator::ResultRecorder(int64_t aveAggTime)
  * Record qsf congestion info
  * Note that all rate and time is parsed from "us" into "ms"
  */
-void Aggregator::QsfRecorder(std::string prefix, double qsf)
+void Aggregator::QsfRecorder(FlowId flow, double qsf)
 {
-    // Open the file using fstream in append mode
-    std::ofstream file(qsf_recorder[prefix], std::ios::app);
-
-    if (!file.is_open())
-    {
-        std::cerr << "Failed to open the file: " << qsf_recorder[prefix] << std::endl;
-        return;
-    }
-
-    double actualQsf;
-    if (qsf == -1)
-    {
-        actualQsf = static_cast<double>(std::max(interestQueue[prefix].size(), partialAggResult.size()));
-    }
-    else
-    {
-        actualQsf = qsf;
-    }
+    FlowState &state = m_flows[flow];
+    double localQueue = static_cast<double>(std::max(state.interestQueue.size(), m_aggTable.DataCount()));
+    double actualQsf = qsf == -1 ? localQueue : qsf;
 
     // Unit: ms or pkgs/ms
     // time - rate limit - BW - throughput(data arrival rate) - qsf - local queue size(larger one between interest/data queue) - interest queue size - data queue size - rtt estimation
-
     std::chrono::milliseconds now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
-    file << now.count() << " "
-         << m_rateLimit[prefix] * 1000 << " "
-         << m_estimatedBW[prefix] * 1000 << " "
-         << GetDataRate(prefix) * 1000 << " "
-         << actualQsf << " "
-         << static_cast<double>(std::max(interestQueue[prefix].size(), partialAggResult.size())) << " "
-         << interestQueue[prefix].size() << " "
-         << partialAggResult.size() << " "
-         << static_cast<int64_t>(RTT_estimation_qsf[prefix] / 1000) << " "
-         << std::endl;
-
-    file.close();
+    Telemetry::Instance().Record(state.qsfStream, flow, now.count(),
+                                 {state.rateLimit * 1000,
+                                  state.estimatedBW * 1000,
+                                  GetDataRate(flow) * 1000,
+                                  actualQsf,
+                                  localQueue,
+                                  static_cast<double>(state.interestQueue.size()),
+                                  static_cast<double>(m_aggTable.DataCount()),
+                                  static_cast<double>(state.rttEstimationQsf / 1000)});
 }
 
 /**
  * Record queue size based CC info
  */
-void Aggregator::QueueRecorder(std::string prefix, double queueSize)
+void Aggregator::QueueRecorder(FlowId flow, double queueSize)
 {
-    // Open the file using fstream in append mode
-    std::ofstream file(qsNew_recorder[prefix], std::ios::app);
-
-    if (!file.is_open())
-    {
-        std::cerr << "Failed to open the file: " << qsNew_recorder[prefix] << std::endl;
-        return;
-    }
-
-    // Write the response_time to the file, followed by a newline
-
+    FlowState &state = m_flows[flow];
+    // time - rate limit - BW - throughput(data arrival rate) - queue size - in-flight - rtt estimation
     std::chrono::milliseconds now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
-    file << now.count() << " "
-         << m_rateLimit[prefix] * 1000 << " "
-         << m_estimatedBW[prefix] * 1000 << " "
-         << GetDataRate(prefix) * 1000 << " "
-         << queueSize << " "
-         << m_inFlight[prefix] << " "
-         << RTT_estimation_qsf[prefix] / 1000 << " "
-         << std::endl;
-
-    // Close the file
-    file.close();
+    Telemetry::Instance().Record(state.queueStream, flow, now.count(),
+                                 {state.rateLimit * 1000,
+                                  state.estimatedBW * 1000,
+                                  GetDataRate(flow) * 1000,
+                                  queueSize,
+                                  static_cast<double>(state.inFlight),
+                                  static_cast<double>(state.rttEstimationQsf / 1000)});
 }
 
 /**
  * Based on returned data, update rtt estimation
- * @param prefix
+ * @param flow
  * @param resTime unit - us
  */
-void Aggregator::RTTMeasure(std::string prefix, int64_t resTime)
+void Aggregator::RTTMeasure(FlowId flow, int64_t resTime)
 {
+    FlowState &state = m_flows[flow];
     // Update RTT estimation
-    if (RTT_estimation_qsf[prefix] == 0)
+    if (state.rttEstimationQsf == 0)
     {
-        RTT_estimation_qsf[prefix] = resTime;
+        state.rttEstimationQsf = resTime;
     }
     else
     {
-        RTT_estimation_qsf[prefix] = m_EWMAFactor * RTT_estimation_qsf[prefix] + (1 - m_EWMAFactor) * resTime;
+        state.rttEstimationQsf = m_EWMAFactor * state.rttEstimationQsf + (1 - m_EWMAFactor) * resTime;
     }
 }
 
@@ -1742,20 +2022,21 @@ void Aggregator::RTTMeasure(std::string prefix, int64_t resTime)
  * Get the data rate and return with correct value from the sliding window
  */
 double
-Aggregator::GetDataRate(std::string prefix)
+Aggregator::GetDataRate(FlowId flow)
 {
-    double rawDataRate = m_qsfSlidingWindows[prefix].GetDataArrivalRate();
+    FlowState &state = m_flows[flow];
+    double rawDataRate = state.qsfSlidingWindow.GetDataArrivalRate();
 
     // "0": sliding window size is less than one, keep init rate as data arrival rate; "-1" indicates error
     if (rawDataRate == -1)
     {
-        spdlog::info("Returned data arrival rate is -1, please check!");
+        LOG_INFO(Log::AGGREGATOR, "Returned data arrival rate is -1, please check!");
         std::exit(EXIT_FAILURE);
         return 0;
     }
     else if (rawDataRate == 0)
     {
-        spdlog::info("Sliding window is not enough, data arrival rate is corrected as init rate: {} pkgs/ms", m_qsfInitRate * 1000);
+        LOG_INFO(Log::AGGREGATOR, "Sliding window is not enough, data arrival rate is corrected as init rate: {} pkgs/ms", m_qsfInitRate * 1000);
         return m_qsfInitRate;
     }
     else
@@ -1766,11 +2047,12 @@ Aggregator::GetDataRate(std::string prefix)
 
 /**
  * Bandwidth estimation
- * @param prefix flow
+ * @param flow flow
  * @param dataArrivalRate data arrival rate
  */
-void Aggregator::BandwidthEstimation(std::string prefix, double qsfUpstream)
+void Aggregator::BandwidthEstimation(FlowId flow, double qsfUpstream)
 {
+    FlowState &state = m_flows[flow];
 
     std::chrono::milliseconds now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
     std::chrono::milliseconds arrivalTime = now;
@@ -1778,19 +2060,19 @@ void Aggregator::BandwidthEstimation(std::string prefix, double qsfUpstream)
     if (qsfUpstream == -1)
     {
         // Aggregator which connects to producers directly
-        double localQueue = static_cast<double>(std::max(interestQueue[prefix].size(), sumParameters.size()));
-        spdlog::info("Use local queue size as qsf: {}", localQueue);
-        m_qsfSlidingWindows[prefix].AddPacket(arrivalTime, localQueue);
+        double localQueue = static_cast<double>(std::max(state.interestQueue.size(), m_aggTable.DataCount()));
+        LOG_DEBUG(Log::AGGREGATOR, "Use local queue size as qsf: {}", localQueue);
+        state.qsfSlidingWindow.AddPacket(arrivalTime, localQueue);
     }
     else
     {
         // Other aggregators
-        spdlog::info("Upstream qsf: {}", qsfUpstream);
-        m_qsfSlidingWindows[prefix].AddPacket(arrivalTime, qsfUpstream);
+        LOG_DEBUG(Log::AGGREGATOR, "Upstream qsf: {}", qsfUpstream);
+        state.qsfSlidingWindow.AddPacket(arrivalTime, qsfUpstream);
     }
 
-    double aveQSF = m_qsfSlidingWindows[prefix].GetAverageQsf();
-    double dataArrivalRate = GetDataRate(prefix);
+    double aveQSF = state.qsfSlidingWindow.GetAverageQsf();
+    double dataArrivalRate = GetDataRate(flow);
 
     // Error handling
     if (aveQSF == -1)
@@ -1803,55 +2085,57 @@ void Aggregator::BandwidthEstimation(std::string prefix, double qsfUpstream)
     // Update bandwidth estimation
     if (aveQSF > m_qsfQueueThreshold)
     {
-        m_estimatedBW[prefix] = dataArrivalRate;
+        state.estimatedBW = dataArrivalRate;
     }
-    if (dataArrivalRate > m_estimatedBW[prefix])
+    if (dataArrivalRate > state.estimatedBW)
     {
-        m_estimatedBW[prefix] = dataArrivalRate;
+        state.estimatedBW = dataArrivalRate;
     }
 
-    spdlog::info("Flow: {} - Average QSF: {}, Arrival Rate: {} pkgs/ms, Bandwidth estimation: {} pkgs/ms", prefix, aveQSF, dataArrivalRate * 1000, m_estimatedBW[prefix] * 1000);
+    LOG_DEBUG(Log::AGGREGATOR, "Flow: {} - Average QSF: {}, Arrival Rate: {} pkgs/ms, Bandwidth estimation: {} pkgs/ms", state.name, aveQSF, dataArrivalRate * 1000, state.estimatedBW * 1000);
 }
 
 /**
  * Update each flow's rate limit.
  */
-void Aggregator::RateLimitUpdate(std::string prefix)
+void Aggregator::RateLimitUpdate(FlowId flow)
 {
-    double qsf = m_qsfSlidingWindows[prefix].GetAverageQsf();
-    spdlog::info("Flow {} - qsf: {}", prefix, qsf);
+    FlowState &state = m_flows[flow];
+    double qsf = state.qsfSlidingWindow.GetAverageQsf();
+    LOG_DEBUG(Log::AGGREGATOR, "Flow {} - qsf: {}", state.name, qsf);
 
     // Congestion control
     if (qsf > 2 * m_qsfQueueThreshold)
     {
-        m_rateLimit[prefix] = m_estimatedBW[prefix] * m_qsfMDFactor;
-        spdlog::info("Congestion detected. Update rate limit: {} pkgs/ms", m_rateLimit[prefix] * 1000);
+        state.rateLimit = state.estimatedBW * m_qsfMDFactor;
+        LOG_DEBUG(Log::AGGREGATOR, "Congestion detected. Update rate limit: {} pkgs/ms", state.rateLimit * 1000);
     }
     else
     {
-        m_rateLimit[prefix] = m_estimatedBW[prefix];
-        spdlog::info("No congestion. Update rate limit by estimated BW: {} pkgs/ms", m_rateLimit[prefix] * 1000);
+        state.rateLimit = state.estimatedBW;
+        LOG_DEBUG(Log::AGGREGATOR, "No congestion. Update rate limit by estimated BW: {} pkgs/ms", state.rateLimit * 1000);
     }
 
     // Rate probing
     if (qsf < m_qsfQueueThreshold)
     {
-        m_rateLimit[prefix] = m_rateLimit[prefix] * m_qsfRPFactor;
-        spdlog::info("Start rate probing. Updated rate limit: {} pkgs/ms", m_rateLimit[prefix] * 1000);
+        state.rateLimit = state.rateLimit * m_qsfRPFactor;
+        LOG_DEBUG(Log::AGGREGATOR, "Start rate probing. Updated rate limit: {} pkgs/ms", state.rateLimit * 1000);
     }
+    m_pacer.SetRate(flow, state.rateLimit);
 
     // Error handling
-    if (RTT_estimation_qsf[prefix] == 0)
+    if (state.rttEstimationQsf == 0)
     {
-        spdlog::info("RTT estimation is 0, please check!");
+        LOG_INFO(Log::AGGREGATOR, "RTT estimation is 0, please check!");
         std::exit(EXIT_FAILURE);
         return;
     }
 
-    spdlog::info("Flow {} - Schedule next rate limit update after {} ms", prefix, RTT_estimation_qsf[prefix] / 1000);
+    LOG_DEBUG(Log::AGGREGATOR, "Flow {} - Schedule next rate limit update after {} ms", state.name, state.rttEstimationQsf / 1000);
     // waiting for modification
-    m_rateEvent[prefix] = m_scheduler.schedule(ndn::time::microseconds(RTT_estimation_qsf[prefix]), [this, prefix]
-                                               { this->RateLimitUpdate(prefix); });
+    state.rateEvent = m_scheduler.schedule(ndn::time::microseconds(state.rttEstimationQsf), [this, flow]
+                                           { this->RateLimitUpdate(flow); });
 }
 
 int main(int argc, char *argv[])
@@ -22,10 +22,29 @@
 #include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index/member.hpp>
 #include <boost/circular_buffer.hpp>
+#include <boost/asio/post.hpp>
 #include "sliding_window.hpp"
+#include "aggregation_table.hpp"
+#include "flow_table.hpp"
+#include "timer_wheel.hpp"
+#include "pending_interest_table.hpp"
+#include "reducer_pool.hpp"
+#include "pacer.hpp"
+#include "aggregation_subtree.hpp"
+#include "signing_policy.hpp"
 #include "ndn-cxx/lp/nack-header.hpp"
 #include "ndn-app.hpp"
 #include "ModelData.hpp"
+#include "kernels/reduce.hpp"
+
+/**
+ * Handling of a child's data that arrives after its iteration has been forwarded partially
+ */
+enum class LatePolicy
+{
+    MERGE, // Aggregate it within a grace window after the iteration is forwarded, the result is sent at its end
+    DROP   // Stop aggregating as soon as the iteration is forwarded
+};
 
 class Aggregator : public App
 {
@@ -71,16 +90,28 @@ public:
     virtual void OnTimeout(const ndn::Interest &interest);
 
     /**
-     * @brief Schedule the next packet to be sent
+     * @brief Release the interests every flow's rate limit allows since the last tick, then schedule the next tick
+     */
+    void PacerTick();
+
+    /**
+     * @brief Send the next interest of flow, called by the pacer once per token
+     * @return False if the flow has nothing to send right now
      */
-    virtual void ScheduleNextPacket(std::string prefix);
+    virtual bool ReleasePacket(FlowId flow);
     void InterestSplitting(uint32_t seq);
     void InterestGenerator();
 
+    /**
+     * @brief Swap replaced children for their replacements after the consumer repaired the tree
+     * @return False if the subtree changed in any other way
+     */
+    bool ReplaceChildren(const std::map<std::string, std::vector<std::string>> &children);
+
     /**
      * @brief Send a packet
      */
-    void SendPacket(std::string prefix);
+    void SendPacket(FlowId flow);
 
     /**
      * @brief Send an Interest packet
@@ -102,13 +133,13 @@ public:
      * @return The current window size
      */
     uint32_t GetWindow() const;
-    double GetDataRate(std::string prefix);
+    double GetDataRate(FlowId flow);
 
-    void BandwidthEstimation(std::string prefix, double qsfUpstream);
+    void BandwidthEstimation(FlowId flow, double qsfUpstream);
 
-    void RateLimitUpdate(std::string prefix);
+    void RateLimitUpdate(FlowId flow);
     void AggTableRecorder(uint32_t seq);
-    void InFlightRecorder(std::string prefix);
+    void InFlightRecorder(FlowId flow);
     /**
      * @brief Set the maximum sequence number
      * @param seqMax The maximum sequence number
@@ -124,16 +155,16 @@ public:
     /**
      * @brief Increase the window size
      */
-    void WindowIncrease(std::string prefix);
+    void WindowIncrease(FlowId flow);
 
     /**
      * @brief Decrease the window size
      * @param type The type of decrease (e.g., congestion)
      */
-    void WindowDecrease(std::string prefix, std::string type);
+    void WindowDecrease(FlowId flow, std::string type);
 
-    void CubicIncerase(std::string prefix);
-    void CubicDecrease(std::string prefix, std::string type);
+    void CubicIncerase(FlowId flow);
+    void CubicDecrease(FlowId flow, std::string type);
 
     /**
      * @brief Aggregate data
@@ -142,6 +173,13 @@ public:
      */
     void Aggregate(const ModelData &data, const uint32_t &seq);
 
+    /**
+     * @brief Aggregate data straight from the received packet's content, without decoding into ModelData
+     * @param data View over the upstream Data content
+     * @param seq The sequence number
+     */
+    void Aggregate(const ModelDataView &data, const uint32_t &seq);
+
     /**
      * @brief Get the mean of the aggregated data
      * @param seq The sequence number
@@ -149,6 +187,47 @@ public:
      */
     ModelData GetMean(const uint32_t &seq);
 
+    /**
+     * @brief Every child's data of the iteration has been aggregated: record the aggregation time, schedule the result
+     * @param slot The iteration's slot
+     */
+    void FinishIteration(AggregationTable::Slot &slot);
+
+    /**
+     * @brief Io thread side of a reducer pool completion
+     * @param seq The sequence number
+     */
+    void OnIterationReduced(uint32_t seq);
+
+    /**
+     * @brief Whether the iteration can be forwarded: every child, the quorum, or anything once the deadline passed
+     * @param slot The iteration's slot
+     */
+    bool IsReady(const AggregationTable::Slot &slot) const;
+
+    /**
+     * @brief Schedule the iteration's deadline, a multiple of the children's median SRTT
+     * @param seq The sequence number
+     */
+    void ArmIterationDeadline(uint32_t seq);
+
+    /**
+     * @brief Median of the children's SRTT, in us, 0 before any RTT sample
+     */
+    int64_t MedianSrtt() const;
+
+    /**
+     * @brief The iteration's deadline expired, forward it partially if any child has arrived
+     * @param seq The sequence number
+     */
+    void OnIterationDeadline(uint32_t seq);
+
+    /**
+     * @brief Give up on the children of a partially forwarded iteration: cancel their interests, drop queued ones
+     * @param slot The iteration's slot
+     */
+    void CancelStragglers(AggregationTable::Slot &slot);
+
     /**
      * @brief Sum the response time
      * @param response_time The response time to sum
@@ -173,36 +252,22 @@ public:
      */
     int64_t GetAggregateTimeAverage();
 
-    void RTOMeasure(std::string prefix, int64_t resTime);
+    void RTOMeasure(FlowId flow, int64_t resTime);
 
-    bool CongestionDetection(std::string prefix, int64_t responseTime);
+    bool CongestionDetection(FlowId flow, int64_t responseTime);
     // QSF
-    void RTTMeasure(std::string prefix, int64_t resTime);
-
-    /**
-     * @brief Parse the received aggregation tree
-     * @param input The input string
-     * @return A pair containing the parsed aggregation tree
-     */
-    std::pair<std::string, std::vector<std::string>> aggTreeProcessSingleString(const std::string &input);
-
-    /**
-     * @brief Parse the received aggregation trees
-     * @param inputs The input strings
-     * @return A map containing the parsed aggregation trees
-     */
-    std::map<std::string, std::vector<std::string>> aggTreeProcessStrings(const std::vector<std::string> &inputs);
+    void RTTMeasure(FlowId flow, int64_t resTime);
 
-    double GetDataQueueSize(std::string prefix);
+    double GetDataQueueSize(FlowId flow);
     /**
      * @brief Record the window size for testing purposes
      */
-    void WindowRecorder(std::string prefix);
+    void WindowRecorder(FlowId flow);
 
     /**
      * @brief Record the RTO for testing purposes
      */
-    void RTORecorder(std::string prefix);
+    void RTORecorder(FlowId flow);
 
     /**
      * @brief Record the response time
@@ -211,7 +276,7 @@ public:
      * @param ECN The ECN flag
      * @param threshold_actual The actual threshold
      */
-    void ResponseTimeRecorder(std::chrono::milliseconds responseTime, uint32_t seq, std::string prefix);
+    void ResponseTimeRecorder(std::chrono::milliseconds responseTime, uint32_t seq, FlowId flow);
 
     /**
      * @brief Record the aggregation time
@@ -230,7 +295,7 @@ public:
      * @param threshold The threshold
      * @return True if the window can be decreased, false otherwise
      */
-    bool CanDecreaseWindow(std::string prefix, int64_t threshold);
+    bool CanDecreaseWindow(FlowId flow, int64_t threshold);
 
     /**
      * @brief Record the throughput
@@ -241,9 +306,9 @@ public:
 
     void ResultRecorder(int64_t aveAggTime);
 
-    void QsfRecorder(std::string prefix, double qsf);
+    void QsfRecorder(FlowId flow, double qsf);
 
-    void QueueRecorder(std::string prefix, double queueSize);
+    void QueueRecorder(FlowId flow, double queueSize);
 
 protected:
     /**
@@ -279,18 +344,17 @@ protected:
     // log file
     std::string folderPath = "logs/agg";
 
-    std::map<std::string, std::string> RTO_recorder;
-    std::map<std::string, std::string> window_recorder;
-    std::map<std::string, std::string> responseTime_recorder;
-    std::map<std::string, std::string> inFlight_recorder;
-    std::map<std::string, std::string> qsf_recorder;   //? qsf
-    std::map<std::string, std::string> qsNew_recorder; //! Updated queue size CC
     std::string aggTable_recorder;
     std::string aggregateTime_recorder;
+    TelemetryStream aggTableStream = INVALID_STREAM;
+    TelemetryStream aggregateTimeStream = INVALID_STREAM;
     int suspiciousPacketCount; // Record the number of timeout
     int downstreamRetxCount;   // Record the number of retransmission interests from downstream
     int interestOverflow;      // Record the number of interest overflow within interest queue
     int dataOverflow;          // Record the number of data overflow within data queue
+    int partialCount = 0;      // Record the number of iterations forwarded without every child
+    int lateDropped = 0;       // Record the number of children's data dropped after their iteration was forwarded
+    int lateMerged = 0;        // Record the number of children's data merged within the grace window
     int nackCount;             // Record the number of NACK
 
     // Local throughput measurement
@@ -303,13 +367,10 @@ protected:
     // Tree broadcast synchronization
     bool treeSync;
 
-    int numChild;                         // Start congestion control after 3 iterations
-    std::map<std::string, int> RTT_count; // How many RTT packets this node has received, used to estimate how many iterations have passed
+    int numChild; // Start congestion control after 3 iterations
 
     //? The following is new design for windowed average RTT
-    std::map<std::string, std::deque<int64_t>> RTT_windowed_queue; // Store windowed average RTT for each flow
-    std::map<std::string, int64_t> RTT_historical_estimation;      // Historical RTT estimation
-    int m_smooth_window_size;                                      // Window size for RTT windowed average
+    int m_smooth_window_size; // Window size for RTT windowed average
 
     // Congestion signal
     bool ECNLocal;
@@ -317,26 +378,18 @@ protected:
 
     //// Basic cwnd management
     uint32_t m_initialWindow;
-    std::map<std::string, double> m_window;
     uint32_t m_minWindow;
-    std::map<std::string, uint32_t> m_inFlight;
-    std::map<std::string, double> m_ssthresh;
     bool m_setInitialWindowOnTimeout;
 
     // Window decrease suppression
-    std::map<std::string, std::chrono::milliseconds> lastWindowDecreaseTime;
     bool isWindowDecreaseSuppressed;
 
     // CUBIC
     static constexpr double m_cubic_c = 0.4;
     static constexpr double m_cubicBeta = 0.7;
     bool m_useCubicFastConv;
-    std::map<std::string, double> m_cubicWmax;
-    std::map<std::string, double> m_cubicLastWmax;
 
     // AIMD
-    std::map<std::string, uint32_t> lastCongestionSeq;
-    std::map<std::string, int> successiveCongestion;
     bool m_useCwa;
     double m_alpha;                // Timeout decrease factor
     double m_beta;                 // Local congestion decrease factor
@@ -347,16 +400,24 @@ protected:
     bool m_reactToCongestionMarks; // PCON's implementation, disable it for now
     int m_interestQueue;           // Max interest queue size
     int m_dataQueue;               // Max data queue size
-    int m_dataSize;                // Max data size
+    int m_aggTableSize;            // Max number of iterations in progress, slots of the aggregation table
+    int m_reducerThreads;          // Threads decoding and reducing upstream data, 0 to aggregate inline on the io thread
+    int m_repairRounds;            // Timeout rounds without data before a child is reported silent to the consumer
+    int m_partialQuorum;           // Children enough to forward an iteration, 0 to wait for all of them
+    double m_partialDeadline;      // Deadline of an iteration in multiples of the children's median SRTT, 0 to disable
+    LatePolicy m_latePolicy;       // What to do with children's data arriving after the iteration is forwarded
+    double m_lateGrace;            // MERGE: how long a partial iteration waits for late data, in multiples of the median SRTT
+    int m_dataSize;                // Max data size, i.e. parameters per segment
     uint32_t m_iteNum;
+    uint32_t m_lastSeq;            // Seq of the last segment of the last iteration
 
     // TODO from yitong:debugging this section now
     // Interest sending rate pacing
-    std::map<std::string, ndn::scheduler::EventId> m_scheduleEvent;
-    std::map<std::string, ndn::scheduler::EventId> m_sendEvent;
     bool firstInterest;
     bool isRTTEstimated;
     int m_initPace;
+    int m_pacerTick;     // Period of the pacer, unit: us
+    double m_pacerBurst; // Max interests a flow may send at once, raised to one tick's worth of its rate
 
     //? QSF
     int m_qsfQueueThreshold;
@@ -364,47 +425,30 @@ protected:
     double m_qsfRPFactor;
     int m_qsfTimeDuration;
     double m_qsfInitRate; // Unit: pgks/ms
-    std::map<std::string, bool> firstData;
-    std::map<std::string, SlidingWindow<double>> m_qsfSlidingWindows;
-    std::map<std::string, ndn::scheduler::EventId> m_rateEvent;
-    std::map<std::string, double> m_rateLimit;         // Unit: pkgs/ms
-    std::map<std::string, double> m_estimatedBW;       // Unit: pkgs/ms
-    std::map<std::string, int64_t> RTT_estimation_qsf; // Unit: ms
 
-    // Interest queue (for each flow), keep tracking about each flow
-    std::map<std::string, std::deque<uint32_t>> interestQueue;
+    // Per-flow state (cwnd, RTO, QSF, interest queue, log files), indexed by the child's FlowId
+    FlowTable m_flows;
 
     // Interest splitting - divided interests
-    std::map<std::string, std::string> NameSec0_2;
-    std::map<std::string, uint32_t> SeqMap;
     std::vector<std::string> vec_iteration; // Store upstream nodes' name
 
-    // Timeout check and RTT measurement
-    std::map<std::string, std::chrono::milliseconds> m_timeoutCheck;
-    std::map<std::string, int64_t> SRTT;
-    std::map<std::string, int64_t> RTTVAR;
-    std::map<std::string, int> roundRTT;
-    std::map<std::string, std::chrono::milliseconds> RTO_threshold;
-    std::map<std::string, int> numTimeout;
+    // Outstanding interests, keyed by (flow, seq): timeout check and pending entry (nonce, sending time, face handle)
+    TimerWheel m_timeouts;
+    PendingInterestTable m_pit;
 
-    // Aggregation list
-    std::map<uint32_t, std::vector<std::string>> map_agg_oldSeq_newName; // name segments
-    std::map<uint32_t, std::string> m_agg_newDataName;                   // whole name
+    // Interest sending rate pacing, one tick releases the interests of all children
+    Pacer m_pacer;
+    ndn::scheduler::EventId m_pacerEvent;
 
-    // Aggregation variables storage
-    std::map<uint32_t, bool> partialAggResult;
-    std::map<uint32_t, std::vector<double>> sumParameters;             // result after performing aggregation(arithmetic add them together)
-    std::map<uint32_t, std::vector<std::string>> congestionSignalList; // result after aggregating congestion signal
-    std::map<uint32_t, bool> congestionSignal;                         // congestion signal for current node
+    // Per-iteration aggregation state (downstream name, partial sum, child arrivals, timing)
+    AggregationTable m_aggTable;
+    std::unique_ptr<ReducerPool> m_reducers; // Pipeline mode only, see m_reducerThreads
+    std::map<uint32_t, bool> congestionSignal; // congestion signal for current node
 
     // Response/Aggregation time measurement
-    std::map<std::string, std::chrono::milliseconds> rttStartTime;
-    std::map<std::string, std::chrono::milliseconds> responseTime;
     int64_t totalResponseTime;
     int round;
 
-    std::map<uint32_t, std::chrono::milliseconds> aggregateStartTime;
-    std::map<uint32_t, std::chrono::milliseconds> aggregateTime;
     int64_t totalAggregateTime;
     int iterationCount;
 
@@ -462,7 +506,7 @@ protected:
     SeqTimeoutsContainer m_seqFullDelay;
     std::map<uint32_t, uint32_t> m_seqRetxCounts;
     ndn::KeyChain m_keyChain;
-    std::map<std::string, ndn::PendingInterestHandle> m_pendingInterest;
+    SigningPolicy m_signing; // Signs the Data sent downstream and verifies the Data from children
     std::chrono::steady_clock::time_point startTime;
     ndn::Scheduler m_scheduler;
 
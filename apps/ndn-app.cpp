@@ -16,10 +16,7 @@ App::App()
       m_appId(std::numeric_limits<uint32_t>::max())
 {
     // initialize spdlog
-    m_logger = spdlog::basic_logger_mt("app_logger", "logs/app.log");
-    spdlog::set_default_logger(m_logger);
-    spdlog::set_level(spdlog::level::info); // set log level
-    spdlog::flush_on(spdlog::level::info);  // flush after each log
+    m_logger = Log::init("app_logger", "logs/app.log");
 
     spdlog::info("App initialized");
 }
@@ -36,7 +33,7 @@ uint32_t App::GetId() const
 
 void App::OnInterest(const ndn::InterestFilter &filter, const ndn::Interest &interest)
 {
-    spdlog::info("Received Interest: {}", interest.getName().toUri());
+    LOG_DEBUG(Log::APP, "Received Interest: {}", interest.getName().toUri());
 }
 
 void App::OnRegisterSuccess(const ndn::Name &prefix)
@@ -51,7 +48,7 @@ void App::OnRegisterFailure(const ndn::Name &prefix, const std::string &reason)
 
 void App::OnData(const ndn::Interest &interest, const ndn::Data &data)
 {
-    spdlog::info("Received Data: {}", data.getName().toUri());
+    LOG_DEBUG(Log::APP, "Received Data: {}", data.getName().toUri());
 }
 
 void App::OnNack(const ndn::Interest &interest, const ndn::lp::Nack &nack)
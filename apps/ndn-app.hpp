@@ -6,6 +6,7 @@
 #include <ndn-cxx/encoding/block.hpp>
 #include <spdlog/spdlog.h>
 #include <spdlog/sinks/basic_file_sink.h>
+#include "logging.hpp"
 #include <chrono>
 #include <memory>
 #include <set>
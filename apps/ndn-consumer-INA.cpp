@@ -10,71 +10,41 @@ ConsumerINA::ConsumerINA()
 
 void ConsumerINA::SendInterest(std::shared_ptr<ndn::Name> newName)
 {
-    // Get the prefix of the interest, which is the flow name
-    std::string flow = newName->get(0).toUri();
-    // Record inFlight for congestion control
-    // m_inFlight[flow]++;
+    // Record inFlight for congestion control, done per flow in Consumer::SendInterest
     Consumer::SendInterest(newName);
 }
-void ConsumerINA::ScheduleNextPacket(std::string prefix)
+bool ConsumerINA::ReleasePacket(FlowId flow)
 {
-    spdlog::debug("triggered ScheduleNextPacket");
-    // ps:deleted schedule and imported the thread
-    if (interestQueue.find(prefix) == interestQueue.end())
+    if (flow >= m_flows.Size())
     {
-        spdlog::debug("Flow {} is not found in the interest queue.", prefix);
+        LOG_DEBUG(Log::CONSUMER, "Flow {} is not found in the flow table.", flow);
         std::exit(EXIT_FAILURE);
-        return;
+        return false;
     }
+    FlowState &state = m_flows[flow];
     //? Check whether interest queue is null, if so, split new interests...
     // Interest splitting
-    if (interestQueue[prefix].empty())
+    if (state.interestQueue.empty())
     {
-        // Reach the last iteration, stop scheduling new packets for current flow
-        if (globalSeq == m_iteNum)
+        // Reach the last segment of the last iteration, stop pacing the current flow
+        if (globalSeq == m_lastSeq)
         {
             spdlog::info("All iterations have been finished, no need to schedule new interests.");
-            return;
+            m_pacer.Stop(flow);
+            return false;
         }
 
         // Check whether interest queue is full
         if (!InterestSplitting())
         {
-            //? Fail to split new interests, schedule this flow later
-            spdlog::debug("Other flows' queue is full, schedule this flow later.");
-        }
-        else
-        {
-            if (m_sendEvent[prefix])
-            {
-                m_sendEvent[prefix].cancel();
-                m_sendEvent[prefix].reset();
-                spdlog::debug("Suspicious, remove the previous event.");
-            }
-            spdlog::debug("the prefix that will be sent is {}", prefix);
-            m_sendEvent[prefix] = m_scheduler.schedule(ndn::time::milliseconds(0), [this, prefix]
-                                                       { this->SendPacket(prefix); });
+            //? Fail to split new interests, try this flow again on the next tick
+            LOG_DEBUG(Log::CONSUMER, "Other flows' queue is full, schedule this flow later.");
+            return false;
         }
     }
-    else
-    {
-        if (m_sendEvent[prefix])
-        {
-            m_sendEvent[prefix].cancel();
-            m_sendEvent[prefix].reset();
-            spdlog::debug("Suspicious, remove the previous event.");
-        }
-        spdlog::debug("the prefix that will be sent is {} but not empty", prefix);
-        m_sendEvent[prefix] = m_scheduler.schedule(ndn::time::milliseconds(0), [this, prefix]
-                                                   { this->SendPacket(prefix); });
-        spdlog::debug("finish putting sending packet event");
-    }
-    // Schdule next scheduling event
-    double nextTime = 1 / m_rateLimit[prefix]; // Unit: us
-    spdlog::info("Flow {} -> Schedule next sending event after {} ms. from consumerINA schedule next packet", prefix, nextTime / 1000);
-    m_scheduleEvent[prefix] = m_scheduler.schedule(ndn::time::microseconds(static_cast<int64_t>(nextTime)),
-                                                   [this, prefix]
-                                                   { this->ScheduleNextPacket(prefix); });
+    LOG_DEBUG(Log::CONSUMER, "the state.name that will be sent is {}", state.name);
+    SendPacket(flow);
+    return true;
 }
 
 void ConsumerINA::StartApplication()
@@ -84,7 +54,7 @@ void ConsumerINA::StartApplication()
 
 void ConsumerINA::OnData(const ndn::Interest &interest, const ndn::Data &data)
 {
-    spdlog::info("ConsumerINA received data");
+    LOG_DEBUG(Log::CONSUMER, "ConsumerINA received data");
     Consumer::OnData(interest, data);
 }
 
@@ -99,49 +69,51 @@ uint32_t ConsumerINA::GetWindow() const
     return m_initialWindow;
 }
 
-void ConsumerINA::WindowIncrease(std::string prefix)
+void ConsumerINA::WindowIncrease(FlowId flow)
 {
+    FlowState &state = m_flows[flow];
     if (m_ccAlgorithm == CcAlgorithm::AIMD)
     {
         // If cwnd is larger than 8, check whether current bottleneck is because of downstream slow interest, if so, stop increasing cwnd
-        /*         if (m_window[prefix] > 8.0 && m_window[prefix] - m_inFlight[prefix] > 30.0){
+        /*         if (state.window > 8.0 && state.window - state.inFlight > 30.0){
                     NS_LOG_DEBUG("Current bottleneck is downstream slow interest, stop increasing cwnd.");
                 } else  */
         if (m_useWIS)
         {
-            if (m_window[prefix] < m_ssthresh[prefix])
+            if (state.window < state.ssthresh)
             {
-                m_window[prefix] += 1.0;
+                state.window += 1.0;
             }
             else
             {
-                m_window[prefix] += (1.0 / m_window[prefix]);
+                state.window += (1.0 / state.window);
             }
-            spdlog::debug("Window size of flow '{}' is increased to {}", prefix, m_window[prefix]);
+            LOG_DEBUG(Log::CONSUMER, "Window size of flow '{}' is increased to {}", state.name, state.window);
         }
         else
         {
-            m_window[prefix] += 1.0;
-            spdlog::debug("Window size of flow '{}' is increased to {}", prefix, m_window[prefix]);
+            state.window += 1.0;
+            LOG_DEBUG(Log::CONSUMER, "Window size of flow '{}' is increased to {}", state.name, state.window);
         }
     }
     else if (m_ccAlgorithm == CcAlgorithm::CUBIC)
     {
-        CubicIncerase(prefix);
+        CubicIncerase(flow);
     }
     else
     {
-        spdlog::debug("CC alogrithm can't be recognized, please check!");
+        LOG_DEBUG(Log::CONSUMER, "CC alogrithm can't be recognized, please check!");
         std::exit(EXIT_FAILURE);
     }
 }
 
-void ConsumerINA::WindowDecrease(std::string prefix, std::string type)
+void ConsumerINA::WindowDecrease(FlowId flow, std::string type)
 {
+    FlowState &state = m_flows[flow];
 
     // Track last window decrease time
     auto now = std::chrono::steady_clock::now();
-    lastWindowDecreaseTime[prefix] = std::chrono::duration_cast<std::chrono::milliseconds>(now - startTime);
+    state.lastWindowDecreaseTime = std::chrono::duration_cast<std::chrono::milliseconds>(now - startTime);
 
     // AIMD for timeout
 
@@ -149,27 +121,27 @@ void ConsumerINA::WindowDecrease(std::string prefix, std::string type)
     {
         if (type == "timeout")
         {
-            m_ssthresh[prefix] = m_window[prefix] * m_alpha;
-            m_window[prefix] = m_ssthresh[prefix];
+            state.ssthresh = state.window * m_alpha;
+            state.window = state.ssthresh;
         }
         else if (type == "nack")
         {
-            m_ssthresh[prefix] = m_window[prefix] * m_alpha;
-            m_window[prefix] = m_ssthresh[prefix];
+            state.ssthresh = state.window * m_alpha;
+            state.window = state.ssthresh;
         }
         else if (type == "ConsumerCongestion")
         {
-            m_ssthresh[prefix] = m_window[prefix] * m_beta;
-            m_window[prefix] = m_ssthresh[prefix];
+            state.ssthresh = state.window * m_beta;
+            state.window = state.ssthresh;
         }
         else if (type == "RemoteCongestion")
         {
-            m_ssthresh[prefix] = m_window[prefix] * m_gamma;
-            m_window[prefix] = m_ssthresh[prefix];
+            state.ssthresh = state.window * m_gamma;
+            state.window = state.ssthresh;
         }
         else
         {
-            spdlog::info("Unknown congestion type, please check!");
+            LOG_INFO(Log::CONSUMER, "Unknown congestion type, please check!");
             std::exit(EXIT_FAILURE);
         }
     }
@@ -177,17 +149,17 @@ void ConsumerINA::WindowDecrease(std::string prefix, std::string type)
     {
         if (type == "timeout")
         {
-            m_ssthresh[prefix] = m_window[prefix] * m_alpha;
-            m_window[prefix] = m_ssthresh[prefix];
+            state.ssthresh = state.window * m_alpha;
+            state.window = state.ssthresh;
         }
         else if (type == "nack")
         {
-            m_ssthresh[prefix] = m_window[prefix] * m_alpha;
-            m_window[prefix] = m_ssthresh[prefix];
+            state.ssthresh = state.window * m_alpha;
+            state.window = state.ssthresh;
         }
         else if (type == "ConsumerCongestion")
         {
-            CubicDecrease(prefix, type);
+            CubicDecrease(flow, type);
         }
         else if (type == "RemoteCongestion")
         {
@@ -195,104 +167,107 @@ void ConsumerINA::WindowDecrease(std::string prefix, std::string type)
         }
         else
         {
-            spdlog::info("Unknown congestion type, please check!");
+            LOG_INFO(Log::CONSUMER, "Unknown congestion type, please check!");
             std::exit(EXIT_FAILURE);
         }
     }
     else
     {
-        spdlog::debug("CC alogrithm can't be recognized, please check!");
+        LOG_DEBUG(Log::CONSUMER, "CC alogrithm can't be recognized, please check!");
         std::exit(EXIT_FAILURE);
     }
 
     // Window size can't be reduced below 1
-    if (m_window[prefix] < m_minWindow)
+    if (state.window < m_minWindow)
     {
-        m_window[prefix] = m_minWindow;
+        state.window = m_minWindow;
     }
 
-    spdlog::debug("Flow: {}. Window size decreased to {}. Reason: {}", prefix, m_window[prefix], type);
+    LOG_DEBUG(Log::CONSUMER, "Flow: {}. Window size decreased to {}. Reason: {}", state.name, state.window, type);
 }
 
 // /**
 //    + * Cubic increase
-//    + * @param prefix Flow name
+//    + * @param flow Flow name
 //    + */
-void ConsumerINA::CubicIncerase(std::string prefix)
+void ConsumerINA::CubicIncerase(FlowId flow)
 {
+    FlowState &state = m_flows[flow];
     // 1. Time since last congestion event in Seconds
 
     // TODO: Check if t is correct
     auto now = std::chrono::steady_clock::now();
-    const double t = (std::chrono::duration_cast<std::chrono::microseconds>(now - startTime).count() - std::chrono::duration_cast<std::chrono::microseconds>(lastWindowDecreaseTime[prefix]).count()) / 1e6;
-    spdlog::debug("Time since last congestion event: {}", t);
+    const double t = (std::chrono::duration_cast<std::chrono::microseconds>(now - startTime).count() - std::chrono::duration_cast<std::chrono::microseconds>(state.lastWindowDecreaseTime).count()) / 1e6;
+    LOG_DEBUG(Log::CONSUMER, "Time since last congestion event: {}", t);
     // 2. Time it takes to increase the window to cubic_wmax
     // K = cubic_root(W_max*(1-beta_cubic)/C) (Eq. 2)
-    const double k = std::cbrt(m_cubicWmax[prefix] * (1 - m_cubicBeta) / m_cubic_c);
-    spdlog::debug("K value: {}", k);
+    const double k = std::cbrt(state.cubicWmax * (1 - m_cubicBeta) / m_cubic_c);
+    LOG_DEBUG(Log::CONSUMER, "K value: {}", k);
     // 3. Target: W_cubic(t) = C*(t-K)^3 + W_max (Eq. 1)
-    const double w_cubic = m_cubic_c * std::pow(t - k, 3) + m_cubicWmax[prefix];
-    spdlog::debug("Cubic increase target: {}", w_cubic);
+    const double w_cubic = m_cubic_c * std::pow(t - k, 3) + state.cubicWmax;
+    LOG_DEBUG(Log::CONSUMER, "Cubic increase target: {}", w_cubic);
     // 4. Estimate of Reno Increase (Currently Disabled)
     //  const double rtt = m_rtt->GetCurrentEstimate().GetSeconds();
     //  const double w_est = m_cubic_wmax*m_beta + (3*(1-m_beta)/(1+m_beta)) * (t/rtt);
     //* TCP-friendly region, need to be disabled for ICN, "w_est" is not needed
     // constexpr double w_est = 0.0;
     //! Original cubic increase
-    /*     if (m_cubicWmax[prefix] <= 0) {
+    /*     if (state.cubicWmax <= 0) {
     +        NS_LOG_DEBUG("Error! Wmax is less than 0, check cubic increase!");
     +        Simulator::Stop();
     +    }
     +
-    +    double cubic_increment = std::max(w_cubic, 0.0) - m_window[prefix];
+    +    double cubic_increment = std::max(w_cubic, 0.0) - state.window;
     +    // Cubic increment must be positive:
     +    // Note: This change is not part of the RFC, but I added it to improve performance.
     +    if (cubic_increment < 0) {
     +        cubic_increment = 0.0;
     +    NS_LOG_DEBUG("Cubic increment: " << cubic_increment);
-    +    m_window[prefix] += cubic_increment / m_window[prefix]; */
+    +    state.window += cubic_increment / state.window; */
     //! Customized cubic increase
-    if (m_window[prefix] < m_ssthresh[prefix])
+    if (state.window < state.ssthresh)
     {
-        m_window[prefix] += 1.0;
+        state.window += 1.0;
     }
     else
     {
-        if (m_cubicWmax[prefix] <= 0)
+        if (state.cubicWmax <= 0)
         {
-            spdlog::debug("Error! Wmax is less than 0, check cubic increase!");
+            LOG_DEBUG(Log::CONSUMER, "Error! Wmax is less than 0, check cubic increase!");
             std::exit(EXIT_FAILURE);
         }
-        double cubic_increment = std::max(w_cubic, 0.0) - m_window[prefix];
+        double cubic_increment = std::max(w_cubic, 0.0) - state.window;
         // Cubic increment must be positive:
         // Note: This change is not part of the RFC, but I added it to improve performance.
         if (cubic_increment < 0)
         {
             cubic_increment = 0.0;
         }
-        spdlog::debug("Cubic increment: {}", cubic_increment);
-        m_window[prefix] += cubic_increment / m_window[prefix];
+        LOG_DEBUG(Log::CONSUMER, "Cubic increment: {}", cubic_increment);
+        state.window += cubic_increment / state.window;
     }
-    spdlog::debug("Window size of flow '{}' is increased to {}", prefix, m_window[prefix]);
+    LOG_DEBUG(Log::CONSUMER, "Window size of flow '{}' is increased to {}", state.name, state.window);
 }
 
-void ConsumerINA::CubicDecrease(std::string prefix, std::string type)
+void ConsumerINA::CubicDecrease(FlowId flow, std::string type)
 {
+    FlowState &state = m_flows[flow];
     //! Traditional cubic window decrease
-    m_cubicWmax[prefix] = m_window[prefix];
-    m_ssthresh[prefix] = m_window[prefix] * m_cubicBeta;
-    m_ssthresh[prefix] = std::max<double>(m_ssthresh[prefix], m_minWindow);
-    m_window[prefix] = m_window[prefix] * m_cubicBeta;
+    state.cubicWmax = state.window;
+    state.ssthresh = state.window * m_cubicBeta;
+    state.ssthresh = std::max<double>(state.ssthresh, m_minWindow);
+    state.window = state.window * m_cubicBeta;
 }
 
-void ConsumerINA::WindowRecorder(std::string prefix)
+void ConsumerINA::WindowRecorder(FlowId flow)
 {
+    FlowState &state = m_flows[flow];
     // Open file; on first call, truncate it to delete old content
-    std::ofstream file(windowRecorder[prefix], std::ios::app);
+    std::ofstream file(state.windowRecorder, std::ios::app);
 
     if (!file.is_open())
     {
-        spdlog::error("Failed to open the file: {}", windowRecorder[prefix]);
+        spdlog::error("Failed to open the file: {}", state.windowRecorder);
         return;
     }
 
@@ -300,20 +275,21 @@ void ConsumerINA::WindowRecorder(std::string prefix)
     auto now = std::chrono::steady_clock::now();
     auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - startTime).count();
 
-    file << now_ms << " " << m_window[prefix] << " " << m_ssthresh[prefix] << " " << interestQueue[prefix].size() << std::endl;
+    file << now_ms << " " << state.window << " " << state.ssthresh << " " << state.interestQueue.size() << std::endl;
 
     file.close();
 }
 
-void ConsumerINA::ResponseTimeRecorder(std::string prefix, bool flag)
+void ConsumerINA::ResponseTimeRecorder(FlowId flow, bool flag)
 {
+    FlowState &state = m_flows[flow];
     // Open the file using fstream in append mode
-    std::ofstream file(responseTime_recorder[prefix], std::ios::app);
+    std::ofstream file(state.responseTimeRecorder, std::ios::app);
 
     if (!file.is_open())
     {
 
-        spdlog::error("Failed to open the file: {}", responseTime_recorder[prefix]);
+        spdlog::error("Failed to open the file: {}", state.responseTimeRecorder);
         return;
     }
 
@@ -337,33 +313,30 @@ void ConsumerINA::InitializeParameter()
     Consumer::InitializeParameter();
 
     // Initialize cwnd
-    for (const auto &round : globalTreeRound)
+    for (FlowState &state : m_flows)
     {
-        for (const auto &flow : round)
-        {
-            m_window[flow] = m_initialWindow;
-            m_inFlight[flow] = 0;
-            m_ssthresh[flow] = std::numeric_limits<double>::max();
-
-            // Initialize CUBIC factor
-            m_cubicLastWmax[flow] = m_initialWindow;
-            m_cubicWmax[flow] = m_initialWindow;
-            auto now = std::chrono::steady_clock::now();
-            lastWindowDecreaseTime[flow] = std::chrono::duration_cast<std::chrono::milliseconds>(now - startTime);
-        }
+        state.window = m_initialWindow;
+        state.inFlight = 0;
+        state.ssthresh = std::numeric_limits<double>::max();
+
+        // Initialize CUBIC factor
+        state.cubicLastWmax = m_initialWindow;
+        state.cubicWmax = m_initialWindow;
+        auto now = std::chrono::steady_clock::now();
+        state.lastWindowDecreaseTime = std::chrono::duration_cast<std::chrono::milliseconds>(now - startTime);
     }
 }
 
 void ConsumerINA::OnNack(const ndn::Interest &interest, const ndn::lp::Nack &nack)
 {
     Consumer::OnNack(interest, nack);
-    spdlog::info("ConsumerINA received nack");
+    LOG_DEBUG(Log::CONSUMER, "ConsumerINA received nack");
 }
 
 void ConsumerINA::OnTimeout(const ndn::Interest &interest)
 {
     Consumer::OnTimeout(interest);
-    spdlog::info("ConsumerINA received timeout");
+    LOG_DEBUG(Log::CONSUMER, "ConsumerINA received timeout");
 }
 
 int main()
@@ -62,25 +62,25 @@ public:
 
     /**
      * Override from Consumer class
-     * Schedule the next packet to be sent
+     * Send the next packet of flow, splitting new interests if its queue is empty
      */
-    virtual void ScheduleNextPacket(std::string prefix) override;
+    virtual bool ReleasePacket(FlowId flow) override;
 
 private:
     /**
      * Increase the window size
      */
-    void WindowIncrease(std::string prefix);
+    void WindowIncrease(FlowId flow);
 
     /**
      * Decrease the window size
      * @param type The type of decrease (e.g., congestion)
      */
-    void WindowDecrease(std::string prefix, std::string type);
+    void WindowDecrease(FlowId flow, std::string type);
 
-    void CubicIncerase(std::string prefix);
+    void CubicIncerase(FlowId flow);
 
-    void CubicDecrease(std::string prefix, std::string type);
+    void CubicDecrease(FlowId flow, std::string type);
     /**
      * Set the window size
      * @param window The new window size
@@ -96,13 +96,13 @@ private:
     /**
      * Record the window size for testing purposes
      */
-    void WindowRecorder(std::string prefix);
+    void WindowRecorder(FlowId flow);
 
     /**
      * Record the response time
      * @param flag A flag indicating whether to record the response time
      */
-    void ResponseTimeRecorder(std::string prefix, bool flag);
+    void ResponseTimeRecorder(FlowId flow, bool flag);
 
     /**
      * Initialize log files
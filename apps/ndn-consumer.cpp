@@ -25,10 +25,7 @@ Consumer::Consumer()
       iterationCount(0)
 {
     // Initialize spdlog
-    m_logger = spdlog::basic_logger_mt("consumer_logger", "logs/consumer.log");
-    spdlog::set_default_logger(m_logger);
-    spdlog::set_level(spdlog::level::info); // Set log level
-    spdlog::flush_on(spdlog::level::info);  // Flush after each log
+    m_logger = Log::init("consumer_logger", "logs/consumer.log"); // Levels, flushing and async mode: [Log] in config.ini
 
     spdlog::info("Consumer initialized with interest name: {}", m_interestName);
 
@@ -55,7 +52,12 @@ void Consumer::ReadConfig()
     m_useCwa = pt.get<bool>("General.UseCwa", true);
     m_useCubicFastConv = pt.get<bool>("General.UseCubicFastConv", false);
     m_smooth_window_size = pt.get<int>("General.RTTWindowSize", 3);
-    m_dataSize = pt.get<int>("General.DataSize", 150);
+    if (m_smooth_window_size < 1 || m_smooth_window_size > static_cast<int>(RTT_WINDOW_CAPACITY))
+    {
+        spdlog::error("General.RTTWindowSize must be between 1 and {}", RTT_WINDOW_CAPACITY);
+        std::exit(EXIT_FAILURE);
+    }
+    m_dataSize = static_cast<int>(ModelSchema::instance().parameterCount());
 
     // QSF section
     m_qsfQueueThreshold = pt.get<int>("QSF.QueueThreshold", 3);
@@ -66,8 +68,29 @@ void Consumer::ReadConfig()
 
     // Consumer section
     m_iteNum = pt.get<int>("Consumer.Iteration", 200);
+    m_lastSeq = ModelSchema::instance().segmentSeq(m_iteNum, ModelSchema::instance().segmentCount() - 1);
     m_interestQueue = pt.get<int>("Consumer.ConInterestQueue", 5);
     m_dataQueue = pt.get<int>("Consumer.ConDataQueue", 20);
+    m_pitSize = pt.get<int>("Consumer.PitSize", 4096);
+    m_treeCacheDir = pt.get<std::string>("Consumer.TreeCacheDir", "../experiments/tree-cache");
+    m_repairRounds = pt.get<int>("Consumer.RepairRounds", 5);
+    std::string solver = pt.get<std::string>("Consumer.ClusteringSolver", "simplex");
+    if (solver == "simplex")
+        m_solverBackend = MinCostFlowSolver::kNetworkSimplex;
+    else if (solver == "ssp")
+        m_solverBackend = MinCostFlowSolver::kSuccessiveShortestPath;
+    else
+    {
+        spdlog::error("Consumer.ClusteringSolver must be simplex or ssp, got {}", solver);
+        std::exit(EXIT_FAILURE);
+    }
+
+    // Pacer section
+    m_pacerTick = pt.get<int>("Pacer.TickInterval", 500);
+    m_pacerBurst = pt.get<double>("Pacer.Burst", 4.0);
+
+    // Security section
+    m_signing = SigningPolicy::fromConfig("../experiments/config.ini");
 }
 
 /**
@@ -85,34 +108,198 @@ void Consumer::TreeBroadcast()
         {
             continue;
         }
+        SendTreeInit(parentNode);
+    }
+    initSeq++;
+}
 
-        std::string nameWithType;
-        std::string nameType = "initialization";
-        nameWithType += "/" + parentNode;
-        auto result = getLeafNodes(parentNode, broadcastTree);
+void Consumer::SendTreeInit(const std::string &node)
+{
+    // The subtree travels in the parameters, "/<node>/<parameters digest>/initialization/<seq>"
+    std::vector<uint8_t> parameters = AggregationSubtree::Encode(node, aggregationTree[0]);
+    ndn::Name name("/" + node);
+    name.appendParametersSha256DigestPlaceholder();
+    name.append("initialization");
+    name.appendSequenceNumber(globalSeq);
+
+    // Fix the digest in the name, so a retransmission finds the parameters again from it
+    ndn::Interest interest(name);
+    interest.setApplicationParameters(ndn::make_span(parameters.data(), parameters.size()));
+    std::shared_ptr<ndn::Name> newName = std::make_shared<ndn::Name>(interest.getName());
+    spdlog::info("Node {}'s name is: {}, subtree of {} bytes", node, newName->toUri(), parameters.size());
+
+    m_initParameters[newName->toUri()] = std::move(parameters);
+    SendInterest(newName);
+}
 
-        // Construct nameWithType variable for tree broadcast
-        for (const auto &[childNode, leaves] : result)
+/**
+ * Repair the tree around an aggregator that stopped answering. Only its children are reclustered (AggregationTree::
+ * repairTree), its replacement takes over the flow of the failed node at its parent, and only the parent and the
+ * replacement get a new initialization Interest. The rest of the tree keeps aggregating meanwhile.
+ */
+void Consumer::RepairTree(const std::string &failed)
+{
+    auto start = std::chrono::steady_clock::now();
+    if (!m_tree)
+    {
+        // The tree came from the cache, only now are the link costs needed
+        m_tree = std::make_unique<AggregationTree>(filename);
+        m_tree->solverBackend = m_solverBackend;
+        m_tree->aggregationAllocation = aggregationTree[0];
+        for (size_t roundIndex = 1; roundIndex < aggregationTree.size(); ++roundIndex)
         {
-            std::string name_indication;
-            name_indication += childNode + ".";
-            for (const auto &leaf : leaves)
-            {
-                name_indication += leaf + ".";
-            }
-            name_indication.resize(name_indication.size() - 1); // Remove the last extra dot
-            nameWithType += "/" + name_indication;
+            m_tree->noCHTree.push_back(aggregationTree[roundIndex].at(m_nodeprefix));
         }
-        nameWithType += "/" + nameType;
+    }
 
-        // Use spdlog instead of cout
-        spdlog::info("Node {}'s name is: {}", parentNode, nameWithType);
+    AggregationTree::TreeRepair repair;
+    if (!m_tree->repairTree(failed, m_constraint, repair))
+    {
+        spdlog::error("Aggregator {} failed and can't be replaced, the aggregation stalls!", failed);
+        return;
+    }
+    if (repair.parent == m_nodeprefix && repair.heads.size() != 1)
+    {
+        spdlog::error("Aggregator {} is replaced by {} aggregators, a flow can't be split while running!", failed, repair.heads.size());
+        std::exit(EXIT_FAILURE);
+        return;
+    }
 
-        std::shared_ptr<ndn::Name> newName = std::make_shared<ndn::Name>(nameWithType);
-        newName->appendSequenceNumber(globalSeq);
-        SendInterest(newName);
+    // Rebuild the rounds the same way ConstructAggregationTree() does
+    std::map<std::string, std::vector<std::string>> rawAggregationTree = m_tree->aggregationAllocation;
+    aggregationTree.clear();
+    aggregationTree.push_back(rawAggregationTree);
+    for (const auto &subTree : m_tree->noCHTree)
+    {
+        rawAggregationTree[m_nodeprefix] = subTree;
+        aggregationTree.push_back(rawAggregationTree);
     }
-    initSeq++;
+
+    // A child of the consumer hands its flow over, the outstanding segments now wait for the replacement
+    if (repair.parent == m_nodeprefix)
+    {
+        const std::string &head = repair.heads.front();
+        FlowId flow = m_flows.Find(failed);
+        if (flow == INVALID_FLOW || !m_flows.Rename(flow, head))
+        {
+            spdlog::error("Flow of {} can't be handed over to {}, please check!", failed, head);
+            std::exit(EXIT_FAILURE);
+            return;
+        }
+        FlowState &state = m_flows[flow];
+        state.nameSec0_2 = "/" + head + state.nameSec0_2.substr(state.nameSec0_2.find('/', 1));
+        state.silentRounds = 0;
+        std::replace(vec_iteration.begin(), vec_iteration.end(), failed, head);
+        for (auto &[seq, names] : map_agg_oldSeq_newName)
+        {
+            std::replace(names.begin(), names.end(), failed, head);
+        }
+        for (auto &leaves : globalTreeRound)
+        {
+            std::replace(leaves.begin(), leaves.end(), failed, head);
+        }
+    }
+
+    // The failed node's own initialization is given up
+    for (auto it = m_initPending.begin(); it != m_initPending.end();)
+    {
+        if (ndn::Name(it->first).get(0).toUri() == failed)
+        {
+            it->second.handle.cancel();
+            m_initParameters.erase(it->first);
+            it = m_initPending.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    broadcastList.erase(failed);
+
+    // Only the parent and the replacements get a new subtree
+    std::vector<std::string> changed = repair.heads;
+    if (repair.parent != m_nodeprefix)
+    {
+        changed.push_back(repair.parent);
+    }
+    for (const auto &node : changed)
+    {
+        broadcastList.insert(node);
+        SendTreeInit(node);
+    }
+
+    std::string heads;
+    for (const auto &head : repair.heads)
+    {
+        heads += (heads.empty() ? "" : " ") + head;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    spdlog::info("Aggregator {} under {} replaced by {} in {} us", failed, repair.parent, heads, elapsed.count());
+}
+
+/**
+ * Expired interests alone can't tell a dead child from a live aggregator stuck behind a dead descendant, so a silent
+ * aggregator is asked for its status first, "/<node>/status/<seq>". It answers with its children that have been
+ * silent for as many rounds, those are probed in turn and the node that doesn't answer is the one repaired.
+ */
+void Consumer::ProbeNode(const std::string &node)
+{
+    if (node == m_nodeprefix || aggregationTree.empty() || aggregationTree[0].find(node) == aggregationTree[0].end())
+    {
+        spdlog::warn("Producer {} has been silent for {} rounds, only aggregators can be replaced", node, m_repairRounds);
+        return;
+    }
+    if (!m_probing.insert(node).second)
+        return;
+
+    ndn::Name name("/" + node);
+    name.append("status");
+    name.appendSequenceNumber(m_probeSeq++);
+    ndn::Interest interest(name);
+    interest.setCanBePrefix(false);
+    interest.setMustBeFresh(true);
+    interest.setInterestLifetime(ndn::time::milliseconds(3 * m_retxTimer.count()));
+    spdlog::info("Aggregator {} has been silent for {} rounds, probing it: {}", node, m_repairRounds, name.toUri());
+    m_face.expressInterest(interest,
+                           [this, node](const ndn::Interest &, const ndn::Data &data)
+                           { this->OnProbeData(node, data); },
+                           [this, node](const ndn::Interest &, const ndn::lp::Nack &)
+                           { this->OnProbeFailed(node); },
+                           [this, node](const ndn::Interest &)
+                           { this->OnProbeFailed(node); });
+}
+
+void Consumer::OnProbeData(const std::string &node, const ndn::Data &data)
+{
+    m_probing.erase(node);
+    // Alive, a direct child is given another m_repairRounds rounds before it's probed again
+    FlowId flow = m_flows.Find(node);
+    if (flow != INVALID_FLOW)
+        m_flows[flow].silentRounds = 0;
+    if (m_signing.Verify(data) != SigningPolicy::Verdict::ACCEPT)
+    {
+        LOG_INFO(Log::CONSUMER, "Status {} failed {} verification, dropped", data.getName().toUri(), signingModeName(m_signing.Mode()));
+        return;
+    }
+
+    const ndn::Block &content = data.getContent();
+    std::istringstream silent(std::string(reinterpret_cast<const char *>(content.value()), content.value_size()));
+    std::string child;
+    while (silent >> child)
+    {
+        spdlog::info("Aggregator {} reports its child {} silent", node, child);
+        ProbeNode(child);
+    }
+}
+
+void Consumer::OnProbeFailed(const std::string &node)
+{
+    m_probing.erase(node);
+    // Replaced meanwhile through another report
+    if (aggregationTree.empty() || aggregationTree[0].find(node) == aggregationTree[0].end())
+        return;
+    spdlog::warn("Aggregator {} didn't answer its status probe, repairing the tree around it", node);
+    RepairTree(node);
 }
 
 void Consumer::ConstructAggregationTree()
@@ -143,22 +330,37 @@ void Consumer::ConstructAggregationTree()
         std::exit(EXIT_FAILURE);
         return;
     }
-    // Create AggregationTree object
-    AggregationTree tree(filename);
     std::vector<std::string> dataPointNames = Utility::getProducers(filename);
     std::map<std::string, std::vector<std::string>> rawAggregationTree;
     std::vector<std::vector<std::string>> rawSubTree;
 
-    // Construct the aggregation tree
-    if (tree.aggregationTreeConstruction(dataPointNames, m_constraint))
+    // Reuse the tree of a previous run on the same topology, producers and constraint
+    std::string cacheKey = m_treeCacheDir.empty() ? "" : TreeCache::Key(filename, dataPointNames, m_constraint, static_cast<int>(m_solverBackend));
+    std::string cachePath = cacheKey.empty() ? "" : TreeCache::Path(m_treeCacheDir, cacheKey);
+    if (!cachePath.empty() && TreeCache::Load(cachePath, cacheKey, rawAggregationTree, rawSubTree))
     {
-        rawAggregationTree = tree.aggregationAllocation;
-        rawSubTree = tree.noCHTree;
+        spdlog::info("Aggregation tree loaded from cache {}", cachePath);
     }
     else
     {
-        spdlog::error("Fail to construct aggregation tree!");
-        std::exit(EXIT_FAILURE);
+        // Create AggregationTree object, kept for repairs
+        m_tree = std::make_unique<AggregationTree>(filename);
+        m_tree->solverBackend = m_solverBackend;
+
+        // Construct the aggregation tree
+        if (m_tree->aggregationTreeConstruction(dataPointNames, m_constraint))
+        {
+            rawAggregationTree = m_tree->aggregationAllocation;
+            rawSubTree = m_tree->noCHTree;
+        }
+        else
+        {
+            spdlog::error("Fail to construct aggregation tree!");
+            std::exit(EXIT_FAILURE);
+        }
+
+        if (!cachePath.empty() && !TreeCache::Store(cachePath, cacheKey, rawAggregationTree, rawSubTree))
+            spdlog::warn("Failed to write aggregation tree cache {}", cachePath);
     }
 
     // Get the number of producers
@@ -227,6 +429,19 @@ void Consumer::ConstructAggregationTree()
             linkCount++;
         }
     }
+
+    // Intern consumer's child flows of all rounds, a flow belongs to the first round it shows up in
+    m_flows.Clear();
+    for (int roundIndex = 0; roundIndex < globalTreeRound.size(); roundIndex++)
+    {
+        for (const auto &flow : globalTreeRound[roundIndex])
+        {
+            if (m_flows.Find(flow) == INVALID_FLOW)
+            {
+                m_flows[m_flows.Intern(flow)].round = roundIndex;
+            }
+        }
+    }
 }
 
 void Consumer::StartApplication()
@@ -276,8 +491,9 @@ int Consumer::findRoundIndex(const std::string &target)
     return App::findRoundIndex(globalTreeRound, target);
 }
 
-double Consumer::getDataQueueSize(std::string prefix)
+double Consumer::getDataQueueSize(FlowId flow)
 {
+    FlowState &state = m_flows[flow];
     double queueSize = 0.0;
     for (const auto &[seq, aggList] : map_agg_oldSeq_newName)
     {
@@ -289,13 +505,13 @@ double Consumer::getDataQueueSize(std::string prefix)
                     NS_LOG_DEBUG(str); // Print each string in the vector
                 } */
 
-        if (std::find(aggList.begin(), aggList.end(), prefix) == aggList.end())
+        if (std::find(aggList.begin(), aggList.end(), state.name) == aggList.end())
         {
             queueSize = 1.0;
         }
     }
 
-    spdlog::debug("Flow: {} -> Data queue size: {}", prefix, queueSize);
+    LOG_DEBUG(Log::CONSUMER, "Flow: {} -> Data queue size: {}", state.name, queueSize);
     return queueSize;
 }
 
@@ -304,11 +520,27 @@ void Consumer::Aggregate(const ModelData &data, const uint32_t &seq)
     // first initialization
     if (sumParameters.find(seq) == sumParameters.end())
     {
-        sumParameters[seq] = std::vector<double>(m_dataSize, 0.0);
+        sumParameters[seq] = std::vector<double>(ModelSchema::instance().segmentLength(ModelSchema::instance().segmentOf(seq)), 0.0);
+    }
+
+    // Aggregate data
+    Reduce::sum(sumParameters[seq].data(), data.parameters.data(), std::min(data.parameters.size(), sumParameters[seq].size()));
+    contributorCount[seq] += data.contributors;
+}
+
+void Consumer::Aggregate(const ModelDataView &data, const uint32_t &seq)
+{
+    // first initialization
+    auto sumIt = sumParameters.find(seq);
+    if (sumIt == sumParameters.end())
+    {
+        size_t segmentLength = ModelSchema::instance().segmentLength(ModelSchema::instance().segmentOf(seq));
+        sumIt = sumParameters.emplace(seq, std::vector<double>(segmentLength, 0.0)).first;
     }
 
     // Aggregate data
-    std::transform(sumParameters[seq].begin(), sumParameters[seq].end(), data.parameters.begin(), sumParameters[seq].begin(), std::plus<double>());
+    accumulateModelData(data, sumIt->second.data());
+    contributorCount[seq] += data.contributors;
 }
 
 std::vector<double> Consumer::getMean(const uint32_t &seq)
@@ -320,11 +552,20 @@ std::vector<double> Consumer::getMean(const uint32_t &seq)
         return result;
     }
 
-    for (auto value : sumParameters[seq])
+    // Aggregators may forward an iteration without every producer, average over the models actually summed
+    uint32_t contributors = static_cast<uint32_t>(producerCount);
+    auto countIt = contributorCount.find(seq);
+    if (countIt != contributorCount.end() && countIt->second > 0)
     {
-        result.push_back(value / static_cast<double>(producerCount));
+        contributors = countIt->second;
+        if (static_cast<int>(contributors) < producerCount)
+            LOG_INFO(Log::CONSUMER, "Iteration {} aggregates {} of {} producers", seq, contributors, producerCount);
     }
 
+    const std::vector<double> &sum = sumParameters[seq];
+    result.assign(sum.size(), 0.0);
+    Reduce::scaledSum(result.data(), sum.data(), 1.0 / static_cast<double>(contributors), sum.size());
+
     return result;
 }
 
@@ -363,16 +604,37 @@ int64_t Consumer::GetAggregateTimeAverage()
 
 void Consumer::OnData(const ndn::Interest &interest, const ndn::Data &data)
 {
-    spdlog::info("Consumer received data");
+    LOG_DEBUG(Log::CONSUMER, "Consumer received data");
     if (!m_active)
         return;
 
     App::OnData(interest, data);
+    switch (m_signing.Verify(data))
+    {
+    case SigningPolicy::Verdict::REJECT:
+        LOG_INFO(Log::CONSUMER, "Data {} failed {} verification, dropped", data.getName().toUri(), signingModeName(m_signing.Mode()));
+        return;
+    case SigningPolicy::Verdict::HOLD:
+        LOG_DEBUG(Log::CONSUMER, "Data {} is held until its manifest arrives", data.getName().toUri());
+        return;
+    default:
+        break;
+    }
+    // Segments held for the manifest this data carried are handled right after it
+    for (ndn::Data &held : m_signing.TakeReleased())
+        m_scheduler.schedule(ndn::time::milliseconds(0), [this, held = std::move(held)]
+                             { this->OnData(ndn::Interest(held.getName()), held); });
     std::string type = data.getName().get(-2).toUri();
     std::string name_sec0 = data.getName().get(0).toUri();
     uint32_t seq = data.getName().at(-1).toSequenceNumber();
+    FlowId flow = m_flows.Find(data.getName());
     std::string dataName = data.getName().toUri();
     int dataSize = data.wireEncode().size();
+    if (type == "data" && flow == INVALID_FLOW && m_flows.Retired(data.getName()))
+    {
+        LOG_DEBUG(Log::CONSUMER, "Late data {} from a replaced child, dropped", dataName);
+        return;
+    }
     // Check whether this's duplicate data packet
     // question: why can't use receive duplicate data
     if (m_agg_finished.find(seq) != m_agg_finished.end())
@@ -383,64 +645,70 @@ void Consumer::OnData(const ndn::Interest &interest, const ndn::Data &data)
     }
 
     // TODO: testing, delete later
-    // getDataQueueSize(name_sec0);
+    // getDataQueueSize(flow);
 
     // TODO: what's the best strategy under qsf design?
     //? Currently pause the interest sending for 5 * current period
+    if (type == "data" && flow == INVALID_FLOW)
+    {
+        spdlog::error("Data from {} doesn't belong to any flow, please check!", name_sec0);
+        std::exit(EXIT_FAILURE);
+        return;
+    }
+
     // Check partial aggregation table
-    if (sumParameters.find(seq) == sumParameters.end())
+    if (type == "data" && sumParameters.find(seq) == sumParameters.end())
     {
         // New iteration, currently not exist in the partial agg result
         if (partialAggResult.size() >= m_dataQueue)
         {
+            FlowState &state = m_flows[flow];
             // Exceed max data size
-            spdlog::info("Exceeding the max data queue, stop interest sending for flow ", name_sec0);
+            LOG_INFO(Log::CONSUMER, "Exceeding the max data queue, stop interest sending for flow {}", name_sec0);
             dataOverflow++;
 
-            // Schdule next event after 5 * current period
-            if (m_scheduleEvent[name_sec0])
-            {
-                m_scheduleEvent[name_sec0].cancel();
-                m_scheduleEvent[name_sec0].reset();
-            }
-
-            double nextTime = 5 * 1 / m_rateLimit[name_sec0]; // Unit: us
-            spdlog::info("Flow {} -> Schedule next sending event after {} ms. from consumer ondata", name_sec0, nextTime / 1000);
-            // TODO:check whether int is suitable for the design
-            m_scheduleEvent[name_sec0] = m_scheduler.schedule(ndn::time::microseconds(static_cast<int64_t>(nextTime)),
-                                                              [this, name_sec0]
-                                                              { this->ScheduleNextPacket(name_sec0); });
+            // Pause the flow for 5 * current period
+            double nextTime = 5 * 1 / state.rateLimit; // Unit: us
+            LOG_DEBUG(Log::CONSUMER, "Flow {} -> Pause interest sending for {} ms. from consumer ondata", name_sec0, nextTime / 1000);
+            auto now = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime);
+            m_pacer.Pause(flow, now.count() + static_cast<int64_t>(nextTime));
         }
         partialAggResult[seq] = true;
     }
 
     // Erase timeout
-    if (m_timeoutCheck.find(dataName) != m_timeoutCheck.end())
-        m_timeoutCheck.erase(dataName);
-    else
+    if (!StopTimeoutCheck(data.getName()))
     {
         spdlog::error("Suspicious data packet, not exists in timeout list.");
         std::exit(EXIT_FAILURE);
         return;
     }
 
-    if (m_inFlight[name_sec0] > 0)
+    // The interest is satisfied, recycle its pending entry
+    PendingInterest pending;
+    bool wasPending = ErasePendingInterest(data.getName(), &pending);
+
+    if (flow != INVALID_FLOW && m_flows[flow].inFlight > 0)
     {
-        m_inFlight[name_sec0]--;
+        m_flows[flow].inFlight--;
     }
     if (type == "data")
     {
+        FlowState &state = m_flows[flow];
+        state.silentRounds = 0;
+
         // Perform data name matching with interest name
-        ModelData modelData;
+        ModelDataView modelData;
         auto data_agg = map_agg_oldSeq_newName.find(seq);
         if (data_agg != map_agg_oldSeq_newName.end())
         {
             // Aggregation starts
             auto &aggVec = data_agg->second;
             auto aggVecIt = std::find(aggVec.begin(), aggVec.end(), name_sec0);
-            std::vector<uint8_t> oldbuffer(data.getContent().value(), data.getContent().value() + data.getContent().value_size());
+            const ndn::Block &content = data.getContent();
 
-            if (deserializeModelData(oldbuffer, modelData))
+            size_t segmentLength = ModelSchema::instance().segmentLength(ModelSchema::instance().segmentOf(seq));
+            if (deserializeModelData(content.value(), content.value_size(), segmentLength, modelData))
             {
                 if (aggVecIt != aggVec.end())
                 {
@@ -462,85 +730,100 @@ void Consumer::OnData(const ndn::Interest &interest, const ndn::Data &data)
             }
 
             // RTT measurement
-            if (rttStartTime.find(dataName) != rttStartTime.end())
+            std::chrono::milliseconds responseTime(0);
+            if (wasPending)
             {
                 auto now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
-                responseTime[dataName] = now - rttStartTime[dataName];
-                ResponseTimeSum(responseTime[dataName].count());
-                rttStartTime.erase(dataName);
-                spdlog::info("Consumer's response time of sequence {} is: {} ms.", dataName, responseTime[dataName].count());
+                responseTime = now - pending.sendTime;
+                ResponseTimeSum(responseTime.count());
+                LOG_DEBUG(Log::CONSUMER, "Consumer's response time of sequence {} is: {} ms.", dataName, responseTime.count());
             }
             // RTO/RTT measure
             // zyx: data arrives so fastly that responseTime is 0
-            RTOMeasure(responseTime[dataName].count(), name_sec0);
-            RTTMeasure(name_sec0, responseTime[dataName].count());
+            RTOMeasure(responseTime.count(), flow);
+            RTTMeasure(flow, responseTime.count());
 
             //! Debugging, qsf design
             // Update estimated bandwidth
-            BandwidthEstimation(name_sec0, modelData.qsf);
+            BandwidthEstimation(flow, modelData.qsf);
 
             // Init rate limit update
-            if (firstData.at(name_sec0))
+            if (state.firstData)
             {
 
-                spdlog::debug("Init rate limit update for flow {}", name_sec0);
-                m_rateEvent[name_sec0] = m_scheduler.schedule(ndn::time::milliseconds(0), [this, name_sec0]
-                                                              { this->RateLimitUpdate(name_sec0); });
-                firstData[name_sec0] = false;
+                LOG_DEBUG(Log::CONSUMER, "Init rate limit update for flow {}", name_sec0);
+                state.rateEvent = m_scheduler.schedule(ndn::time::milliseconds(0), [this, flow]
+                                                       { this->RateLimitUpdate(flow); });
+                state.firstData = false;
             }
 
             // Get round index
-            int roundIndex = findRoundIndex(name_sec0);
+            int roundIndex = state.round;
             if (roundIndex == -1)
             {
                 spdlog::error("Error on roundIndex!");
                 std::exit(EXIT_FAILURE);
             }
-            spdlog::debug("This packet comes from round {}", roundIndex);
+            LOG_DEBUG(Log::CONSUMER, "This packet comes from round {}", roundIndex);
 
             // qsf recorder
-            QsfRecorder(name_sec0, modelData.qsf);
-            QueueRecorder(name_sec0, getDataQueueSize(name_sec0));
+            QsfRecorder(flow, modelData.qsf);
+            QueueRecorder(flow, getDataQueueSize(flow));
 
             // Record RTT
-            ResponseTimeRecorder(roundIndex, name_sec0, seq, responseTime[dataName]);
+            ResponseTimeRecorder(roundIndex, flow, seq, responseTime);
             // Record RTO
-            RTORecorder(name_sec0);
-            InFlightRecorder(name_sec0);
-            // Check whether the aggregation iteration has finished
+            RTORecorder(flow);
+            InFlightRecorder(flow);
+            // Check whether the aggregation of the segment has finished
             if (aggVec.empty())
             {
-                spdlog::debug("Aggregation of iteration {} finished!", seq);
-                // Measure aggregation time
-                if (aggregateStartTime.find(seq) != aggregateStartTime.end())
-                {
-                    auto now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
-                    aggregateTime[seq] = now - aggregateStartTime[seq];
-                    AggregateTimeSum(aggregateTime[seq].count());
-                    spdlog::info("Iteration {}'s aggregation time is:{}  ms.", seq, aggregateTime[seq].count());
-
-                    aggregateStartTime.erase(seq);
-                }
-                else
-                {
-                    spdlog::debug("Error when calculating aggregation time, no reference found for seq {}", seq);
-                }
-
-                // Record aggregation time
-                AggregateTimeRecorder(aggregateTime[seq], seq);
-
-                // Get aggregation result and store them
-                aggregationResult[seq] = getMean(seq);
-
-                // Mark the map that current iteration has finished
+                const ModelSchema &schema = ModelSchema::instance();
+                uint32_t iteration = schema.iterationOf(seq);
+                uint32_t segment = schema.segmentOf(seq);
+                LOG_DEBUG(Log::CONSUMER, "Aggregation of segment {} of iteration {} finished!", segment, iteration);
+
+                // Get aggregation result and store it into the iteration's model
+                std::vector<double> mean = getMean(seq);
+                std::vector<double> &model = aggregationResult[iteration];
+                if (model.empty())
+                    model.assign(m_dataSize, 0.0);
+                std::copy(mean.begin(), mean.end(), model.begin() + schema.segmentOffset(segment));
+
+                // Mark the map that current segment has finished
                 m_agg_finished[seq] = true;
 
-                // Clear aggregation time mapping for current iteration
-                aggregateTime.erase(seq);
-
                 // Remove seq from aggMap
                 map_agg_oldSeq_newName.erase(seq);
                 partialAggResult.erase(seq);
+                contributorCount.erase(seq);
+
+                // The iteration is done once all its segments are
+                if (++aggregatedSegments[iteration] == schema.segmentCount())
+                {
+                    aggregatedSegments.erase(iteration);
+                    LOG_DEBUG(Log::CONSUMER, "Aggregation of iteration {} finished!", iteration);
+                    // Measure aggregation time
+                    if (aggregateStartTime.find(iteration) != aggregateStartTime.end())
+                    {
+                        auto now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
+                        aggregateTime[iteration] = now - aggregateStartTime[iteration];
+                        AggregateTimeSum(aggregateTime[iteration].count());
+                        LOG_DEBUG(Log::CONSUMER, "Iteration {}'s aggregation time is:{}  ms.", iteration, aggregateTime[iteration].count());
+
+                        aggregateStartTime.erase(iteration);
+                    }
+                    else
+                    {
+                        LOG_DEBUG(Log::CONSUMER, "Error when calculating aggregation time, no reference found for iteration {}", iteration);
+                    }
+
+                    // Record aggregation time
+                    AggregateTimeRecorder(aggregateTime[iteration], iteration);
+
+                    // Clear aggregation time mapping for current iteration
+                    aggregateTime.erase(iteration);
+                }
             }
 
             // Stop simulation
@@ -561,9 +844,6 @@ void Consumer::OnData(const ndn::Interest &interest, const ndn::Data &data)
                 std::exit(EXIT_SUCCESS);
                 return;
             }
-            // Clear rtt mapping of this packet
-            rttStartTime.erase(dataName);
-            responseTime.erase(dataName);
         }
         else
         {
@@ -574,6 +854,7 @@ void Consumer::OnData(const ndn::Interest &interest, const ndn::Data &data)
     else if (type == "initialization")
     {
         spdlog::debug("Initialization data packet received, start aggregation!");
+        m_initParameters.erase(dataName);
         auto it = std::find(broadcastList.begin(), broadcastList.end(), name_sec0);
         if (it != broadcastList.end())
         {
@@ -581,9 +862,10 @@ void Consumer::OnData(const ndn::Interest &interest, const ndn::Data &data)
             spdlog::debug("Node {} has received aggregationTree map, erase it from broadcastList", name_sec0);
         }
         // qsf: init for each flow
-        // m_scheduleEvent[name_sec0] = Simulator::ScheduleNow(&Consumer::ScheduleNextPacket, this, name_sec0);
+        // state.scheduleEvent = Simulator::ScheduleNow(&Consumer::ScheduleNextPacket, this, name_sec0);
 
         // Tree broadcasting synchronization is done
+        bool wasSynced = broadcastSync;
         if (broadcastList.empty())
         {
             broadcastSync = true;
@@ -593,18 +875,18 @@ void Consumer::OnData(const ndn::Interest &interest, const ndn::Data &data)
             AggTreeRecorder();
         }
 
-        //! Schedule all flows together after synchronization
-        if (broadcastSync)
+        //! Start all flows together after synchronization, the subtrees pushed by a repair find them running
+        if (broadcastSync && !wasSynced)
         {
-            for (const auto &vec_round : globalTreeRound)
+            auto now = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime);
+            for (FlowId flow = 0; flow < m_flows.Size(); ++flow)
             {
-                for (const auto &flow : vec_round)
-                {
-                    spdlog::debug("Flow {} -> Schedule next sending event after initialization", flow);
-                    m_scheduleEvent[flow] = m_scheduler.schedule(ndn::time::milliseconds(0), [this, flow]
-                                                                 { this->ScheduleNextPacket(flow); });
-                }
+                LOG_DEBUG(Log::CONSUMER, "Flow {} -> Start interest sending after initialization", m_flows.Name(flow));
+                m_pacer.Start(flow, now.count());
             }
+            if (!m_pacerEvent)
+                m_pacerEvent = m_scheduler.schedule(ndn::time::milliseconds(0), [this]
+                                                    { this->PacerTick(); });
         }
     }
 }
@@ -613,17 +895,29 @@ void Consumer::OnNack(const ndn::Interest &interest, const ndn::lp::Nack &nack)
 {
     App::OnNack(interest, nack);
     std::string dataName = nack.getInterest().getName().toUri();
-    std::string name_sec0 = nack.getInterest().getName().get(0).toUri();
     uint32_t seq = nack.getInterest().getName().get(-1).toSequenceNumber();
     // if (nack.getReason() == ndn::lp::NackReason::DUPLICATE)
     // {
 
     //     return;
     // }
+    FlowId flow = m_flows.Find(nack.getInterest().getName());
+    if (flow == INVALID_FLOW && m_flows.Retired(nack.getInterest().getName()))
+    {
+        LOG_DEBUG(Log::CONSUMER, "NACK of {} from a replaced child, ignored", dataName);
+        return;
+    }
+    if (flow == INVALID_FLOW)
+    {
+        spdlog::error("NACK of an unknown flow, please exit and check!");
+        std::exit(EXIT_FAILURE);
+        return;
+    }
+    FlowState &state = m_flows[flow];
 
-    if (m_inFlight[name_sec0] > 0)
+    if (state.inFlight > 0)
     {
-        m_inFlight[name_sec0]--;
+        state.inFlight--;
     }
     else
     {
@@ -633,26 +927,22 @@ void Consumer::OnNack(const ndn::Interest &interest, const ndn::lp::Nack &nack)
     }
 
     // Insert the rejected interest back to the front of the interest queue
-    interestQueue[name_sec0].push_front(seq);
+    state.interestQueue.push_front(seq);
 
     // Decrease sending rate for certain flow
-    // WindowDecrease(name_sec0, "nack");
+    // WindowDecrease(flow, "nack");
 
     // Stop tracing rtt and timeout
-    rttStartTime.erase(dataName);
-    m_timeoutCheck.erase(dataName);
+    ErasePendingInterest(nack.getInterest().getName());
+    StopTimeoutCheck(nack.getInterest().getName());
     nackCount++;
 }
 
 void Consumer::OnTimeout(const ndn::Interest &interest)
 {
-    if (m_timeoutCheck.find(interest.getName().toUri()) != m_timeoutCheck.end())
+    if (!StopTimeoutCheck(interest.getName()))
     {
-        m_timeoutCheck.erase(interest.getName().toUri());
-    }
-    else
-    {
-        spdlog::info("already recieved packet");
+        LOG_DEBUG(Log::CONSUMER, "already recieved packet");
         return;
     }
     App::OnTimeout(interest);
@@ -692,86 +982,128 @@ void Consumer::CheckRetxTimeout()
     // ps:deleted schedule event and have different ontimeout
     std::chrono::milliseconds now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
 
-    for (auto it = m_timeoutCheck.begin(); it != m_timeoutCheck.end();)
+    // Tree broadcast interests, checked against a fixed threshold, an aggregator that never answers is replaced
+    std::vector<std::string> unreachable;
+    for (auto &[name, pending] : m_initPending)
     {
-        // Parse the string and extract the first segment, e.g. "agg0", then find out its round
-        std::string type = std::make_shared<ndn::Name>(it->first)->get(-2).toUri();
-
-        // For two types of data, check timeout respectively
-        if (type == "initialization")
+        if (now - pending.sendTime > (3 * m_retxTimer))
         {
-            if (now - it->second > (3 * m_retxTimer))
+            pending.handle.cancel();
+            if (m_repairRounds > 0 && pending.retxCount >= m_repairRounds)
             {
-
-                std::string name = it->first;
-                // it = m_timeoutCheck.erase(it);
-
-                m_pendingInterest[name].cancel();
-                // TODO：why should I wait for 1ms
-                m_timeoutEvent = m_scheduler.schedule(ndn::time::milliseconds(1), [this, name]
-                                                      { this->OnTimeout(ndn::Interest(name)); });
+                unreachable.push_back(ndn::Name(name).get(0).toUri());
+                continue;
             }
-            // else
-            // {
-            //     ++it;
-            // }
-            it++;
+            // TODO：why should I wait for 1ms
+            m_timeoutEvent = m_scheduler.schedule(ndn::time::milliseconds(1), [this, name = name]
+                                                  { this->OnTimeout(ndn::Interest(name)); });
         }
-        else if (type == "data")
-        {
-            std::string name = it->first;
-            std::string prefix = std::make_shared<ndn::Name>(name)->get(0).toUri();
+    }
+    for (const auto &node : unreachable)
+    {
+        RepairTree(node);
+    }
 
-            if (now - it->second > RTO_threshold[prefix])
-            {
-                std::string name = it->first;
-                // it = m_timeoutCheck.erase(it);
-                numTimeout[prefix]++;
-
-                m_pendingInterest[name].cancel();
-                spdlog::info("Timeout check name: {}", name);
-                m_timeoutEvent = m_scheduler.schedule(ndn::time::milliseconds(1), [this, name]
-                                                      { this->OnTimeout(ndn::Interest(name)); });
-                // OnTimeout(ndn::Interest(name));
-            }
-            // else
-            // {
-            //     ++it;
-            // }
-            it++;
-        }
+    // Data interests, only the ones whose deadline has passed are visited, they stay tracked until OnTimeout()
+    std::vector<TimerWheel::Key> expired;
+    m_timeouts.Expire(now, expired);
+
+    // A round counts once per child however many of its interests expired in it, a burst of expirations is one round.
+    // A child silent for m_repairRounds rounds is probed, not torn down, see ProbeNode().
+    std::set<FlowId> silentFlows;
+    for (TimerWheel::Key key : expired)
+    {
+        m_flows[TimerWheel::KeyFlow(key)].numTimeout++;
+        silentFlows.insert(TimerWheel::KeyFlow(key));
+    }
+    for (FlowId flow : silentFlows)
+    {
+        FlowState &state = m_flows[flow];
+        if (m_repairRounds > 0 && ++state.silentRounds == m_repairRounds)
+            ProbeNode(state.name);
+    }
+
+    for (TimerWheel::Key key : expired)
+    {
+        FlowId flow = TimerWheel::KeyFlow(key);
+
+        ndn::Name name(m_flows[flow].nameSec0_2);
+        name.appendSequenceNumber(TimerWheel::KeySeq(key));
+        if (PendingInterest *pending = m_pit.Find(key))
+            pending->handle.cancel();
+        LOG_DEBUG(Log::CONSUMER, "Timeout check name: {}", name.toUri());
+        m_timeoutEvent = m_scheduler.schedule(ndn::time::milliseconds(1), [this, name]
+                                              { this->OnTimeout(ndn::Interest(name)); });
     }
 
     // Reschedule the next timeout check event
     m_retxEvent = m_scheduler.schedule(ndn::time::milliseconds(m_retxTimer.count()), [this]
                                        { this->CheckRetxTimeout(); });
-    // m_retxEvent = m_checkretxScheduler.schedule(ndn::time::milliseconds(0), [this]
-    //                                             { this->CheckRetxTimeout(); });
 }
 
-void Consumer::RTOMeasure(int64_t resTime, std::string prefix)
+bool Consumer::StopTimeoutCheck(const ndn::Name &name)
+{
+    // A tree broadcast interest times out by its pending entry's sending time, which is reset when it's retransmitted
+    if (name.get(-2).toUri() == "initialization")
+        return m_initPending.find(name.toUri()) != m_initPending.end();
+
+    FlowId flow = m_flows.Find(name);
+    return flow != INVALID_FLOW && m_timeouts.Cancel(TimerWheel::MakeKey(flow, name.get(-1).toSequenceNumber()));
+}
+
+std::pair<PendingInterest *, bool> Consumer::InsertPendingInterest(const ndn::Name &name, FlowId flow)
+{
+    if (name.get(-2).toUri() == "initialization")
+    {
+        auto [it, inserted] = m_initPending.try_emplace(name.toUri());
+        return {&it->second, inserted};
+    }
+    if (flow == INVALID_FLOW)
+        return {nullptr, false};
+    return m_pit.Insert(TimerWheel::MakeKey(flow, name.get(-1).toSequenceNumber()));
+}
+
+bool Consumer::ErasePendingInterest(const ndn::Name &name, PendingInterest *erased)
+{
+    if (name.get(-2).toUri() == "initialization")
+    {
+        auto it = m_initPending.find(name.toUri());
+        if (it == m_initPending.end())
+            return false;
+        if (erased != nullptr)
+            *erased = it->second;
+        m_initPending.erase(it);
+        return true;
+    }
+
+    FlowId flow = m_flows.Find(name);
+    return flow != INVALID_FLOW && m_pit.Erase(TimerWheel::MakeKey(flow, name.get(-1).toSequenceNumber()), erased);
+}
+
+void Consumer::RTOMeasure(int64_t resTime, FlowId flow)
 {
-    if (!initRTO[prefix])
+    FlowState &state = m_flows[flow];
+    if (!state.initRTO)
     {
-        RTTVAR[prefix] = resTime / 2;
-        SRTT[prefix] = resTime;
-        spdlog::debug("Initialize RTO for flow:{}", prefix);
-        initRTO[prefix] = true;
+        state.rttvar = resTime / 2;
+        state.srtt = resTime;
+        LOG_DEBUG(Log::CONSUMER, "Initialize RTO for flow:{}", state.name);
+        state.initRTO = true;
     }
     else
     {
-        RTTVAR[prefix] = 0.75 * RTTVAR[prefix] + 0.25 * std::abs(SRTT[prefix] - resTime); // RTTVAR = (1 - b) * RTTVAR + b * |SRTT - RTTsample|, where b = 0.25
-        SRTT[prefix] = 0.875 * SRTT[prefix] + 0.125 * resTime;                            // SRTT = (1 - a) * SRTT + a * RTTsample, where a = 0.125
+        state.rttvar = 0.75 * state.rttvar + 0.25 * std::abs(state.srtt - resTime); // RTTVAR = (1 - b) * RTTVAR + b * |SRTT - RTTsample|, where b = 0.25
+        state.srtt = 0.875 * state.srtt + 0.125 * resTime;                            // SRTT = (1 - a) * SRTT + a * RTTsample, where a = 0.125
     }
-    int64_t RTO = SRTT[prefix] + 4 * RTTVAR[prefix]; // RTO = SRTT + K * RTTVAR, where K = 4
+    int64_t RTO = state.srtt + 4 * state.rttvar; // RTO = SRTT + K * RTTVAR, where K = 4
     // TODO: check if milliseconds is the right unit or microseconds
-    RTO_threshold[prefix] = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::microseconds(4 * RTO));
+    state.rtoThreshold = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::microseconds(4 * RTO));
 }
 
 void Consumer::InterestGenerator()
 {
     // Generate name from section 1 to 3 (except for seq)
-    spdlog::debug("consumer start generate interest");
+    LOG_DEBUG(Log::CONSUMER, "consumer start generate interest");
     std::vector<std::string> objectProducer;
     std::string token;
     std::istringstream tokenStream(proList);
@@ -795,10 +1127,10 @@ void Consumer::InterestGenerator()
                 name_sec1 += leaf + ".";
             }
             name_sec1.resize(name_sec1.size() - 1);
-            spdlog::debug("Name section 1: {}", name_sec1);
+            LOG_DEBUG(Log::CONSUMER, "Name section 1: {}", name_sec1);
             name_sec0_2 = "/" + child + "/" + name_sec1 + "/data";
-            spdlog::debug("Name section 0-2: {}", name_sec0_2);
-            NameSec0_2[child] = name_sec0_2;
+            LOG_DEBUG(Log::CONSUMER, "Name section 0-2: {}", name_sec0_2);
+            m_flows[m_flows.Find(child)].nameSec0_2 = name_sec0_2;
             vec_iteration.push_back(child); // Will be added to aggregation map later
         }
     }
@@ -807,9 +1139,9 @@ void Consumer::InterestGenerator()
 bool Consumer::InterestSplitting()
 {
     bool canSplit = true;
-    for (const auto &[prefix, queue] : interestQueue)
+    for (const FlowState &state : m_flows)
     {
-        if (queue.size() >= m_interestQueue)
+        if (state.interestQueue.size() >= m_interestQueue)
         {
             canSplit = false;
             break;
@@ -819,135 +1151,158 @@ bool Consumer::InterestSplitting()
     {
         // Update seq
         globalSeq++;
-        for (auto &[prefix, queue] : interestQueue)
+        for (FlowState &state : m_flows)
         {
-            queue.push_back(globalSeq);
+            state.interestQueue.push_back(globalSeq);
         }
     }
     else
     {
-        spdlog::info("Interest queue is full.");
+        LOG_INFO(Log::CONSUMER, "Interest queue is full.");
         return false;
     }
 
     return true;
 }
 
-void Consumer::SendPacket(std::string prefix)
+/**
+ * Pacer's periodic tick, every flow sends what its rate limit allows since the last tick
+ */
+void Consumer::PacerTick()
+{
+    auto now = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime);
+    m_pacer.Tick(now.count(), [this](FlowId flow)
+                 { return this->ReleasePacket(flow); });
+
+    // Stop ticking once every flow has finished
+    if (m_pacer.ActiveCount() == 0)
+    {
+        m_pacerEvent.reset();
+        return;
+    }
+    m_pacerEvent = m_scheduler.schedule(ndn::time::microseconds(m_pacerTick), [this]
+                                        { this->PacerTick(); });
+}
+
+void Consumer::SendPacket(FlowId flow)
 {
-    spdlog::info("Consumer starts sending packet");
+    FlowState &state = m_flows[flow];
+    LOG_DEBUG(Log::CONSUMER, "Consumer starts sending packet");
     // Error handling for queue
-    if (interestQueue[prefix].empty())
+    if (state.interestQueue.empty())
     {
-        spdlog::info("No more Interests to send - prefix {}", prefix);
+        LOG_DEBUG(Log::CONSUMER, "No more Interests to send - state.name {}", state.name);
         std::exit(EXIT_FAILURE);
         return; // Early return if the queue is empty to avoid popping from an empty deque
     }
-    uint32_t seq = interestQueue[prefix].front();
-    interestQueue[prefix].pop_front();
-    SeqMap[prefix] = seq;
-    std::shared_ptr<ndn::Name> newName = std::make_shared<ndn::Name>(NameSec0_2[prefix]);
+    uint32_t seq = state.interestQueue.front();
+    state.interestQueue.pop_front();
+    state.seq = seq;
+    std::shared_ptr<ndn::Name> newName = std::make_shared<ndn::Name>(state.nameSec0_2);
     newName->appendSequenceNumber(seq);
-    spdlog::info("Sending packet - {}", newName->toUri());
+    LOG_DEBUG(Log::CONSUMER, "Sending packet - {}", newName->toUri());
     SendInterest(newName);
     // This is different from the code in ndnSim because we need to record the aggregation map before sending the interest
 
-    // Check whether it's the start of a new iteration
-    if (aggregateStartTime.find(seq) == aggregateStartTime.end())
+    // Check whether it's the start of a new segment, the iteration's aggregation time starts with its first segment
+    if (map_agg_oldSeq_newName.find(seq) == map_agg_oldSeq_newName.end())
     {
         std::chrono::milliseconds now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
-        aggregateStartTime[seq] = now;
+        aggregateStartTime.emplace(ModelSchema::instance().iterationOf(seq), now);
         map_agg_oldSeq_newName[seq] = vec_iteration;
-        spdlog::info("map aggreation old seq new name: {} {}", seq, prefix);
+        LOG_DEBUG(Log::CONSUMER, "map aggreation old seq new name: {} {}", seq, state.name);
     }
 }
 
 void Consumer::SendInterest(std::shared_ptr<ndn::Name> newName)
 {
-    spdlog::debug("Consumer starts sending interest");
+    LOG_DEBUG(Log::CONSUMER, "Consumer starts sending interest");
     if (!m_active)
         return;
 
     std::string nameWithSeq = newName->toUri();
-    std::string name_sec0 = newName->get(0).toUri();
-    // Trace timeout
+    FlowId flow = m_flows.Find(*newName);
+    // Trace timeout, data interests expire after the flow's RTO threshold at sending time
     auto now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
-    m_timeoutCheck[nameWithSeq] = now;
+    if (newName->get(-2).toUri() != "initialization" && flow != INVALID_FLOW)
+        m_timeouts.Arm(TimerWheel::MakeKey(flow, newName->get(-1).toSequenceNumber()), now + m_flows[flow].rtoThreshold);
 
-    // Start response time
-    rttStartTime[nameWithSeq] = now;
-
-    std::shared_ptr<ndn::Interest> interest = std::make_shared<ndn::Interest>();
-
-    // Check if nonce already exists for this interest
-    if (m_nonceMap.find(nameWithSeq) == m_nonceMap.end())
+    // Pending entry, holds the nonce and the reference of the response time
+    auto [pending, inserted] = InsertPendingInterest(*newName, flow);
+    if (pending == nullptr)
     {
-        // Generate a new nonce and store it
-        uint32_t nonce = static_cast<uint32_t>(m_uniformDist(m_rand));
-        m_nonceMap[nameWithSeq] = nonce;
-        spdlog::info("New nonce generated for interest: {}", nameWithSeq);
+        spdlog::error("Can't track pending interest {}, the table is full ({} entries) or the flow is unknown!", nameWithSeq, m_pit.Capacity());
+        std::exit(EXIT_FAILURE);
+        return;
     }
-    interest->setNonce(m_nonceMap[nameWithSeq]);
+    if (inserted)
+    {
+        // Generate a new nonce, a retransmission keeps the one of the first transmission
+        pending->nonce = static_cast<uint32_t>(m_uniformDist(m_rand));
+        LOG_DEBUG(Log::CONSUMER, "New nonce generated for interest: {}", nameWithSeq);
+    }
+    else
+    {
+        pending->retxCount++;
+    }
+    pending->sendTime = now;
+
+    std::shared_ptr<ndn::Interest> interest = std::make_shared<ndn::Interest>();
+    interest->setNonce(pending->nonce);
     // interest->setNonce(m_uniformDist(m_rand));
     // TODO: check if the nonce is the reason?
     interest->setName(*newName);
+    // Initialization interests carry their subtree
+    auto parameters = m_initParameters.find(nameWithSeq);
+    if (parameters != m_initParameters.end())
+        interest->setApplicationParameters(ndn::make_span(parameters->second.data(), parameters->second.size()));
     interest->setCanBePrefix(false);
     // interest->setInterestLifetime(ndn::time::milliseconds(m_interestLifeTime.count()));
     interest->setInterestLifetime(ndn::time::seconds(2));
 
-    spdlog::info("Sending interest >>>> {}", nameWithSeq);
+    LOG_DEBUG(Log::CONSUMER, "Sending interest >>>> {}", nameWithSeq);
     // TODO: there are some problems with the following code because actully the ontimeout doesn't suit the situation
-    m_pendingInterest[nameWithSeq] = m_face.expressInterest(*interest,
-                                                            std::bind(&Consumer::OnData, this, _1, _2),
-                                                            std::bind(&Consumer::OnNack, this, _1, _2),
-                                                            std::bind(&Consumer::OnTimeout, this, _1));
+    pending->handle = m_face.expressInterest(*interest,
+                                             std::bind(&Consumer::OnData, this, _1, _2),
+                                             std::bind(&Consumer::OnNack, this, _1, _2),
+                                             std::bind(&Consumer::OnTimeout, this, _1));
     // m_face.processEvents();
 
     // Record interest throughput
     // Actual interests sending and retransmission are recorded as well
-    m_inFlight[name_sec0]++;
-    spdlog::debug("consumer finished sending interest");
+    if (flow != INVALID_FLOW)
+    {
+        m_flows[flow].inFlight++;
+    }
+    LOG_DEBUG(Log::CONSUMER, "consumer finished sending interest");
 }
 
-bool Consumer::CongestionDetection(std::string prefix, int64_t responseTime)
+bool Consumer::CongestionDetection(FlowId flow, int64_t responseTime)
 {
-    //* Normal usage is "push_back" "pop_front"
-    // Update RTT windowed queue and historical estimation
-    RTT_windowed_queue[prefix].push_back(responseTime);
-    RTT_count[prefix]++;
-
-    if (RTT_windowed_queue[prefix].size() > m_smooth_window_size)
+    FlowState &state = m_flows[flow];
+    // Update RTT windowed average and historical estimation, the sample leaving the window feeds the EWMA
+    int64_t transitionValue;
+    if (state.rttWindow.Add(responseTime, &transitionValue))
     {
-        int64_t transitionValue = RTT_windowed_queue[prefix].front();
-        RTT_windowed_queue[prefix].pop_front();
-
-        if (RTT_historical_estimation[prefix] == 0)
-        {
-            RTT_historical_estimation[prefix] = transitionValue;
-        }
-        else
-        {
-            RTT_historical_estimation[prefix] = m_EWMAFactor * transitionValue + (1 - m_EWMAFactor) * RTT_historical_estimation[prefix];
-        }
+        state.rttHistorical.Add(static_cast<double>(transitionValue));
     }
     else
     {
-        spdlog::debug("m_smooth_window_size: {}", m_smooth_window_size);
-        spdlog::debug("RTT_windowed_queue size: {}", RTT_windowed_queue[prefix].size());
+        LOG_DEBUG(Log::CONSUMER, "RTT window size: {}", state.rttWindow.Size());
     }
+    state.rttMin.Add(responseTime);
+    state.rttTail.Add(static_cast<double>(responseTime));
+    state.rttCount++;
 
     // Detect congestion
-    if (RTT_count[prefix] >= 2 * m_smooth_window_size)
+    if (state.rttCount >= 2 * m_smooth_window_size)
     {
-        int64_t pastRTTAverage = 0;
-        for (int64_t pastRTT : RTT_windowed_queue[prefix])
-        {
-            pastRTTAverage += pastRTT;
-        }
-        pastRTTAverage /= m_smooth_window_size;
+        int64_t pastRTTAverage = state.rttWindow.Sum() / m_smooth_window_size;
+
         // Enable RTT-estimation for scheduler
         isRTTEstimated = true;
-        int64_t rtt_threshold = m_thresholdFactor * RTT_historical_estimation[prefix];
+
+        int64_t rtt_threshold = m_thresholdFactor * state.rttHistorical.Value();
         if (rtt_threshold < pastRTTAverage)
         {
             return true;
@@ -959,64 +1314,31 @@ bool Consumer::CongestionDetection(std::string prefix, int64_t responseTime)
     }
     else
     {
-        spdlog::debug("RTT_count: {}", RTT_count[prefix]);
+        LOG_DEBUG(Log::CONSUMER, "RTT_count: {}", state.rttCount);
         return false;
     }
 }
 
-void Consumer::RTORecorder(std::string prefix)
+void Consumer::RTORecorder(FlowId flow)
 {
-    // Open the file using fstream in append mode
-    std::ofstream file(RTO_recorder[prefix], std::ios::app);
-
-    if (!file.is_open())
-    {
-        spdlog::error("Failed to open the file: {}", RTO_recorder[prefix]);
-        return;
-    }
-
-    // Write the response_time to the file, followed by a newline
-    auto now = std::chrono::steady_clock::now();
-    file << std::chrono::duration_cast<std::chrono::milliseconds>(now - startTime).count() << " " << RTO_threshold[prefix].count() << std::endl;
-
-    // Close the file
-    file.close();
+    FlowState &state = m_flows[flow];
+    auto now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
+    Telemetry::Instance().Record(state.rtoStream, flow, now.count(), {static_cast<double>(state.rtoThreshold.count())});
 }
 
-void Consumer::ResponseTimeRecorder(int roundIndex, std::string prefix, uint32_t seq, std::chrono::milliseconds responseTime)
+void Consumer::ResponseTimeRecorder(int roundIndex, FlowId flow, uint32_t seq, std::chrono::milliseconds responseTime)
 {
-
-    std::ofstream file(responseTime_recorder[prefix], std::ios::app);
-
-    if (!file.is_open())
-    {
-        spdlog::error("Failed to open the file: {}", responseTime_recorder[prefix]);
-        std::exit(EXIT_FAILURE);
-        return;
-    }
-
+    FlowState &state = m_flows[flow];
     auto now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
-
-    file << now.count() << " " << seq << " " << responseTime.count() << std::endl;
-    file.close();
+    Telemetry::Instance().Record(state.responseTimeStream, flow, now.count(),
+                                 {static_cast<double>(seq), static_cast<double>(responseTime.count())});
 }
 
 void Consumer::AggregateTimeRecorder(std::chrono::milliseconds aggregateTime, uint32_t seq)
 {
-    // Open the file using fstream in append mode
-    std::ofstream file(aggregateTime_recorder, std::ios::app);
-
-    if (!file.is_open())
-    {
-        spdlog::error("Failed to open the file: {}", aggregateTime_recorder);
-        return;
-    }
-
-    // Write aggregation time to file, followed by a new line
     auto now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
-    file << now.count() << " " << seq << " " << aggregateTime.count() << std::endl;
-
-    file.close();
+    Telemetry::Instance().Record(aggregateTimeStream, INVALID_FLOW, now.count(),
+                                 {static_cast<double>(seq), static_cast<double>(aggregateTime.count())});
 }
 
 void Consumer::InitializeLogFile()
@@ -1024,36 +1346,32 @@ void Consumer::InitializeLogFile()
     // waiting for modify path
     //  Check whether object path exists, create it if not
     CheckDirectoryExist(folderPath);
-    for (int roundIndex = 0; roundIndex < globalTreeRound.size(); roundIndex++)
-    {
-        for (int i = 0; i < globalTreeRound[roundIndex].size(); i++)
-        {
-            // RTT/RTO recorder
-            // responseTime_recorder[globalTreeRound[roundIndex][i]] = folderPath + "/consumer_RTT_round" + std::to_string(roundIndex) + "_" + globalTreeRound[roundIndex][i] + ".txt";
-            // RTO_recorder[globalTreeRound[roundIndex][i]] = folderPath + "/consumer_RTO_round" + std::to_string(roundIndex) + "_" + globalTreeRound[roundIndex][i] + ".txt";
-            responseTime_recorder[globalTreeRound[roundIndex][i]] = folderPath + "/consumer_RTT_" + globalTreeRound[roundIndex][i] + ".txt";
-            spdlog::debug("responseTime_recorder[{}]: {}", globalTreeRound[roundIndex][i], responseTime_recorder[globalTreeRound[roundIndex][i]]);
-            RTO_recorder[globalTreeRound[roundIndex][i]] = folderPath + "/consumer_RTO_" + globalTreeRound[roundIndex][i] + ".txt";
-            OpenFile(responseTime_recorder[globalTreeRound[roundIndex][i]]);
-            OpenFile(RTO_recorder[globalTreeRound[roundIndex][i]]);
-        }
-    }
-    for (const auto &round : globalTreeRound)
-    {
-        for (const auto &prefix : round)
-        {
-            qsNew_recorder[prefix] = folderPath + "/consumer_queue_" + prefix + ".txt";
-            qsf_recorder[prefix] = folderPath + "/consumer_qsf_" + prefix + ".txt";
-            inFlight_recorder[prefix] = folderPath + "/consumer_inFlight_" + prefix + ".txt";
-            OpenFile(qsNew_recorder[prefix]);
-            OpenFile(qsf_recorder[prefix]);
-            OpenFile(inFlight_recorder[prefix]);
-        }
+
+    // Per-packet samples are recorded to a binary telemetry log, telemetry-convert writes the text files below from it
+    Telemetry &telemetry = Telemetry::Instance();
+    telemetry.Open(folderPath + "/consumer_telemetry.bin");
+    for (FlowState &state : m_flows)
+    {
+        // RTT/RTO recorder
+        // state.responseTimeRecorder = folderPath + "/consumer_RTT_round" + std::to_string(state.round) + "_" + state.name + ".txt";
+        // state.rtoRecorder = folderPath + "/consumer_RTO_round" + std::to_string(state.round) + "_" + state.name + ".txt";
+        state.responseTimeRecorder = folderPath + "/consumer_RTT_" + state.name + ".txt";
+        spdlog::debug("responseTime_recorder[{}]: {}", state.name, state.responseTimeRecorder);
+        state.rtoRecorder = folderPath + "/consumer_RTO_" + state.name + ".txt";
+        state.responseTimeStream = telemetry.RegisterStream(state.responseTimeRecorder, "ii");
+        state.rtoStream = telemetry.RegisterStream(state.rtoRecorder, "i");
+
+        state.queueRecorder = folderPath + "/consumer_queue_" + state.name + ".txt";
+        state.qsfRecorder = folderPath + "/consumer_qsf_" + state.name + ".txt";
+        state.inFlightRecorder = folderPath + "/consumer_inFlight_" + state.name + ".txt";
+        state.queueStream = telemetry.RegisterStream(state.queueRecorder, "ffffii", true);
+        state.qsfStream = telemetry.RegisterStream(state.qsfRecorder, "fffffi", true);
+        state.inFlightStream = telemetry.RegisterStream(state.inFlightRecorder, "i");
     }
     // Aggregation time, AggTree, throughput
     aggregateTime_recorder = folderPath + "/consumer_aggregationTime.txt";
+    aggregateTimeStream = telemetry.RegisterStream(aggregateTime_recorder, "ii");
     // Open the file and clear all contents for all log files
-    OpenFile(aggregateTime_recorder);
     OpenFile(throughput_recorder);
     OpenFile(aggTree_recorder);
     // Result log
@@ -1064,42 +1382,46 @@ void Consumer::InitializeLogFile()
  */
 void Consumer::InitializeParameter()
 {
-    int i = 0;
-    // Each round
-    for (const auto &round : globalTreeRound)
-    {
-        // Individual flow
-        for (const auto &prefix : round)
-        {
-            //* Initialize RTO and RTT parameters
-            initRTO[prefix] = false;
-            RTO_threshold[prefix] = 5 * m_retxTimer;
-            // RTT_threshold[prefix] = 0;
-            RTT_count[prefix] = 0;
-            RTT_historical_estimation[prefix] = 0;
-            //* Initialize sequence map, interest queue
-            SeqMap[prefix] = 0;
-            interestQueue[prefix] = std::deque<uint32_t>();
-            m_inFlight[prefix] = 0;
-            //! Debugging - Initialize qsf info
-            m_qsfSlidingWindows[prefix] = SlidingWindow<double>(std::chrono::milliseconds(m_qsfTimeDuration));
-            m_estimatedBW[prefix] = m_qsfInitRate;
-            m_rateLimit[prefix] = m_qsfInitRate;
-            firstData[prefix] = true;
-            // m_rateEvent[prefix] = Simulator::ScheduleNow(&Consumer::RateLimitUpdate, this, prefix);
-            RTT_estimation_qsf[prefix] = 0; // Init rtt estimation as 0
-            spdlog::info("Init rate limit - {} pkgs/ms.", m_rateLimit[prefix] * 1000);
-        }
-        i++;
-    }
+    // Individual flow of every round
+    for (FlowState &state : m_flows)
+    {
+        //* Initialize RTO and RTT parameters
+        state.initRTO = false;
+        state.rtoThreshold = 5 * m_retxTimer;
+        // state.rttThreshold = 0;
+        state.rttWindow = WindowedSum<int64_t, RTT_WINDOW_CAPACITY>(m_smooth_window_size);
+        state.rttHistorical = Ewma(m_EWMAFactor);
+        state.rttMin.Clear();
+        state.rttTail.Clear();
+        state.rttCount = 0;
+        //* Initialize sequence map, interest queue
+        state.seq = 0;
+        state.interestQueue = std::deque<uint32_t>();
+        state.inFlight = 0;
+        //! Debugging - Initialize qsf info
+        state.qsfSlidingWindow = SlidingWindow<double>(std::chrono::milliseconds(m_qsfTimeDuration));
+        state.estimatedBW = m_qsfInitRate;
+        state.rateLimit = m_qsfInitRate;
+        state.firstData = true;
+        // state.rateEvent = Simulator::ScheduleNow(&Consumer::RateLimitUpdate, this, flow);
+        state.rttEstimationQsf = 0; // Init rtt estimation as 0
+        spdlog::info("Init rate limit - {} pkgs/ms.", state.rateLimit * 1000);
+    }
+    // Preallocate the pending interest table, it's recycled instead of growing with the iterations
+    m_pit.Reset(m_pitSize);
+
     // Init params for interest sending rate pacing
+    m_pacer.Reset(m_flows.Size(), m_pacerTick, m_pacerBurst);
+    for (FlowId flow = 0; flow < m_flows.Size(); ++flow)
+        m_pacer.SetRate(flow, m_flows[flow].rateLimit);
     isRTTEstimated = false;
 }
 
-bool Consumer::CanDecreaseWindow(std::string prefix, int64_t threshold)
+bool Consumer::CanDecreaseWindow(FlowId flow, int64_t threshold)
 {
+    FlowState &state = m_flows[flow];
     auto now = std::chrono::steady_clock::now();
-    auto lastDecrease_ms = lastWindowDecreaseTime[prefix].count();
+    auto lastDecrease_ms = state.lastWindowDecreaseTime.count();
 
     if (std::chrono::duration_cast<std::chrono::microseconds>(now - startTime).count() - lastDecrease_ms >= threshold)
     {
@@ -1116,18 +1438,11 @@ bool Consumer::CanDecreaseWindow(std::string prefix, int64_t threshold)
 /**
  * Record in-flight packets when receiving a new packet
  */
-void Consumer::InFlightRecorder(std::string prefix)
+void Consumer::InFlightRecorder(FlowId flow)
 {
-    // Open file; on first call, truncate it to delete old content
-    std::ofstream file(inFlight_recorder[prefix], std::ios::app);
-    if (!file.is_open())
-    {
-        std::cerr << "Failed to open the file: " << inFlight_recorder[prefix] << std::endl;
-        return;
-    }
+    FlowState &state = m_flows[flow];
     auto now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
-    file << now.count() << " " << m_inFlight[prefix] << std::endl;
-    file.close();
+    Telemetry::Instance().Record(state.inFlightStream, flow, now.count(), {static_cast<double>(state.inFlight)});
 }
 
 void Consumer::ThroughputRecorder(int interestThroughput, int dataThroughput, std::chrono::milliseconds start_simulation, std::chrono::milliseconds start_throughput)
@@ -1217,6 +1532,21 @@ void Consumer::ResultRecorder(uint32_t iteNum, int timeoutNum, int64_t aveAggTim
     file << "Nack(upstream interest queue overflow) is triggered for " << nackCount << " times" << std::endl;
     file << "Average aggregation time: " << aveAggTime << " ms." << std::endl;
     file << "Total aggregation time: " << totalTime << " ms." << std::endl;
+    const SigningPolicy::Stats &signing = m_signing.GetStats();
+    file << "Verification (" << signingModeName(m_signing.Mode()) << "): " << signing.verified << " accepted, " << signing.rejected
+         << " rejected, " << signing.held << " held for their manifest, " << signing.unmatched << " unmatched" << std::endl;
+    for (FlowId flow = 0; flow < m_flows.Size(); ++flow)
+    {
+        const Pacer::Stats &stats = m_pacer.GetStats(flow);
+        file << "Flow " << m_flows.Name(flow) << " pacing: " << stats.released << " interests sent, " << stats.expected
+             << " allowed by the rate limit (error " << stats.Error() << "), max batch " << stats.maxBatch << std::endl;
+        const FlowState &state = m_flows[flow];
+        if (!state.rttMin.Empty())
+        {
+            file << "Flow " << m_flows.Name(flow) << " RTT: min " << state.rttMin.Value() << " us (last " << RTT_MIN_WINDOW
+                 << " samples), p95 " << static_cast<int64_t>(state.rttTail.Value()) << " us, historical " << static_cast<int64_t>(state.rttHistorical.Value()) << " us" << std::endl;
+        }
+    }
     file << "-----------------------------------" << std::endl;
 }
 
@@ -1224,86 +1554,57 @@ void Consumer::ResultRecorder(uint32_t iteNum, int timeoutNum, int64_t aveAggTim
  * Record qsf congestion info
  * Unit - transferred into ms or pkgs/ms
  */
-void Consumer::QsfRecorder(std::string prefix, double qsf)
+void Consumer::QsfRecorder(FlowId flow, double qsf)
 {
-    // Open the file using fstream in append mode
-    std::ofstream file(qsf_recorder[prefix], std::ios::app);
-
-    if (!file.is_open())
-    {
-        spdlog::error("Failed to open the file: {}", qsf_recorder[prefix]);
-        return;
-    }
-
-    double actualQsf;
-    if (qsf == -1)
-    {
-        actualQsf = static_cast<double>(std::max(interestQueue[prefix].size(), partialAggResult.size()));
-    }
-    else
-    {
-        actualQsf = qsf;
-    }
+    FlowState &state = m_flows[flow];
+    double localQueue = static_cast<double>(std::max(state.interestQueue.size(), partialAggResult.size()));
+    double actualQsf = qsf == -1 ? localQueue : qsf;
 
     // time - rate limit - BW - throughput(data arrival rate) - qsf - local queue size - rtt estimation
     auto now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
-    file << now.count() << " "
-         << m_rateLimit[prefix] * 1000 << " "
-         << m_estimatedBW[prefix] * 1000 << " "
-         << GetDataRate(prefix) * 1000 << " "
-         << actualQsf << " "
-         << static_cast<double>(std::max(interestQueue[prefix].size(), partialAggResult.size())) << " "
-         << RTT_estimation_qsf[prefix] / 1000 << " "
-         << std::endl;
-
-    file.close();
+    Telemetry::Instance().Record(state.qsfStream, flow, now.count(),
+                                 {state.rateLimit * 1000,
+                                  state.estimatedBW * 1000,
+                                  GetDataRate(flow) * 1000,
+                                  actualQsf,
+                                  localQueue,
+                                  static_cast<double>(state.rttEstimationQsf / 1000)});
 }
 
 /**
  * Record queue size based CC info
  */
-void Consumer::QueueRecorder(std::string prefix, double queueSize)
+void Consumer::QueueRecorder(FlowId flow, double queueSize)
 {
-    // Open the file using fstream in append mode
-    std::ofstream file(qsNew_recorder[prefix], std::ios::app);
-
-    if (!file.is_open())
-    {
-        spdlog::error("Failed to open the file: {}", qsNew_recorder[prefix]);
-        return;
-    }
-
-    // Write the response_time to the file, followed by a newline
+    FlowState &state = m_flows[flow];
+    // time - rate limit - BW - throughput(data arrival rate) - queue size - in-flight - rtt estimation
     auto now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
-    file << now.count() << " "
-         << m_rateLimit[prefix] * 1000 << " "
-         << m_estimatedBW[prefix] * 1000 << " "
-         << GetDataRate(prefix) * 1000 << " "
-         << queueSize << " "
-         << m_inFlight[prefix] << " "
-         << RTT_estimation_qsf[prefix] / 1000 << " "
-         << std::endl;
-
-    // Close the file
-    file.close();
+    Telemetry::Instance().Record(state.queueStream, flow, now.count(),
+                                 {state.rateLimit * 1000,
+                                  state.estimatedBW * 1000,
+                                  GetDataRate(flow) * 1000,
+                                  queueSize,
+                                  static_cast<double>(state.inFlight),
+                                  static_cast<double>(state.rttEstimationQsf / 1000)});
 }
 
-// zyx : avoid RTT_estimation_qsf[prefix] == 0
-void Consumer::RTTMeasure(std::string prefix, int64_t resTime)
+// zyx : avoid state.rttEstimationQsf == 0
+void Consumer::RTTMeasure(FlowId flow, int64_t resTime)
 {
+    FlowState &state = m_flows[flow];
     // Update RTT estimation
-    if (RTT_estimation_qsf[prefix] == 0)
+    if (state.rttEstimationQsf == 0)
     {
-        RTT_estimation_qsf[prefix] = resTime;
+        state.rttEstimationQsf = resTime;
     }
     else
     {
-        RTT_estimation_qsf[prefix] = m_EWMAFactor * RTT_estimation_qsf[prefix] + (1 - m_EWMAFactor) * resTime;
+        state.rttEstimationQsf = m_EWMAFactor * state.rttEstimationQsf + (1 - m_EWMAFactor) * resTime;
     }
     // TODO : need to consider more instead of assigning it 1
-    if (RTT_estimation_qsf[prefix] == 0)
+    if (state.rttEstimationQsf == 0)
     {
-        RTT_estimation_qsf[prefix] = 1;
+        state.rttEstimationQsf = 1;
     }
 }
 
@@ -1311,9 +1612,10 @@ void Consumer::RTTMeasure(std::string prefix, int64_t resTime)
  * Get the data rate and return with correct value from the sliding window
  */
 double
-Consumer::GetDataRate(std::string prefix)
+Consumer::GetDataRate(FlowId flow)
 {
-    double rawDataRate = m_qsfSlidingWindows[prefix].GetDataArrivalRate();
+    FlowState &state = m_flows[flow];
+    double rawDataRate = state.qsfSlidingWindow.GetDataArrivalRate();
 
     // "0": sliding window size is less than one, keep init rate as data arrival rate; "-1" indicates error
     if (rawDataRate == -1)
@@ -1324,7 +1626,7 @@ Consumer::GetDataRate(std::string prefix)
     }
     else if (rawDataRate == 0)
     {
-        spdlog::info("Sliding window is not enough, data arrival rate is corrected as init rate: {} pkgs/ms", m_qsfInitRate * 1000);
+        LOG_INFO(Log::CONSUMER, "Sliding window is not enough, data arrival rate is corrected as init rate: {} pkgs/ms", m_qsfInitRate * 1000);
         return m_qsfInitRate;
     }
     else
@@ -1335,32 +1637,33 @@ Consumer::GetDataRate(std::string prefix)
 
 /**
  * Bandwidth estimation
- * @param prefix flow
+ * @param flow flow
  * @param dataArrivalRate data arrival rate
  */
-void Consumer::BandwidthEstimation(std::string prefix, double qsfUpstream)
+void Consumer::BandwidthEstimation(FlowId flow, double qsfUpstream)
 {
+    FlowState &state = m_flows[flow];
     auto arrivalTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
-    spdlog::info("Flow: {} - Arrival time: {}", prefix, arrivalTime.count());
+    LOG_DEBUG(Log::CONSUMER, "Flow: {} - Arrival time: {}", state.name, arrivalTime.count());
     if (qsfUpstream == -1)
     {
         // Upstream aggregator which connects to producers directly
-        double localQueue = static_cast<double>(std::max(interestQueue[prefix].size(), partialAggResult.size()));
-        m_qsfSlidingWindows[prefix].AddPacket(arrivalTime, localQueue);
+        double localQueue = static_cast<double>(std::max(state.interestQueue.size(), partialAggResult.size()));
+        state.qsfSlidingWindow.AddPacket(arrivalTime, localQueue);
     }
     else
     {
         // Other aggregators
-        m_qsfSlidingWindows[prefix].AddPacket(arrivalTime, qsfUpstream);
+        state.qsfSlidingWindow.AddPacket(arrivalTime, qsfUpstream);
     }
 
-    double aveQSF = m_qsfSlidingWindows[prefix].GetAverageQsf();
-    double dataArrivalRate = GetDataRate(prefix);
+    double aveQSF = state.qsfSlidingWindow.GetAverageQsf();
+    double dataArrivalRate = GetDataRate(flow);
 
     // Correction for qsf and data arrival rate
     if (aveQSF == -1)
     {
-        spdlog::info("Returned QSF is -1, please check!");
+        LOG_INFO(Log::CONSUMER, "Returned QSF is -1, please check!");
         std::exit(EXIT_FAILURE);
         return;
     }
@@ -1368,56 +1671,58 @@ void Consumer::BandwidthEstimation(std::string prefix, double qsfUpstream)
     // Update bandwidth estimation
     if (aveQSF > m_qsfQueueThreshold)
     {
-        spdlog::info("QSF is larger than threshold, update bandwidth estimation: {} pkgs/ms", dataArrivalRate * 1000);
-        m_estimatedBW[prefix] = dataArrivalRate;
+        LOG_DEBUG(Log::CONSUMER, "QSF is larger than threshold, update bandwidth estimation: {} pkgs/ms", dataArrivalRate * 1000);
+        state.estimatedBW = dataArrivalRate;
     }
 
-    if (dataArrivalRate > m_estimatedBW[prefix])
+    if (dataArrivalRate > state.estimatedBW)
     {
-        m_estimatedBW[prefix] = dataArrivalRate;
+        state.estimatedBW = dataArrivalRate;
     }
 
-    spdlog::info("Flow: {} - Average QSF: {}, Arrival Rate: {} pkgs/ms, Bandwidth estimation: {} pkgs/ms",
-                 prefix, aveQSF, dataArrivalRate * 1000, m_estimatedBW[prefix] * 1000);
+    LOG_DEBUG(Log::CONSUMER, "Flow: {} - Average QSF: {}, Arrival Rate: {} pkgs/ms, Bandwidth estimation: {} pkgs/ms",
+                 state.name, aveQSF, dataArrivalRate * 1000, state.estimatedBW * 1000);
 }
 
 /**
  * Update each flow's rate limit.
  */
-void Consumer::RateLimitUpdate(std::string prefix)
+void Consumer::RateLimitUpdate(FlowId flow)
 {
-    double qsf = m_qsfSlidingWindows[prefix].GetAverageQsf();
-    spdlog::debug("Flow {} - qsf: {}", prefix, qsf);
+    FlowState &state = m_flows[flow];
+    double qsf = state.qsfSlidingWindow.GetAverageQsf();
+    LOG_DEBUG(Log::CONSUMER, "Flow {} - qsf: {}", state.name, qsf);
 
     // Congestion control
     if (qsf > 2 * m_qsfQueueThreshold)
     {
-        m_rateLimit[prefix] = m_estimatedBW[prefix] * m_qsfMDFactor;
-        spdlog::debug("Congestion detected. Update rate limit: {} pkgs/ms", m_rateLimit[prefix] * 1000);
+        state.rateLimit = state.estimatedBW * m_qsfMDFactor;
+        LOG_DEBUG(Log::CONSUMER, "Congestion detected. Update rate limit: {} pkgs/ms", state.rateLimit * 1000);
     }
     else
     {
-        m_rateLimit[prefix] = m_estimatedBW[prefix];
-        spdlog::debug("No congestion. Update rate limit by estimated BW: {} pkgs/ms", m_rateLimit[prefix] * 1000);
+        state.rateLimit = state.estimatedBW;
+        LOG_DEBUG(Log::CONSUMER, "No congestion. Update rate limit by estimated BW: {} pkgs/ms", state.rateLimit * 1000);
     }
 
     // Rate probing
     if (qsf < m_qsfQueueThreshold)
     {
-        m_rateLimit[prefix] = m_rateLimit[prefix] * m_qsfRPFactor;
-        spdlog::debug("Start rate probing. Updated rate limit: {} pkgs/ms", m_rateLimit[prefix] * 1000);
+        state.rateLimit = state.rateLimit * m_qsfRPFactor;
+        LOG_DEBUG(Log::CONSUMER, "Start rate probing. Updated rate limit: {} pkgs/ms", state.rateLimit * 1000);
     }
+    m_pacer.SetRate(flow, state.rateLimit);
 
     // Error handling
-    if (RTT_estimation_qsf[prefix] == 0)
+    if (state.rttEstimationQsf == 0)
     {
         spdlog::error("RTT estimation is 0, please check!");
         std::exit(EXIT_FAILURE);
         return;
     }
 
-    spdlog::debug("Flow {} - Schedule next rate limit update after {} ms", prefix, RTT_estimation_qsf[prefix] / 1000);
+    LOG_DEBUG(Log::CONSUMER, "Flow {} - Schedule next rate limit update after {} ms", state.name, state.rttEstimationQsf / 1000);
 
-    m_rateEvent[prefix] = m_scheduler.schedule(ndn::time::microseconds(RTT_estimation_qsf[prefix]), [this, prefix]
-                                               { this->RateLimitUpdate(prefix); });
+    state.rateEvent = m_scheduler.schedule(ndn::time::microseconds(state.rttEstimationQsf), [this, flow]
+                                           { this->RateLimitUpdate(flow); });
 }
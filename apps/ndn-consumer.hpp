@@ -23,9 +23,18 @@
 #include <chrono>
 #include <filesystem>
 #include <fstream>
+#include <sstream>
 #include "ndn-app.hpp"
 #include "ModelData.hpp"
+#include "kernels/reduce.hpp"
 #include "sliding_window.hpp"
+#include "flow_table.hpp"
+#include "aggregation_subtree.hpp"
+#include "tree_cache.hpp"
+#include "timer_wheel.hpp"
+#include "pending_interest_table.hpp"
+#include "pacer.hpp"
+#include "signing_policy.hpp"
 #include "algorithm/utility/utility.hpp"
 #include "algorithm/include/AggregationTree.hpp"
 
@@ -79,7 +88,26 @@ public:
     void TreeBroadcast();
     void ConstructAggregationTree();
 
-    void SendPacket(std::string prefix);
+    /**
+     * @brief Send node its subtree of the current aggregation tree in an initialization Interest
+     */
+    void SendTreeInit(const std::string &node);
+
+    /**
+     * @brief Replace a failed aggregator, or the one behind a dead link, and push the subtrees that changed
+     * @param failed Aggregator that stopped answering
+     */
+    void RepairTree(const std::string &failed);
+
+    /**
+     * @brief Ask a silent aggregator for its status. No answer means it's dead and it's repaired; an answer lists its
+     * own silent children, which are probed in turn, so only the node whose whole subtree went silent is replaced
+     */
+    void ProbeNode(const std::string &node);
+    void OnProbeData(const std::string &node, const ndn::Data &data);
+    void OnProbeFailed(const std::string &node);
+
+    void SendPacket(FlowId flow);
     void InterestGenerator();
 
     bool InterestSplitting();
@@ -90,6 +118,13 @@ public:
      */
     void Aggregate(const ModelData &data, const uint32_t &seq);
 
+    /**
+     * @brief Method to aggregate data straight from the received packet's content
+     * @param data View over the received Data content
+     * @param seq The sequence number
+     */
+    void Aggregate(const ModelDataView &data, const uint32_t &seq);
+
     /**
      * @brief Method to get the mean of the parameters
      * @param seq The sequence number
@@ -126,41 +161,41 @@ public:
      * @param prefix The prefix for which to get the data queue size
      * @return The size of the data queue
      */
-    double getDataQueueSize(std::string prefix);
+    double getDataQueueSize(FlowId flow);
 
     /**
      * @brief Measure the Round-Trip Time (RTT) for a given prefix
      * @param prefix The prefix for which to measure RTT
      * @param resTime The response time
      */
-    void RTTMeasure(std::string prefix, int64_t resTime);
+    void RTTMeasure(FlowId flow, int64_t resTime);
 
     /**
      * @brief Get the data rate for a given prefix
      * @param prefix The prefix for which to get the data rate
      * @return The data rate
      */
-    double GetDataRate(std::string prefix);
+    double GetDataRate(FlowId flow);
 
     /**
      * @brief Estimate the bandwidth for a given prefix based on the QSF (Queue Size Factor) upstream
      * @param prefix The prefix for which to estimate bandwidth
      * @param qsfUpstream The QSF upstream value
      */
-    void BandwidthEstimation(std::string prefix, double qsfUpstream);
+    void BandwidthEstimation(FlowId flow, double qsfUpstream);
 
     /**
      * @brief Update the rate limit for a given prefix
      * @param prefix The prefix for which to update the rate limit
      */
-    void RateLimitUpdate(std::string prefix);
+    void RateLimitUpdate(FlowId flow);
 
     /**
      * @brief Record the QSF (Queue Size Factor) for a given prefix
      * @param prefix The prefix for which to record the QSF
      * @param qsf The QSF value
      */
-    void QsfRecorder(std::string prefix, double qsf);
+    void QsfRecorder(FlowId flow, double qsf);
 
     /**
      * @brief Detect congestion for a given prefix based on the response time
@@ -168,22 +203,22 @@ public:
      * @param responseTime The response time
      * @return True if congestion is detected, false otherwise
      */
-    bool CongestionDetection(std::string prefix, int64_t responseTime);
+    bool CongestionDetection(FlowId flow, int64_t responseTime);
 
     /**
      * Compute new RTO based on response time of recent packets
      * @param resTime
      * @param roundIndex data packet's round index
      */
-    void RTOMeasure(int64_t resTime, std::string prefix);
+    void RTOMeasure(int64_t resTime, FlowId flow);
 
     /**
      * @brief Method to record RTO results in files for testing purposes
      */
-    void RTORecorder(std::string prefix);
+    void RTORecorder(FlowId flow);
 
     // waiting for comments
-    void InFlightRecorder(std::string prefix);
+    void InFlightRecorder(FlowId flow);
 
     /**
      * @brief Method to record response time for a given prefix and sequence number
@@ -192,7 +227,7 @@ public:
      * @param seq The sequence number
      * @param responseTime The response time in milliseconds
      */
-    void ResponseTimeRecorder(int roundIndex, std::string prefix, uint32_t seq, std::chrono::milliseconds responseTime);
+    void ResponseTimeRecorder(int roundIndex, FlowId flow, uint32_t seq, std::chrono::milliseconds responseTime);
 
     /**
      * @brief Method to record aggregate time for a given sequence number
@@ -217,7 +252,7 @@ public:
      * @param threshold The threshold value
      * @return True if the window size can be decreased, false otherwise
      */
-    bool CanDecreaseWindow(std::string prefix, int64_t threshold);
+    bool CanDecreaseWindow(FlowId flow, int64_t threshold);
 
     /**
      * @brief Method to record throughput information
@@ -247,7 +282,7 @@ public:
      * @param prefix The prefix for which to record the queue size
      * @param queueSize The size of the queue
      */
-    void QueueRecorder(std::string prefix, double queueSize);
+    void QueueRecorder(FlowId flow, double queueSize);
 
     /**
      * @brief Override the function in App class to return leaf nodes
@@ -275,7 +310,16 @@ protected:
 
     virtual void StopApplication() override;
 
-    virtual void ScheduleNextPacket(std::string prefix) = 0;
+    /**
+     * @brief Send the next interest of flow, called by the pacer once per token
+     * @return False if the flow has nothing to send right now
+     */
+    virtual bool ReleasePacket(FlowId flow) = 0;
+
+    /**
+     * @brief Release the interests every flow's rate limit allows since the last tick, then schedule the next tick
+     */
+    void PacerTick();
 
     virtual void SendInterest(std::shared_ptr<ndn::Name> newName);
 
@@ -284,6 +328,29 @@ protected:
      */
     void CheckRetxTimeout();
 
+    /**
+     * @brief Stop tracking the timeout of an interest
+     * @param name The interest's name
+     * @return False if it wasn't tracked, i.e. its data, nack or timeout has been handled already
+     */
+    bool StopTimeoutCheck(const ndn::Name &name);
+
+    /**
+     * @brief Pending entry of an interest about to be sent, created unless it's a retransmission
+     * @param name The interest's name
+     * @param flow The interest's flow, unused for tree broadcast interests
+     * @return The entry (nullptr if it can't be tracked) and whether it has just been created
+     */
+    std::pair<PendingInterest *, bool> InsertPendingInterest(const ndn::Name &name, FlowId flow);
+
+    /**
+     * @brief Recycle the pending entry of an answered interest
+     * @param name The interest's name
+     * @param erased Receives the entry's last content, may be nullptr
+     * @return False if the interest isn't pending
+     */
+    bool ErasePendingInterest(const ndn::Name &name, PendingInterest *erased = nullptr);
+
     /**
      * @brief Method to set the retransmission timer
      * @param retxTimer The retransmission timer value
@@ -302,19 +369,12 @@ protected:
 
     // Log path
     std::string folderPath = "logs/con";
-    std::map<std::string, std::string> RTO_recorder;
-    std::map<std::string, std::string> responseTime_recorder; // Format: 'Time', 'seq', 'RTT', ‘ECN’, 'isWindowDecreaseSuppressed'
-    std::map<std::string, std::string> windowRecorder;        // Format: 'Time', 'cwnd', 'cwnd threshold' (when cwnd is larger than the threshold, cwnd increase will be suppressed)
-    std::map<std::string, std::string> inFlight_recorder;     // Format: 'Time', 'inFlight'
-    std::map<std::string, std::string> qsf_recorder;          //? qsf
-    std::map<std::string, std::string> qsNew_recorder;        //! Updated queue size CC
-    std::string aggregateTime_recorder;                       // Format: 'Time', 'aggTime'
-    int suspiciousPacketCount;                                // When timeout is triggered, add one
-    int dataOverflow;                                         // Record the number of data overflow
-    int nackCount;                                            // Record the number of NACK
-
-    // Update when WindowDecrease() is called every time, used for CWA algorithm
-    std::map<std::string, std::chrono::milliseconds> lastWindowDecreaseTime;
+    std::string aggregateTime_recorder; // Format: 'Time', 'aggTime'
+    TelemetryStream aggregateTimeStream = INVALID_STREAM;
+    int suspiciousPacketCount;          // When timeout is triggered, add one
+    int dataOverflow;                   // Record the number of data overflow
+    int nackCount;                      // Record the number of NACK
+
     bool isWindowDecreaseSuppressed;
 
     // Throughput measurement
@@ -329,11 +389,8 @@ protected:
     // General window design
     uint32_t m_initialWindow;
     uint32_t m_minWindow;
-    std::map<std::string, double> m_window;
-    std::map<std::string, uint32_t> m_inFlight;
 
     // AIMD design
-    std::map<std::string, double> m_ssthresh;
     bool m_useCwa;
     uint32_t m_highData;
     double m_recPoint;
@@ -347,13 +404,9 @@ protected:
     static constexpr double m_cubic_c = 0.4;
     static constexpr double m_cubicBeta = 0.7;
     bool m_useCubicFastConv;
-    std::map<std::string, double> m_cubicWmax;
-    std::map<std::string, double> m_cubicLastWmax;
 
     // TODO: debugging
     // Interest sending rate pacing
-    std::map<std::string, ndn::scheduler::EventId> m_scheduleEvent;
-    std::map<std::string, ndn::scheduler::EventId> m_sendEvent;
     bool isRTTEstimated;
     int m_initPace;
 
@@ -363,24 +416,16 @@ protected:
     double m_qsfRPFactor;
     int m_qsfTimeDuration;
     double m_qsfInitRate; // Unit: pgks/ms
-    std::map<std::string, bool> firstData;
-    std::map<std::string, SlidingWindow<double>> m_qsfSlidingWindows;
-    std::map<std::string, ndn::scheduler::EventId> m_rateEvent;
-    std::map<std::string, double> m_rateLimit;         // Unit: pkgs/ms
-    std::map<std::string, double> m_estimatedBW;       // Unit: pkgs/ms
-    std::map<std::string, int64_t> RTT_estimation_qsf; // Unit: ms
 
     // Global flow map
     std::vector<std::vector<std::string>> globalTreeRound; // First dimension: round. Second dimension: next-tier leaves, initialized in ConstructAggregationTree()
     int linkCount;
 
-    //! Start here, implement per-flow design, change round into per-flow
-    std::map<std::string, int> RTT_count; // How many RTT packets this node has received, used to estimate how many iterations have passed
+    // Per-flow state (cwnd, RTO, QSF, interest queue, log files), one entry per consumer child over all rounds
+    FlowTable m_flows;
 
     //? The following is new design for windowed average RTT
-    std::map<std::string, std::deque<int64_t>> RTT_windowed_queue; // Store windowed average RTT for each flow
-    std::map<std::string, int64_t> RTT_historical_estimation;      // Historical RTT estimation
-    int m_smooth_window_size;                                      // Window size for RTT windowed average
+    int m_smooth_window_size; // Window size for RTT windowed average
 
     //* initSeq is only used once, when broadcasting the aggregation tree
     uint32_t initSeq;
@@ -390,11 +435,6 @@ protected:
 
     uint32_t globalSeq;
 
-    //? Track the latest iteration has been sent. Function - determine whether it's the correct time to start aggregation time
-    std::map<std::string, uint32_t> SeqMap; // Key: flow, Value: seq
-    //? Keep a interest queue for each flow
-    std::map<std::string, std::deque<uint32_t>> interestQueue; // Key: flow, Value: queue
-
     // Get producer list, which are used to generate new interests
     std::string proList;
 
@@ -404,25 +444,28 @@ protected:
     bool broadcastSync;
     std::set<std::string> broadcastList; // Elements within the set need to be broadcasted, all elements are unique
 
-    std::map<uint32_t, std::vector<std::string>> map_agg_oldSeq_newName; // Manage names for entire iteration
-    std::map<uint32_t, bool> m_agg_finished;                             // Manage whether aggregation is finished for each iteration
+    std::map<uint32_t, std::vector<std::string>> map_agg_oldSeq_newName; // Manage names for each segment's seq
+    std::map<uint32_t, bool> m_agg_finished;                             // Manage whether aggregation is finished for each segment's seq
+    std::map<uint32_t, uint32_t> aggregatedSegments;                     // Segments of an iteration whose aggregation is finished
 
     // Used inside InterestGenerator
-    std::map<std::string, std::string> NameSec0_2; // Key: flow, Value: first three segments of interest name, e.g. "/agg0/pro0.pro1/data"
-    std::vector<std::string> vec_iteration;        // Store upstream nodes' name
+    std::vector<std::string> vec_iteration; // Store upstream nodes' name
 
     // Timeout check/ RTO measurement
-    std::map<std::string, std::chrono::milliseconds> m_timeoutCheck;
-    std::map<std::string, std::chrono::milliseconds> RTO_threshold;
-    std::map<std::string, int64_t> SRTT;
-    std::map<std::string, int64_t> RTTVAR;
-    std::map<std::string, bool> initRTO;
-    // TODO: Count the number of timeout, testing purpose only
-    std::map<std::string, int> numTimeout;
+    TimerWheel m_timeouts;                                // Data interests, keyed by (flow, seq)
+    PendingInterestTable m_pit;                           // Data interests' nonce, sending time and face handle
+    std::map<std::string, PendingInterest> m_initPending; // Tree broadcast interests, one per aggregator, timed out by sendTime
+    std::map<std::string, std::vector<uint8_t>> m_initParameters; // Encoded subtree of each tree broadcast interest, by name
+
+    // Interest sending rate pacing, one tick releases the interests of all flows
+    Pacer m_pacer;
+    SigningPolicy m_signing; // Verifies the Data from children
+    ndn::scheduler::EventId m_pacerEvent;
 
     // Designed for actual aggregation operations
     std::map<uint32_t, bool> partialAggResult;
     std::map<uint32_t, std::vector<double>> sumParameters;
+    std::map<uint32_t, uint32_t> contributorCount; // Producers' models summed into sumParameters
     std::map<uint32_t, std::vector<double>> aggregationResult;
     int producerCount;
 
@@ -431,8 +474,6 @@ protected:
     bool ECNRemote;
 
     // defined for response time
-    std::map<std::string, std::chrono::milliseconds> rttStartTime;
-    std::map<std::string, std::chrono::milliseconds> responseTime;
     int64_t total_response_time;
     int round;
 
@@ -447,10 +488,20 @@ protected:
     std::string m_interestName; // Consumer's interest prefix
     std::string m_nodeprefix;   // Consumer's node prefix
     uint32_t m_iteNum;          // The number of iterations
+    uint32_t m_lastSeq;         // Seq of the last segment of the last iteration
     int m_interestQueue;        // Interest queue size
     int m_dataQueue;            // Data queue size
+    int m_pitSize;              // Max number of outstanding data interests
+    int m_pacerTick;            // Period of the pacer, unit: us
+    double m_pacerBurst;        // Max interests a flow may send at once, raised to one tick's worth of its rate
     int m_dataSize;             // Data size
     int m_constraint;           // Constraint of each sub-tree
+    std::string m_treeCacheDir; // Directory of the aggregation tree cache, empty to always rebuild the tree
+    int m_repairRounds;         // Silent timeout check rounds after which a child is probed, 0 to never repair the tree
+    std::set<std::string> m_probing; // Nodes with an outstanding status probe
+    uint32_t m_probeSeq = 0;
+    MinCostFlowSolver::Backend m_solverBackend; // Min-cost flow solver of the clustering, "simplex" or "ssp" in the config
+    std::unique_ptr<AggregationTree> m_tree; // Tree and link costs kept for repairs, built on the first one after a cache hit
     double m_EWMAFactor;        // Factor used in EWMA, recommended value is between 0.1 and 0.3
     double m_thresholdFactor;   // Factor to compute "RTT_threshold", i.e. "RTT_threshold = Threshold_factor * RTT_measurement"
     bool m_useWIS;
@@ -529,8 +580,6 @@ protected:
     SeqTimeoutsContainer m_seqLastDelay;
     SeqTimeoutsContainer m_seqFullDelay;
     std::map<uint32_t, uint32_t> m_seqRetxCounts;
-    std::map<std::string, uint32_t> m_nonceMap;
-    std::map<std::string, ndn::PendingInterestHandle> m_pendingInterest;
 
     std::chrono::steady_clock::time_point startTime;
     ndn::Scheduler m_scheduler;
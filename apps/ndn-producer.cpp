@@ -1,19 +1,23 @@
 #include "ndn-producer.hpp"
 
 #include "ModelData.hpp"
+#include <boost/asio/post.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/ini_parser.hpp>
 
 Producer::Producer(const std::string &prefix)
     : m_virtualPayloadSize(1024),
       m_freshness(ndn::time::milliseconds(1000)),
       m_prefixnum(0),
       m_prefix(prefix),
-      m_dataSize(150)
+      m_dataSize(static_cast<int>(ModelSchema::instance().parameterCount())),
+      m_generator(std::random_device{}()),
+      m_prefetch(1),
+      m_iteNum(200)
 {
     // 初始化 spdlog
-    m_logger = spdlog::basic_logger_mt("producer_logger", "logs/producer.log");
-    spdlog::set_default_logger(m_logger);
-    spdlog::set_level(spdlog::level::info); // 设置日志级别
-    spdlog::flush_on(spdlog::level::info);  // 每条 info 级别及以上的日志后刷新
+    m_logger = Log::init("producer_logger", "logs/producer.log"); // 级别、刷新与异步模式见 config.ini [Log]
+    ReadConfig();
 
     spdlog::info("Producer initialized");
 }
@@ -21,35 +25,67 @@ Producer::Producer(const std::string &prefix)
 Producer::Producer()
     : m_virtualPayloadSize(1024),
       m_freshness(ndn::time::milliseconds(1000)),
-      m_prefixnum(0)
+      m_prefixnum(0),
+      m_dataSize(static_cast<int>(ModelSchema::instance().parameterCount())),
+      m_generator(std::random_device{}()),
+      m_prefetch(1),
+      m_iteNum(200)
 {
     // 初始化 spdlog
-    m_logger = spdlog::basic_logger_mt("producer_logger", "logs/producer.log");
-    spdlog::set_default_logger(m_logger);
-    spdlog::set_level(spdlog::level::info); // 设置日志级别
-    spdlog::flush_on(spdlog::level::warn);  // 每条 warn 级别及以上的日志后刷新
+    m_logger = Log::init("producer_logger", "logs/producer.log"); // 级别、刷新与异步模式见 config.ini [Log]
+    ReadConfig();
 
     spdlog::info("Producer initialized");
 }
 
+void Producer::ReadConfig()
+{
+    boost::property_tree::ptree pt;
+    try
+    {
+        boost::property_tree::ini_parser::read_ini("../experiments/config.ini", pt);
+    }
+    catch (const std::exception &e)
+    {
+        spdlog::error("Exception caught: {}", e.what());
+    }
+
+    // Producer section
+    m_shardFile = pt.get<std::string>("Producer.ShardFile", "");
+    m_prefetch = pt.get<uint32_t>("Producer.Prefetch", 1);
+    m_iteNum = pt.get<uint32_t>("Consumer.Iteration", 200);
+
+    // Security section
+    m_signing = SigningPolicy::fromConfig("../experiments/config.ini");
+}
+
 void Producer::OnInterest(const ndn::InterestFilter &filter, const ndn::Interest &interest)
 {
     App::OnInterest(filter, interest);
 
     if (!m_active)
         return;
+    const ModelSchema &schema = ModelSchema::instance();
+    const ndn::name::Component &last = interest.getName().at(-1);
+    uint32_t seq = last.isSequenceNumber() ? static_cast<uint32_t>(last.toSequenceNumber()) : 0;
+
+    // Serve the trainer's shard, prepared in the background
+    if (m_loader != nullptr && seq != 0)
+    {
+        ServeShard(interest, seq);
+        return;
+    }
+
     // create Data packet
     auto data = std::make_shared<ndn::Data>(interest.getName());
     data->setFreshnessPeriod(m_freshness);
 
-    // generate new data content
-    ModelData modelData;
-    std::default_random_engine generator(std::random_device{}());   // reate random generator
+    // generate new data content, only the segment the interest asks for
+    ModelData modelData(schema, schema.segmentOf(seq));
     std::uniform_real_distribution<double> distribution(0.0, 10.0); // define range (0.0, 10.0)
-    modelData.parameters.clear();
-    for (int i = 0; i < m_dataSize; ++i)
+    for (double &parameter : modelData.parameters)
     {
-        modelData.parameters.push_back(distribution(generator)); // generate random double range (0.0, 10.0)
+        parameter = distribution(m_generator); // generate random double range (0.0, 10.0)
     }
 
     std::vector<uint8_t> buffer;
@@ -58,17 +94,117 @@ void Producer::OnInterest(const ndn::InterestFilter &filter, const ndn::Interest
     ndn::Block contentBlock(ndn::tlv::Content, bufferPtr);
     data->setContent(contentBlock);
 
-    // use KeyChain to sign Data packet
-    m_keyChain.sign(*data);
+    // sign Data packet with the configured signing policy
+    m_signing.Sign(m_keyChain, *data);
     // send Data packet
     m_face.put(*data);
 }
 
+void Producer::ServeShard(const ndn::Interest &interest, uint32_t seq)
+{
+    const ModelSchema &schema = ModelSchema::instance();
+    uint32_t iteration = schema.iterationOf(seq);
+    uint32_t segment = schema.segmentOf(seq);
+    m_dataPrefix = interest.getName().getPrefix(-1);
+
+    // Keep the previous iteration for retransmissions, prepare the next ones while this one is served
+    while (!m_shards.empty() && m_shards.begin()->first + 1 < iteration)
+        m_shards.erase(m_shards.begin());
+    for (uint32_t next = iteration; next <= std::min(iteration + m_prefetch, m_iteNum); ++next)
+        RequestShard(next);
+
+    ShardState &state = m_shards[iteration];
+    if (state.failed)
+    {
+        // The prefetch may have run before the trainer wrote the file, it's needed now
+        state.failed = false;
+        m_loader->Request(iteration);
+    }
+    if (state.shard == nullptr)
+    {
+        state.pending.push_back(interest);
+        return;
+    }
+
+    if (segment < state.data.size() && state.data[segment] != nullptr && state.data[segment]->getName() == interest.getName())
+        m_face.put(*state.data[segment]);
+    else
+        m_face.put(*MakeData(interest.getName(), state.shard->contents[segment]));
+}
+
+void Producer::RequestShard(uint32_t iteration)
+{
+    if (m_shards.find(iteration) != m_shards.end())
+        return;
+    m_shards.emplace(iteration, ShardState{});
+    m_loader->Request(iteration);
+}
+
+void Producer::OnShardLoaded(uint32_t iteration, std::shared_ptr<const ShardLoader::Shard> shard)
+{
+    auto it = m_shards.find(iteration);
+    if (it == m_shards.end())
+        return; // Served and dropped meanwhile
+    ShardState &state = it->second;
+    if (shard == nullptr)
+    {
+        if (!state.pending.empty())
+        {
+            spdlog::error("Shard of iteration {} ({}) can't be loaded, stop and check!", iteration, m_loader->PathOf(iteration));
+            std::exit(EXIT_FAILURE);
+        }
+        // Prefetched too early, kept as failed rather than dropped so the following interests don't retry it, the
+        // loader already logged why
+        LOG_DEBUG(Log::PRODUCER, "Shard of iteration {} couldn't be prefetched, loaded again once it's served", iteration);
+        state.failed = true;
+        return;
+    }
+
+    // Pre-sign every segment under the name the interests use
+    const ModelSchema &schema = ModelSchema::instance();
+    state.shard = std::move(shard);
+    state.data.resize(schema.segmentCount());
+    for (uint32_t segment = 0; segment < schema.segmentCount(); ++segment)
+    {
+        ndn::Name name(m_dataPrefix);
+        name.appendSequenceNumber(schema.segmentSeq(iteration, segment));
+        state.data[segment] = MakeData(name, state.shard->contents[segment]);
+    }
+    LOG_DEBUG(Log::PRODUCER, "Shard of iteration {} ready, {} pending interests", iteration, state.pending.size());
+
+    std::vector<ndn::Interest> pending;
+    pending.swap(state.pending);
+    for (const ndn::Interest &interest : pending)
+        ServeShard(interest, static_cast<uint32_t>(interest.getName().at(-1).toSequenceNumber()));
+}
+
+std::shared_ptr<ndn::Data> Producer::MakeData(const ndn::Name &name, const ndn::Block &content)
+{
+    auto data = std::make_shared<ndn::Data>(name);
+    data->setFreshnessPeriod(m_freshness);
+    data->setContent(content);
+    m_signing.Sign(m_keyChain, *data);
+    return data;
+}
+
 void Producer::StartApplication()
 {
 
     App::StartApplication();
     spdlog::info("Producer application started");
+    if (!m_shardFile.empty())
+    {
+        std::string unsupported;
+        if (!ShardLoader::IsSupported(unsupported))
+        {
+            spdlog::error("Tensor {} can't be read from shard files, float32 or float64 expected", unsupported);
+            std::exit(EXIT_FAILURE);
+        }
+        m_loader = std::make_unique<ShardLoader>(m_shardFile, m_prefix.empty() ? "" : m_prefix.get(0).toUri(), [this](uint32_t iteration, std::shared_ptr<const ShardLoader::Shard> shard)
+                                                 { boost::asio::post(m_face.getIoContext(), [this, iteration, shard = std::move(shard)]() mutable
+                                                                     { OnShardLoaded(iteration, std::move(shard)); }); });
+        spdlog::info("Serving shards from {}, {} iterations ahead", m_shardFile, m_prefetch);
+    }
     m_face.setInterestFilter(m_prefix.toUri(),
                              std::bind(&Producer::OnInterest, this, std::placeholders::_1, std::placeholders::_2),
                              std::bind(&App::OnRegisterSuccess, this, std::placeholders::_1),
@@ -79,6 +215,7 @@ void Producer::StartApplication()
 
 void Producer::StopApplication()
 {
+    m_loader.reset();
     App::StopApplication();
     spdlog::info("Producer application stopped");
 }
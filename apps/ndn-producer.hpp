@@ -14,6 +14,8 @@
 #include <string>
 #include <iostream>
 #include "ndn-app.hpp"
+#include "signing_policy.hpp"
+#include "shard_loader.hpp"
 
 class Producer : public App
 {
@@ -46,6 +48,45 @@ public:
     void StopApplication() override;
 
 private:
+    /**
+     * @brief Read the producer's configuration from config.ini
+     */
+    void ReadConfig();
+
+    /**
+     * @brief Answer an interest from the iteration's shard, queue it until the shard is loaded
+     * @param seq Packet seq of the interest
+     */
+    void ServeShard(const ndn::Interest &interest, uint32_t seq);
+
+    /**
+     * @brief Start loading the shard of iteration unless it's loaded or being loaded
+     */
+    void RequestShard(uint32_t iteration);
+
+    /**
+     * @brief Called on the io thread once the loader is done with iteration
+     * @param shard nullptr if the shard file couldn't be loaded
+     */
+    void OnShardLoaded(uint32_t iteration, std::shared_ptr<const ShardLoader::Shard> shard);
+
+    /**
+     * @brief Build and sign the Data of a segment
+     */
+    std::shared_ptr<ndn::Data> MakeData(const ndn::Name &name, const ndn::Block &content);
+
+private:
+    /**
+     * An iteration's shard, loaded or being loaded
+     */
+    struct ShardState
+    {
+        std::shared_ptr<const ShardLoader::Shard> shard; // nullptr while loading
+        std::vector<std::shared_ptr<ndn::Data>> data;    // Pre-signed Data of each segment, under m_dataPrefix
+        std::vector<ndn::Interest> pending;              // Interests waiting for the shard
+        bool failed = false;                             // Prefetch couldn't load it, loaded again once it's served
+    };
+
     ndn::Name m_prefix;
     ndn::Name m_postfix;
     uint32_t m_virtualPayloadSize;
@@ -54,9 +95,19 @@ private:
     // uint32_t m_signature;
     // ndn::Name m_keyLocator;
     ndn::KeyChain m_keyChain;
+    SigningPolicy m_signing; // Security.SigningMode
     uint32_t m_prefixnum; // customized
 
     int m_dataSize;
+    std::default_random_engine m_generator; // Random parameters when no shard file is configured
+
+    // Shard mode
+    std::string m_shardFile; // Producer.ShardFile, path of the trainer's shard files, empty for random parameters
+    uint32_t m_prefetch;     // Iterations loaded ahead of the one being served
+    uint32_t m_iteNum;       // The number of iterations, nothing is loaded beyond it
+    std::unique_ptr<ShardLoader> m_loader;
+    std::map<uint32_t, ShardState> m_shards; // Iterations around the one being served
+    ndn::Name m_dataPrefix;                  // Name of the last interest without the seq
 };
 
 #endif // NDN_PRODUCER_H
\ No newline at end of file
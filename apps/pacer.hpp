@@ -0,0 +1,182 @@
+#ifndef PACER_HPP
+#define PACER_HPP
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include "flow_table.hpp"
+
+/**
+ * Token-bucket pacer releasing the Interests of every flow from one periodic tick
+ *
+ * Each flow earns tokens at its QSF rate limit. On every tick it spends them, one Interest per token, in a batch
+ * bounded by the bucket size. So the scheduler sees one event per tick instead of two per Interest. The bucket
+ * holds at least the tokens earned since the last tick, so a rate above one Interest per tick and a tick that fires
+ * late are both honoured. Times are in microseconds on the caller's clock.
+ */
+class Pacer
+{
+public:
+    /**
+     * Pacing error metrics of one flow
+     */
+    struct Stats
+    {
+        uint64_t released = 0;      // Interests sent
+        double expected = 0.0;      // Interests the rate limit allowed while the flow had something to send
+        int64_t backloggedTime = 0; // Time the flow had something to send, unit: us
+        uint64_t batches = 0;       // Ticks that released at least one Interest
+        uint32_t maxBatch = 0;      // Most Interests released by one tick
+
+        /**
+         * @brief Sent minus allowed, positive when the flow ran ahead of its rate
+         */
+        double Error() const
+        {
+            return static_cast<double>(released) - expected;
+        }
+    };
+
+    Pacer() : m_tickInterval(1000), m_burst(1.0) {}
+
+    /**
+     * @brief Drop every bucket and size the pacer for flowCount flows, all stopped
+     * @param tickInterval Period of Tick(), unit: us
+     * @param burst Bucket size, i.e. max Interests per batch, raised to one tick's worth of tokens
+     */
+    void Reset(size_t flowCount, int64_t tickInterval, double burst)
+    {
+        m_buckets.assign(flowCount, Bucket{});
+        m_tickInterval = std::max<int64_t>(tickInterval, 1);
+        m_burst = std::max(burst, 1.0);
+    }
+
+    /**
+     * @brief Update the rate limit of flow, unit: pkgs/us
+     */
+    void SetRate(FlowId flow, double rate)
+    {
+        m_buckets[flow].rate = std::max(rate, 0.0);
+    }
+
+    /**
+     * @brief Start pacing flow, its first Interest goes out on the next tick
+     */
+    void Start(FlowId flow, int64_t now)
+    {
+        Bucket &bucket = m_buckets[flow];
+        bucket.active = true;
+        bucket.tokens = std::max(bucket.tokens, 1.0);
+        bucket.lastRefill = now;
+        bucket.pausedUntil = 0;
+    }
+
+    /**
+     * @brief Stop pacing flow, e.g. after its last iteration
+     */
+    void Stop(FlowId flow)
+    {
+        m_buckets[flow].active = false;
+    }
+
+    /**
+     * @brief Release nothing from flow before until, tokens aren't earned meanwhile
+     */
+    void Pause(FlowId flow, int64_t until)
+    {
+        Bucket &bucket = m_buckets[flow];
+        bucket.tokens = 0.0;
+        bucket.pausedUntil = until;
+    }
+
+    /**
+     * @brief Refill every active flow up to now and spend its tokens
+     * @param release Called once per token as release(flow), returns false if the flow has nothing to send
+     * @return Number of Interests released
+     */
+    template <typename Function>
+    size_t Tick(int64_t now, Function &&release)
+    {
+        size_t total = 0;
+        for (FlowId flow = 0; flow < m_buckets.size(); ++flow)
+        {
+            Bucket &bucket = m_buckets[flow];
+            if (!bucket.active)
+                continue;
+
+            int64_t elapsed = std::max<int64_t>(now - bucket.lastRefill, 0);
+            bucket.lastRefill = now;
+            if (now < bucket.pausedUntil)
+                continue;
+
+            // A late tick may spend what the rate earned since the last one, plus the fraction carried over
+            double capacity = std::max(m_burst, bucket.rate * std::max(elapsed, m_tickInterval) + 1.0);
+            bucket.tokens = std::min(capacity, bucket.tokens + bucket.rate * elapsed);
+
+            uint32_t batch = 0;
+            bool backlogged = true;
+            // Re-check active, release() may stop the flow
+            while (bucket.active && bucket.tokens >= 1.0)
+            {
+                if (!release(flow))
+                {
+                    backlogged = false;
+                    break;
+                }
+                bucket.tokens -= 1.0;
+                ++batch;
+            }
+
+            Stats &stats = bucket.stats;
+            if (backlogged)
+            {
+                stats.expected += bucket.rate * elapsed;
+                stats.backloggedTime += elapsed;
+            }
+            if (batch > 0)
+            {
+                stats.released += batch;
+                ++stats.batches;
+                stats.maxBatch = std::max(stats.maxBatch, batch);
+            }
+            total += batch;
+        }
+        return total;
+    }
+
+    bool IsActive(FlowId flow) const
+    {
+        return m_buckets[flow].active;
+    }
+
+    /**
+     * @brief Number of flows being paced
+     */
+    size_t ActiveCount() const
+    {
+        return std::count_if(m_buckets.begin(), m_buckets.end(), [](const Bucket &bucket)
+                             { return bucket.active; });
+    }
+
+    const Stats &GetStats(FlowId flow) const
+    {
+        return m_buckets[flow].stats;
+    }
+
+private:
+    struct Bucket
+    {
+        bool active = false;
+        double rate = 0.0;   // Unit: pkgs/us
+        double tokens = 0.0; // Interests that may be sent now
+        int64_t lastRefill = 0;
+        int64_t pausedUntil = 0;
+        Stats stats;
+    };
+
+    std::vector<Bucket> m_buckets; // Indexed by FlowId
+    int64_t m_tickInterval;
+    double m_burst;
+};
+
+#endif // PACER_HPP
@@ -0,0 +1,164 @@
+#ifndef PENDING_INTEREST_TABLE_HPP
+#define PENDING_INTEREST_TABLE_HPP
+
+#include <ndn-cxx/face.hpp>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <utility>
+#include "timer_wheel.hpp"
+
+/**
+ * Everything the app keeps about one Interest it has sent and not seen answered yet
+ */
+struct PendingInterest
+{
+    uint32_t nonce = 0;
+    std::chrono::milliseconds sendTime{0}; // Last (re)transmission, reference of the response time
+    uint32_t retxCount = 0;                // Retransmissions after a timeout, 0 for the first transmission
+    ndn::PendingInterestHandle handle;     // Cancels the face's own PIT entry
+};
+
+/**
+ * App-level pending Interest table, keyed by (flow, seq) like the timeout wheel
+ *
+ * Fixed-capacity open addressing with linear probing, entries are erased by shifting the following ones back, so
+ * there are no tombstones and memory stays flat however many iterations are run. Entries are recycled when the
+ * Interest is answered by Data or Nack or given up after a timeout.
+ */
+class PendingInterestTable
+{
+public:
+    using Key = TimerWheel::Key;
+
+    PendingInterestTable() : m_size(0), m_shift(64) {}
+
+    /**
+     * @brief Drop every entry and preallocate the table
+     * @param capacity Max number of pending Interests, rounded up to a power of two
+     */
+    void Reset(size_t capacity)
+    {
+        size_t slots = 1;
+        int bits = 0;
+        while (slots < capacity)
+        {
+            slots <<= 1;
+            ++bits;
+        }
+        m_slots.assign(slots, Slot{});
+        m_size = 0;
+        m_shift = 64 - bits;
+    }
+
+    /**
+     * @brief Entry of key, created if it doesn't exist yet
+     * @return The entry (nullptr if the table is full) and whether it has just been created
+     */
+    std::pair<PendingInterest *, bool> Insert(Key key)
+    {
+        if (m_slots.empty())
+            return {nullptr, false};
+        size_t mask = m_slots.size() - 1;
+        for (size_t i = Home(key), probes = 0; probes < m_slots.size(); i = (i + 1) & mask, ++probes)
+        {
+            Slot &slot = m_slots[i];
+            if (!slot.used)
+            {
+                slot.used = true;
+                slot.key = key;
+                slot.entry = PendingInterest{};
+                ++m_size;
+                return {&slot.entry, true};
+            }
+            if (slot.key == key)
+                return {&slot.entry, false};
+        }
+        return {nullptr, false};
+    }
+
+    /**
+     * @return nullptr if key isn't pending
+     */
+    PendingInterest *Find(Key key)
+    {
+        size_t index = IndexOf(key);
+        return index != NPOS ? &m_slots[index].entry : nullptr;
+    }
+
+    /**
+     * @brief Recycle the entry of key
+     * @param erased Receives the entry's last content, may be nullptr
+     * @return False if key isn't pending
+     */
+    bool Erase(Key key, PendingInterest *erased = nullptr)
+    {
+        size_t hole = IndexOf(key);
+        if (hole == NPOS)
+            return false;
+        if (erased != nullptr)
+            *erased = m_slots[hole].entry;
+
+        // Backward shift: move back every following entry of the cluster that may live in the hole
+        size_t mask = m_slots.size() - 1;
+        for (size_t i = (hole + 1) & mask, probes = 1; probes < m_slots.size() && m_slots[i].used; i = (i + 1) & mask, ++probes)
+        {
+            size_t home = Home(m_slots[i].key);
+            if (((i - home) & mask) >= ((i - hole) & mask))
+            {
+                m_slots[hole] = std::move(m_slots[i]);
+                hole = i;
+            }
+        }
+        m_slots[hole].used = false;
+        m_slots[hole].entry = PendingInterest{};
+        --m_size;
+        return true;
+    }
+
+    size_t Size() const
+    {
+        return m_size;
+    }
+
+    size_t Capacity() const
+    {
+        return m_slots.size();
+    }
+
+private:
+    static constexpr size_t NPOS = SIZE_MAX;
+
+    struct Slot
+    {
+        Key key = 0;
+        bool used = false;
+        PendingInterest entry;
+    };
+
+    size_t Home(Key key) const
+    {
+        // Fibonacci hashing, consecutive seqs of one flow spread over the table
+        return m_shift >= 64 ? 0 : static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> m_shift);
+    }
+
+    size_t IndexOf(Key key) const
+    {
+        if (m_slots.empty())
+            return NPOS;
+        size_t mask = m_slots.size() - 1;
+        for (size_t i = Home(key), probes = 0; probes < m_slots.size() && m_slots[i].used; i = (i + 1) & mask, ++probes)
+        {
+            if (m_slots[i].key == key)
+                return i;
+        }
+        return NPOS;
+    }
+
+private:
+    std::vector<Slot> m_slots;
+    size_t m_size;
+    int m_shift; // 64 - log2(capacity)
+};
+
+#endif // PENDING_INTEREST_TABLE_HPP
@@ -0,0 +1,76 @@
+#include "reducer_pool.hpp"
+#include <algorithm>
+
+ReducerPool::ReducerPool(size_t threadCount, Completion onComplete)
+    : m_onComplete(std::move(onComplete))
+{
+    threadCount = std::max<size_t>(threadCount, 1);
+    m_workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i)
+        m_workers.push_back(std::make_unique<Worker>());
+    for (std::unique_ptr<Worker> &worker : m_workers)
+        worker->thread = std::thread(&ReducerPool::WorkerLoop, this, std::ref(*worker));
+}
+
+ReducerPool::~ReducerPool()
+{
+    for (std::unique_ptr<Worker> &worker : m_workers)
+    {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        worker->stopping = true;
+        worker->cv.notify_one();
+    }
+    for (std::unique_ptr<Worker> &worker : m_workers)
+    {
+        if (worker->thread.joinable())
+            worker->thread.join();
+    }
+}
+
+void ReducerPool::Submit(AggregationTable::Slot &slot, const ndn::Block &content, const ModelDataView &view, bool last)
+{
+    Worker &worker = *m_workers[slot.seq % m_workers.size()];
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back(Task{&slot, content, view, last});
+    }
+    worker.cv.notify_one();
+}
+
+void ReducerPool::Flush(AggregationTable::Slot &slot)
+{
+    Worker &worker = *m_workers[slot.seq % m_workers.size()];
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back(Task{&slot, ndn::Block(), ModelDataView{}, true});
+    }
+    worker.cv.notify_one();
+}
+
+void ReducerPool::WorkerLoop(Worker &worker)
+{
+    std::deque<Task> batch;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(worker.mutex);
+            worker.cv.wait(lock, [&worker]
+                           { return worker.stopping || !worker.tasks.empty(); });
+            if (worker.tasks.empty())
+                return; // Stopping and drained
+            batch.swap(worker.tasks);
+        }
+
+        for (Task &task : batch)
+        {
+            AggregationTable::Slot &slot = *task.slot;
+            if (task.view.payload != nullptr)
+                aggregateModelData(slot, task.view);
+
+            if (task.last && m_onComplete)
+                m_onComplete(slot.seq);
+        }
+        // Drop the content buffers here rather than holding them until the next batch
+        batch.clear();
+    }
+}
@@ -0,0 +1,92 @@
+#ifndef REDUCER_POOL_HPP
+#define REDUCER_POOL_HPP
+
+#include <ndn-cxx/encoding/block.hpp>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <cstdint>
+#include "aggregation_table.hpp"
+#include "ModelData.hpp"
+
+/**
+ * Worker threads decoding upstream payloads and adding them to the aggregation table, the aggregator's pipeline mode
+ *
+ * Iterations are sharded over the workers by seq, so every payload of one iteration is reduced by the same thread, in
+ * submission order, and the slot's sum and congestedNodes need no locking. The io thread keeps everything else:
+ * the slot's bookkeeping (arrivals, timing, release), the header parse and the congestion control state. Once the
+ * payload submitted as the last one of an iteration has been reduced the completion callback is invoked on the
+ * worker, it's expected to post the rest of the work back to the io thread.
+ *
+ * Submit() must only be called from one thread.
+ */
+class ReducerPool
+{
+public:
+    using Completion = std::function<void(uint32_t seq)>;
+
+    /**
+     * @param threadCount Number of workers, at least 1
+     * @param onComplete Invoked on a worker once the last payload of an iteration has been reduced
+     */
+    ReducerPool(size_t threadCount, Completion onComplete);
+
+    /**
+     * @brief Reduce every payload submitted so far, then stop the workers
+     */
+    ~ReducerPool();
+
+    ReducerPool(const ReducerPool &) = delete;
+    ReducerPool &operator=(const ReducerPool &) = delete;
+
+    /**
+     * @brief Queue a payload to be added to slot
+     * @param slot Slot of seq, must stay in use until the completion of seq has been handled
+     * @param content The Data's content, keeps the buffer view points into alive
+     * @param view View over content filled by deserializeModelData()
+     * @param last Whether it's the last payload of the iteration, i.e. completion is reported after it
+     */
+    void Submit(AggregationTable::Slot &slot, const ndn::Block &content, const ModelDataView &view, bool last);
+
+    /**
+     * @brief Report the completion of slot once every payload submitted for it so far has been reduced
+     *
+     * Used when an iteration is forwarded without its last payload, e.g. at its deadline.
+     */
+    void Flush(AggregationTable::Slot &slot);
+
+    size_t ThreadCount() const
+    {
+        return m_workers.size();
+    }
+
+private:
+    struct Task
+    {
+        AggregationTable::Slot *slot;
+        ndn::Block content;
+        ModelDataView view; // payload is nullptr for a flush
+        bool last;
+    };
+
+    struct Worker
+    {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<Task> tasks;
+        bool stopping = false;
+        std::thread thread;
+    };
+
+    void WorkerLoop(Worker &worker);
+
+private:
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    Completion m_onComplete;
+};
+
+#endif // REDUCER_POOL_HPP
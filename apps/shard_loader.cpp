@@ -0,0 +1,179 @@
+#include "shard_loader.hpp"
+#include "ModelData.hpp"
+#include <ndn-cxx/encoding/buffer.hpp>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    /**
+     * @brief Bytes per element of a dtype in shard files, 0 if unsupported
+     */
+    size_t elementSize(const std::string &dtype)
+    {
+        if (dtype == "float32")
+            return sizeof(float);
+        if (dtype == "float64")
+            return sizeof(double);
+        return 0;
+    }
+
+    void replaceAll(std::string &text, const std::string &from, const std::string &to)
+    {
+        for (size_t pos = text.find(from); pos != std::string::npos; pos = text.find(from, pos + to.size()))
+            text.replace(pos, from.size(), to);
+    }
+}
+
+ShardLoader::ShardLoader(std::string pattern, std::string name, Completion onComplete)
+    : m_pattern(std::move(pattern)),
+      m_name(std::move(name)),
+      m_onComplete(std::move(onComplete)),
+      m_stopping(false)
+{
+    m_thread = std::thread(&ShardLoader::LoaderLoop, this);
+}
+
+ShardLoader::~ShardLoader()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        m_requests.clear();
+    }
+    m_cv.notify_one();
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+void ShardLoader::Request(uint32_t iteration)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_requests.push_back(iteration);
+    }
+    m_cv.notify_one();
+}
+
+std::string ShardLoader::PathOf(uint32_t iteration) const
+{
+    std::string path = m_pattern;
+    replaceAll(path, "{name}", m_name);
+    replaceAll(path, "{iteration}", std::to_string(iteration));
+    return path;
+}
+
+bool ShardLoader::IsSupported(std::string &unsupported)
+{
+    for (const TensorSpec &tensor : ModelSchema::instance().tensors())
+    {
+        if (elementSize(tensor.dtype) == 0)
+        {
+            unsupported = tensor.name + " (" + tensor.dtype + ")";
+            return false;
+        }
+    }
+    return true;
+}
+
+std::shared_ptr<const ShardLoader::Shard> ShardLoader::Load(const std::string &path, uint32_t iteration)
+{
+    const ModelSchema &schema = ModelSchema::instance();
+    size_t expectedSize = 0;
+    for (const TensorSpec &tensor : schema.tensors())
+        expectedSize += tensor.size * elementSize(tensor.dtype);
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        spdlog::error("Failed to open shard {}: {}", path, std::strerror(errno));
+        return nullptr;
+    }
+    struct stat status{};
+    if (::fstat(fd, &status) != 0 || static_cast<size_t>(status.st_size) < expectedSize || expectedSize == 0)
+    {
+        spdlog::error("Shard {} holds {} bytes, {} expected", path, static_cast<long long>(status.st_size), expectedSize);
+        ::close(fd);
+        return nullptr;
+    }
+    void *mapping = ::mmap(nullptr, expectedSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        spdlog::error("Failed to map shard {}: {}", path, std::strerror(errno));
+        return nullptr;
+    }
+    ::madvise(mapping, expectedSize, MADV_SEQUENTIAL);
+
+    // Widen every tensor into the flat parameter vector, the file isn't required to be aligned
+    std::vector<double> parameters(schema.parameterCount());
+    const uint8_t *it = static_cast<const uint8_t *>(mapping);
+    for (const TensorSpec &tensor : schema.tensors())
+    {
+        double *out = parameters.data() + tensor.offset;
+        if (tensor.dtype == "float32")
+        {
+            for (size_t i = 0; i < tensor.size; ++i, it += sizeof(float))
+            {
+                float value;
+                std::memcpy(&value, it, sizeof(float));
+                out[i] = value;
+            }
+        }
+        else
+        {
+            std::memcpy(out, it, tensor.size * sizeof(double));
+            it += tensor.size * sizeof(double);
+        }
+    }
+    ::munmap(mapping, expectedSize);
+
+    auto shard = std::make_shared<Shard>();
+    shard->iteration = iteration;
+    shard->contents.reserve(schema.segmentCount());
+    std::vector<uint8_t> buffer;
+    for (uint32_t segment = 0; segment < schema.segmentCount(); ++segment)
+    {
+        ModelData modelData(schema, segment);
+        auto begin = parameters.begin() + schema.segmentOffset(segment);
+        std::copy(begin, begin + modelData.parameters.size(), modelData.parameters.begin());
+
+        serializeModelData(modelData, buffer);
+        auto bufferPtr = std::make_shared<ndn::Buffer>(buffer.data(), buffer.data() + buffer.size());
+        shard->contents.emplace_back(ndn::tlv::Content, bufferPtr);
+    }
+    return shard;
+}
+
+void ShardLoader::LoaderLoop()
+{
+    while (true)
+    {
+        uint32_t iteration;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this]
+                      { return m_stopping || !m_requests.empty(); });
+            if (m_stopping)
+                return;
+            iteration = m_requests.front();
+            m_requests.pop_front();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::shared_ptr<const Shard> shard = Load(PathOf(iteration), iteration);
+        if (shard != nullptr)
+        {
+            auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+            spdlog::debug("Shard of iteration {} loaded in {} us", iteration, elapsed.count());
+        }
+        m_onComplete(iteration, std::move(shard));
+    }
+}
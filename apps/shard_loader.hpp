@@ -0,0 +1,87 @@
+#ifndef SHARD_LOADER_HPP
+#define SHARD_LOADER_HPP
+
+#include <ndn-cxx/encoding/block.hpp>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <string>
+#include <cstdint>
+
+/**
+ * Background thread turning the shard file of an iteration, as written by the trainer, into encoded segments
+ *
+ * The file holds the ModelSchema tensors back to back in declaration order, each as raw little-endian elements of
+ * the tensor's dtype (float32 or float64). It is memory-mapped, converted and encoded with the configured encoding
+ * into one Content block per segment, so serving an Interest is down to building and signing the Data. Completion
+ * is reported on the loader thread, it's expected to post the shard back to the io thread.
+ *
+ * Request() must only be called from one thread.
+ */
+class ShardLoader
+{
+public:
+    struct Shard
+    {
+        uint32_t iteration;
+        std::vector<ndn::Block> contents; // Content of each segment, indexed by segment
+    };
+
+    /**
+     * @brief Invoked with nullptr if the file can't be loaded
+     */
+    using Completion = std::function<void(uint32_t iteration, std::shared_ptr<const Shard> shard)>;
+
+    /**
+     * @param pattern Path of the shard files, "{name}" is replaced by name and "{iteration}" by the iteration
+     * @param name Name of the producer
+     * @param onComplete Invoked on the loader thread once an iteration is loaded
+     */
+    ShardLoader(std::string pattern, std::string name, Completion onComplete);
+
+    /**
+     * @brief Stop the loader, requests not started yet are dropped
+     */
+    ~ShardLoader();
+
+    ShardLoader(const ShardLoader &) = delete;
+    ShardLoader &operator=(const ShardLoader &) = delete;
+
+    /**
+     * @brief Queue the loading of iteration
+     */
+    void Request(uint32_t iteration);
+
+    std::string PathOf(uint32_t iteration) const;
+
+    /**
+     * @brief Whether every tensor of the schema has a dtype shard files can hold
+     */
+    static bool IsSupported(std::string &unsupported);
+
+    /**
+     * @brief Load and encode one shard file
+     * @return nullptr if the file can't be read or is too short for the schema
+     */
+    static std::shared_ptr<const Shard> Load(const std::string &path, uint32_t iteration);
+
+private:
+    void LoaderLoop();
+
+private:
+    std::string m_pattern;
+    std::string m_name;
+    Completion m_onComplete;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<uint32_t> m_requests;
+    bool m_stopping;
+    std::thread m_thread;
+};
+
+#endif // SHARD_LOADER_HPP
@@ -0,0 +1,285 @@
+#include "signing_policy.hpp"
+#include "ModelData.hpp"
+#include <ndn-cxx/security/signing-helpers.hpp>
+#include <ndn-cxx/security/verification-helpers.hpp>
+#include <ndn-cxx/security/transform/bool-sink.hpp>
+#include <ndn-cxx/security/transform/buffer-source.hpp>
+#include <ndn-cxx/security/transform/private-key.hpp>
+#include <ndn-cxx/security/transform/verifier-filter.hpp>
+#include <ndn-cxx/util/sha256.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/ini_parser.hpp>
+#include <spdlog/spdlog.h>
+#include <cstdlib>
+
+SigningMode parseSigningMode(const std::string &name)
+{
+    if (name == "sha256")
+        return SigningMode::SHA256;
+    if (name == "hmac")
+        return SigningMode::HMAC;
+    if (name == "manifest")
+        return SigningMode::MANIFEST;
+    if (name != "identity")
+        spdlog::error("Unknown signing mode {}, falling back to identity", name);
+    return SigningMode::IDENTITY;
+}
+
+const char *signingModeName(SigningMode mode)
+{
+    switch (mode)
+    {
+    case SigningMode::SHA256:
+        return "sha256";
+    case SigningMode::HMAC:
+        return "hmac";
+    case SigningMode::MANIFEST:
+        return "manifest";
+    default:
+        return "identity";
+    }
+}
+
+SigningPolicy::SigningPolicy()
+    : m_mode(SigningMode::IDENTITY),
+      m_digestSigning(ndn::security::signingWithSha256()),
+      m_hasHmacKey(false)
+{
+}
+
+SigningPolicy SigningPolicy::fromConfig(const std::string &filename)
+{
+    SigningPolicy policy;
+    std::string hmacKey;
+    boost::property_tree::ptree pt;
+    try
+    {
+        boost::property_tree::ini_parser::read_ini(filename, pt);
+        policy.m_mode = parseSigningMode(pt.get<std::string>("Security.SigningMode", "identity"));
+        hmacKey = pt.get<std::string>("Security.HmacKey", "");
+    }
+    catch (const std::exception &e)
+    {
+        spdlog::error("Exception caught: {}", e.what());
+    }
+
+    // The manifest vouches for every segment of its batch, a manifest that can't be checked would accept anything
+    if ((policy.m_mode == SigningMode::HMAC || policy.m_mode == SigningMode::MANIFEST) && hmacKey.empty())
+    {
+        spdlog::error("Signing mode {} needs a pre-shared key in Security.HmacKey", signingModeName(policy.m_mode));
+        std::exit(EXIT_FAILURE);
+    }
+    if (!hmacKey.empty() && (policy.m_mode == SigningMode::HMAC || policy.m_mode == SigningMode::MANIFEST))
+    {
+        try
+        {
+            policy.m_keySigning.setSigningHmacKey(hmacKey);
+            policy.m_hasHmacKey = true;
+        }
+        catch (const std::exception &e)
+        {
+            spdlog::error("Invalid Security.HmacKey, base64 expected: {}", e.what());
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
+    spdlog::info("Signing policy: {}", signingModeName(policy.m_mode));
+    return policy;
+}
+
+void SigningPolicy::Sign(ndn::KeyChain &keyChain, ndn::Data &data)
+{
+    switch (m_mode)
+    {
+    case SigningMode::SHA256:
+        keyChain.sign(data, m_digestSigning);
+        ++m_stats.digestSigned;
+        return;
+    case SigningMode::MANIFEST:
+        break;
+    default:
+        SignWithKey(keyChain, data);
+        return;
+    }
+
+    BatchKey key;
+    uint32_t segment;
+    if (!GetBatchKey(data.getName(), key, segment))
+    {
+        SignWithKey(keyChain, data);
+        return;
+    }
+
+    Prune(m_outgoing, key.first);
+    OutgoingBatch &batch = m_outgoing[key];
+    // Retransmission after the manifest, the receiver can't match it any more
+    if (batch.done)
+    {
+        SignWithKey(keyChain, data);
+        return;
+    }
+
+    uint32_t segmentCount = ModelSchema::instance().segmentCount();
+    if (batch.digests.empty())
+        batch.digests.resize(segmentCount);
+    bool isNew = batch.digests[segment].empty();
+
+    // The last segment of the batch carries the digests of the others
+    if (isNew && batch.sentCount + 1 == segmentCount)
+    {
+        if (segmentCount > 1)
+        {
+            std::vector<uint8_t> manifest;
+            manifest.reserve((segmentCount - 1) * ndn::util::Sha256::DIGEST_SIZE);
+            for (uint32_t i = 0; i < segmentCount; ++i)
+            {
+                if (i != segment)
+                    manifest.insert(manifest.end(), batch.digests[i].begin(), batch.digests[i].end());
+            }
+            ndn::MetaInfo metaInfo = data.getMetaInfo();
+            metaInfo.addAppMetaInfo(ndn::makeBinaryBlock(MANIFEST_TLV, ndn::make_span(manifest.data(), manifest.size())));
+            data.setMetaInfo(metaInfo);
+            ++m_stats.manifests;
+        }
+        SignWithKey(keyChain, data);
+        batch.done = true;
+        batch.digests.clear();
+        batch.digests.shrink_to_fit();
+        return;
+    }
+
+    keyChain.sign(data, m_digestSigning);
+    ++m_stats.digestSigned;
+    const ndn::name::Component &digest = data.getFullName().get(-1);
+    batch.digests[segment].assign(reinterpret_cast<const char *>(digest.value()), digest.value_size());
+    if (isNew)
+        ++batch.sentCount;
+}
+
+SigningPolicy::Verdict SigningPolicy::Verify(const ndn::Data &data)
+{
+    Verdict verdict = Verdict::ACCEPT;
+    switch (m_mode)
+    {
+    case SigningMode::SHA256:
+        if (data.getSignatureType() != ndn::tlv::DigestSha256 || !ndn::security::verifyDigest(data, ndn::DigestAlgorithm::SHA256))
+            verdict = Verdict::REJECT;
+        break;
+    case SigningMode::HMAC:
+        if (!VerifyWithKey(data))
+            verdict = Verdict::REJECT;
+        break;
+    case SigningMode::MANIFEST:
+        verdict = VerifyManifest(data);
+        break;
+    default:
+        break;
+    }
+
+    if (verdict == Verdict::ACCEPT)
+        ++m_stats.verified;
+    else if (verdict == Verdict::REJECT)
+        ++m_stats.rejected;
+    else
+        ++m_stats.held;
+    return verdict;
+}
+
+SigningPolicy::Verdict SigningPolicy::VerifyManifest(const ndn::Data &data)
+{
+    BatchKey key;
+    uint32_t segment;
+    bool hasBatch = GetBatchKey(data.getName(), key, segment);
+
+    if (data.getSignatureType() != ndn::tlv::DigestSha256)
+    {
+        if (!VerifyWithKey(data))
+            return Verdict::REJECT;
+        const ndn::Block *manifest = data.getMetaInfo().findAppMetaInfo(MANIFEST_TLV);
+        if (manifest == nullptr || !hasBatch)
+            return Verdict::ACCEPT;
+
+        Prune(m_incoming, key.first);
+        IncomingBatch &batch = m_incoming[key];
+        const char *digests = reinterpret_cast<const char *>(manifest->value());
+        for (size_t offset = 0; offset + ndn::util::Sha256::DIGEST_SIZE <= manifest->value_size(); offset += ndn::util::Sha256::DIGEST_SIZE)
+            batch.manifest.emplace(digests + offset, ndn::util::Sha256::DIGEST_SIZE);
+        batch.hasManifest = true;
+
+        // Segments held ahead of the manifest, Verify() accepts the listed ones when the caller hands them back
+        for (auto &[digest, held] : batch.held)
+        {
+            if (batch.manifest.count(digest) > 0)
+            {
+                m_released.push_back(std::move(held));
+            }
+            else
+            {
+                ++m_stats.unmatched;
+                ++m_stats.rejected;
+                spdlog::warn("Segment {} of {} iteration {} isn't listed by its manifest, dropped", held.getName().toUri(), key.second, key.first);
+            }
+        }
+        batch.held.clear();
+        return Verdict::ACCEPT;
+    }
+
+    // Digests alone only vouch for segments listed by a manifest
+    if (!hasBatch || !ndn::security::verifyDigest(data, ndn::DigestAlgorithm::SHA256))
+        return Verdict::REJECT;
+
+    Prune(m_incoming, key.first);
+    IncomingBatch &batch = m_incoming[key];
+    const ndn::name::Component &digestComponent = data.getFullName().get(-1);
+    std::string digest(reinterpret_cast<const char *>(digestComponent.value()), digestComponent.value_size());
+    if (batch.hasManifest)
+        return batch.manifest.count(digest) > 0 ? Verdict::ACCEPT : Verdict::REJECT;
+
+    batch.held.emplace(std::move(digest), data);
+    return Verdict::HOLD;
+}
+
+bool SigningPolicy::GetBatchKey(const ndn::Name &name, BatchKey &key, uint32_t &segment) const
+{
+    // Only model segments, /<node>/<leaves>/data/<seq>, other replies are signed one by one
+    if (name.size() < 2 || !name.get(-1).isSequenceNumber() || name.get(-2).toUri() != "data")
+        return false;
+    uint32_t seq = static_cast<uint32_t>(name.get(-1).toSequenceNumber());
+    if (seq == 0)
+        return false;
+
+    const ModelSchema &schema = ModelSchema::instance();
+    key = BatchKey(schema.iterationOf(seq), name.getPrefix(-1).toUri());
+    segment = schema.segmentOf(seq);
+    return true;
+}
+
+void SigningPolicy::SignWithKey(ndn::KeyChain &keyChain, ndn::Data &data)
+{
+    keyChain.sign(data, m_keySigning);
+    ++m_stats.keySigned;
+}
+
+bool SigningPolicy::VerifyWithKey(const ndn::Data &data) const
+{
+    if (!m_hasHmacKey)
+        return m_mode == SigningMode::IDENTITY;
+    if (data.getSignatureType() != ndn::tlv::SignatureHmacWithSha256)
+        return false;
+
+    namespace transform = ndn::security::transform;
+    bool verified = false;
+    try
+    {
+        const ndn::Block &signature = data.getSignatureValue();
+        transform::bufferSource(data.extractSignedRanges()) >>
+            transform::verifierFilter(ndn::DigestAlgorithm::SHA256, *m_keySigning.getHmacKey(),
+                                      ndn::make_span(signature.value(), signature.value_size())) >>
+            transform::boolSink(verified);
+    }
+    catch (const std::exception &)
+    {
+        return false;
+    }
+    return verified;
+}
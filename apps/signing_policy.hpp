@@ -0,0 +1,166 @@
+#ifndef SIGNING_POLICY_HPP
+#define SIGNING_POLICY_HPP
+
+#include <ndn-cxx/data.hpp>
+#include <ndn-cxx/security/key-chain.hpp>
+#include <ndn-cxx/security/signing-info.hpp>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include <cstdint>
+
+/**
+ * @brief How Data packets are signed, Security.SigningMode in config.ini
+ *
+ * IDENTITY signs every packet with the default identity key (asymmetric, the ndn-cxx default), SHA256 with a
+ * DigestSha256 signature, HMAC with HMAC-SHA256 under the pre-shared Security.HmacKey. MANIFEST signs the segments
+ * of an iteration with DigestSha256 and only the last one sent with the HMAC key, carrying the digests of the others.
+ */
+enum class SigningMode : uint8_t
+{
+    IDENTITY = 0,
+    SHA256 = 1,
+    HMAC = 2,
+    MANIFEST = 3
+};
+
+// AppMetaInfo TLV type of the manifest, the concatenated implicit digests of the other segments
+constexpr uint32_t MANIFEST_TLV = 200;
+
+// Iterations a manifest batch is kept for, older ones are dropped when a newer iteration starts
+constexpr uint32_t MANIFEST_HISTORY = 64;
+
+/**
+ * @brief Parse the mode name used in config.ini (identity, sha256, hmac, manifest)
+ * @return IDENTITY for unknown names
+ */
+SigningMode parseSigningMode(const std::string &name);
+
+const char *signingModeName(SigningMode mode);
+
+/**
+ * Signs outgoing and verifies incoming Data packets with the same configured policy
+ *
+ * Data segments are grouped into manifest batches by name without the seq and by iteration (ModelSchema), so every
+ * downstream flow gets its own manifest. A segment arriving before its manifest is held, not accepted: once the
+ * manifest checks out the segments it lists are handed back by TakeReleased() and the others are rejected.
+ * Other packets, and retransmissions after the batch's manifest, are signed on their own with the key.
+ * The identity key's signatures aren't verified, there is no trust schema to check them against.
+ */
+class SigningPolicy
+{
+public:
+    enum class Verdict
+    {
+        ACCEPT,
+        REJECT,
+        HOLD // Waits for its manifest, see TakeReleased()
+    };
+
+    struct Stats
+    {
+        uint64_t keySigned = 0;    // Packets signed with the identity or HMAC key
+        uint64_t digestSigned = 0; // Packets signed with DigestSha256 only
+        uint64_t manifests = 0;    // Manifests sent
+        uint64_t verified = 0;     // Packets accepted
+        uint64_t rejected = 0;     // Packets whose signature or digest didn't check out
+        uint64_t held = 0;         // Segments that arrived before their manifest
+        uint64_t unmatched = 0;    // Held segments missing from their manifest, rejected
+    };
+
+    SigningPolicy();
+
+    /**
+     * @brief Build a policy from a configuration file, falls back to IDENTITY if it can't be read
+     *
+     * HMAC and MANIFEST read the base64 pre-shared key from Security.HmacKey and exit without one.
+     *
+     * @param filename Path of the INI file
+     */
+    static SigningPolicy fromConfig(const std::string &filename);
+
+    SigningMode Mode() const
+    {
+        return m_mode;
+    }
+
+    /**
+     * @brief Sign data, in MANIFEST mode the packet may get the batch's manifest
+     */
+    void Sign(ndn::KeyChain &keyChain, ndn::Data &data);
+
+    /**
+     * @brief Check data's signature, or its digest against the batch's manifest
+     * @return HOLD if data is a segment whose manifest hasn't arrived yet, the policy keeps a copy of it
+     */
+    Verdict Verify(const ndn::Data &data);
+
+    /**
+     * @brief Held segments listed by a manifest accepted since the last call, to be handled as if they just arrived
+     */
+    std::vector<ndn::Data> TakeReleased()
+    {
+        return std::exchange(m_released, {});
+    }
+
+    const Stats &GetStats() const
+    {
+        return m_stats;
+    }
+
+private:
+    using BatchKey = std::pair<uint32_t, std::string>; // (iteration, name without seq), oldest iteration first
+
+    struct OutgoingBatch
+    {
+        std::vector<std::string> digests; // Implicit digest of each segment sent, empty if not sent yet
+        uint32_t sentCount = 0;
+        bool done = false; // Manifest sent
+    };
+
+    struct IncomingBatch
+    {
+        std::map<std::string, ndn::Data> held; // Segments arrived before the manifest, by implicit digest
+        std::set<std::string> manifest;        // Digests listed by the manifest
+        bool hasManifest = false;
+    };
+
+    /**
+     * @brief Batch of a packet name, false if the packet doesn't belong to any
+     */
+    bool GetBatchKey(const ndn::Name &name, BatchKey &key, uint32_t &segment) const;
+
+    void SignWithKey(ndn::KeyChain &keyChain, ndn::Data &data);
+
+    /**
+     * @brief Verify a key signature, identity signatures are accepted unchecked
+     */
+    bool VerifyWithKey(const ndn::Data &data) const;
+
+    Verdict VerifyManifest(const ndn::Data &data);
+
+    /**
+     * @brief Drop the batches more than MANIFEST_HISTORY iterations older than iteration
+     */
+    template <typename Batch>
+    static void Prune(std::map<BatchKey, Batch> &batches, uint32_t iteration)
+    {
+        while (!batches.empty() && batches.begin()->first.first + MANIFEST_HISTORY < iteration)
+            batches.erase(batches.begin());
+    }
+
+private:
+    SigningMode m_mode;
+    ndn::security::SigningInfo m_keySigning; // Identity or HMAC key
+    ndn::security::SigningInfo m_digestSigning;
+    bool m_hasHmacKey;
+
+    std::map<BatchKey, OutgoingBatch> m_outgoing;
+    std::map<BatchKey, IncomingBatch> m_incoming;
+    std::vector<ndn::Data> m_released;
+    Stats m_stats;
+};
+
+#endif // SIGNING_POLICY_HPP
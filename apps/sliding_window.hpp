@@ -1,12 +1,17 @@
 #ifndef SLIDING_WINDOW_HPP
 #define SLIDING_WINDOW_HPP
 
-#include <deque>
-#include <numeric>
 #include <chrono>
 #include <spdlog/spdlog.h>
+#include "window_stats.hpp"
 
-template <typename T>
+/**
+ * Packets that arrived within the last window duration, with the running sum of their values
+ *
+ * At most Capacity packets are kept, past that the oldest ones leave the window early, which keeps the arrival
+ * rate exact but averages the value over fewer packets than the full duration holds.
+ */
+template <typename T, size_t Capacity = 1024>
 class SlidingWindow
 {
 public:
@@ -22,55 +27,78 @@ public:
 
     void AddPacket(std::chrono::milliseconds newTime, T value)
     {
-        m_data.push_back({newTime, value});
+        if (m_data.Full())
+            Evict();
+        m_data.PushBack({newTime, value});
+        m_sum += value;
 
         // Remove outdated packets
-        while (!m_data.empty() && (newTime - m_data.front().arrivalTime) > m_windowDuration)
+        while (!m_data.Empty() && (newTime - m_data.Front().arrivalTime) > m_windowDuration)
         {
-            m_data.pop_front();
+            Evict();
         }
     }
 
     size_t GetCurrentWindowSize() const
     {
-        return m_data.size();
+        return m_data.Size();
     }
 
     double GetAverageQsf() const
     {
-        if (m_data.empty())
+        if (m_data.Empty())
             return 0.0;
 
-        double sum = std::accumulate(m_data.begin(), m_data.end(), 0.0, [](double acc, const DataInfo &info)
-                                     { return acc + info.value; });
-        return sum / m_data.size();
+        return static_cast<double>(m_sum) / m_data.Size();
     }
 
     // Unit - pkgs/us
     double GetDataArrivalRate() const
     {
-        if (m_data.size() < 2)
+        if (m_data.Size() < 2)
         {
             return 0.0;
         }
 
-        auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(m_data.back().arrivalTime - m_data.front().arrivalTime).count();
+        auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(m_data.Back().arrivalTime - m_data.Front().arrivalTime).count();
         // difference : is it without = is ok?
         if (duration < 0)
         {
-            spdlog::info("Current number of elements within the sliding window: {}", m_data.size());
-            spdlog::info("Back element: {} us.", std::chrono::duration_cast<std::chrono::microseconds>(m_data.back().arrivalTime).count());
-            spdlog::info("Front element: {} us.", std::chrono::duration_cast<std::chrono::microseconds>(m_data.front().arrivalTime).count());
+            spdlog::info("Current number of elements within the sliding window: {}", m_data.Size());
+            spdlog::info("Back element: {} us.", std::chrono::duration_cast<std::chrono::microseconds>(m_data.Back().arrivalTime).count());
+            spdlog::info("Front element: {} us.", std::chrono::duration_cast<std::chrono::microseconds>(m_data.Front().arrivalTime).count());
             spdlog::info("Actual duration: {} ns.", duration);
             return -1.0;
         }
         // difference : data type conversion
-        return static_cast<double>((m_data.size() - 1)) / duration * 1e3;
+        return static_cast<double>((m_data.Size() - 1)) / duration * 1e3;
+    }
+
+private:
+    void Evict()
+    {
+        m_sum -= m_data.Front().value;
+        m_data.PopFront();
+        // Rebuild the sum every Capacity evictions as WindowedSum does, a window that never drains doesn't drift
+        if (m_data.Empty())
+        {
+            m_sum = T{};
+            m_evictions = 0;
+        }
+        else if (++m_evictions == Capacity)
+        {
+            m_sum = T{};
+            for (size_t i = 0; i < m_data.Size(); ++i)
+                m_sum += m_data[i].value;
+            m_evictions = 0;
+        }
     }
 
 private:
     std::chrono::milliseconds m_windowDuration;
-    std::deque<DataInfo> m_data;
+    RingBuffer<DataInfo, Capacity> m_data;
+    T m_sum{};
+    size_t m_evictions = 0;
 };
 
 #endif // SLIDING_WINDOW_HPP
\ No newline at end of file
@@ -0,0 +1,140 @@
+/**
+ * Convert a binary telemetry log back into the text logs the recorders used to write
+ *
+ * Usage: telemetry-convert <telemetry.bin> [...]
+ * Every stream listed in "<telemetry.bin>.idx" is written (truncated) to its original path, one line per
+ * sample: time followed by the columns, separated by a space.
+ */
+#include "telemetry.hpp"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include <string>
+#include <cstdlib>
+
+namespace
+{
+    struct StreamOutput
+    {
+        std::string columns; // Column types, see Telemetry::RegisterStream()
+        bool trailingSpace = false;
+        std::unique_ptr<std::ofstream> file;
+        std::string pending;     // Text of the sample being reassembled
+        uint16_t nextColumn = 0; // Column expected next, 0 when no sample is pending
+    };
+
+    bool ReadIndex(const std::string &path, std::vector<StreamOutput> &streams)
+    {
+        std::ifstream index(path);
+        if (!index.is_open())
+        {
+            std::cerr << "Failed to open the file: " << path << std::endl;
+            return false;
+        }
+
+        std::string line;
+        while (std::getline(index, line))
+        {
+            std::istringstream iss(line);
+            unsigned id;
+            int trailingSpace;
+            StreamOutput output;
+            if (!(iss >> id >> output.columns >> trailingSpace))
+                continue;
+            std::string textPath;
+            std::getline(iss >> std::ws, textPath);
+
+            output.trailingSpace = trailingSpace != 0;
+            output.file = std::make_unique<std::ofstream>(textPath, std::ofstream::out | std::ofstream::trunc);
+            if (!output.file->is_open())
+            {
+                std::cerr << "Failed to open the file: " << textPath << std::endl;
+                return false;
+            }
+            if (streams.size() <= id)
+                streams.resize(id + 1);
+            streams[id] = std::move(output);
+        }
+        return true;
+    }
+
+    void AppendRecord(StreamOutput &output, const TelemetryRecord &record)
+    {
+        if (record.column != output.nextColumn)
+        {
+            // Only whole samples are recorded, a gap means the log was cut, start over at this sample
+            output.pending.clear();
+            output.nextColumn = 0;
+            if (record.column != 0)
+                return;
+        }
+
+        std::ostringstream oss;
+        if (record.column == 0)
+            oss << record.time;
+        oss << " ";
+        if (record.column < output.columns.size() && output.columns[record.column] == 'i')
+            oss << static_cast<int64_t>(record.value);
+        else
+            oss << record.value;
+        output.pending += oss.str();
+
+        if (++output.nextColumn == output.columns.size())
+        {
+            *output.file << output.pending << (output.trailingSpace ? " \n" : "\n");
+            output.pending.clear();
+            output.nextColumn = 0;
+        }
+    }
+
+    bool Convert(const std::string &path)
+    {
+        std::vector<StreamOutput> streams;
+        if (!ReadIndex(path + ".idx", streams))
+            return false;
+
+        std::ifstream log(path, std::ios::binary);
+        if (!log.is_open())
+        {
+            std::cerr << "Failed to open the file: " << path << std::endl;
+            return false;
+        }
+
+        std::vector<TelemetryRecord> batch(4096);
+        size_t total = 0;
+        while (log)
+        {
+            log.read(reinterpret_cast<char *>(batch.data()), batch.size() * sizeof(TelemetryRecord));
+            size_t count = static_cast<size_t>(log.gcount()) / sizeof(TelemetryRecord);
+            for (size_t i = 0; i < count; ++i)
+            {
+                const TelemetryRecord &record = batch[i];
+                if (record.stream < streams.size() && streams[record.stream].file)
+                    AppendRecord(streams[record.stream], record);
+            }
+            total += count;
+        }
+
+        std::cout << path << ": " << total << " records, " << streams.size() << " streams" << std::endl;
+        return true;
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <telemetry.bin> [...]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    int status = EXIT_SUCCESS;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!Convert(argv[i]))
+            status = EXIT_FAILURE;
+    }
+    return status;
+}
@@ -0,0 +1,146 @@
+#include "telemetry.hpp"
+#include <chrono>
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+Telemetry::Telemetry()
+    : m_ring(RING_CAPACITY),
+      m_head(0),
+      m_tail(0),
+      m_dropped(0),
+      m_log(nullptr),
+      m_index(nullptr),
+      m_streamCount(0),
+      m_running(false)
+{
+    m_batch.reserve(BATCH_SIZE);
+}
+
+Telemetry::~Telemetry()
+{
+    Close();
+}
+
+Telemetry &Telemetry::Instance()
+{
+    static Telemetry telemetry;
+    return telemetry;
+}
+
+bool Telemetry::Open(const std::string &path)
+{
+    Close();
+
+    m_log = std::fopen(path.c_str(), "wb");
+    m_index = std::fopen((path + ".idx").c_str(), "w");
+    if (!m_log || !m_index)
+    {
+        spdlog::error("Failed to open the telemetry log: {}", path);
+        if (m_log)
+            std::fclose(m_log);
+        if (m_index)
+            std::fclose(m_index);
+        m_log = nullptr;
+        m_index = nullptr;
+        return false;
+    }
+
+    m_head.store(0, std::memory_order_relaxed);
+    m_tail.store(0, std::memory_order_relaxed);
+    m_dropped.store(0, std::memory_order_relaxed);
+    m_streamCount = 0;
+    m_running.store(true, std::memory_order_release);
+    m_writer = std::thread(&Telemetry::WriterLoop, this);
+    return true;
+}
+
+TelemetryStream Telemetry::RegisterStream(const std::string &textPath, const std::string &columns, bool trailingSpace)
+{
+    if (!m_index || m_streamCount == INVALID_STREAM)
+        return INVALID_STREAM;
+
+    TelemetryStream stream = m_streamCount++;
+    // Index line: id - column types - trailing separator - text path (last, so it may contain spaces)
+    std::fprintf(m_index, "%u %s %d %s\n", static_cast<unsigned>(stream), columns.c_str(), trailingSpace ? 1 : 0, textPath.c_str());
+    std::fflush(m_index);
+    return stream;
+}
+
+void Telemetry::Record(TelemetryStream stream, uint32_t flow, int64_t time, std::initializer_list<double> values)
+{
+    if (stream == INVALID_STREAM || !m_running.load(std::memory_order_relaxed))
+        return;
+
+    uint64_t head = m_head.load(std::memory_order_relaxed);
+    uint64_t tail = m_tail.load(std::memory_order_acquire);
+    if (head + values.size() - tail > RING_CAPACITY)
+    {
+        // Never block the data path, a sample is either recorded completely or not at all
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    uint16_t column = 0;
+    for (double value : values)
+    {
+        TelemetryRecord &record = m_ring[(head + column) & (RING_CAPACITY - 1)];
+        record.time = time;
+        record.flow = flow;
+        record.stream = stream;
+        record.column = column;
+        record.value = value;
+        ++column;
+    }
+    m_head.store(head + values.size(), std::memory_order_release);
+}
+
+void Telemetry::Close()
+{
+    if (!m_running.exchange(false))
+        return;
+
+    if (m_writer.joinable())
+        m_writer.join();
+
+    uint64_t dropped = m_dropped.load(std::memory_order_relaxed);
+    if (dropped > 0)
+        spdlog::warn("Telemetry ring overflowed, {} samples were dropped", dropped);
+
+    std::fclose(m_log);
+    std::fclose(m_index);
+    m_log = nullptr;
+    m_index = nullptr;
+}
+
+void Telemetry::WriterLoop()
+{
+    while (m_running.load(std::memory_order_acquire))
+    {
+        if (Drain() == 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    // Whatever the app thread published before Close()
+    while (Drain() > 0)
+    {
+    }
+}
+
+size_t Telemetry::Drain()
+{
+    uint64_t tail = m_tail.load(std::memory_order_relaxed);
+    uint64_t head = m_head.load(std::memory_order_acquire);
+    size_t count = static_cast<size_t>(std::min<uint64_t>(head - tail, BATCH_SIZE));
+    if (count == 0)
+        return 0;
+
+    m_batch.clear();
+    for (size_t i = 0; i < count; ++i)
+        m_batch.push_back(m_ring[(tail + i) & (RING_CAPACITY - 1)]);
+    m_tail.store(tail + count, std::memory_order_release);
+
+    // Flush per batch, the aggregator is usually stopped with SIGKILL
+    std::fwrite(m_batch.data(), sizeof(TelemetryRecord), m_batch.size(), m_log);
+    std::fflush(m_log);
+    return count;
+}
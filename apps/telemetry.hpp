@@ -0,0 +1,117 @@
+#ifndef TELEMETRY_HPP
+#define TELEMETRY_HPP
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdint>
+#include <initializer_list>
+
+/**
+ * Id of a telemetry stream, i.e. of one text log the recorders used to append to
+ */
+using TelemetryStream = uint16_t;
+
+constexpr TelemetryStream INVALID_STREAM = 0xFFFF;
+
+/**
+ * One column of one sample, as stored in the ring and in the binary log
+ */
+struct TelemetryRecord
+{
+    int64_t time;    // Sample time, the first column of the text line, unit: ms since the app started
+    uint32_t flow;   // FlowId the sample belongs to, INVALID_FLOW for per-process samples
+    uint16_t stream; // TelemetryStream the sample is written to
+    uint16_t column; // Index of value in the text line, not counting time
+    double value;
+};
+
+static_assert(sizeof(TelemetryRecord) == 24, "TelemetryRecord is written to disk as is");
+
+/**
+ * Per-process telemetry sink replacing the append-and-close text recorders
+ *
+ * The app thread pushes fixed-size binary records into a lock-free single-producer ring, a background writer
+ * drains it in batches to "<path>" and flushes after every batch, so a killed process only loses the last few
+ * milliseconds of samples. Streams are described in "<path>.idx" (id, column types, text path), the
+ * telemetry-convert tool turns the binary log back into the original text files. When the ring is full the
+ * whole sample is dropped rather than blocking the data path, drops are reported on Close().
+ *
+ * Record() must only be called from one thread.
+ */
+class Telemetry
+{
+public:
+    /**
+     * @brief The process-wide sink
+     */
+    static Telemetry &Instance();
+
+    ~Telemetry();
+
+    /**
+     * @brief Create (truncate) the binary log and its index, start the writer thread
+     * @param path Path of the binary log
+     * @return False if either file can't be opened
+     */
+    bool Open(const std::string &path);
+
+    /**
+     * @brief Describe a text log, must be called before samples are recorded to it
+     * @param textPath File telemetry-convert writes this stream to
+     * @param columns One character per column after the time: 'i' integer, 'f' floating point
+     * @param trailingSpace Whether a text line ends with a separator before the newline
+     * @return INVALID_STREAM if the sink isn't open
+     */
+    TelemetryStream RegisterStream(const std::string &textPath, const std::string &columns, bool trailingSpace = false);
+
+    /**
+     * @brief Record one sample, i.e. one text line, values in column order
+     */
+    void Record(TelemetryStream stream, uint32_t flow, int64_t time, std::initializer_list<double> values);
+
+    /**
+     * @brief Stop the writer thread after draining the ring and close both files
+     */
+    void Close();
+
+    /**
+     * @brief Number of samples dropped because the ring was full
+     */
+    uint64_t Dropped() const
+    {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    Telemetry();
+
+    void WriterLoop();
+
+    /**
+     * @brief Move everything published so far from the ring to the binary log
+     * @return Number of records written
+     */
+    size_t Drain();
+
+private:
+    static constexpr size_t RING_CAPACITY = size_t(1) << 16; // Records, must be a power of two
+    static constexpr size_t BATCH_SIZE = 4096;               // Max records per fwrite
+
+    std::vector<TelemetryRecord> m_ring;
+    alignas(64) std::atomic<uint64_t> m_head; // Next slot the producer writes, owned by the app thread
+    alignas(64) std::atomic<uint64_t> m_tail; // Next slot the writer reads, owned by the writer thread
+    alignas(64) std::atomic<uint64_t> m_dropped;
+
+    std::vector<TelemetryRecord> m_batch;
+    std::FILE *m_log;
+    std::FILE *m_index;
+    TelemetryStream m_streamCount;
+
+    std::thread m_writer;
+    std::atomic<bool> m_running;
+};
+
+#endif // TELEMETRY_HPP
@@ -0,0 +1,297 @@
+#ifndef TIMER_WHEEL_HPP
+#define TIMER_WHEEL_HPP
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+
+/**
+ * Hierarchical timer wheel tracking the timeouts of outstanding Interests, keyed by (flow, seq)
+ *
+ * Four levels of 64 slots with a 1 ms tick cover about 4.6 hours, later deadlines are parked in the last level and
+ * re-placed as the wheel turns. Arm() and Cancel() are O(1), Expire() costs the number of ticks elapsed plus the
+ * number of timers that are due, independently of how many Interests are outstanding.
+ *
+ * A timer that expires isn't forgotten: it stays tracked, in the expired state, until Cancel() or Arm() is called
+ * for it. So "is this Interest still outstanding" keeps being answered by Contains() until the timeout is handled.
+ */
+class TimerWheel
+{
+public:
+    using Key = uint64_t;
+
+    static constexpr Key MakeKey(uint32_t flow, uint32_t seq)
+    {
+        return (static_cast<Key>(flow) << 32) | seq;
+    }
+
+    static constexpr uint32_t KeyFlow(Key key)
+    {
+        return static_cast<uint32_t>(key >> 32);
+    }
+
+    static constexpr uint32_t KeySeq(Key key)
+    {
+        return static_cast<uint32_t>(key);
+    }
+
+    TimerWheel() : m_current(0), m_armedCount(0), m_free(NIL)
+    {
+        m_heads.fill(NIL);
+    }
+
+    /**
+     * @brief (Re)start the timer of key
+     * @param deadline Time the timer expires at, on the same clock as Expire()'s now, a deadline that has passed
+     *                 already is reported by the next Expire()
+     */
+    void Arm(Key key, std::chrono::milliseconds deadline)
+    {
+        int64_t tick = std::max<int64_t>(deadline.count(), 0);
+        auto it = m_index.find(key);
+        uint32_t node;
+        if (it != m_index.end())
+        {
+            node = it->second;
+            if (m_nodes[node].armed)
+                Unlink(node);
+            else
+                ++m_armedCount;
+        }
+        else
+        {
+            node = Allocate();
+            m_nodes[node].key = key;
+            m_index.emplace(key, node);
+            ++m_armedCount;
+        }
+        m_nodes[node].expires = static_cast<uint64_t>(tick);
+        m_nodes[node].armed = true;
+        if (m_nodes[node].expires <= m_current)
+            Link(node, DUE_SLOT); // Already due, the wheel won't come back to its tick
+        else
+            Place(node, m_current + 1);
+    }
+
+    /**
+     * @brief Stop tracking key, whether its timer is running or has expired
+     * @return False if key isn't tracked
+     */
+    bool Cancel(Key key)
+    {
+        auto it = m_index.find(key);
+        if (it == m_index.end())
+            return false;
+        uint32_t node = it->second;
+        if (m_nodes[node].armed)
+        {
+            Unlink(node);
+            --m_armedCount;
+        }
+        m_index.erase(it);
+        Free(node);
+        return true;
+    }
+
+    /**
+     * @brief Whether key is tracked, i.e. armed or expired but not cancelled yet
+     */
+    bool Contains(Key key) const
+    {
+        return m_index.find(key) != m_index.end();
+    }
+
+    /**
+     * @brief Turn the wheel up to now and report the timers that became due
+     * @param now Current time
+     * @param expired Receives the keys of the timers whose deadline is at or before now
+     * @return Number of keys appended to expired
+     */
+    size_t Expire(std::chrono::milliseconds now, std::vector<Key> &expired)
+    {
+        size_t before = expired.size();
+        ExpireSlot(DUE_SLOT, expired);
+        uint64_t target = static_cast<uint64_t>(std::max<int64_t>(now.count(), 0));
+        if (target < m_current)
+            return expired.size() - before;
+        if (m_armedCount == 0)
+        {
+            // Nothing to expire, skip the idle ticks
+            m_current = target;
+            return expired.size() - before;
+        }
+
+        while (m_current < target)
+        {
+            // Slot m_current has been processed already, the first tick of every turn cascades the upper levels
+            ++m_current;
+            for (size_t level = 1; level < LEVELS; ++level)
+            {
+                if ((m_current >> (SLOT_BITS * level)) << (SLOT_BITS * level) != m_current)
+                    break;
+                Cascade(level, (m_current >> (SLOT_BITS * level)) & SLOT_MASK);
+            }
+            ExpireSlot(m_current & SLOT_MASK, expired);
+            if (m_armedCount == 0)
+            {
+                m_current = target;
+                break;
+            }
+        }
+        return expired.size() - before;
+    }
+
+    /**
+     * @brief Number of tracked keys, armed or expired
+     */
+    size_t Size() const
+    {
+        return m_index.size();
+    }
+
+    void Clear()
+    {
+        m_nodes.clear();
+        m_index.clear();
+        m_heads.fill(NIL);
+        m_armedCount = 0;
+        m_free = NIL;
+    }
+
+private:
+    static constexpr uint32_t NIL = UINT32_MAX;
+    static constexpr size_t LEVELS = 4;
+    static constexpr size_t SLOT_BITS = 6;
+    static constexpr size_t SLOTS = size_t(1) << SLOT_BITS;
+    static constexpr uint64_t SLOT_MASK = SLOTS - 1;
+    static constexpr uint64_t SPAN = uint64_t(1) << (SLOT_BITS * LEVELS); // Ticks covered by the wheel
+    static constexpr size_t DUE_SLOT = LEVELS * SLOTS;                     // Timers armed with a deadline already passed
+
+    struct Node
+    {
+        Key key = 0;
+        uint64_t expires = 0;
+        uint32_t prev = NIL;
+        uint32_t next = NIL;   // Also links the free list
+        uint32_t slot = NIL;   // Index into m_heads
+        bool armed = false;
+    };
+
+    uint32_t Allocate()
+    {
+        if (m_free != NIL)
+        {
+            uint32_t node = m_free;
+            m_free = m_nodes[node].next;
+            m_nodes[node] = Node{};
+            return node;
+        }
+        m_nodes.emplace_back();
+        return static_cast<uint32_t>(m_nodes.size() - 1);
+    }
+
+    void Free(uint32_t node)
+    {
+        m_nodes[node].armed = false;
+        m_nodes[node].next = m_free;
+        m_free = node;
+    }
+
+    /**
+     * @brief Link node into the slot of its deadline
+     * @param earliest First tick that hasn't been processed yet, earlier deadlines are due on it
+     */
+    void Place(uint32_t node, uint64_t earliest)
+    {
+        // Deadlines beyond the wheel are parked on its last reachable tick
+        uint64_t expires = std::max(m_nodes[node].expires, earliest);
+        expires = std::min(expires, m_current + SPAN - 1);
+        uint64_t delta = expires - m_current;
+
+        size_t level = 0;
+        while (level + 1 < LEVELS && delta >= (uint64_t(1) << (SLOT_BITS * (level + 1))))
+            ++level;
+        Link(node, level * SLOTS + ((expires >> (SLOT_BITS * level)) & SLOT_MASK));
+    }
+
+    void Link(uint32_t node, size_t slot)
+    {
+        Node &n = m_nodes[node];
+        n.slot = static_cast<uint32_t>(slot);
+        n.prev = NIL;
+        n.next = m_heads[slot];
+        if (n.next != NIL)
+            m_nodes[n.next].prev = node;
+        m_heads[slot] = node;
+    }
+
+    void Unlink(uint32_t node)
+    {
+        Node &n = m_nodes[node];
+        if (n.prev != NIL)
+            m_nodes[n.prev].next = n.next;
+        else
+            m_heads[n.slot] = n.next;
+        if (n.next != NIL)
+            m_nodes[n.next].prev = n.prev;
+        n.prev = NIL;
+        n.next = NIL;
+        n.slot = NIL;
+    }
+
+    uint32_t Detach(size_t slot)
+    {
+        uint32_t node = m_heads[slot];
+        m_heads[slot] = NIL;
+        return node;
+    }
+
+    void Cascade(size_t level, uint64_t index)
+    {
+        uint32_t node = Detach(level * SLOTS + index);
+        while (node != NIL)
+        {
+            uint32_t next = m_nodes[node].next;
+            Place(node, m_current);
+            node = next;
+        }
+    }
+
+    void ExpireSlot(size_t index, std::vector<Key> &expired)
+    {
+        uint32_t node = Detach(index);
+        while (node != NIL)
+        {
+            uint32_t next = m_nodes[node].next;
+            Node &n = m_nodes[node];
+            if (n.expires > m_current)
+            {
+                // Parked beyond the wheel's span, not due yet
+                Place(node, m_current + 1);
+            }
+            else
+            {
+                n.prev = NIL;
+                n.next = NIL;
+                n.slot = NIL;
+                n.armed = false;
+                --m_armedCount;
+                expired.push_back(n.key);
+            }
+            node = next;
+        }
+    }
+
+private:
+    std::vector<Node> m_nodes;
+    std::unordered_map<Key, uint32_t> m_index; // Tracked key -> node
+    std::array<uint32_t, LEVELS * SLOTS + 1> m_heads;
+    uint64_t m_current; // Last tick processed
+    size_t m_armedCount;
+    uint32_t m_free; // Head of the free node list
+};
+
+#endif // TIMER_WHEEL_HPP
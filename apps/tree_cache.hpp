@@ -0,0 +1,160 @@
+#ifndef TREE_CACHE_HPP
+#define TREE_CACHE_HPP
+
+#include <vector>
+#include <map>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <filesystem>
+#include <system_error>
+#include <cstdint>
+#include <cstdio>
+
+/**
+ * On-disk cache of the aggregation tree the consumer builds, so a rerun on an unchanged topology skips the
+ * clustering. Entries are keyed by a hash of the topology file's contents, the producer list and the sub-tree
+ * constraint, one file per key:
+ *   ina-aggregation-tree <version> <key>
+ *   tree <parent> <child>...      (one line per entry of AggregationTree::aggregationAllocation)
+ *   subtree <node>...             (one line per entry of AggregationTree::noCHTree, in order)
+ * Node names never contain whitespace, they come from the topology file.
+ */
+class TreeCache
+{
+public:
+    using Allocation = std::map<std::string, std::vector<std::string>>;
+    using SubTrees = std::vector<std::vector<std::string>>;
+
+    // Bump when the file format or the tree construction changes, older entries are then ignored
+    static constexpr int VERSION = 1;
+
+    /**
+     * @brief Cache key of a tree construction, empty if the topology file can't be read
+     * @param backend Min-cost flow solver of the clustering, trees built by different backends are kept apart
+     */
+    static std::string Key(const std::string &topologyFile, const std::vector<std::string> &producers, int constraint, int backend)
+    {
+        std::ifstream file(topologyFile, std::ios::binary);
+        if (!file)
+            return "";
+        std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        uint64_t hash = FNV_OFFSET;
+        Hash(hash, contents);
+        for (const std::string &producer : producers)
+            Hash(hash, producer);
+        Hash(hash, std::to_string(constraint));
+        Hash(hash, std::to_string(backend));
+        Hash(hash, std::to_string(VERSION));
+
+        char key[17];
+        std::snprintf(key, sizeof(key), "%016llx", static_cast<unsigned long long>(hash));
+        return key;
+    }
+
+    /**
+     * @brief Path of the entry of key in directory
+     */
+    static std::string Path(const std::string &directory, const std::string &key)
+    {
+        return (std::filesystem::path(directory) / (key + ".tree")).string();
+    }
+
+    /**
+     * @brief Read the entry at path, false if it's missing, malformed or written for another key
+     */
+    static bool Load(const std::string &path, const std::string &key, Allocation &allocation, SubTrees &subTrees)
+    {
+        std::ifstream file(path);
+        std::string line;
+        if (!file || !std::getline(file, line) || line != Header(key))
+            return false;
+
+        Allocation loadedAllocation;
+        SubTrees loadedSubTrees;
+        while (std::getline(file, line))
+        {
+            std::istringstream fields(line);
+            std::string kind, name;
+            fields >> kind;
+            std::vector<std::string> nodes;
+            while (fields >> name)
+                nodes.push_back(name);
+
+            if (kind == "tree" && !nodes.empty())
+                loadedAllocation[nodes.front()].assign(nodes.begin() + 1, nodes.end());
+            else if (kind == "subtree")
+                loadedSubTrees.push_back(std::move(nodes));
+            else if (!kind.empty())
+                return false;
+        }
+        if (loadedAllocation.empty())
+            return false;
+
+        allocation = std::move(loadedAllocation);
+        subTrees = std::move(loadedSubTrees);
+        return true;
+    }
+
+    /**
+     * @brief Write the entry at path, through a temporary file so a concurrent reader never sees half of it
+     */
+    static bool Store(const std::string &path, const std::string &key, const Allocation &allocation, const SubTrees &subTrees)
+    {
+        std::error_code error;
+        std::filesystem::path target(path);
+        if (target.has_parent_path())
+            std::filesystem::create_directories(target.parent_path(), error);
+        if (error)
+            return false;
+
+        std::string temporary = path + ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::trunc);
+            file << Header(key) << '\n';
+            for (const auto &[parent, children] : allocation)
+            {
+                file << "tree " << parent;
+                for (const std::string &child : children)
+                    file << ' ' << child;
+                file << '\n';
+            }
+            for (const std::vector<std::string> &subTree : subTrees)
+            {
+                file << "subtree";
+                for (const std::string &node : subTree)
+                    file << ' ' << node;
+                file << '\n';
+            }
+            if (!file.flush())
+                return false;
+        }
+        std::filesystem::rename(temporary, target, error);
+        return !error;
+    }
+
+private:
+    static constexpr uint64_t FNV_OFFSET = 14695981039346656037ULL;
+    static constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+
+    // FNV-1a over the bytes of field and a separator, so ("ab", "c") and ("a", "bc") differ
+    static void Hash(uint64_t &hash, const std::string &field)
+    {
+        for (unsigned char c : field)
+        {
+            hash ^= c;
+            hash *= FNV_PRIME;
+        }
+        hash ^= 0xff;
+        hash *= FNV_PRIME;
+    }
+
+    static std::string Header(const std::string &key)
+    {
+        return "ina-aggregation-tree " + std::to_string(VERSION) + " " + key;
+    }
+};
+
+#endif // TREE_CACHE_HPP
@@ -0,0 +1,433 @@
+#ifndef WINDOW_STATS_HPP
+#define WINDOW_STATS_HPP
+
+#include <array>
+#include <algorithm>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Incremental window estimators, every sample costs O(1) (amortized for the min/max) whatever the window length
+ *
+ * Windows keep their samples in a RingBuffer whose capacity is fixed at compile time, nothing is allocated per
+ * sample. A window's runtime length can't exceed the capacity, callers clamp their configuration to it.
+ */
+
+/**
+ * @brief Fixed capacity FIFO, Capacity must be a power of two
+ */
+template <typename T, size_t Capacity>
+class RingBuffer
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "RingBuffer capacity must be a power of two");
+
+public:
+    bool Empty() const
+    {
+        return m_size == 0;
+    }
+
+    bool Full() const
+    {
+        return m_size == Capacity;
+    }
+
+    size_t Size() const
+    {
+        return m_size;
+    }
+
+    static constexpr size_t MaxSize()
+    {
+        return Capacity;
+    }
+
+    /**
+     * @brief Append value, the buffer must not be full
+     */
+    void PushBack(const T &value)
+    {
+        m_items[(m_head + m_size) & MASK] = value;
+        ++m_size;
+    }
+
+    void PopFront()
+    {
+        m_head = (m_head + 1) & MASK;
+        --m_size;
+    }
+
+    void PopBack()
+    {
+        --m_size;
+    }
+
+    const T &Front() const
+    {
+        return m_items[m_head];
+    }
+
+    const T &Back() const
+    {
+        return m_items[(m_head + m_size - 1) & MASK];
+    }
+
+    /**
+     * @brief Element index positions after the front
+     */
+    const T &operator[](size_t index) const
+    {
+        return m_items[(m_head + index) & MASK];
+    }
+
+    void Clear()
+    {
+        m_head = 0;
+        m_size = 0;
+    }
+
+private:
+    static constexpr size_t MASK = Capacity - 1;
+
+    std::array<T, Capacity> m_items{};
+    size_t m_head = 0;
+    size_t m_size = 0;
+};
+
+/**
+ * @brief Running sum and mean of the last Length() samples
+ *
+ * The sum is rebuilt from the buffer once every Capacity evictions, so rounding errors of floating point samples
+ * don't accumulate, which keeps the cost amortized O(1).
+ */
+template <typename T, size_t Capacity>
+class WindowedSum
+{
+public:
+    explicit WindowedSum(size_t length = Capacity)
+    {
+        SetLength(length);
+    }
+
+    /**
+     * @brief Change the window length, clamped to [1, Capacity], the oldest samples are dropped if it shrinks
+     */
+    void SetLength(size_t length)
+    {
+        m_length = std::clamp<size_t>(length, 1, Capacity);
+        while (m_samples.Size() > m_length)
+            Evict();
+    }
+
+    size_t Length() const
+    {
+        return m_length;
+    }
+
+    /**
+     * @brief Add a sample, the oldest one leaves the window if it's full
+     * @param evicted Set to the sample leaving the window, if any
+     * @return True if a sample left the window
+     */
+    bool Add(T value, T *evicted = nullptr)
+    {
+        bool full = m_samples.Size() == m_length;
+        if (full)
+        {
+            if (evicted != nullptr)
+                *evicted = m_samples.Front();
+            Evict();
+        }
+        m_samples.PushBack(value);
+        m_sum += value;
+        return full;
+    }
+
+    size_t Size() const
+    {
+        return m_samples.Size();
+    }
+
+    bool Full() const
+    {
+        return m_samples.Size() == m_length;
+    }
+
+    T Sum() const
+    {
+        return m_sum;
+    }
+
+    double Mean() const
+    {
+        return m_samples.Empty() ? 0.0 : static_cast<double>(m_sum) / m_samples.Size();
+    }
+
+    void Clear()
+    {
+        m_samples.Clear();
+        m_sum = T{};
+        m_evictions = 0;
+    }
+
+private:
+    void Evict()
+    {
+        m_sum -= m_samples.Front();
+        m_samples.PopFront();
+        if (++m_evictions == Capacity)
+        {
+            m_sum = T{};
+            for (size_t i = 0; i < m_samples.Size(); ++i)
+                m_sum += m_samples[i];
+            m_evictions = 0;
+        }
+    }
+
+private:
+    RingBuffer<T, Capacity> m_samples;
+    size_t m_length = Capacity;
+    T m_sum{};
+    size_t m_evictions = 0;
+};
+
+/**
+ * @brief Exponentially weighted moving average, seeded with the first sample
+ */
+class Ewma
+{
+public:
+    /**
+     * @param alpha Weight of a new sample, between 0 and 1
+     */
+    explicit Ewma(double alpha = 0.3) : m_alpha(alpha) {}
+
+    void SetAlpha(double alpha)
+    {
+        m_alpha = alpha;
+    }
+
+    void Add(double value)
+    {
+        m_value = m_empty ? value : m_alpha * value + (1 - m_alpha) * m_value;
+        m_empty = false;
+    }
+
+    bool Empty() const
+    {
+        return m_empty;
+    }
+
+    /**
+     * @brief Current average, 0 before the first sample
+     */
+    double Value() const
+    {
+        return m_value;
+    }
+
+    void Clear()
+    {
+        m_value = 0.0;
+        m_empty = true;
+    }
+
+private:
+    double m_alpha;
+    double m_value = 0.0;
+    bool m_empty = true;
+};
+
+/**
+ * @brief Minimum (or maximum, with std::greater) of the last Length() samples
+ *
+ * Monotonic deque: a sample that can never be the extremum again, because a newer one is at least as good, is
+ * dropped on arrival, so the front always holds the answer.
+ */
+template <typename T, size_t Capacity, typename Compare = std::less<T>>
+class WindowedExtremum
+{
+public:
+    explicit WindowedExtremum(size_t length = Capacity)
+    {
+        SetLength(length);
+    }
+
+    /**
+     * @brief Change the window length, clamped to [1, Capacity], takes effect from the next sample
+     */
+    void SetLength(size_t length)
+    {
+        m_length = std::clamp<size_t>(length, 1, Capacity);
+    }
+
+    void Add(T value)
+    {
+        uint64_t index = m_count++;
+        while (!m_candidates.Empty() && !m_compare(m_candidates.Back().value, value))
+            m_candidates.PopBack();
+        while (!m_candidates.Empty() && m_candidates.Front().index + m_length <= index)
+            m_candidates.PopFront();
+        m_candidates.PushBack({index, value});
+    }
+
+    bool Empty() const
+    {
+        return m_candidates.Empty();
+    }
+
+    /**
+     * @brief Extremum of the window, the window must not be empty
+     */
+    T Value() const
+    {
+        return m_candidates.Front().value;
+    }
+
+    void Clear()
+    {
+        m_candidates.Clear();
+        m_count = 0;
+    }
+
+private:
+    struct Candidate
+    {
+        uint64_t index; // Position of the sample in the stream
+        T value;
+    };
+
+    RingBuffer<Candidate, Capacity> m_candidates;
+    size_t m_length = Capacity;
+    uint64_t m_count = 0;
+    Compare m_compare;
+};
+
+template <typename T, size_t Capacity>
+using WindowedMin = WindowedExtremum<T, Capacity, std::less<T>>;
+
+template <typename T, size_t Capacity>
+using WindowedMax = WindowedExtremum<T, Capacity, std::greater<T>>;
+
+/**
+ * @brief Streaming estimate of one quantile in five markers (the P-square algorithm of Jain and Chlamtac)
+ *
+ * Covers every sample since the last Clear(), exact until the fifth one.
+ */
+class QuantileSketch
+{
+public:
+    /**
+     * @param quantile Between 0 and 1, e.g. 0.95
+     */
+    explicit QuantileSketch(double quantile = 0.5) : m_quantile(quantile) {}
+
+    void Add(double value)
+    {
+        if (m_count < MARKERS)
+        {
+            m_heights[m_count++] = value;
+            if (m_count == MARKERS)
+            {
+                std::sort(m_heights.begin(), m_heights.end());
+                double p = m_quantile;
+                m_positions = {0, 1, 2, 3, 4};
+                m_desired = {0, 2 * p, 4 * p, 2 + 2 * p, 4};
+                m_increments = {0, p / 2, p, (1 + p) / 2, 1};
+            }
+            return;
+        }
+        ++m_count;
+
+        // Cell the sample falls in, stretching the extreme markers if needed
+        size_t cell;
+        if (value < m_heights[0])
+        {
+            m_heights[0] = value;
+            cell = 0;
+        }
+        else if (value >= m_heights[MARKERS - 1])
+        {
+            m_heights[MARKERS - 1] = value;
+            cell = MARKERS - 2;
+        }
+        else
+        {
+            cell = 0;
+            while (value >= m_heights[cell + 1])
+                ++cell;
+        }
+        for (size_t i = cell + 1; i < MARKERS; ++i)
+            m_positions[i] += 1;
+        for (size_t i = 0; i < MARKERS; ++i)
+            m_desired[i] += m_increments[i];
+
+        // Move the middle markers one step towards their desired positions
+        for (size_t i = 1; i < MARKERS - 1; ++i)
+        {
+            double offset = m_desired[i] - m_positions[i];
+            if ((offset >= 1 && m_positions[i + 1] - m_positions[i] > 1) || (offset <= -1 && m_positions[i - 1] - m_positions[i] < -1))
+            {
+                int step = offset >= 0 ? 1 : -1;
+                double height = Parabolic(i, step);
+                if (m_heights[i - 1] < height && height < m_heights[i + 1])
+                    m_heights[i] = height;
+                else
+                    m_heights[i] = Linear(i, step);
+                m_positions[i] += step;
+            }
+        }
+    }
+
+    uint64_t Count() const
+    {
+        return m_count;
+    }
+
+    /**
+     * @brief Current estimate, 0 before the first sample
+     */
+    double Value() const
+    {
+        if (m_count >= MARKERS)
+            return m_heights[2];
+        if (m_count == 0)
+            return 0.0;
+        std::array<double, MARKERS> sorted = m_heights;
+        std::sort(sorted.begin(), sorted.begin() + m_count);
+        return sorted[static_cast<size_t>(m_quantile * (m_count - 1) + 0.5)];
+    }
+
+    void Clear()
+    {
+        m_count = 0;
+    }
+
+private:
+    double Parabolic(size_t i, int step) const
+    {
+        double n = m_positions[i], nPrev = m_positions[i - 1], nNext = m_positions[i + 1];
+        return m_heights[i] + step / (nNext - nPrev) *
+                                  ((n - nPrev + step) * (m_heights[i + 1] - m_heights[i]) / (nNext - n) +
+                                   (nNext - n - step) * (m_heights[i] - m_heights[i - 1]) / (n - nPrev));
+    }
+
+    double Linear(size_t i, int step) const
+    {
+        size_t neighbour = step > 0 ? i + 1 : i - 1;
+        return m_heights[i] + step * (m_heights[neighbour] - m_heights[i]) / (m_positions[neighbour] - m_positions[i]);
+    }
+
+private:
+    static constexpr size_t MARKERS = 5;
+
+    double m_quantile;
+    uint64_t m_count = 0;
+    std::array<double, MARKERS> m_heights{};    // Marker heights, the estimate is the middle one
+    std::array<double, MARKERS> m_positions{};  // Actual marker positions
+    std::array<double, MARKERS> m_desired{};    // Desired marker positions
+    std::array<double, MARKERS> m_increments{}; // Growth of the desired positions per sample
+};
+
+#endif // WINDOW_STATS_HPP
@@ -8,6 +8,7 @@
 #include "../pipeline/pipeline-interests-hybla.hpp"
 #include "../pipeline/pipeliner.hpp"
 #include "../pipeline/discover-version.hpp"
+#include "logging.hpp"
 
 #include <boost/lexical_cast.hpp>
 #include <ndn-cxx/security/validator-null.hpp>
@@ -65,17 +66,17 @@ namespace ndn::chunks
         if (m_options.isVerbose)
         {
             std::cerr << "Requesting chunk #" << chuNo << "\n";
-            spdlog::debug("Requesting chunk #{}, Name :{}", chuNo, m_prefix.toUri());
+            LOG_DEBUG(Log::PIPELINE, "Requesting chunk #{}, Name :{}", chuNo, m_prefix.toUri());
         }
 
         ChunkInfo &chuInfo = m_chunkInfo[chuNo];
         chuInfo.pipeliner = new Pipeliner(security::getAcceptAllValidator());
         Name namewithchuno;
 
-        spdlog::debug("Lambda expression executed for chunk #{}", chuNo);
+        LOG_DEBUG(Log::PIPELINE, "Lambda expression executed for chunk #{}", chuNo);
         // auto &chuInfo = m_chunkInfo[chuNo];
         namewithchuno = Name(m_prefix).append(std::to_string(chuNo));
-        spdlog::debug("Name :{}", namewithchuno.toUri());
+        LOG_DEBUG(Log::PIPELINE, "Name :{}", namewithchuno.toUri());
         auto discover = std::make_unique<DiscoverVersion>(m_face, namewithchuno, m_options);
         std::unique_ptr<PipelineInterestsAdaptive> pipeline;
 
@@ -110,7 +111,7 @@ namespace ndn::chunks
         chuInfo.timeSent = time::steady_clock::now();
         m_nSent++;
         m_highInterest = chuNo;
-        spdlog::debug("Finished sending interest for chunk #{}", chuNo);
+        LOG_DEBUG(Log::PIPELINE, "Finished sending interest for chunk #{}", chuNo);
 
         // m_scheduler.schedule(time::milliseconds(0), [this, &pipeline]() mutable
         // {
@@ -129,7 +130,7 @@ namespace ndn::chunks
     ChunksInterestsAdaptive::checkSendNext(uint64_t chuNo)
     {
 
-        spdlog::debug("Check send next");
+        LOG_DEBUG(Log::PIPELINE, "Check send next");
         ChunkInfo &chuInfo = m_chunkInfo[chuNo];
         if (m_checkEvent)
         {
@@ -137,12 +138,12 @@ namespace ndn::chunks
         }
         if (chuInfo.pipeliner->m_pipeline->m_canschedulenext)
         {
-            spdlog::debug("Send next chunk");
+            LOG_DEBUG(Log::PIPELINE, "Send next chunk");
             sendInterest(getNextChunkNo());
         }
         else
         {
-            spdlog::debug("Schedule next check");
+            LOG_DEBUG(Log::PIPELINE, "Schedule next check");
             m_checkEvent = m_scheduler.schedule(time::milliseconds(0), [this, chuNo]
                                                 { checkSendNext(chuNo); });
         }
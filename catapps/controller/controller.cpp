@@ -5,6 +5,7 @@
 #include <stdexcept>
 #include <ndn-cxx/encoding/block.hpp>
 #include <ndn-cxx/util/sha256.hpp>
+#include "kernels/reduce.hpp"
 
 namespace ndn::chunks
 {
@@ -416,15 +417,15 @@ namespace ndn::chunks
             Name dataName = segmentData[0]->getName();
 
             // 从所有数据包中提取内容
-            std::vector<std::vector<uint8_t>> contents;
+            std::vector<const uint8_t *> contents;
+            contents.reserve(segmentData.size());
             size_t minSize = std::numeric_limits<size_t>::max();
 
             for (const auto &data : segmentData)
             {
                 const Block &content = data->getContent();
-                std::vector<uint8_t> contentBytes(content.value(), content.value() + content.value_size());
-                contents.push_back(contentBytes);
-                minSize = std::min(minSize, contentBytes.size());
+                contents.push_back(content.value());
+                minSize = std::min(minSize, content.value_size());
             }
 
             if (minSize == 0)
@@ -434,21 +435,12 @@ namespace ndn::chunks
             }
 
             // 执行字节级平均
-            std::vector<uint8_t> averagedContent(minSize);
-
-            for (size_t i = 0; i < minSize; ++i)
-            {
-                uint64_t sum = 0;
-                for (const auto &content : contents)
-                {
-                    sum += content[i];
-                }
-                averagedContent[i] = static_cast<uint8_t>(sum / contents.size());
-            }
+            auto averagedContent = make_shared<Buffer>(minSize);
+            Reduce::mean(averagedContent->data(), contents.data(), contents.size(), minSize);
 
             // 创建新的数据包
             auto resultData = std::make_shared<Data>(dataName);
-            resultData->setContent(make_shared<Buffer>(averagedContent.data(), averagedContent.size()));
+            resultData->setContent(averagedContent);
             resultData->setFreshnessPeriod(segmentData[0]->getFreshnessPeriod());
 
             result[segNo] = resultData;
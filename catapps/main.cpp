@@ -18,6 +18,7 @@
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/ini_parser.hpp>
 #include <spdlog/sinks/basic_file_sink.h>
+#include "logging.hpp"
 
 #include <fstream>
 #include <iostream>
@@ -158,10 +159,7 @@ namespace ndn::chunks
     static int
     main(int argc, char *argv[])
     {
-        auto m_logger = spdlog::basic_logger_mt("splitter_logger", "logs/consumer.log");
-        spdlog::set_default_logger(m_logger);
-        spdlog::set_level(spdlog::level::debug);
-        spdlog::flush_on(spdlog::level::debug);
+        auto m_logger = Log::init("splitter_logger", "logs/consumer.log", "../experiments/conconfig.ini");
         const std::string programName(argv[0]);
 
         Options options;
@@ -342,8 +340,8 @@ namespace ndn::chunks
             Splitter splitter(security::getAcceptAllValidator());
             BOOST_ASSERT(discover != nullptr);
             BOOST_ASSERT(pipeline != nullptr);
-            spdlog::set_level(spdlog::level::from_str(logLevel));
-            spdlog::flush_on(spdlog::level::from_str(logLevel));
+            // Subsystems with a level of their own in [Log] keep it, flushing follows Log.FlushLevel
+            Log::setLevel(spdlog::level::from_str(logLevel));
             splitter.run(std::move(discover), std::move(split));
             spdlog::info("starting processing events");
 
@@ -144,7 +144,7 @@ namespace ndn::chunks
         data->setFreshnessPeriod(time::seconds(10));
         data->setContent(makeStringBlock(tlv::Content, "Get initial interest"));
 
-        m_keyChain.sign(*data);
+        m_keyChain.sign(*data, m_options.signingInfo);
 
         m_face.put(*data);
 